@@ -17,6 +17,7 @@
 #include "unicode/uchar.h"
 #include "unicode/uniset.h"
 #include "unicode/chariter.h"
+#include "unicode/ubrk.h"
 #include "unicode/ures.h"
 #include "unicode/udata.h"
 #include "unicode/putil.h"
@@ -31,6 +32,13 @@
 #include "umutex.h"
 #include "uresimp.h"
 #include "ubrkimpl.h"
+#include "ucmndata.h"
+#include "udatamem.h"
+#include "umapfile.h"
+
+#if !UCONFIG_NO_FILE_IO
+#include <stdio.h>
+#endif
 
 U_NAMESPACE_BEGIN
 
@@ -124,7 +132,8 @@ UnhandledEngine::handleCharacter(UChar32 c, int32_t breakType) {
  ******************************************************************
  */
 
-ICULanguageBreakFactory::ICULanguageBreakFactory(UErrorCode &/*status*/) {
+ICULanguageBreakFactory::ICULanguageBreakFactory(UErrorCode &/*status*/)
+        : fPublishedEngineCount(0) {
     fEngines = 0;
 }
 
@@ -149,6 +158,16 @@ ICULanguageBreakFactory::getEngineFor(UChar32 c, int32_t breakType) {
     const LanguageBreakEngine *lbe = NULL;
     UErrorCode  status = U_ZERO_ERROR;
 
+    // Look through the published engines first, without locking.
+    // Engines are published after they are fully constructed, and only appended.
+    int32_t i = umtx_loadAcquire(fPublishedEngineCount);
+    while (--i >= 0) {
+        lbe = fPublishedEngines[i];
+        if (lbe->handles(c, breakType)) {
+            return lbe;
+        }
+    }
+
     Mutex m(&gBreakEngineMutex);
 
     if (fEngines == NULL) {
@@ -160,7 +179,7 @@ ICULanguageBreakFactory::getEngineFor(UChar32 c, int32_t breakType) {
         }
         fEngines = engines;
     } else {
-        int32_t i = fEngines->size();
+        i = fEngines->size();
         while (--i >= 0) {
             lbe = (const LanguageBreakEngine *)(fEngines->elementAt(i));
             if (lbe != NULL && lbe->handles(c, breakType)) {
@@ -173,6 +192,11 @@ ICULanguageBreakFactory::getEngineFor(UChar32 c, int32_t breakType) {
     lbe = loadEngineFor(c, breakType);
     if (lbe != NULL) {
         fEngines->push((void *)lbe, status);
+        int32_t count = umtx_loadAcquire(fPublishedEngineCount);
+        if (U_SUCCESS(status) && count < kMaxPublishedEngines) {
+            fPublishedEngines[count] = lbe;
+            umtx_storeRelease(fPublishedEngineCount, count + 1);
+        }
     }
     return lbe;
 }
@@ -184,62 +208,203 @@ ICULanguageBreakFactory::loadEngineFor(UChar32 c, int32_t breakType) {
     if (U_SUCCESS(status)) {
         DictionaryMatcher *m = loadDictionaryMatcherFor(code, breakType);
         if (m != NULL) {
-            const LanguageBreakEngine *engine = NULL;
-            switch(code) {
-            case USCRIPT_THAI:
-                engine = new ThaiBreakEngine(m, status);
-                break;
-            case USCRIPT_LAO:
-                engine = new LaoBreakEngine(m, status);
-                break;
-            case USCRIPT_MYANMAR:
-                engine = new BurmeseBreakEngine(m, status);
-                break;
-            case USCRIPT_KHMER:
-                engine = new KhmerBreakEngine(m, status);
-                break;
+            return createEngine(code, m, status);
+        }
+    }
+    return NULL;
+}
+
+LanguageBreakEngine *
+ICULanguageBreakFactory::createEngine(UScriptCode script, DictionaryMatcher *m, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        delete m;
+        return NULL;
+    }
+    LanguageBreakEngine *engine = NULL;
+    switch(script) {
+    case USCRIPT_THAI:
+        engine = new ThaiBreakEngine(m, status);
+        break;
+    case USCRIPT_LAO:
+        engine = new LaoBreakEngine(m, status);
+        break;
+    case USCRIPT_MYANMAR:
+        engine = new BurmeseBreakEngine(m, status);
+        break;
+    case USCRIPT_KHMER:
+        engine = new KhmerBreakEngine(m, status);
+        break;
 
 #if !UCONFIG_NO_NORMALIZATION
-                // CJK not available w/o normalization
-            case USCRIPT_HANGUL:
-                engine = new CjkBreakEngine(m, kKorean, status);
-                break;
-
-            // use same BreakEngine and dictionary for both Chinese and Japanese
-            case USCRIPT_HIRAGANA:
-            case USCRIPT_KATAKANA:
-            case USCRIPT_HAN:
-                engine = new CjkBreakEngine(m, kChineseJapanese, status);
-                break;
+        // CJK not available w/o normalization
+    case USCRIPT_HANGUL:
+        engine = new CjkBreakEngine(m, kKorean, status);
+        break;
+
+    // use same BreakEngine and dictionary for both Chinese and Japanese
+    case USCRIPT_HIRAGANA:
+    case USCRIPT_KATAKANA:
+    case USCRIPT_HAN:
+        engine = new CjkBreakEngine(m, kChineseJapanese, status);
+        break;
 #if 0
-            // TODO: Have to get some characters with script=common handled
-            // by CjkBreakEngine (e.g. U+309B). Simply subjecting
-            // them to CjkBreakEngine does not work. The engine has to
-            // special-case them.
-            case USCRIPT_COMMON:
-            {
-                UBlockCode block = ublock_getCode(code);
-                if (block == UBLOCK_HIRAGANA || block == UBLOCK_KATAKANA)
-                   engine = new CjkBreakEngine(dict, kChineseJapanese, status);
-                break;
-            }
+    // TODO: Have to get some characters with script=common handled
+    // by CjkBreakEngine (e.g. U+309B). Simply subjecting
+    // them to CjkBreakEngine does not work. The engine has to
+    // special-case them.
+    case USCRIPT_COMMON:
+    {
+        UBlockCode block = ublock_getCode(code);
+        if (block == UBLOCK_HIRAGANA || block == UBLOCK_KATAKANA)
+           engine = new CjkBreakEngine(dict, kChineseJapanese, status);
+        break;
+    }
 #endif
 #endif
 
-            default:
-                break;
-            }
-            if (engine == NULL) {
-                delete m;
-            }
-            else if (U_FAILURE(status)) {
-                delete engine;
-                engine = NULL;
-            }
-            return engine;
-        }
+    default:
+        break;
     }
+    if (engine == NULL) {
+        delete m;
+    }
+    else if (U_FAILURE(status)) {
+        delete engine;
+        engine = NULL;
+    }
+    return engine;
+}
+
+/**
+ * Creates a DictionaryMatcher for .dict data.
+ * Closes the file if no matcher can be created.
+ */
+static DictionaryMatcher *
+createDictionaryMatcher(UDataMemory *file) {
+    const uint8_t *data = (const uint8_t *)udata_getMemory(file);
+    const int32_t *indexes = (const int32_t *)data;
+    const int32_t offset = indexes[DictionaryData::IX_STRING_TRIE_OFFSET];
+    const int32_t trieType = indexes[DictionaryData::IX_TRIE_TYPE] & DictionaryData::TRIE_TYPE_MASK;
+    DictionaryMatcher *m = NULL;
+    if (trieType == DictionaryData::TRIE_TYPE_BYTES) {
+        const int32_t transform = indexes[DictionaryData::IX_TRANSFORM];
+        const char *characters = (const char *)(data + offset);
+        m = new BytesDictionaryMatcher(characters, transform, file);
+    }
+    else if (trieType == DictionaryData::TRIE_TYPE_UCHARS) {
+        const UChar *characters = (const UChar *)(data + offset);
+        m = new UCharsDictionaryMatcher(characters, file);
+    }
+    if (m == NULL) {
+        // no matcher exists to take ownership - either we are an invalid 
+        // type or memory allocation failed
+        udata_close(file);
+    }
+    return m;
+}
+
+/**
+ * Memory-maps a .dict file given by its full path, and validates its header
+ * and indexes. Unlike udata_open(), this does not look in the ICU data.
+ */
+static UDataMemory *
+openDictionaryFile(const char *path, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return NULL;
+    }
+    if (path == NULL) {
+        status = U_ILLEGAL_ARGUMENT_ERROR;
+        return NULL;
+    }
+#if UCONFIG_NO_FILE_IO
+    status = U_UNSUPPORTED_ERROR;
     return NULL;
+#else
+    int32_t fileLength = -1;
+    FILE *f = fopen(path, "rb");
+    if (f != NULL) {
+        if (fseek(f, 0, SEEK_END) == 0) {
+            fileLength = (int32_t)ftell(f);
+        }
+        fclose(f);
+    }
+    UDataMemory dataMemory;
+    if (fileLength < (int32_t)sizeof(DataHeader) || !uprv_mapFile(&dataMemory, path)) {
+        status = U_FILE_ACCESS_ERROR;
+        return NULL;
+    }
+
+    const DataHeader *pHeader = dataMemory.pHeader;
+    const UDataInfo &info = pHeader->info;
+    int32_t headerSize = pHeader->dataHeader.headerSize;
+    int32_t length = fileLength - headerSize;
+    const int32_t *indexes = (const int32_t *)((const char *)pHeader + headerSize);
+    UBool isValid =
+        pHeader->dataHeader.magic1 == 0xda &&
+        pHeader->dataHeader.magic2 == 0x27 &&
+        info.size >= sizeof(UDataInfo) &&
+        info.isBigEndian == U_IS_BIG_ENDIAN &&
+        info.charsetFamily == U_CHARSET_FAMILY &&
+        info.sizeofUChar == U_SIZEOF_UCHAR &&
+        info.dataFormat[0] == 0x44 &&   // dataFormat="Dict"
+        info.dataFormat[1] == 0x69 &&
+        info.dataFormat[2] == 0x63 &&
+        info.dataFormat[3] == 0x74 &&
+        info.formatVersion[0] == 1 &&
+        (headerSize & 15) == 0 &&
+        length >= (int32_t)(DictionaryData::IX_COUNT * 4) &&
+        indexes[DictionaryData::IX_STRING_TRIE_OFFSET] >= (int32_t)(DictionaryData::IX_COUNT * 4) &&
+        indexes[DictionaryData::IX_STRING_TRIE_OFFSET] < indexes[DictionaryData::IX_RESERVED1_OFFSET] &&
+        indexes[DictionaryData::IX_TOTAL_SIZE] <= length;
+    if (!isValid) {
+        udata_close(&dataMemory);
+        status = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+
+    UDataMemory *file = UDataMemory_createNewInstance(&status);
+    if (U_FAILURE(status)) {
+        udata_close(&dataMemory);
+        return NULL;
+    }
+    file->pHeader = pHeader;
+    file->mapAddr = dataMemory.mapAddr;
+    file->map = dataMemory.map;
+    file->length = fileLength;
+    return file;
+#endif
+}
+
+LanguageBreakEngine *
+ICULanguageBreakFactory::createEngineWithDictionary(UScriptCode script, const char *path,
+                                                    UErrorCode &status) {
+    UDataMemory *file = openDictionaryFile(path, status);
+    if (U_FAILURE(status)) {
+        return NULL;
+    }
+    DictionaryMatcher *custom = createDictionaryMatcher(file);
+    if (custom == NULL) {
+        status = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+    DictionaryMatcher *m = loadDictionaryMatcherFor(script, UBRK_WORD);
+    if (m != NULL) {
+        DictionaryMatcher *both = new UnionDictionaryMatcher(m, custom);
+        if (both == NULL) {
+            delete m;
+            delete custom;
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return NULL;
+        }
+        m = both;
+    } else {
+        m = custom;
+    }
+    LanguageBreakEngine *engine = createEngine(script, m, status);
+    if (engine == NULL && U_SUCCESS(status)) {
+        status = U_UNSUPPORTED_ERROR;
+    }
+    return engine;
 }
 
 DictionaryMatcher *
@@ -269,26 +434,7 @@ ICULanguageBreakFactory::loadDictionaryMatcherFor(UScriptCode script, int32_t /*
     UDataMemory *file = udata_open(U_ICUDATA_BRKITR, ext.data(), dictnbuf.data(), &status);
     if (U_SUCCESS(status)) {
         // build trie
-        const uint8_t *data = (const uint8_t *)udata_getMemory(file);
-        const int32_t *indexes = (const int32_t *)data;
-        const int32_t offset = indexes[DictionaryData::IX_STRING_TRIE_OFFSET];
-        const int32_t trieType = indexes[DictionaryData::IX_TRIE_TYPE] & DictionaryData::TRIE_TYPE_MASK;
-        DictionaryMatcher *m = NULL;
-        if (trieType == DictionaryData::TRIE_TYPE_BYTES) {
-            const int32_t transform = indexes[DictionaryData::IX_TRANSFORM];
-            const char *characters = (const char *)(data + offset);
-            m = new BytesDictionaryMatcher(characters, transform, file);
-        }
-        else if (trieType == DictionaryData::TRIE_TYPE_UCHARS) {
-            const UChar *characters = (const UChar *)(data + offset);
-            m = new UCharsDictionaryMatcher(characters, file);
-        }
-        if (m == NULL) {
-            // no matcher exists to take ownership - either we are an invalid 
-            // type or memory allocation failed
-            udata_close(file);
-        }
-        return m;
+        return createDictionaryMatcher(file);
     } else if (dictfname != NULL) {
         // we don't have a dictionary matcher.
         // returning NULL here will cause us to fail to find a dictionary break engine, as expected
@@ -298,6 +444,34 @@ ICULanguageBreakFactory::loadDictionaryMatcherFor(UScriptCode script, int32_t /*
     return NULL;
 }
 
+/*
+ ******************************************************************
+ */
+
+SharedBreakEngine::SharedBreakEngine(LanguageBreakEngine *adoptEngine, const SharedBreakEngine *next)
+        : fEngine(adoptEngine), fNext(next) {
+    if (fNext != NULL) {
+        fNext->addRef();
+    }
+}
+
+SharedBreakEngine::~SharedBreakEngine() {
+    delete fEngine;
+    if (fNext != NULL) {
+        fNext->removeRef();
+    }
+}
+
+const LanguageBreakEngine *
+SharedBreakEngine::findEngineFor(UChar32 c, int32_t breakType) const {
+    for (const SharedBreakEngine *p = this; p != NULL; p = p->fNext) {
+        if (p->fEngine->handles(c, breakType)) {
+            return p->fEngine;
+        }
+    }
+    return NULL;
+}
+
 U_NAMESPACE_END
 
 #endif /* #if !UCONFIG_NO_BREAK_ITERATION */
@@ -14,6 +14,8 @@
 #include "unicode/uobject.h"
 #include "unicode/utext.h"
 #include "unicode/uscript.h"
+#include "sharedobject.h"
+#include "umutex.h"
 
 U_NAMESPACE_BEGIN
 
@@ -234,6 +236,24 @@ class ICULanguageBreakFactory : public LanguageBreakFactory {
 
   UStack    *fEngines;
 
+  enum { kMaxPublishedEngines = 16 };
+
+    /**
+     * The first kMaxPublishedEngines engines created by this factory, also in fEngines,
+     * for lookup without locking. Engines are only ever appended, and they are not
+     * deleted before the factory. getEngineFor() looks up any later engines in
+     * fEngines while holding gBreakEngineMutex.
+     * @internal
+     */
+  const LanguageBreakEngine *fPublishedEngines[kMaxPublishedEngines];
+
+    /**
+     * The number of engines in fPublishedEngines. It is incremented with release
+     * semantics after an engine is stored, and read with acquire semantics.
+     * @internal
+     */
+  u_atomic_int32_t fPublishedEngineCount;
+
  public:
 
   /**
@@ -261,6 +281,35 @@ class ICULanguageBreakFactory : public LanguageBreakFactory {
   */
   virtual const LanguageBreakEngine *getEngineFor(UChar32 c, int32_t breakType);
 
+ /**
+  * <p>Create a LanguageBreakEngine for the specified script that uses a
+  * custom dictionary in addition to the dictionary in the ICU data, if any.
+  * The custom dictionary file, in the format written by the gendict tool,
+  * is memory-mapped.
+  * The engine is owned by the caller, not by this factory.</p>
+  *
+  * @param script The script whose characters the engine is to handle.
+  * @param path The full path of the dictionary file.
+  * @param status Set to U_FILE_ACCESS_ERROR if the file cannot be read,
+  * U_INVALID_FORMAT_ERROR if it is not a dictionary,
+  * U_UNSUPPORTED_ERROR if there is no dictionary-based engine for the script.
+  * @return A new LanguageBreakEngine, or NULL.
+  */
+  LanguageBreakEngine *createEngineWithDictionary(UScriptCode script, const char *path,
+                                                  UErrorCode &status);
+
+ /**
+  * <p>Create a LanguageBreakEngine for the specified script with the given dictionary.</p>
+  *
+  * @param script The script whose characters the engine is to handle.
+  * @param adoptDictionary The dictionary. It is deleted if no engine is created.
+  * @param status Information on any errors encountered.
+  * @return A new LanguageBreakEngine, or NULL if there is no dictionary-based
+  * engine for the script.
+  */
+  static LanguageBreakEngine *createEngine(UScriptCode script, DictionaryMatcher *adoptDictionary,
+                                           UErrorCode &status);
+
 protected:
  /**
   * <p>Create a LanguageBreakEngine for the set of characters to which
@@ -285,6 +334,50 @@ protected:
   virtual DictionaryMatcher *loadDictionaryMatcherFor(UScriptCode script, int32_t breakType);
 };
 
+/*******************************************************************
+ * SharedBreakEngine
+ */
+
+/**
+ * <p>SharedBreakEngine is a reference-counted, immutable list node
+ * that owns one LanguageBreakEngine. Break iterators use such lists
+ * for engines with custom dictionaries, and share them among clones.</p>
+ */
+class SharedBreakEngine : public SharedObject {
+ public:
+
+  /**
+   * <p>Constructor. Adds a reference to next, if not NULL.</p>
+   *
+   * @param adoptEngine The engine, deleted with this object.
+   * @param next The rest of the list, or NULL.
+   */
+  SharedBreakEngine(LanguageBreakEngine *adoptEngine, const SharedBreakEngine *next);
+
+  /**
+   * <p>Virtual destructor. Removes the reference to the rest of the list.</p>
+   */
+  virtual ~SharedBreakEngine();
+
+  /**
+   * <p>Find the engine in this list that handles the character.</p>
+   *
+   * @param c A character that begins a run for which a LanguageBreakEngine is
+   * sought.
+   * @param breakType The kind of text break for which a LanguageBreakEngine is
+   * sought.
+   * @return The first engine in the list that handles c, or NULL.
+   */
+  const LanguageBreakEngine *findEngineFor(UChar32 c, int32_t breakType) const;
+
+ private:
+  LanguageBreakEngine *fEngine;
+  const SharedBreakEngine *fNext;
+
+  SharedBreakEngine(const SharedBreakEngine &other);  // not implemented
+  SharedBreakEngine &operator=(const SharedBreakEngine &other);  // not implemented
+};
+
 U_NAMESPACE_END
 
     /* BRKENG_H */
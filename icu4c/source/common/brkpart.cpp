@@ -0,0 +1,294 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   Copyright (C) 2016, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*******************************************************************************
+*   file name:  brkpart.cpp
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   LineBreakPartitioner: splits a text at mandatory line breaks so that
+*   the partitions can be line-broken independently (and concurrently),
+*   then merges the per-partition boundaries.
+*/
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_BREAK_ITERATION
+
+#include "unicode/brkpart.h"
+#include "unicode/rbbi.h"
+#include "unicode/uchar.h"
+#include "unicode/utext.h"
+#include "uvector.h"
+#include "uvectr32.h"
+
+U_NAMESPACE_BEGIN
+
+/**
+ * The results for one partition.
+ * reach is the boundary where iteration stopped: the start of a later partition
+ * or the end of the text. boundaries holds all boundaries after the
+ * partition start, up to and including reach.
+ */
+class LineBreakPartition : public UObject {
+public:
+    LineBreakPartition(UErrorCode &status) : boundaries(status), reach(-1), isDone(FALSE) {}
+    virtual ~LineBreakPartition();
+
+    UVector32 boundaries;
+    int32_t reach;
+    UBool isDone;
+};
+
+LineBreakPartition::~LineBreakPartition() {}
+
+UOBJECT_DEFINE_RTTI_IMPLEMENTATION(LineBreakPartitioner)
+
+LineBreakPartitioner::LineBreakPartitioner(const BreakIterator &lineIter, UErrorCode &status)
+        : fIter(NULL), fText(NULL), fTextLength(0), fCutPoints(NULL), fPartitions(NULL) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    const RuleBasedBreakIterator *rbbi = dynamic_cast<const RuleBasedBreakIterator *>(&lineIter);
+    if (rbbi == NULL) {
+        status = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    fIter = static_cast<RuleBasedBreakIterator *>(rbbi->clone());
+    fCutPoints = new UVector32(status);
+    fPartitions = new UVector(uprv_deleteUObject, NULL, status);
+    if (fIter == NULL || fCutPoints == NULL || fPartitions == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    // Drop the caller's text so that per-partition clones do not copy it.
+    UText empty = UTEXT_INITIALIZER;
+    utext_openUChars(&empty, NULL, 0, &status);
+    fIter->setText(&empty, status);
+    utext_close(&empty);
+}
+
+LineBreakPartitioner::~LineBreakPartitioner() {
+    delete fPartitions;
+    delete fCutPoints;
+    utext_close(fText);
+    delete fIter;
+}
+
+void LineBreakPartitioner::clearPartitions() {
+    if (fPartitions != NULL) {
+        fPartitions->removeAllElements();
+    }
+    if (fCutPoints != NULL) {
+        fCutPoints->removeAllElements();
+    }
+    fTextLength = 0;
+}
+
+static inline UBool isMandatoryBreak(UChar32 c) {
+    switch (u_getIntPropertyValue(c, UCHAR_LINE_BREAK)) {
+    case U_LB_MANDATORY_BREAK:
+    case U_LB_CARRIAGE_RETURN:
+    case U_LB_LINE_FEED:
+    case U_LB_NEXT_LINE:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+void LineBreakPartitioner::setText(UText *text, int32_t minLength, UErrorCode &status) {
+    clearPartitions();
+    if (U_FAILURE(status)) {
+        return;
+    }
+    if (fIter == NULL) {
+        status = U_INVALID_STATE_ERROR;
+        return;
+    }
+    if (text == NULL) {
+        status = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    if (minLength < 1) {
+        minLength = 1;
+    }
+    fText = utext_clone(fText, text, FALSE, TRUE, &status);
+    if (U_FAILURE(status)) {
+        return;
+    }
+    fTextLength = (int32_t)utext_nativeLength(fText);
+
+    // Cut after a mandatory break once the partition is long enough.
+    // Never cut between CR and LF: the LF is a mandatory break itself.
+    fCutPoints->addElement(0, status);
+    int32_t start = 0;
+    utext_setNativeIndex(fText, 0);
+    UChar32 c;
+    while ((c = UTEXT_NEXT32(fText)) >= 0) {
+        if (c == 0xd && UTEXT_CURRENT32(fText) == 0xa) {
+            continue;
+        }
+        if (isMandatoryBreak(c)) {
+            int32_t limit = (int32_t)UTEXT_GETNATIVEINDEX(fText);
+            if ((limit - start) >= minLength && limit < fTextLength) {
+                fCutPoints->addElement(limit, status);
+                start = limit;
+            }
+        }
+    }
+    fCutPoints->addElement(fTextLength, status);
+
+    int32_t count = fCutPoints->size() - 1;
+    for (int32_t i = 0; i < count && U_SUCCESS(status); ++i) {
+        LineBreakPartition *p = new LineBreakPartition(status);
+        if (p == NULL) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+            break;
+        }
+        fPartitions->addElement(p, status);
+        if (U_FAILURE(status)) {
+            delete p;
+        }
+    }
+    if (U_FAILURE(status)) {
+        clearPartitions();
+    }
+}
+
+int32_t LineBreakPartitioner::countPartitions() const {
+    return fPartitions == NULL ? 0 : fPartitions->size();
+}
+
+int32_t LineBreakPartitioner::getPartitionStart(int32_t index) const {
+    if (index < 0 || index >= countPartitions()) {
+        return -1;
+    }
+    return fCutPoints->elementAti(index);
+}
+
+int32_t LineBreakPartitioner::getPartitionLimit(int32_t index) const {
+    if (index < 0 || index >= countPartitions()) {
+        return -1;
+    }
+    return fCutPoints->elementAti(index + 1);
+}
+
+void LineBreakPartitioner::breakPartition(int32_t index, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    if (index < 0 || index >= countPartitions()) {
+        status = U_INDEX_OUTOFBOUNDS_ERROR;
+        return;
+    }
+    LineBreakPartition *p = static_cast<LineBreakPartition *>(fPartitions->elementAt(index));
+    if (p->isDone) {
+        return;
+    }
+    p->boundaries.removeAllElements();
+
+    // The iterator clone and the text clone are owned by this call,
+    // which keeps concurrent calls for different partitions independent.
+    RuleBasedBreakIterator *iter = static_cast<RuleBasedBreakIterator *>(fIter->clone());
+    if (iter == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    UText *text = utext_clone(NULL, fText, FALSE, TRUE, &status);
+    iter->setText(text, status);
+    if (U_FAILURE(status)) {
+        utext_close(text);
+        delete iter;
+        return;
+    }
+    // The partition start is a boundary and the rules restart there,
+    // so iterate forward as if from the start of the text.
+    iter->first();
+    utext_setNativeIndex(iter->fText, fCutPoints->elementAti(index));
+
+    // Stop at the first boundary that is the start of a later partition.
+    // Normally that is the limit of this partition.
+    const int32_t *cutPoints = fCutPoints->getBuffer();
+    int32_t cutIndex = index + 1;
+    int32_t cutCount = fCutPoints->size();
+    int32_t b;
+    for (;;) {
+        b = iter->next();
+        if (b == BreakIterator::DONE) {
+            b = fTextLength;
+            break;
+        }
+        p->boundaries.addElement(b, status);
+        while (cutIndex < cutCount && cutPoints[cutIndex] < b) {
+            ++cutIndex;
+        }
+        if (cutIndex < cutCount && cutPoints[cutIndex] == b) {
+            break;
+        }
+    }
+    delete iter;
+    utext_close(text);
+    if (U_SUCCESS(status)) {
+        p->reach = b;
+        p->isDone = TRUE;
+    }
+}
+
+void LineBreakPartitioner::breakAllPartitions(UErrorCode &status) {
+    int32_t count = countPartitions();
+    for (int32_t i = 0; i < count && U_SUCCESS(status); ++i) {
+        breakPartition(i, status);
+    }
+}
+
+int32_t LineBreakPartitioner::getBoundaries(int32_t *dest, int32_t capacity, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return 0;
+    }
+    if (capacity < 0 || (dest == NULL && capacity > 0)) {
+        status = U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    int32_t count = countPartitions();
+    if (count == 0) {
+        status = U_INVALID_STATE_ERROR;
+        return 0;
+    }
+    int32_t length = 0;
+    if (capacity > 0) {
+        dest[0] = 0;
+    }
+    ++length;
+    // Follow the chain of partitions whose starts are reached by the previous ones.
+    int32_t index = 0;
+    while (index < count) {
+        breakPartition(index, status);
+        if (U_FAILURE(status)) {
+            return 0;
+        }
+        const LineBreakPartition *p = static_cast<const LineBreakPartition *>(fPartitions->elementAt(index));
+        int32_t n = p->boundaries.size();
+        for (int32_t i = 0; i < n; ++i, ++length) {
+            if (length < capacity) {
+                dest[length] = p->boundaries.elementAti(i);
+            }
+        }
+        if (p->reach >= fTextLength) {
+            break;
+        }
+        index = fCutPoints->indexOf(p->reach, index + 1);
+    }
+    if (length > capacity) {
+        status = U_BUFFER_OVERFLOW_ERROR;
+    }
+    return length;
+}
+
+U_NAMESPACE_END
+
+#endif  /* !UCONFIG_NO_BREAK_ITERATION */
@@ -115,6 +115,57 @@ DictionaryBreakEngine::setCharacters( const UnicodeSet &set ) {
 // that form a nested sequence.
 static const int32_t POSSIBLE_WORD_LIST_MAX = 20;
 
+// Number of entries in a CandidateCache; must be a power of 2.
+static const int32_t CANDIDATE_CACHE_SIZE = 16;
+
+// Direct-mapped cache of dictionary lookups at text offsets within one
+// dictionary range. The PossibleWord ring entries look up the same offsets
+// repeatedly while they look ahead, back up and resynchronize; with the cache,
+// each offset is normally matched against the dictionary only once.
+// The results depend on the range end, so a cache must not outlive its range.
+class CandidateCache : public UMemory {
+private:
+    struct Entry {
+        int32_t   offset;     // Text offset of the lookup, or -1
+        int32_t   count;
+        int32_t   prefix;
+        int32_t   cuLengths[POSSIBLE_WORD_LIST_MAX];
+        int32_t   cpLengths[POSSIBLE_WORD_LIST_MAX];
+    };
+
+    DictionaryMatcher *dict;
+    int32_t   rangeEnd;
+    Entry     entries[CANDIDATE_CACHE_SIZE];
+
+public:
+    CandidateCache(DictionaryMatcher *d, int32_t end) : dict(d), rangeEnd(end) {
+        for (int32_t i = 0; i < CANDIDATE_CACHE_SIZE; ++i) {
+            entries[i].offset = -1;
+        }
+    };
+    ~CandidateCache() {};
+
+    // Find the dictionary words starting at the current text position, like
+    // DictionaryMatcher::matches(). The text position is undefined afterwards.
+    int32_t   matches( UText *text, int32_t *cuLengths, int32_t *cpLengths, int32_t *prefix );
+};
+
+int32_t CandidateCache::matches( UText *text, int32_t *cuLengths, int32_t *cpLengths, int32_t *prefix ) {
+    int32_t start = (int32_t)utext_getNativeIndex(text);
+    Entry &e = entries[start & (CANDIDATE_CACHE_SIZE - 1)];
+    if (e.offset != start) {
+        e.count = dict->matches(text, rangeEnd-start, POSSIBLE_WORD_LIST_MAX,
+                                e.cuLengths, e.cpLengths, NULL, &e.prefix);
+        e.offset = start;
+    }
+    if (e.count > 0) {
+        uprv_memcpy(cuLengths, e.cuLengths, e.count * 4);
+        uprv_memcpy(cpLengths, e.cpLengths, e.count * 4);
+    }
+    *prefix = e.prefix;
+    return e.count;
+}
+
 class PossibleWord {
 private:
     // list of word candidate lengths, in increasing length order
@@ -132,7 +183,7 @@ public:
     ~PossibleWord() {};
   
     // Fill the list of candidates if needed, select the longest, and return the number found
-    int32_t   candidates( UText *text, DictionaryMatcher *dict, int32_t rangeEnd );
+    int32_t   candidates( UText *text, CandidateCache &cache );
   
     // Select the currently marked candidate, point after it in the text, and invalidate self
     int32_t   acceptMarked( UText *text );
@@ -153,12 +204,12 @@ public:
 };
 
 
-int32_t PossibleWord::candidates( UText *text, DictionaryMatcher *dict, int32_t rangeEnd ) {
+int32_t PossibleWord::candidates( UText *text, CandidateCache &cache ) {
     // TODO: If getIndex is too slow, use offset < 0 and add discardAll()
     int32_t start = (int32_t)utext_getNativeIndex(text);
     if (start != offset) {
         offset = start;
-        count = dict->matches(text, rangeEnd-start, UPRV_LENGTHOF(cuLengths), cuLengths, cpLengths, NULL, &prefix);
+        count = cache.matches(text, cuLengths, cpLengths, &prefix);
         // Dictionary leaves text after longest prefix, not longest word. Back up.
         if (count <= 0) {
             utext_setNativeIndex(text, start);
@@ -263,6 +314,7 @@ ThaiBreakEngine::divideUpDictionaryRange( UText *text,
     int32_t current;
     UErrorCode status = U_ZERO_ERROR;
     PossibleWord words[THAI_LOOKAHEAD];
+    CandidateCache candidateCache(fDictionary, rangeEnd);
     
     utext_setNativeIndex(text, rangeStart);
     
@@ -271,7 +323,7 @@ ThaiBreakEngine::divideUpDictionaryRange( UText *text,
         cuWordLength = 0;
 
         // Look for candidate words at the current position
-        int32_t candidates = words[wordsFound%THAI_LOOKAHEAD].candidates(text, fDictionary, rangeEnd);
+        int32_t candidates = words[wordsFound%THAI_LOOKAHEAD].candidates(text, candidateCache);
         
         // If we found exactly one, use that
         if (candidates == 1) {
@@ -287,7 +339,7 @@ ThaiBreakEngine::divideUpDictionaryRange( UText *text,
             }
             do {
                 int32_t wordsMatched = 1;
-                if (words[(wordsFound + 1) % THAI_LOOKAHEAD].candidates(text, fDictionary, rangeEnd) > 0) {
+                if (words[(wordsFound + 1) % THAI_LOOKAHEAD].candidates(text, candidateCache) > 0) {
                     if (wordsMatched < 2) {
                         // Followed by another dictionary word; mark first word as a good candidate
                         words[wordsFound%THAI_LOOKAHEAD].markCurrent();
@@ -302,7 +354,7 @@ ThaiBreakEngine::divideUpDictionaryRange( UText *text,
                     // See if any of the possible second words is followed by a third word
                     do {
                         // If we find a third word, stop right away
-                        if (words[(wordsFound + 2) % THAI_LOOKAHEAD].candidates(text, fDictionary, rangeEnd)) {
+                        if (words[(wordsFound + 2) % THAI_LOOKAHEAD].candidates(text, candidateCache)) {
                             words[wordsFound % THAI_LOOKAHEAD].markCurrent();
                             goto foundBest;
                         }
@@ -329,7 +381,7 @@ foundBest:
             // if it is a dictionary word, do nothing. If it isn't, then if there is
             // no preceding word, or the non-word shares less than the minimum threshold
             // of characters with a dictionary word, then scan to resynchronize
-            if (words[wordsFound % THAI_LOOKAHEAD].candidates(text, fDictionary, rangeEnd) <= 0
+            if (words[wordsFound % THAI_LOOKAHEAD].candidates(text, candidateCache) <= 0
                   && (cuWordLength == 0
                       || words[wordsFound%THAI_LOOKAHEAD].longestPrefix() < THAI_PREFIX_COMBINE_THRESHOLD)) {
                 // Look for a plausible word boundary
@@ -352,7 +404,7 @@ foundBest:
                         // two characters after uc were not 0x0E4C THANTHAKHAT before
                         // checking the dictionary. That is just a performance filter,
                         // but it's not clear it's faster than checking the trie.
-                        int32_t candidates = words[(wordsFound + 1) % THAI_LOOKAHEAD].candidates(text, fDictionary, rangeEnd);
+                        int32_t candidates = words[(wordsFound + 1) % THAI_LOOKAHEAD].candidates(text, candidateCache);
                         utext_setNativeIndex(text, current + cuWordLength + chars);
                         if (candidates > 0) {
                             break;
@@ -386,7 +438,7 @@ foundBest:
         // resynch continues to function. For example, one of the suffix characters
         // could be a typo in the middle of a word.
         if ((int32_t)utext_getNativeIndex(text) < rangeEnd && cuWordLength > 0) {
-            if (words[wordsFound%THAI_LOOKAHEAD].candidates(text, fDictionary, rangeEnd) <= 0
+            if (words[wordsFound%THAI_LOOKAHEAD].candidates(text, candidateCache) <= 0
                 && fSuffixSet.contains(uc = utext_current32(text))) {
                 if (uc == THAI_PAIYANNOI) {
                     if (!fSuffixSet.contains(utext_previous32(text))) {
@@ -498,6 +550,7 @@ LaoBreakEngine::divideUpDictionaryRange( UText *text,
     int32_t current;
     UErrorCode status = U_ZERO_ERROR;
     PossibleWord words[LAO_LOOKAHEAD];
+    CandidateCache candidateCache(fDictionary, rangeEnd);
     
     utext_setNativeIndex(text, rangeStart);
     
@@ -506,7 +559,7 @@ LaoBreakEngine::divideUpDictionaryRange( UText *text,
         cpWordLength = 0;
 
         // Look for candidate words at the current position
-        int32_t candidates = words[wordsFound%LAO_LOOKAHEAD].candidates(text, fDictionary, rangeEnd);
+        int32_t candidates = words[wordsFound%LAO_LOOKAHEAD].candidates(text, candidateCache);
         
         // If we found exactly one, use that
         if (candidates == 1) {
@@ -522,7 +575,7 @@ LaoBreakEngine::divideUpDictionaryRange( UText *text,
             }
             do {
                 int32_t wordsMatched = 1;
-                if (words[(wordsFound + 1) % LAO_LOOKAHEAD].candidates(text, fDictionary, rangeEnd) > 0) {
+                if (words[(wordsFound + 1) % LAO_LOOKAHEAD].candidates(text, candidateCache) > 0) {
                     if (wordsMatched < 2) {
                         // Followed by another dictionary word; mark first word as a good candidate
                         words[wordsFound%LAO_LOOKAHEAD].markCurrent();
@@ -537,7 +590,7 @@ LaoBreakEngine::divideUpDictionaryRange( UText *text,
                     // See if any of the possible second words is followed by a third word
                     do {
                         // If we find a third word, stop right away
-                        if (words[(wordsFound + 2) % LAO_LOOKAHEAD].candidates(text, fDictionary, rangeEnd)) {
+                        if (words[(wordsFound + 2) % LAO_LOOKAHEAD].candidates(text, candidateCache)) {
                             words[wordsFound % LAO_LOOKAHEAD].markCurrent();
                             goto foundBest;
                         }
@@ -561,7 +614,7 @@ foundBest:
             // if it is a dictionary word, do nothing. If it isn't, then if there is
             // no preceding word, or the non-word shares less than the minimum threshold
             // of characters with a dictionary word, then scan to resynchronize
-            if (words[wordsFound % LAO_LOOKAHEAD].candidates(text, fDictionary, rangeEnd) <= 0
+            if (words[wordsFound % LAO_LOOKAHEAD].candidates(text, candidateCache) <= 0
                   && (cuWordLength == 0
                       || words[wordsFound%LAO_LOOKAHEAD].longestPrefix() < LAO_PREFIX_COMBINE_THRESHOLD)) {
                 // Look for a plausible word boundary
@@ -582,7 +635,7 @@ foundBest:
                     if (fEndWordSet.contains(pc) && fBeginWordSet.contains(uc)) {
                         // Maybe. See if it's in the dictionary.
                         // TODO: this looks iffy; compare with old code.
-                        int32_t candidates = words[(wordsFound + 1) % LAO_LOOKAHEAD].candidates(text, fDictionary, rangeEnd);
+                        int32_t candidates = words[(wordsFound + 1) % LAO_LOOKAHEAD].candidates(text, candidateCache);
                         utext_setNativeIndex(text, current + cuWordLength + chars);
                         if (candidates > 0) {
                             break;
@@ -691,6 +744,7 @@ BurmeseBreakEngine::divideUpDictionaryRange( UText *text,
     int32_t current;
     UErrorCode status = U_ZERO_ERROR;
     PossibleWord words[BURMESE_LOOKAHEAD];
+    CandidateCache candidateCache(fDictionary, rangeEnd);
     
     utext_setNativeIndex(text, rangeStart);
     
@@ -699,7 +753,7 @@ BurmeseBreakEngine::divideUpDictionaryRange( UText *text,
         cpWordLength = 0;
 
         // Look for candidate words at the current position
-        int32_t candidates = words[wordsFound%BURMESE_LOOKAHEAD].candidates(text, fDictionary, rangeEnd);
+        int32_t candidates = words[wordsFound%BURMESE_LOOKAHEAD].candidates(text, candidateCache);
         
         // If we found exactly one, use that
         if (candidates == 1) {
@@ -715,7 +769,7 @@ BurmeseBreakEngine::divideUpDictionaryRange( UText *text,
             }
             do {
                 int32_t wordsMatched = 1;
-                if (words[(wordsFound + 1) % BURMESE_LOOKAHEAD].candidates(text, fDictionary, rangeEnd) > 0) {
+                if (words[(wordsFound + 1) % BURMESE_LOOKAHEAD].candidates(text, candidateCache) > 0) {
                     if (wordsMatched < 2) {
                         // Followed by another dictionary word; mark first word as a good candidate
                         words[wordsFound%BURMESE_LOOKAHEAD].markCurrent();
@@ -730,7 +784,7 @@ BurmeseBreakEngine::divideUpDictionaryRange( UText *text,
                     // See if any of the possible second words is followed by a third word
                     do {
                         // If we find a third word, stop right away
-                        if (words[(wordsFound + 2) % BURMESE_LOOKAHEAD].candidates(text, fDictionary, rangeEnd)) {
+                        if (words[(wordsFound + 2) % BURMESE_LOOKAHEAD].candidates(text, candidateCache)) {
                             words[wordsFound % BURMESE_LOOKAHEAD].markCurrent();
                             goto foundBest;
                         }
@@ -754,7 +808,7 @@ foundBest:
             // if it is a dictionary word, do nothing. If it isn't, then if there is
             // no preceding word, or the non-word shares less than the minimum threshold
             // of characters with a dictionary word, then scan to resynchronize
-            if (words[wordsFound % BURMESE_LOOKAHEAD].candidates(text, fDictionary, rangeEnd) <= 0
+            if (words[wordsFound % BURMESE_LOOKAHEAD].candidates(text, candidateCache) <= 0
                   && (cuWordLength == 0
                       || words[wordsFound%BURMESE_LOOKAHEAD].longestPrefix() < BURMESE_PREFIX_COMBINE_THRESHOLD)) {
                 // Look for a plausible word boundary
@@ -775,7 +829,7 @@ foundBest:
                     if (fEndWordSet.contains(pc) && fBeginWordSet.contains(uc)) {
                         // Maybe. See if it's in the dictionary.
                         // TODO: this looks iffy; compare with old code.
-                        int32_t candidates = words[(wordsFound + 1) % BURMESE_LOOKAHEAD].candidates(text, fDictionary, rangeEnd);
+                        int32_t candidates = words[(wordsFound + 1) % BURMESE_LOOKAHEAD].candidates(text, candidateCache);
                         utext_setNativeIndex(text, current + cuWordLength + chars);
                         if (candidates > 0) {
                             break;
@@ -896,6 +950,7 @@ KhmerBreakEngine::divideUpDictionaryRange( UText *text,
     int32_t current;
     UErrorCode status = U_ZERO_ERROR;
     PossibleWord words[KHMER_LOOKAHEAD];
+    CandidateCache candidateCache(fDictionary, rangeEnd);
 
     utext_setNativeIndex(text, rangeStart);
 
@@ -904,7 +959,7 @@ KhmerBreakEngine::divideUpDictionaryRange( UText *text,
         cpWordLength = 0;
 
         // Look for candidate words at the current position
-        int32_t candidates = words[wordsFound%KHMER_LOOKAHEAD].candidates(text, fDictionary, rangeEnd);
+        int32_t candidates = words[wordsFound%KHMER_LOOKAHEAD].candidates(text, candidateCache);
 
         // If we found exactly one, use that
         if (candidates == 1) {
@@ -921,7 +976,7 @@ KhmerBreakEngine::divideUpDictionaryRange( UText *text,
             }
             do {
                 int32_t wordsMatched = 1;
-                if (words[(wordsFound + 1) % KHMER_LOOKAHEAD].candidates(text, fDictionary, rangeEnd) > 0) {
+                if (words[(wordsFound + 1) % KHMER_LOOKAHEAD].candidates(text, candidateCache) > 0) {
                     if (wordsMatched < 2) {
                         // Followed by another dictionary word; mark first word as a good candidate
                         words[wordsFound % KHMER_LOOKAHEAD].markCurrent();
@@ -936,7 +991,7 @@ KhmerBreakEngine::divideUpDictionaryRange( UText *text,
                     // See if any of the possible second words is followed by a third word
                     do {
                         // If we find a third word, stop right away
-                        if (words[(wordsFound + 2) % KHMER_LOOKAHEAD].candidates(text, fDictionary, rangeEnd)) {
+                        if (words[(wordsFound + 2) % KHMER_LOOKAHEAD].candidates(text, candidateCache)) {
                             words[wordsFound % KHMER_LOOKAHEAD].markCurrent();
                             goto foundBest;
                         }
@@ -960,7 +1015,7 @@ foundBest:
             // if it is a dictionary word, do nothing. If it isn't, then if there is
             // no preceding word, or the non-word shares less than the minimum threshold
             // of characters with a dictionary word, then scan to resynchronize
-            if (words[wordsFound % KHMER_LOOKAHEAD].candidates(text, fDictionary, rangeEnd) <= 0
+            if (words[wordsFound % KHMER_LOOKAHEAD].candidates(text, candidateCache) <= 0
                   && (cuWordLength == 0
                       || words[wordsFound % KHMER_LOOKAHEAD].longestPrefix() < KHMER_PREFIX_COMBINE_THRESHOLD)) {
                 // Look for a plausible word boundary
@@ -980,7 +1035,7 @@ foundBest:
                     uc = utext_current32(text);
                     if (fEndWordSet.contains(pc) && fBeginWordSet.contains(uc)) {
                         // Maybe. See if it's in the dictionary.
-                        int32_t candidates = words[(wordsFound + 1) % KHMER_LOOKAHEAD].candidates(text, fDictionary, rangeEnd);
+                        int32_t candidates = words[(wordsFound + 1) % KHMER_LOOKAHEAD].candidates(text, candidateCache);
                         utext_setNativeIndex(text, current+cuWordLength+chars);
                         if (candidates > 0) {
                             break;
@@ -1014,7 +1069,7 @@ foundBest:
         // resynch continues to function. For example, one of the suffix characters
         // could be a typo in the middle of a word.
 //        if ((int32_t)utext_getNativeIndex(text) < rangeEnd && wordLength > 0) {
-//            if (words[wordsFound%KHMER_LOOKAHEAD].candidates(text, fDictionary, rangeEnd) <= 0
+//            if (words[wordsFound%KHMER_LOOKAHEAD].candidates(text, candidateCache) <= 0
 //                && fSuffixSet.contains(uc = utext_current32(text))) {
 //                if (uc == KHMER_PAIYANNOI) {
 //                    if (!fSuffixSet.contains(utext_previous32(text))) {
@@ -153,6 +153,79 @@ int32_t BytesDictionaryMatcher::matches(UText *text, int32_t maxLength, int32_t
     return wordCount;
 }
 
+UnionDictionaryMatcher::~UnionDictionaryMatcher() {
+    delete first;
+    delete second;
+}
+
+int32_t UnionDictionaryMatcher::getType() const {
+    return first->getType();
+}
+
+int32_t UnionDictionaryMatcher::matches(UText *text, int32_t maxLength, int32_t limit,
+                            int32_t *lengths, int32_t *cpLengths, int32_t *values,
+                            int32_t *prefix) const {
+    if (limit < 0) {
+        limit = 0;
+    }
+    // Lengths 0..limit-1 from the first dictionary, limit..2*limit-1 from the second one.
+    MaybeStackArray<int32_t, 40> lengthsArray, cpLengthsArray, valuesArray;
+    if ((limit * 2) > lengthsArray.getCapacity() &&
+            (lengthsArray.resize(limit * 2) == NULL ||
+             cpLengthsArray.resize(limit * 2) == NULL ||
+             valuesArray.resize(limit * 2) == NULL)) {
+        return 0;
+    }
+    int32_t *l = lengthsArray.getAlias();
+    int32_t *cpl = cpLengthsArray.getAlias();
+    int32_t *v = values != NULL ? valuesArray.getAlias() : NULL;
+
+    int32_t startingTextIndex = (int32_t)utext_getNativeIndex(text);
+    int32_t firstPrefix = 0, secondPrefix = 0;
+    int32_t firstCount = first->matches(text, maxLength, limit,
+                                        l, cpl, v, &firstPrefix);
+    int32_t firstEnd = (int32_t)utext_getNativeIndex(text);
+    utext_setNativeIndex(text, startingTextIndex);
+    int32_t secondCount = second->matches(text, maxLength, limit,
+                                          l + limit, cpl + limit, v != NULL ? v + limit : NULL,
+                                          &secondPrefix);
+    int32_t secondEnd = (int32_t)utext_getNativeIndex(text);
+    // Like the other matchers, leave the text after the longest prefix match.
+    if (firstEnd > secondEnd) {
+        utext_setNativeIndex(text, firstEnd);
+    }
+
+    // Merge the two ascending lists of lengths.
+    int32_t i = 0, j = limit, wordCount = 0;
+    int32_t firstLimit = firstCount, secondLimit = limit + secondCount;
+    while ((i < firstLimit || j < secondLimit) && wordCount < limit) {
+        int32_t k;
+        if (j >= secondLimit || (i < firstLimit && l[i] < l[j])) {
+            k = i++;
+        } else {
+            if (i < firstLimit && l[i] == l[j]) {
+                ++i;  // same word in both dictionaries
+            }
+            k = j++;
+        }
+        if (values != NULL) {
+            values[wordCount] = v[k];
+        }
+        if (lengths != NULL) {
+            lengths[wordCount] = l[k];
+        }
+        if (cpLengths != NULL) {
+            cpLengths[wordCount] = cpl[k];
+        }
+        ++wordCount;
+    }
+
+    if (prefix != NULL) {
+        *prefix = firstPrefix > secondPrefix ? firstPrefix : secondPrefix;
+    }
+    return wordCount;
+}
+
 
 U_NAMESPACE_END
 
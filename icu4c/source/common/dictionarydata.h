@@ -135,6 +135,25 @@ private:
     UDataMemory *file;
 };
 
+// Implementation of the DictionaryMatcher interface for the union of two dictionaries,
+// typically a dictionary from the ICU data plus a custom one.
+// Where both dictionaries contain a word, the value from the second one is returned.
+// Both DictionaryMatcher objects are deleted on this object's destruction.
+class U_COMMON_API UnionDictionaryMatcher : public DictionaryMatcher {
+public:
+    UnionDictionaryMatcher(DictionaryMatcher *adoptFirst, DictionaryMatcher *adoptSecond)
+            : first(adoptFirst), second(adoptSecond) { }
+    virtual ~UnionDictionaryMatcher();
+    virtual int32_t matches(UText *text, int32_t maxLength, int32_t limit,
+                            int32_t *lengths, int32_t *cpLengths, int32_t *values,
+                            int32_t *prefix) const;
+    // returns the type of the first dictionary
+    virtual int32_t getType() const;
+private:
+    DictionaryMatcher *first;
+    DictionaryMatcher *second;
+};
+
 U_NAMESPACE_END
 
 U_CAPI int32_t U_EXPORT2
@@ -146,6 +146,28 @@ RuleBasedBreakIterator::RuleBasedBreakIterator( const UnicodeString  &rules,
 }
 
 
+//-------------------------------------------------------------------------------
+//
+//   Constructor       from a set of rules supplied as a string,
+//                     with a directory of precompiled rules as a cache.
+//
+//-------------------------------------------------------------------------------
+RuleBasedBreakIterator::RuleBasedBreakIterator( const UnicodeString  &rules,
+                                                const char           *cacheDirectory,
+                                                UParseError          &parseError,
+                                                UErrorCode           &status)
+{
+    init();
+    if (U_FAILURE(status)) {return;}
+    RuleBasedBreakIterator *bi = (RuleBasedBreakIterator *)
+        RBBIRuleBuilder::createCachedRuleBasedBreakIterator(rules, cacheDirectory, &parseError, status);
+    if (U_SUCCESS(status)) {
+        *this = *bi;
+        delete bi;
+    }
+}
+
+
 //-------------------------------------------------------------------------------
 //
 // Default Constructor.      Create an empty shell that can be set up later.
@@ -203,6 +225,7 @@ RuleBasedBreakIterator::~RuleBasedBreakIterator() {
         delete fUnhandledBreakEngine;
         fUnhandledBreakEngine = NULL;
     }
+    SharedObject::clearPtr(fCustomBreakEngines);
 }
 
 /**
@@ -221,6 +244,7 @@ RuleBasedBreakIterator::operator=(const RuleBasedBreakIterator& that) {
         fLanguageBreakEngines = NULL;   // Just rebuild for now
     }
     // TODO: clone fLanguageBreakEngines from "that"
+    SharedObject::copyPtr(that.fCustomBreakEngines, fCustomBreakEngines);
     UErrorCode status = U_ZERO_ERROR;
     fText = utext_clone(fText, that.fText, FALSE, TRUE, &status);
 
@@ -273,6 +297,7 @@ void RuleBasedBreakIterator::init() {
     fCachedBreakPositions    = NULL;
     fLanguageBreakEngines    = NULL;
     fUnhandledBreakEngine    = NULL;
+    fCustomBreakEngines      = NULL;
     fNumCachedBreakPositions = 0;
     fPositionInCache         = 0;
 
@@ -1808,9 +1833,18 @@ RuleBasedBreakIterator::getLanguageBreakEngine(UChar32 c) {
         }
     }
     
-    // No existing dictionary took the character. See if a factory wants to
-    // give us a new LanguageBreakEngine for this character.
-    lbe = getLanguageBreakEngineFromFactory(c, fBreakType);
+    // No existing dictionary took the character. Engines with custom
+    // dictionaries take precedence over those from the factories.
+    if (fCustomBreakEngines != NULL) {
+        lbe = fCustomBreakEngines->findEngineFor(c, fBreakType);
+    } else {
+        lbe = NULL;
+    }
+
+    // See if a factory wants to give us a new LanguageBreakEngine for this character.
+    if (lbe == NULL) {
+        lbe = getLanguageBreakEngineFromFactory(c, fBreakType);
+    }
     
     // If we got one, use it and push it on our stack.
     if (lbe != NULL) {
@@ -1845,6 +1879,43 @@ RuleBasedBreakIterator::getLanguageBreakEngine(UChar32 c) {
     return fUnhandledBreakEngine;
 }
 
+//-------------------------------------------------------------------------------
+//
+//  addDictionary   Create an engine that uses a custom dictionary file
+//                  and put it in front of the other engines.
+//
+//-------------------------------------------------------------------------------
+void
+RuleBasedBreakIterator::addDictionary(UScriptCode script, const char *path, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    ICULanguageBreakFactory factory(status);
+    LanguageBreakEngine *engine = factory.createEngineWithDictionary(script, path, status);
+    if (U_FAILURE(status)) {
+        delete engine;
+        return;
+    }
+    SharedBreakEngine *engines = new SharedBreakEngine(engine, fCustomBreakEngines);
+    if (engines == NULL) {
+        delete engine;
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    SharedObject::copyPtr(engines, fCustomBreakEngines);
+
+    // Forget the engines found so far, and any breaks found with them.
+    reset();
+    if (fLanguageBreakEngines != NULL) {
+        delete fLanguageBreakEngines;
+        fLanguageBreakEngines = NULL;
+    }
+    if (fUnhandledBreakEngine != NULL) {
+        delete fUnhandledBreakEngine;
+        fUnhandledBreakEngine = NULL;
+    }
+}
+
 
 
 /*int32_t RuleBasedBreakIterator::getBreakType() const {
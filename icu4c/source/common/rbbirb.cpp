@@ -24,8 +24,13 @@
 #include "unicode/uchriter.h"
 #include "unicode/parsepos.h"
 #include "unicode/parseerr.h"
+#include "unicode/icudataver.h"
+#include "charstr.h"
 #include "cmemory.h"
 #include "cstring.h"
+#include "ucachefile.h"
+#include "udatamem.h"
+#include "ustr_imp.h"
 
 #include "rbbirb.h"
 #include "rbbinode.h"
@@ -315,6 +320,84 @@ RBBIRuleBuilder::createRuleBasedBreakIterator( const UnicodeString    &rules,
     return This;
 }
 
+
+//----------------------------------------------------------------------------------------
+//
+//  createCachedRuleBasedBreakIterator    construct from source rules, looking for
+//                                        the compiled rules in a cache directory first.
+//
+//  Cache files are named for a hash of the rules with comments and control characters removed,
+//  which is also the rule source that is stored in the compiled data. A file is used only
+//  if its key (ICU, Unicode and ICU data versions) matches and its stored rules are the same
+//  as the requested rules; otherwise the rules are compiled and the file is (re)written.
+//  Problems with the cache never cause failure: they fall back to compiling the rules.
+//
+//----------------------------------------------------------------------------------------
+BreakIterator *
+RBBIRuleBuilder::createCachedRuleBasedBreakIterator( const UnicodeString    &rules,
+                                    const char       *cacheDirectory,
+                                    UParseError      *parseError,
+                                    UErrorCode       &status)
+{
+    if (U_FAILURE(status)) {
+        return NULL;
+    }
+    UnicodeString strippedRules(RBBIRuleScanner::stripRules(rules));
+    char fileName[32];
+    sprintf(fileName, "rbbi_%08x.brk",
+            (unsigned)ustr_hashUCharsN(strippedRules.getBuffer(), strippedRules.length()));
+
+    // The compiled character classes depend on the Unicode properties in the ICU data.
+    UErrorCode cacheStatus = U_ZERO_ERROR;
+    UVersionInfo dataVersion;
+    char version[U_MAX_VERSION_STRING_LENGTH];
+    CharString key("RBBI ICU " U_ICU_VERSION " Unicode " U_UNICODE_VERSION " data ", cacheStatus);
+    u_getDataVersion(dataVersion, &cacheStatus);
+    u_versionToString(dataVersion, version);
+    key.append(version, cacheStatus);
+
+    UDataInfo info = {
+        sizeof(UDataInfo),
+        0,
+        U_IS_BIG_ENDIAN,
+        U_CHARSET_FAMILY,
+        U_SIZEOF_UCHAR,
+        0,
+        { 0x42, 0x72, 0x6b, 0x20 },     // dataFormat="Brk "
+        { 3, 1, 0, 0 },                 // formatVersion, as in flattenData()
+        { 0, 0, 0, 0 }                  // dataVersion
+    };
+    u_getUnicodeVersion(info.dataVersion);
+
+    UDataMemory *udm = ucachefile_open(cacheDirectory, fileName, &info, key.data(), &cacheStatus);
+    if (udm != NULL) {
+        const RBBIDataHeader *data = (const RBBIDataHeader *)udata_getMemory(udm);
+        if (data->fMagic == 0xb1a0 && data->fFormatVersion[0] == 3 &&
+                data->fLength == (uint32_t)udata_getLength(udm)) {
+            // The new break iterator adopts udm.
+            RuleBasedBreakIterator *bi = new RuleBasedBreakIterator(udm, cacheStatus);
+            udm = NULL;
+            if (bi != NULL && U_SUCCESS(cacheStatus) &&
+                    bi->fData->getRuleSourceString() == strippedRules) {
+                return bi;
+            }
+            delete bi;
+        }
+        udata_close(udm);
+    }
+
+    RuleBasedBreakIterator *bi =
+        (RuleBasedBreakIterator *)createRuleBasedBreakIterator(rules, parseError, status);
+    if (U_SUCCESS(status)) {
+        uint32_t length;
+        const uint8_t *binaryRules = bi->getBinaryRules(length);
+        cacheStatus = U_ZERO_ERROR;
+        ucachefile_write(cacheDirectory, fileName, &info, key.data(),
+                         binaryRules, (int32_t)length, &cacheStatus);
+    }
+    return bi;
+}
+
 U_NAMESPACE_END
 
 #endif /* #if !UCONFIG_NO_BREAK_ITERATION */
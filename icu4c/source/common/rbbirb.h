@@ -112,6 +112,15 @@ public:
                                     UParseError      *parseError,
                                     UErrorCode       &status);
 
+    //
+    //  Same as createRuleBasedBreakIterator(), but first looks for the compiled
+    //   rules in a cache directory, and stores newly compiled rules there.
+    //
+    static BreakIterator * createCachedRuleBasedBreakIterator( const UnicodeString &rules,
+                                    const char       *cacheDirectory,
+                                    UParseError      *parseError,
+                                    UErrorCode       &status);
+
 public:
     // The "public" functions and data members that appear below are accessed
     //  (and shared) by the various parts that make up the rule builder.  They
@@ -0,0 +1,230 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   Copyright (C) 2016, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*******************************************************************************
+*   file name:  ucachefile.cpp
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Persistent cache files for runtime-built binary data.
+*   See ucachefile.h.
+*
+*   File layout:
+*       MappedData   headerSize, magic 0xda 0x27
+*       UDataInfo    caller-provided
+*       uint32_t     payload length
+*       char[]       key string, NUL-terminated, zero-padded to a multiple of 16
+*       payload
+*/
+
+#include "unicode/utypes.h"
+#include "unicode/udata.h"
+#include "charstr.h"
+#include "cmemory.h"
+#include "cstring.h"
+#include "putilimp.h"
+#include "ucachefile.h"
+#include "ucmndata.h"
+#include "udatamem.h"
+#include "umapfile.h"
+
+#if !UCONFIG_NO_FILE_IO
+#include <stdio.h>
+#if U_PLATFORM_USES_ONLY_WIN32_API
+#include <process.h>
+#define GETPID() _getpid()
+#else
+#include <unistd.h>
+#define GETPID() getpid()
+#endif
+#endif
+
+U_NAMESPACE_USE
+
+namespace {
+
+const int32_t KEY_OFFSET = (int32_t)(sizeof(DataHeader) + 4);
+
+#if !UCONFIG_NO_FILE_IO
+
+void makePath(CharString &path, const char *dir, const char *name, UErrorCode &errorCode) {
+    if (dir != NULL && *dir != 0) {
+        path.append(dir, errorCode);
+    }
+    path.appendPathPart(name, errorCode);
+}
+
+/** @return the file length, or -1 if the file cannot be opened */
+int32_t getFileLength(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return -1;
+    }
+    int32_t length = -1;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        length = (int32_t)ftell(f);
+    }
+    fclose(f);
+    return length;
+}
+
+UBool isMatchingInfo(const UDataInfo &actual, const UDataInfo &expected) {
+    return
+        actual.size >= sizeof(UDataInfo) &&
+        actual.isBigEndian == expected.isBigEndian &&
+        actual.charsetFamily == expected.charsetFamily &&
+        actual.sizeofUChar == expected.sizeofUChar &&
+        uprv_memcmp(actual.dataFormat, expected.dataFormat, 4) == 0 &&
+        actual.formatVersion[0] == expected.formatVersion[0];
+}
+
+#endif  // !UCONFIG_NO_FILE_IO
+
+}  // namespace
+
+U_CAPI UDataMemory * U_EXPORT2
+ucachefile_open(const char *dir, const char *name,
+                const UDataInfo *info, const char *key,
+                UErrorCode *pErrorCode) {
+    if (U_FAILURE(*pErrorCode)) {
+        return NULL;
+    }
+    if (name == NULL || info == NULL || key == NULL) {
+        *pErrorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return NULL;
+    }
+#if UCONFIG_NO_FILE_IO
+    (void)dir;
+    *pErrorCode = U_UNSUPPORTED_ERROR;
+    return NULL;
+#else
+    CharString path;
+    makePath(path, dir, name, *pErrorCode);
+    if (U_FAILURE(*pErrorCode)) {
+        return NULL;
+    }
+    int32_t fileLength = getFileLength(path.data());
+    if (fileLength < 0) {
+        *pErrorCode = U_FILE_ACCESS_ERROR;
+        return NULL;
+    }
+    UDataMemory dataMemory;
+    if (fileLength <= KEY_OFFSET || !uprv_mapFile(&dataMemory, path.data())) {
+        *pErrorCode = U_FILE_ACCESS_ERROR;
+        return NULL;
+    }
+
+    // Validate the header before looking at anything else.
+    const DataHeader *pHeader = dataMemory.pHeader;
+    int32_t keyLength = (int32_t)uprv_strlen(key);
+    int32_t headerSize = pHeader->dataHeader.headerSize;
+    const char *bytes = reinterpret_cast<const char *>(pHeader);
+    UBool isValid =
+        pHeader->dataHeader.magic1 == 0xda &&
+        pHeader->dataHeader.magic2 == 0x27 &&
+        pHeader->info.size == info->size &&
+        isMatchingInfo(pHeader->info, *info) &&
+        headerSize == ((KEY_OFFSET + keyLength + 1 + 15) & ~15) &&
+        headerSize <= fileLength &&
+        uprv_memcmp(bytes + KEY_OFFSET, key, keyLength + 1) == 0 &&
+        *reinterpret_cast<const uint32_t *>(bytes + sizeof(DataHeader)) ==
+            (uint32_t)(fileLength - headerSize);
+    if (!isValid) {
+        udata_close(&dataMemory);
+        *pErrorCode = U_INVALID_FORMAT_ERROR;
+        return NULL;
+    }
+
+    UDataMemory *result = UDataMemory_createNewInstance(pErrorCode);
+    if (U_FAILURE(*pErrorCode)) {
+        udata_close(&dataMemory);
+        return NULL;
+    }
+    result->pHeader = pHeader;
+    result->mapAddr = dataMemory.mapAddr;
+    result->map = dataMemory.map;
+    result->length = fileLength;
+    return result;
+#endif
+}
+
+U_CAPI void U_EXPORT2
+ucachefile_write(const char *dir, const char *name,
+                 const UDataInfo *info, const char *key,
+                 const void *data, int32_t length,
+                 UErrorCode *pErrorCode) {
+    if (U_FAILURE(*pErrorCode)) {
+        return;
+    }
+    if (name == NULL || info == NULL || key == NULL || data == NULL || length < 0 ||
+            info->size != sizeof(UDataInfo)) {
+        *pErrorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+#if UCONFIG_NO_FILE_IO
+    (void)dir;
+    *pErrorCode = U_UNSUPPORTED_ERROR;
+#else
+    int32_t keyLength = (int32_t)uprv_strlen(key);
+    int32_t headerSize = (KEY_OFFSET + keyLength + 1 + 15) & ~15;
+    if (headerSize > 0xffff) {
+        *pErrorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    MaybeStackArray<char, 128> headerArray;
+    char *header = headerArray.resize(headerSize);
+    if (header == NULL) {
+        *pErrorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    uprv_memset(header, 0, headerSize);
+    DataHeader *pHeader = reinterpret_cast<DataHeader *>(header);
+    pHeader->dataHeader.headerSize = (uint16_t)headerSize;
+    pHeader->dataHeader.magic1 = 0xda;
+    pHeader->dataHeader.magic2 = 0x27;
+    uprv_memcpy(&pHeader->info, info, sizeof(UDataInfo));
+    uint32_t payloadLength = (uint32_t)length;
+    uprv_memcpy(header + sizeof(DataHeader), &payloadLength, 4);
+    uprv_memcpy(header + KEY_OFFSET, key, keyLength);
+
+    CharString path, tempPath;
+    makePath(path, dir, name, *pErrorCode);
+    // A per-writer temporary name so that concurrent writers
+    // of the same cache file do not interleave their output.
+    // The process id separates processes, the time and a stack address threads.
+    char suffix[64];
+    sprintf(suffix, ".%lx.%lx%lx.tmp", (unsigned long)GETPID(),
+            (unsigned long)uprv_getRawUTCtime(), (unsigned long)(size_t)&suffix);
+    tempPath.append(path, *pErrorCode).append(suffix, -1, *pErrorCode);
+    if (U_FAILURE(*pErrorCode)) {
+        return;
+    }
+
+    FILE *f = fopen(tempPath.data(), "wb");
+    if (f == NULL) {
+        *pErrorCode = U_FILE_ACCESS_ERROR;
+        return;
+    }
+    UBool isWritten =
+        fwrite(header, 1, headerSize, f) == (size_t)headerSize &&
+        fwrite(data, 1, length, f) == (size_t)length;
+    if (fclose(f) != 0) {
+        isWritten = FALSE;
+    }
+    if (isWritten) {
+#if U_PLATFORM_USES_ONLY_WIN32_API
+        // rename() does not replace an existing file on Windows.
+        remove(path.data());
+#endif
+        isWritten = rename(tempPath.data(), path.data()) == 0;
+    }
+    if (!isWritten) {
+        remove(tempPath.data());
+        *pErrorCode = U_FILE_ACCESS_ERROR;
+    }
+#endif
+}
@@ -0,0 +1,71 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   Copyright (C) 2016, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*******************************************************************************
+*   file name:  ucachefile.h
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Persistent cache files for binary data that ICU builds at runtime,
+*   like compiled break rules and collation tailorings.
+*   A cache file is an ordinary ICU data file (DataHeader + payload)
+*   whose header also carries a key string and the payload length.
+*   Cache files are memory-mapped, so that processes share their pages.
+*
+*   These functions are part of the ICU internal implementation, and
+*   are not intended to be used directly by applications.
+*/
+
+#ifndef __UCACHEFILE_H__
+#define __UCACHEFILE_H__
+
+#include "unicode/utypes.h"
+#include "unicode/udata.h"
+
+/**
+ * Opens and memory-maps the cache file dir/name.
+ * The file is accepted only if its UDataInfo matches the expected one
+ * (size, endianness, charset family, UChar size, dataFormat and major formatVersion)
+ * and its key equals the given key.
+ *
+ * Use udata_getMemory() to get the payload and udata_close() to release the file.
+ *
+ * @param dir directory of the cache files
+ * @param name file name including the extension
+ * @param info expected UDataInfo
+ * @param key expected key string, invariant characters
+ * @param pErrorCode ICU error code; U_FILE_ACCESS_ERROR if there is no such file,
+ *        U_INVALID_FORMAT_ERROR if the file is not acceptable
+ * @return the data memory, or NULL if the file was not found or not acceptable
+ * @internal
+ */
+U_CAPI UDataMemory * U_EXPORT2
+ucachefile_open(const char *dir, const char *name,
+                const UDataInfo *info, const char *key,
+                UErrorCode *pErrorCode);
+
+/**
+ * Writes a cache file dir/name with the given UDataInfo, key and payload.
+ * The file is written under a temporary name and then renamed,
+ * so that concurrent readers never see a partially written file.
+ *
+ * @param dir directory of the cache files; must exist
+ * @param name file name including the extension
+ * @param info UDataInfo for the file header
+ * @param key key string, invariant characters
+ * @param data the payload; should be 16-aligned if the payload format requires alignment
+ * @param length payload length in bytes
+ * @param pErrorCode ICU error code; U_FILE_ACCESS_ERROR if the file could not be written
+ * @internal
+ */
+U_CAPI void U_EXPORT2
+ucachefile_write(const char *dir, const char *name,
+                 const UDataInfo *info, const char *key,
+                 const void *data, int32_t length,
+                 UErrorCode *pErrorCode);
+
+#endif
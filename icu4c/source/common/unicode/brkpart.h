@@ -0,0 +1,191 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   Copyright (C) 2016, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*******************************************************************************
+*   file name:  brkpart.h
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*/
+
+#ifndef BRKPART_H
+#define BRKPART_H
+
+#include "unicode/utypes.h"
+
+/**
+ * \file
+ * \brief C++ API: Partitioned line breaking of large texts.
+ */
+
+#if !UCONFIG_NO_BREAK_ITERATION
+
+#include "unicode/uobject.h"
+#include "unicode/utext.h"
+
+#ifndef U_HIDE_DRAFT_API
+
+U_NAMESPACE_BEGIN
+
+class BreakIterator;
+class RuleBasedBreakIterator;
+class UVector;
+class UVector32;
+
+/**
+ * LineBreakPartitioner finds the line break boundaries of a large text by
+ * splitting it into partitions that end after mandatory breaks
+ * (characters with the Line_Break property values BK, CR, LF or NL),
+ * finding the boundaries of each partition independently, and merging the
+ * results.
+ *
+ * The line break rules restart after a mandatory break, so the
+ * partitions can be processed concurrently by different threads.
+ * The merged boundaries are always identical to those found by iterating
+ * over the whole text with first() and next() of the original break iterator.
+ * Should a partition not end on one of its boundaries (as may happen with
+ * custom rules), its iteration simply continues into the following
+ * partitions until it reaches the start of one of them.
+ *
+ * ICU does not create threads. Typical usage is
+ * <pre>
+ * \code
+ *     LineBreakPartitioner partitioner(*lineIter, status);
+ *     partitioner.setText(text, 100000, status);
+ *     // On any threads, once for each partition index i:
+ *     //     partitioner.breakPartition(i, status);
+ *     int32_t length = partitioner.getBoundaries(NULL, 0, status);  // preflight
+ * \endcode
+ * </pre>
+ * breakPartition() may be called concurrently for different partitions.
+ * All other functions must not be called while any breakPartition() call
+ * is in progress.
+ *
+ * This class is not intended for public subclassing.
+ * @draft ICU 59
+ */
+class U_COMMON_API LineBreakPartitioner : public UObject {
+public:
+    /**
+     * Constructor. Clones the break iterator, which must be a RuleBasedBreakIterator,
+     * typically one returned by BreakIterator::createLineInstance().
+     * @param lineIter the break iterator that defines the boundaries
+     * @param status Set to U_ILLEGAL_ARGUMENT_ERROR if lineIter is not a RuleBasedBreakIterator.
+     * @draft ICU 59
+     */
+    LineBreakPartitioner(const BreakIterator &lineIter, UErrorCode &status);
+
+    /**
+     * Destructor.
+     * @draft ICU 59
+     */
+    virtual ~LineBreakPartitioner();
+
+    /**
+     * Sets the text to be broken and splits it into partitions.
+     * Each partition except the last is at least minLength native units long
+     * and ends immediately after a mandatory break.
+     * Any previous results are discarded.
+     *
+     * The partitioner uses a shallow clone of the text;
+     * the underlying text must not be modified or deleted
+     * while the partitioner refers to it.
+     *
+     * @param text the text
+     * @param minLength the minimum length of a partition, in native units;
+     *                  values less than 1 are treated as 1
+     * @param status ICU error code
+     * @draft ICU 59
+     */
+    void setText(UText *text, int32_t minLength, UErrorCode &status);
+
+    /**
+     * @return the number of partitions of the current text, 0 if there is none
+     * @draft ICU 59
+     */
+    int32_t countPartitions() const;
+
+    /**
+     * @param index partition index, 0..countPartitions()-1
+     * @return the native start index of the partition, or -1 if index is out of bounds
+     * @draft ICU 59
+     */
+    int32_t getPartitionStart(int32_t index) const;
+
+    /**
+     * @param index partition index, 0..countPartitions()-1
+     * @return the native limit index of the partition, or -1 if index is out of bounds
+     * @draft ICU 59
+     */
+    int32_t getPartitionLimit(int32_t index) const;
+
+    /**
+     * Finds the boundaries in one partition.
+     * Uses its own clones of the break iterator and of the text,
+     * so that it may be called concurrently for different indexes.
+     * Calling it again for the same index has no effect.
+     * @param index partition index, 0..countPartitions()-1
+     * @param status ICU error code
+     * @draft ICU 59
+     */
+    void breakPartition(int32_t index, UErrorCode &status);
+
+    /**
+     * Finds the boundaries in all partitions that have not been processed yet,
+     * on the calling thread.
+     * @param status ICU error code
+     * @draft ICU 59
+     */
+    void breakAllPartitions(UErrorCode &status);
+
+    /**
+     * Merges the boundaries of the partitions and writes them to dest, in ascending order,
+     * starting with 0 and ending with the length of the text. These are the values
+     * that first() and then next() on the original break iterator return (except DONE).
+     * Partitions that have not been processed by breakPartition() yet
+     * are processed by this function as far as needed.
+     *
+     * @param dest destination array; can be NULL if capacity==0 for pure preflighting
+     * @param capacity the number of int32_t that fit into dest
+     * @param status ICU error code; U_BUFFER_OVERFLOW_ERROR if capacity is too small
+     * @return the number of boundaries
+     * @draft ICU 59
+     */
+    int32_t getBoundaries(int32_t *dest, int32_t capacity, UErrorCode &status);
+
+    /**
+     * ICU "poor man's RTTI", returns a UClassID for this class.
+     * @draft ICU 59
+     */
+    static UClassID U_EXPORT2 getStaticClassID();
+
+    /**
+     * ICU "poor man's RTTI", returns a UClassID for the actual class.
+     * @draft ICU 59
+     */
+    virtual UClassID getDynamicClassID() const;
+
+private:
+    LineBreakPartitioner(const LineBreakPartitioner &other);  // not implemented
+    LineBreakPartitioner &operator=(const LineBreakPartitioner &other);  // not implemented
+
+    void clearPartitions();
+
+    RuleBasedBreakIterator *fIter;
+    UText *fText;
+    int32_t fTextLength;
+    /** Partition start indexes, plus the text length at the end. */
+    UVector32 *fCutPoints;
+    /** The LineBreakPartition objects, one per partition. */
+    UVector *fPartitions;
+};
+
+U_NAMESPACE_END
+
+#endif  /* U_HIDE_DRAFT_API */
+#endif  /* !UCONFIG_NO_BREAK_ITERATION */
+
+#endif  /* BRKPART_H */
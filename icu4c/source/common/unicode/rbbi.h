@@ -30,6 +30,7 @@
 #include "unicode/parseerr.h"
 #include "unicode/schriter.h"
 #include "unicode/uchriter.h"
+#include "unicode/uscript.h"
 
 
 struct UTrie;
@@ -44,6 +45,7 @@ class  RBBIDataWrapper;
 class  UStack;
 class  LanguageBreakEngine;
 class  UnhandledEngine;
+class  SharedBreakEngine;
 struct RBBIStateTable;
 
 
@@ -163,6 +165,16 @@ private:
      */
     int32_t             fBreakType;
 
+    /**
+     *
+     * If present, the list of LanguageBreakEngine objects with custom
+     * dictionaries that were added with addDictionary().
+     * Searched before the engines from the LanguageBreakFactory objects.
+     * Shared with clones.
+     * @internal
+     */
+    const SharedBreakEngine *fCustomBreakEngines;
+
     //=======================================================================
     // constructors
     //=======================================================================
@@ -183,6 +195,8 @@ private:
     friend class RBBIRuleBuilder;
     /** @internal */
     friend class BreakIterator;
+    /** @internal */
+    friend class LineBreakPartitioner;
 
 
 
@@ -214,6 +228,33 @@ public:
                              UParseError           &parseError,
                              UErrorCode            &status);
 
+#ifndef U_HIDE_DRAFT_API
+    /**
+     * Construct a RuleBasedBreakIterator from a set of rules supplied as a string,
+     * using a directory of compiled rules as a persistent cache.
+     *
+     * If the directory contains compiled rules for the same rules (ignoring comments
+     * and line breaks) that were built with the same versions of ICU and of the ICU data,
+     * then they are memory-mapped and used directly,
+     * which is substantially faster than compiling the rules.
+     * Otherwise the rules are compiled and the result is written to the directory
+     * for later use, typically by other processes.
+     * Problems reading or writing the cache directory do not cause an error.
+     *
+     * @param rules The break rules to be used.
+     * @param cacheDirectory The cache directory, which must already exist.
+     * @param parseError  In the event of a syntax error in the rules, provides the location
+     *                    within the rules of the problem.
+     * @param status Information on any errors encountered.
+     * @see #getBinaryRules
+     * @draft ICU 59
+     */
+    RuleBasedBreakIterator( const UnicodeString    &rules,
+                             const char            *cacheDirectory,
+                             UParseError           &parseError,
+                             UErrorCode            &status);
+#endif  /* U_HIDE_DRAFT_API */
+
     /**
      * Contruct a RuleBasedBreakIterator from a set of precompiled binary rules.
      * Binary rules are obtained from RulesBasedBreakIterator::getBinaryRules().
@@ -638,6 +679,37 @@ public:
      */
     virtual RuleBasedBreakIterator &refreshInputText(UText *input, UErrorCode &status);
 
+#ifndef U_HIDE_DRAFT_API
+    /**
+     * Adds a custom dictionary for the dictionary-based breaking of the text
+     * in one script, for example a vocabulary of product names.
+     * The dictionary file is built by the gendict tool from a word list.
+     * It is memory-mapped rather than read into memory,
+     * so that processes which use the same file share its pages.
+     *
+     * The words of the custom dictionary are used together with those of the
+     * dictionary for the script in the ICU data, if there is one.
+     * The dictionary applies only to this break iterator and its later clones,
+     * which share it; other break iterators are not affected.
+     * If several dictionaries are added for a script, then the last one
+     * (together with the ICU dictionary) is used.
+     *
+     * Dictionaries are used for the word and line break iterators, and
+     * for break iterators from custom rules that mark characters as dictionary characters.
+     * Dictionaries for Chinese and Japanese (USCRIPT_HAN) and for Korean (USCRIPT_HANGUL)
+     * should have word costs as values, like the dictionaries in the ICU data.
+     *
+     * @param script The script, one of USCRIPT_THAI, USCRIPT_LAO, USCRIPT_MYANMAR,
+     *               USCRIPT_KHMER, USCRIPT_HAN, USCRIPT_HIRAGANA, USCRIPT_KATAKANA, USCRIPT_HANGUL.
+     * @param path   The full path of the dictionary (.dict) file.
+     * @param status Set to U_FILE_ACCESS_ERROR if the file cannot be read,
+     *               U_INVALID_FORMAT_ERROR if it is not a dictionary file,
+     *               U_UNSUPPORTED_ERROR if there is no dictionary-based breaking for the script.
+     * @draft ICU 59
+     */
+    void addDictionary(UScriptCode script, const char *path, UErrorCode &status);
+#endif  /* U_HIDE_DRAFT_API */
+
 
 private:
     //=======================================================================
@@ -504,6 +504,8 @@
 #define ucache_compareKeys U_ICU_ENTRY_POINT_RENAME(ucache_compareKeys)
 #define ucache_deleteKey U_ICU_ENTRY_POINT_RENAME(ucache_deleteKey)
 #define ucache_hashKeys U_ICU_ENTRY_POINT_RENAME(ucache_hashKeys)
+#define ucachefile_open U_ICU_ENTRY_POINT_RENAME(ucachefile_open)
+#define ucachefile_write U_ICU_ENTRY_POINT_RENAME(ucachefile_write)
 #define ucal_add U_ICU_ENTRY_POINT_RENAME(ucal_add)
 #define ucal_clear U_ICU_ENTRY_POINT_RENAME(ucal_clear)
 #define ucal_clearField U_ICU_ENTRY_POINT_RENAME(ucal_clearField)
@@ -727,6 +729,8 @@
 #define ucol_getRulesEx U_ICU_ENTRY_POINT_RENAME(ucol_getRulesEx)
 #define ucol_getShortDefinitionString U_ICU_ENTRY_POINT_RENAME(ucol_getShortDefinitionString)
 #define ucol_getSortKey U_ICU_ENTRY_POINT_RENAME(ucol_getSortKey)
+#define ucol_getSortKeys U_ICU_ENTRY_POINT_RENAME(ucol_getSortKeys)
+#define ucol_getSortKeysUTF8 U_ICU_ENTRY_POINT_RENAME(ucol_getSortKeysUTF8)
 #define ucol_getStrength U_ICU_ENTRY_POINT_RENAME(ucol_getStrength)
 #define ucol_getTailoredSet U_ICU_ENTRY_POINT_RENAME(ucol_getTailoredSet)
 #define ucol_getUCAVersion U_ICU_ENTRY_POINT_RENAME(ucol_getUCAVersion)
@@ -1376,16 +1380,19 @@
 #define upvec_getValue U_ICU_ENTRY_POINT_RENAME(upvec_getValue)
 #define upvec_open U_ICU_ENTRY_POINT_RENAME(upvec_open)
 #define upvec_setValue U_ICU_ENTRY_POINT_RENAME(upvec_setValue)
+#define uregex_addToSet U_ICU_ENTRY_POINT_RENAME(uregex_addToSet)
 #define uregex_appendReplacement U_ICU_ENTRY_POINT_RENAME(uregex_appendReplacement)
 #define uregex_appendReplacementUText U_ICU_ENTRY_POINT_RENAME(uregex_appendReplacementUText)
 #define uregex_appendTail U_ICU_ENTRY_POINT_RENAME(uregex_appendTail)
 #define uregex_appendTailUText U_ICU_ENTRY_POINT_RENAME(uregex_appendTailUText)
 #define uregex_clone U_ICU_ENTRY_POINT_RENAME(uregex_clone)
 #define uregex_close U_ICU_ENTRY_POINT_RENAME(uregex_close)
+#define uregex_closeSet U_ICU_ENTRY_POINT_RENAME(uregex_closeSet)
 #define uregex_end U_ICU_ENTRY_POINT_RENAME(uregex_end)
 #define uregex_end64 U_ICU_ENTRY_POINT_RENAME(uregex_end64)
 #define uregex_find U_ICU_ENTRY_POINT_RENAME(uregex_find)
 #define uregex_find64 U_ICU_ENTRY_POINT_RENAME(uregex_find64)
+#define uregex_findInSet U_ICU_ENTRY_POINT_RENAME(uregex_findInSet)
 #define uregex_findNext U_ICU_ENTRY_POINT_RENAME(uregex_findNext)
 #define uregex_flags U_ICU_ENTRY_POINT_RENAME(uregex_flags)
 #define uregex_getFindProgressCallback U_ICU_ENTRY_POINT_RENAME(uregex_getFindProgressCallback)
@@ -1408,6 +1415,7 @@
 #define uregex_matches64 U_ICU_ENTRY_POINT_RENAME(uregex_matches64)
 #define uregex_open U_ICU_ENTRY_POINT_RENAME(uregex_open)
 #define uregex_openC U_ICU_ENTRY_POINT_RENAME(uregex_openC)
+#define uregex_openSet U_ICU_ENTRY_POINT_RENAME(uregex_openSet)
 #define uregex_openUText U_ICU_ENTRY_POINT_RENAME(uregex_openUText)
 #define uregex_pattern U_ICU_ENTRY_POINT_RENAME(uregex_pattern)
 #define uregex_patternUText U_ICU_ENTRY_POINT_RENAME(uregex_patternUText)
@@ -1670,6 +1678,7 @@
 #define utext_freeze U_ICU_ENTRY_POINT_RENAME(utext_freeze)
 #define utext_getNativeIndex U_ICU_ENTRY_POINT_RENAME(utext_getNativeIndex)
 #define utext_getPreviousNativeIndex U_ICU_ENTRY_POINT_RENAME(utext_getPreviousNativeIndex)
+#define utext_getUTF8Contents U_ICU_ENTRY_POINT_RENAME(utext_getUTF8Contents)
 #define utext_hasMetaData U_ICU_ENTRY_POINT_RENAME(utext_hasMetaData)
 #define utext_isLengthExpensive U_ICU_ENTRY_POINT_RENAME(utext_isLengthExpensive)
 #define utext_isWritable U_ICU_ENTRY_POINT_RENAME(utext_isWritable)
@@ -25,6 +25,7 @@
 #include "unicode/utf8.h"
 #include "unicode/utf16.h"
 #include "ustr_imp.h"
+#include "utextimp.h"
 #include "cmemory.h"
 #include "cstring.h"
 #include "uassert.h"
@@ -1646,6 +1647,16 @@ utext_openUTF8(UText *ut, const char *s, int64_t length, UErrorCode *status) {
 }
 
 
+U_CAPI const uint8_t * U_EXPORT2
+utext_getUTF8Contents(UText *ut, int32_t *pLength) {
+    if (ut == NULL || ut->pFuncs != &utf8Funcs) {
+        return NULL;
+    }
+    *pLength = (int32_t)utf8TextLength(ut);
+    return (const uint8_t *)ut->context;
+}
+
+
 
 
 
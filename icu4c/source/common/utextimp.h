@@ -0,0 +1,39 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   Copyright (C) 2016, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*******************************************************************************
+*   file name:  utextimp.h
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Access to the text behind ICU's own UText providers, for ICU code
+*   that can work on that text directly instead of through the UText chunks.
+*
+*   These functions are part of the ICU internal implementation, and
+*   are not intended to be used directly by applications.
+*/
+
+#ifndef __UTEXTIMP_H__
+#define __UTEXTIMP_H__
+
+#include "unicode/utypes.h"
+#include "unicode/utext.h"
+
+/**
+ * If the UText was opened with utext_openUTF8(), returns the UTF-8 string
+ * that it reads.  The native indexes of the UText are byte offsets into that string.
+ * For a NUL-terminated string, the length is determined first, as by utext_nativeLength().
+ *
+ * @param ut       The UText.
+ * @param pLength  Receives the length of the string in bytes.
+ * @return         The UTF-8 string, or NULL if the UText is not a UTF-8 UText.
+ * @internal
+ */
+U_CAPI const uint8_t * U_EXPORT2
+utext_getUTF8Contents(UText *ut, int32_t *pLength);
+
+#endif
@@ -50,6 +50,7 @@
 #include "unicode/tblcoll.h"
 #include "collationdata.h"
 #include "collationroot.h"
+#include "collationsort.h"
 #include "collationtailoring.h"
 #include "ucol_imp.h"
 #include "cstring.h"
@@ -989,6 +990,59 @@ Collator::internalCompareUTF8(const char *left, int32_t leftLength,
             errorCode);
 }
 
+namespace {
+
+struct SortContext {
+    SortContext(const Collator &c, const void *s, const int32_t *lengths, UErrorCode &ec)
+            : coll(c), sources(s), sourceLengths(lengths), errorCode(ec) {}
+
+    int32_t lengthOf(int32_t i) const { return sourceLengths != NULL ? sourceLengths[i] : -1; }
+
+    const Collator &coll;
+    const void *sources;
+    const int32_t *sourceLengths;
+    UErrorCode &errorCode;
+};
+
+int32_t U_CALLCONV
+compareIndexedStrings(const void *context, const void *left, const void *right) {
+    const SortContext &sc = *static_cast<const SortContext *>(context);
+    const UChar *const *sources = static_cast<const UChar *const *>(sc.sources);
+    int32_t l = *static_cast<const int32_t *>(left);
+    int32_t r = *static_cast<const int32_t *>(right);
+    return sc.coll.compare(sources[l], sc.lengthOf(l), sources[r], sc.lengthOf(r), sc.errorCode);
+}
+
+int32_t U_CALLCONV
+compareIndexedUTF8Strings(const void *context, const void *left, const void *right) {
+    const SortContext &sc = *static_cast<const SortContext *>(context);
+    const char *const *sources = static_cast<const char *const *>(sc.sources);
+    int32_t l = *static_cast<const int32_t *>(left);
+    int32_t r = *static_cast<const int32_t *>(right);
+    return sc.coll.internalCompareUTF8(sources[l], sc.lengthOf(l),
+                                       sources[r], sc.lengthOf(r), sc.errorCode);
+}
+
+}  // namespace
+
+void
+Collator::sort(const UChar *const sources[], const int32_t sourceLengths[],
+               int32_t count, int32_t permutation[],
+               UErrorCode &errorCode) const {
+    if(!CollationSort::initIndexes(sources, count, permutation, errorCode)) { return; }
+    SortContext context(*this, sources, sourceLengths, errorCode);
+    CollationSort::sortIndexes(permutation, count, compareIndexedStrings, &context, errorCode);
+}
+
+void
+Collator::sortUTF8(const char *const sources[], const int32_t sourceLengths[],
+                   int32_t count, int32_t permutation[],
+                   UErrorCode &errorCode) const {
+    if(!CollationSort::initIndexes(sources, count, permutation, errorCode)) { return; }
+    SortContext context(*this, sources, sourceLengths, errorCode);
+    CollationSort::sortIndexes(permutation, count, compareIndexedUTF8Strings, &context, errorCode);
+}
+
 int32_t
 Collator::internalNextSortKeyPart(UCharIterator * /*iter*/, uint32_t /*state*/[2],
                                   uint8_t * /*dest*/, int32_t /*count*/, UErrorCode &errorCode) const {
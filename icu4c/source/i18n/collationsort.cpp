@@ -0,0 +1,237 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+* Copyright (C) 2016, International Business Machines
+* Corporation and others.  All Rights Reserved.
+*******************************************************************************
+* collationsort.cpp
+*/
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_COLLATION
+
+#include "cmemory.h"
+#include "collationsort.h"
+#include "uarrsort.h"
+
+U_NAMESPACE_BEGIN
+
+namespace {
+
+/** Ranges up to this length are sorted with insertion sorts. */
+const int32_t SHORT_RANGE_LENGTH = 16;
+
+void
+insertionSort(int32_t *indexes, int32_t count, UComparator *cmp, const void *context) {
+    for(int32_t i = 1; i < count; ++i) {
+        int32_t x = indexes[i];
+        int32_t j = i;
+        while(j > 0 && cmp(context, indexes + j - 1, &x) > 0) {
+            indexes[j] = indexes[j - 1];
+            --j;
+        }
+        indexes[j] = x;
+    }
+}
+
+/**
+ * Merges two adjacent sorted runs src[start..mid[ and src[mid..limit[ into dest[start..limit[.
+ * Takes from the first run when items compare equal, which keeps the sort stable.
+ */
+void
+merge(const int32_t *src, int32_t start, int32_t mid, int32_t limit, int32_t *dest,
+      UComparator *cmp, const void *context) {
+    int32_t i = start;
+    int32_t j = mid;
+    int32_t k = start;
+    if(mid < limit && cmp(context, src + mid - 1, src + mid) <= 0) {
+        // The runs are already in order.
+        i = limit;
+    } else {
+        while(i < mid && j < limit) {
+            if(cmp(context, src + j, src + i) < 0) {
+                dest[k++] = src[j++];
+            } else {
+                dest[k++] = src[i++];
+            }
+        }
+    }
+    if(i < mid) {
+        uprv_memcpy(dest + k, src + i, (mid - i) * 4);
+        k += mid - i;
+    }
+    if(j < limit) {
+        uprv_memcpy(dest + k, src + j, (limit - j) * 4);
+    }
+}
+
+/**
+ * Compares two sort keys starting at the given depth,
+ * where they are known to be equal before it.
+ */
+inline int32_t
+compareKeys(const uint8_t *left, const uint8_t *right) {
+    for(;;) {
+        uint8_t b = *left;
+        if(b != *right) { return (int32_t)b - (int32_t)*right; }
+        if(b == 0) { return 0; }
+        ++left;
+        ++right;
+    }
+}
+
+void
+insertionSortByKeys(const uint8_t *keys, const int32_t offsets[],
+                    int32_t *indexes, int32_t count, int32_t depth) {
+    for(int32_t i = 1; i < count; ++i) {
+        int32_t x = indexes[i];
+        const uint8_t *key = keys + offsets[x] + depth;
+        int32_t j = i;
+        while(j > 0 && compareKeys(keys + offsets[indexes[j - 1]] + depth, key) > 0) {
+            indexes[j] = indexes[j - 1];
+            --j;
+        }
+        indexes[j] = x;
+    }
+}
+
+/** A range of indexes whose keys are equal before the depth byte. */
+struct KeyRange {
+    int32_t start;
+    int32_t length;
+    int32_t depth;
+};
+
+}  // namespace
+
+UBool
+CollationSort::initIndexes(const void *sources, int32_t count, int32_t indexes[],
+                           UErrorCode &errorCode) {
+    if(U_FAILURE(errorCode)) { return FALSE; }
+    if(count < 0 || (count > 0 && (sources == NULL || indexes == NULL))) {
+        errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return FALSE;
+    }
+    for(int32_t i = 0; i < count; ++i) {
+        indexes[i] = i;
+    }
+    return count > 1;
+}
+
+void
+CollationSort::sortIndexes(int32_t indexes[], int32_t count,
+                           UComparator *cmp, const void *context,
+                           UErrorCode &errorCode) {
+    if(U_FAILURE(errorCode)) { return; }
+    if(count <= SHORT_RANGE_LENGTH) {
+        insertionSort(indexes, count, cmp, context);
+        return;
+    }
+    MaybeStackArray<int32_t, 64> temp;
+    if(temp.resize(count) == NULL) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    // Sort short runs, then merge pairs of runs back and forth between the two arrays.
+    for(int32_t start = 0; start < count; start += SHORT_RANGE_LENGTH) {
+        int32_t length = count - start;
+        if(length > SHORT_RANGE_LENGTH) { length = SHORT_RANGE_LENGTH; }
+        insertionSort(indexes + start, length, cmp, context);
+    }
+    int32_t *src = indexes;
+    int32_t *dest = temp.getAlias();
+    for(int32_t width = SHORT_RANGE_LENGTH; width < count; width *= 2) {
+        for(int32_t start = 0; start < count; start += 2 * width) {
+            int32_t mid = count - start > width ? start + width : count;
+            int32_t limit = count - mid > width ? mid + width : count;
+            merge(src, start, mid, limit, dest, cmp, context);
+        }
+        int32_t *swap = src;
+        src = dest;
+        dest = swap;
+    }
+    if(src != indexes) {
+        uprv_memcpy(indexes, src, count * 4);
+    }
+}
+
+void
+CollationSort::sortIndexesByKeys(const uint8_t *keys, const int32_t offsets[],
+                                 int32_t indexes[], int32_t count,
+                                 UErrorCode &errorCode) {
+    if(U_FAILURE(errorCode)) { return; }
+    if(count <= SHORT_RANGE_LENGTH) {
+        insertionSortByKeys(keys, offsets, indexes, count, 0);
+        return;
+    }
+    MaybeStackArray<int32_t, 64> temp;
+    MaybeStackArray<uint8_t, 64> bytes;
+    if(temp.resize(count) == NULL || bytes.resize(count) == NULL) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    // Ranges left to sort, processed last-in-first-out instead of with recursion,
+    // because long keys would otherwise recurse very deeply.
+    MaybeStackArray<KeyRange, 64> stack;
+    int32_t stackLength = 0;
+    KeyRange all = { 0, count, 0 };
+    stack[stackLength++] = all;
+    while(stackLength > 0) {
+        KeyRange range = stack[--stackLength];
+        int32_t *rangeIndexes = indexes + range.start;
+        if(range.length <= SHORT_RANGE_LENGTH) {
+            insertionSortByKeys(keys, offsets, rangeIndexes, range.length, range.depth);
+            continue;
+        }
+        int32_t counts[256];
+        uint8_t b;
+        for(;;) {
+            uprv_memset(counts, 0, sizeof(counts));
+            for(int32_t i = 0; i < range.length; ++i) {
+                b = keys[offsets[rangeIndexes[i]] + range.depth];
+                bytes[i] = b;
+                ++counts[b];
+            }
+            // Skip a byte that all of the keys share,
+            // without distributing the indexes.
+            b = bytes[0];
+            if(counts[b] != range.length || b == 0) { break; }
+            ++range.depth;
+        }
+        if(counts[0] == range.length) { continue; }  // all keys are equal
+        // Distribute the indexes into buckets by their current key byte.
+        // Counting positions keeps the indexes in each bucket in their previous order.
+        int32_t positions[256];
+        int32_t sum = 0;
+        for(int32_t i = 0; i < 256; ++i) {
+            positions[i] = sum;
+            sum += counts[i];
+        }
+        int32_t *t = temp.getAlias();
+        for(int32_t i = 0; i < range.length; ++i) {
+            t[positions[bytes[i]]++] = rangeIndexes[i];
+        }
+        uprv_memcpy(rangeIndexes, t, range.length * 4);
+        // Keys that ended (byte 0) are equal and need no further sorting.
+        int32_t start = range.start + counts[0];
+        for(int32_t i = 1; i < 256; ++i) {
+            int32_t length = counts[i];
+            if(length > 1) {
+                if(stackLength == stack.getCapacity() &&
+                        stack.resize(2 * stackLength, stackLength) == NULL) {
+                    errorCode = U_MEMORY_ALLOCATION_ERROR;
+                    return;
+                }
+                KeyRange bucket = { start, length, range.depth + 1 };
+                stack[stackLength++] = bucket;
+            }
+            start += length;
+        }
+    }
+}
+
+U_NAMESPACE_END
+
+#endif  // !UCONFIG_NO_COLLATION
@@ -0,0 +1,63 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+* Copyright (C) 2016, International Business Machines
+* Corporation and others.  All Rights Reserved.
+*******************************************************************************
+* collationsort.h
+*/
+
+#ifndef __COLLATIONSORT_H__
+#define __COLLATIONSORT_H__
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_COLLATION
+
+#include "uarrsort.h"
+
+U_NAMESPACE_BEGIN
+
+/**
+ * Sorts arrays of string indexes, for Collator::sort() and its UTF-8 variant.
+ * Both sorts are stable: Indexes of equal strings keep their relative order.
+ */
+class U_I18N_API CollationSort /* not : public UObject because all methods are static */ {
+public:
+    /**
+     * Checks the arguments of a sort function and sets indexes[i]=i.
+     * @return TRUE if there are at least two strings to be sorted
+     */
+    static UBool initIndexes(const void *sources, int32_t count, int32_t indexes[],
+                             UErrorCode &errorCode);
+
+    /**
+     * Sorts the indexes with a merge sort,
+     * comparing items via the UComparator as for uprv_sortArray().
+     * The comparator receives pointers to int32_t indexes.
+     * Unlike uprv_sortArray() with sortStable=TRUE, this takes O(n log n) comparisons.
+     */
+    static void sortIndexes(int32_t indexes[], int32_t count,
+                            UComparator *cmp, const void *context,
+                            UErrorCode &errorCode);
+
+    /**
+     * Sorts the indexes by their sort keys with an MSD radix sort,
+     * one key byte at a time.
+     * The sort key for index i has the bytes from keys[offsets[i]]
+     * up to and including its terminating zero byte.
+     * Sort keys contain no other zero bytes.
+     */
+    static void sortIndexesByKeys(const uint8_t *keys, const int32_t offsets[],
+                                  int32_t indexes[], int32_t count,
+                                  UErrorCode &errorCode);
+
+private:
+    CollationSort();  // no instantiation
+};
+
+U_NAMESPACE_END
+
+#endif  // !UCONFIG_NO_COLLATION
+#endif  // __COLLATIONSORT_H__
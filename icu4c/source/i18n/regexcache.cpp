@@ -0,0 +1,100 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+//
+//  regexcache.cpp
+//
+//  Copyright (C) 2016, International Business Machines Corporation and others.
+//  All Rights Reserved.
+//
+//  This file contains class SharedRegexPattern, the compiled patterns that
+//  are shared through the UnifiedCache.
+//
+//  This class is internal to the regular expression implementation.
+//  For the public Regular Expression API, see the file "unicode/regex.h"
+//
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_REGULAR_EXPRESSIONS
+
+#include "unicode/regex.h"
+#include "unicode/unistr.h"
+#include "regexcache.h"
+#include "unifiedcache.h"
+
+U_NAMESPACE_BEGIN
+
+SharedRegexPattern::~SharedRegexPattern() {
+    delete ptr;
+}
+
+//
+//  The cache key: the pattern string and the flags.
+//
+class RegexPatternCacheKey : public CacheKey<SharedRegexPattern> {
+public:
+    RegexPatternCacheKey(const UnicodeString &regex, uint32_t flags)
+            : fRegex(regex), fFlags(flags) { }
+    // The key that is passed to UnifiedCache::get() may alias its caller's pattern string.
+    //   The copies that the cache keeps, and the patterns that it compiles, need their own.
+    RegexPatternCacheKey(const RegexPatternCacheKey &other)
+            : CacheKey<SharedRegexPattern>(other),
+              fRegex(other.fRegex, 0), fFlags(other.fFlags) { }
+    virtual ~RegexPatternCacheKey();
+    virtual int32_t hashCode() const {
+        return (37 * CacheKey<SharedRegexPattern>::hashCode() + fRegex.hashCode()) * 37 +
+               (int32_t)fFlags;
+    }
+    virtual UBool operator==(const CacheKeyBase &other) const {
+        if (this == &other) {
+            return TRUE;
+        }
+        if (!CacheKey<SharedRegexPattern>::operator==(other)) {
+            return FALSE;
+        }
+        // We know that this and other are of same class if we get this far.
+        const RegexPatternCacheKey &realOther =
+                static_cast<const RegexPatternCacheKey &>(other);
+        return fFlags == realOther.fFlags && fRegex == realOther.fRegex;
+    }
+    virtual CacheKeyBase *clone() const {
+        return new RegexPatternCacheKey(*this);
+    }
+    virtual const SharedRegexPattern *createObject(
+            const void * /*unused*/, UErrorCode &status) const {
+        UParseError pe;
+        RegexPattern *pattern = RegexPattern::compile(UnicodeString(fRegex, 0), fFlags, pe, status);
+        if (U_FAILURE(status)) {
+            return NULL;
+        }
+        SharedRegexPattern *result = new SharedRegexPattern(pattern);
+        if (result == NULL) {
+            delete pattern;
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return NULL;
+        }
+        result->addRef();
+        return result;
+    }
+private:
+    UnicodeString fRegex;
+    uint32_t      fFlags;
+};
+
+RegexPatternCacheKey::~RegexPatternCacheKey() {
+}
+
+const SharedRegexPattern *SharedRegexPattern::getFromCache(
+        const UnicodeString &regex, uint32_t flags, UErrorCode &status) {
+    const UnifiedCache *cache = UnifiedCache::getInstance(status);
+    if (U_FAILURE(status)) {
+        return NULL;
+    }
+    const SharedRegexPattern *result = NULL;
+    cache->get(RegexPatternCacheKey(regex, flags & ~UREGEX_CACHE_PATTERN), result, status);
+    return result;
+}
+
+U_NAMESPACE_END
+
+#endif  // !UCONFIG_NO_REGULAR_EXPRESSIONS
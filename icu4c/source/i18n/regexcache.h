@@ -0,0 +1,56 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+//
+//  regexcache.h
+//
+//  Copyright (C) 2016, International Business Machines Corporation and others.
+//  All Rights Reserved.
+//
+//  This file contains declarations for the class SharedRegexPattern
+//
+//  This class is internal to the regular expression implementation.
+//  For the public Regular Expression API, see the file "unicode/regex.h"
+//
+//  A SharedRegexPattern is a compiled pattern that is kept in the UnifiedCache,
+//   keyed by the pattern string and its flags.  Patterns opened with the
+//   UREGEX_CACHE_PATTERN flag are compiled only once per process; each opener
+//   holds a reference to the shared pattern and creates its own matchers from it.
+//
+
+#ifndef REGEXCACHE_H
+#define REGEXCACHE_H
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_REGULAR_EXPRESSIONS
+
+#include "sharedobject.h"
+
+U_NAMESPACE_BEGIN
+
+class RegexPattern;
+class UnicodeString;
+
+class U_I18N_API SharedRegexPattern : public SharedObject {
+public:
+    SharedRegexPattern(RegexPattern *patternToAdopt) : ptr(patternToAdopt) { }
+    virtual ~SharedRegexPattern();
+    const RegexPattern *operator->() const { return ptr; }
+    const RegexPattern &operator*() const { return *ptr; }
+
+    //  Returns the compiled pattern for the pattern string and flags, compiling
+    //    it and adding it to the cache if it is not there yet.
+    //    The UREGEX_CACHE_PATTERN flag is ignored.
+    //    The caller must call removeRef() on the result when done with it.
+    static const SharedRegexPattern *getFromCache(
+            const UnicodeString &regex, uint32_t flags, UErrorCode &status);
+private:
+    RegexPattern *ptr;
+    SharedRegexPattern(const SharedRegexPattern &);
+    SharedRegexPattern &operator=(const SharedRegexPattern &);
+};
+
+U_NAMESPACE_END
+
+#endif   // !UCONFIG_NO_REGULAR_EXPRESSIONS
+#endif
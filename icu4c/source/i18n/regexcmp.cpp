@@ -318,6 +318,16 @@ void    RegexCompile::compile(
     //
     matchStartType();
 
+    //
+    // Optimization pass 3: a literal string that any match must contain
+    //
+    requiredLiteral();
+
+    //
+    // Optimization pass 4: loops that never need to give back input
+    //
+    possessiveLoops();
+
     //
     // Set up fast latin-1 range sets
     //
@@ -773,7 +783,7 @@ UBool RegexCompile::doParseActions(int32_t action)
         //
         //  Or, if the item to be repeated is simple
         //     1.   Item to be repeated.
-        //     2.   LOOP_SR_I    set number  (assuming repeated item is a set ref)
+        //     2.   LOOP_SR_I    set number  (assuming repeated item matches one char of a set)
         //     3.   LOOP_C       stack location
         {
             int32_t  topLoc = blockTopLoc(FALSE);        // location of item #1
@@ -783,9 +793,10 @@ UBool RegexCompile::doParseActions(int32_t action)
             if (topLoc == fRXPat->fCompiledPat->size() - 1) {
                 int32_t repeatedOp = (int32_t)fRXPat->fCompiledPat->elementAti(topLoc);
 
-                if (URX_TYPE(repeatedOp) == URX_SETREF) {
-                    // Emit optimized code for [char set]+
-                    appendOp(URX_LOOP_SR_I, URX_VAL(repeatedOp));
+                int32_t setNumber = loopSetNumber(repeatedOp);
+                if (setNumber > 0) {
+                    // Emit optimized code for [char set]+, or for \d+, \w+ or \s+
+                    appendOp(URX_LOOP_SR_I, setNumber);
                     frameLoc = allocateStackData(1);
                     appendOp(URX_LOOP_C, frameLoc);
                     break;
@@ -890,7 +901,7 @@ UBool RegexCompile::doParseActions(int32_t action)
         //       3.   JMP_SAV      2
         //       4.   ...
         //
-        // Or, if the body is a simple [Set],
+        // Or, if the body is a simple [Set], or anything else that matches one char of a set,
         //       1.   LOOP_SR_I    set number
         //       2.   LOOP_C       stack location
         //       ...
@@ -915,9 +926,10 @@ UBool RegexCompile::doParseActions(int32_t action)
             if (topLoc == fRXPat->fCompiledPat->size() - 1) {
                 int32_t repeatedOp = (int32_t)fRXPat->fCompiledPat->elementAti(topLoc);
 
-                if (URX_TYPE(repeatedOp) == URX_SETREF) {
-                    // Emit optimized code for a [char set]*
-                    int32_t loopOpI = buildOp(URX_LOOP_SR_I, URX_VAL(repeatedOp));
+                int32_t setNumber = loopSetNumber(repeatedOp);
+                if (setNumber > 0) {
+                    // Emit optimized code for a [char set]*, or for \d*, \w* or \s*
+                    int32_t loopOpI = buildOp(URX_LOOP_SR_I, setNumber);
                     fRXPat->fCompiledPat->setElementAt(loopOpI, topLoc);
                     dataLoc = allocateStackData(1);
                     appendOp(URX_LOOP_C, dataLoc);
@@ -3156,6 +3168,285 @@ void   RegexCompile::matchStartType() {
 
 
 
+//------------------------------------------------------------------------------
+//
+//   requiredLiteral   Find the longest literal string that must appear in the
+//                     input for the pattern to match.  RegexSet looks for these
+//                     strings to rule out patterns before running their matchers.
+//
+//                     Walk the compiled pattern, keeping the furthest destination
+//                     of the forward branches seen so far.  Every match passes
+//                     through the ops beyond it.  A run of such literal ops, with
+//                     only zero-width ops between them, matches contiguous text.
+//
+//------------------------------------------------------------------------------
+void   RegexCompile::requiredLiteral() {
+    if (U_FAILURE(*fStatus)) {
+        return;
+    }
+    UnicodeString &required = fRXPat->fRequiredLiteral;
+    UnicodeString  run;
+    int32_t        furthestBranch = 0;
+    int32_t        end = fRXPat->fCompiledPat->size();
+    required.remove();
+
+    for (int32_t loc = 3; loc < end; loc++) {
+        int32_t op      = (int32_t)fRXPat->fCompiledPat->elementAti(loc);
+        int32_t opType  = URX_TYPE(op);
+        int32_t opValue = URX_VAL(op);
+        UBool   reached = loc >= furthestBranch;
+
+        switch (opType) {
+        case URX_ONECHAR:
+            if (reached) {
+                run.append((UChar32)opValue);
+                continue;
+            }
+            break;
+
+        case URX_STRING:
+            {
+                int32_t stringLen = URX_VAL(fRXPat->fCompiledPat->elementAti(loc+1));
+                loc++;
+                if (reached) {
+                    run.append(fRXPat->fLiteralText, opValue, stringLen);
+                    continue;
+                }
+            }
+            break;
+
+            // Zero-width ops, which leave a run of literal text intact.
+        case URX_RESERVED_OP:
+        case URX_NOP:
+        case URX_START_CAPTURE:
+        case URX_END_CAPTURE:
+        case URX_STO_INP_LOC:
+        case URX_STO_SP:
+        case URX_LD_SP:
+        case URX_BACKSLASH_B:
+        case URX_BACKSLASH_BU:
+        case URX_BACKSLASH_G:
+        case URX_BACKSLASH_Z:
+        case URX_CARET:
+        case URX_CARET_M:
+        case URX_CARET_M_UNIX:
+        case URX_DOLLAR:
+        case URX_DOLLAR_M:
+        case URX_DOLLAR_D:
+        case URX_DOLLAR_MD:
+        case URX_RELOC_OPRND:
+            continue;
+
+        case URX_STATE_SAVE:
+        case URX_JMP:
+            if (opValue > loc && opValue > furthestBranch) {
+                furthestBranch = opValue;
+            }
+            break;
+
+        case URX_JMPX:
+            if (opValue > loc && opValue > furthestBranch) {
+                furthestBranch = opValue;
+            }
+            loc++;
+            break;
+
+        case URX_CTR_INIT:
+        case URX_CTR_INIT_NG:
+            {
+                // With a minimum count of zero, the loop body may be skipped.
+                int32_t loopEndLoc   = URX_VAL(fRXPat->fCompiledPat->elementAti(loc+1));
+                int32_t minLoopCount = (int32_t)fRXPat->fCompiledPat->elementAti(loc+2);
+                if (minLoopCount == 0 && loopEndLoc + 1 > furthestBranch) {
+                    furthestBranch = loopEndLoc + 1;
+                }
+                loc += 3;
+            }
+            break;
+
+        case URX_STRING_I:
+            loc++;
+            break;
+
+        case URX_LA_START:
+        case URX_LB_START:
+            // A negative look-around block can require that a string is absent.
+            //   Don't try to follow them.
+            required.remove();
+            return;
+
+        default:
+            // Ops that consume input other than literal text, and loops.
+            break;
+        }
+
+        // The op ended any run of literal text.
+        if (run.length() > required.length()) {
+            required = run;
+        }
+        run.remove();
+    }
+    if (run.length() > required.length()) {
+        required = run;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+//
+//   setForOp      For an op that matches exactly one code point out of a fixed set,
+//                 get that set.  Returns FALSE for any other op.
+//
+//------------------------------------------------------------------------------
+UBool RegexCompile::setForOp(int32_t op, UnicodeSet &set) {
+    int32_t opType  = URX_TYPE(op);
+    int32_t opValue = URX_VAL(op);
+    switch (opType) {
+    case URX_SETREF:
+        set = *(UnicodeSet *)fRXPat->fSets->elementAt(opValue);
+        return TRUE;
+
+    case URX_STATIC_SETREF:
+    case URX_STAT_SETREF_N:
+        set = *fRXPat->fStaticSets[opValue & ~URX_NEG_SET];
+        if (opType == URX_STAT_SETREF_N || (opValue & URX_NEG_SET) != 0) {
+            set.complement();
+        }
+        return TRUE;
+
+    case URX_BACKSLASH_D:
+        set.applyIntPropertyValue(UCHAR_GENERAL_CATEGORY_MASK, U_GC_ND_MASK, *fStatus);
+        if (opValue != 0) {
+            set.complement();
+        }
+        return U_SUCCESS(*fStatus);
+
+    case URX_ONECHAR:
+        set.set(opValue, opValue);
+        return TRUE;
+
+    default:
+        return FALSE;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+//
+//   loopSetNumber   For a single op being repeated by * or +, find the number of a
+//                   set in fSets that matches the same characters, for use by a
+//                   URX_LOOP_SR_I.  A set is added for \d, \w, \s and their
+//                   negations, which do not otherwise have one.
+//                   Returns -1 if the op can not be repeated by a URX_LOOP_SR_I.
+//
+//                   A single character, as in a+, keeps the general loop code.
+//                   Exponential patterns like (a+)+b take longer to fail with
+//                   a URX_LOOP_C, which backs up one character per step.
+//
+//------------------------------------------------------------------------------
+int32_t RegexCompile::loopSetNumber(int32_t op) {
+    if (URX_TYPE(op) == URX_SETREF) {
+        return URX_VAL(op);
+    }
+    UnicodeSet set;
+    if (U_FAILURE(*fStatus) || URX_TYPE(op) == URX_ONECHAR || !setForOp(op, set)) {
+        return -1;
+    }
+    UnicodeSet *loopSet = new UnicodeSet(set);
+    if (loopSet == NULL) {
+        error(U_MEMORY_ALLOCATION_ERROR);
+        return -1;
+    }
+    int32_t setNumber = fRXPat->fSets->size();
+    fRXPat->fSets->addElement(loopSet, *fStatus);
+    if (U_FAILURE(*fStatus)) {
+        delete loopSet;
+        return -1;
+    }
+    return setNumber;
+}
+
+
+//------------------------------------------------------------------------------
+//
+//   possessiveLoops   Find [set]* and .* loops whose following op can not match
+//                     any character that the loop consumes, as in \d+\s or [a-z]*=.
+//                     When the following op fails, backing up the loop by one or
+//                     more characters would only put one of the loop's own characters
+//                     in front of it, which fails again.  Replace the URX_LOOP_C of
+//                     such a loop with a URX_NOP, which tells the match engines to
+//                     keep the loop's input without saving a state to come back to.
+//
+//                     Runs after stripNOPs(); the NOPs added here stay in the pattern.
+//
+//------------------------------------------------------------------------------
+void RegexCompile::possessiveLoops() {
+    if (U_FAILURE(*fStatus)) {
+        return;
+    }
+    int32_t end = fRXPat->fCompiledPat->size();
+    for (int32_t loc = 3; loc + 2 < end; loc++) {
+        int32_t op     = (int32_t)fRXPat->fCompiledPat->elementAti(loc);
+        int32_t opType = URX_TYPE(op);
+        if ((opType != URX_LOOP_SR_I && opType != URX_LOOP_DOT_I) ||
+                URX_TYPE(fRXPat->fCompiledPat->elementAti(loc+1)) != URX_LOOP_C) {
+            continue;
+        }
+
+        // The characters that the loop can consume.
+        UnicodeSet loopSet;
+        int32_t opValue = URX_VAL(op);
+        if (opType == URX_LOOP_SR_I) {
+            loopSet = *(UnicodeSet *)fRXPat->fSets->elementAt(opValue);
+        } else {
+            if ((opValue & 1) == 0) {
+                // Not dot-matches-all mode.  The loop stops at line endings.
+                loopSet.add(0x0a);
+                if ((opValue & 2) == 0) {
+                    loopSet.add(0x0b, 0x0d);
+                    loopSet.add(0x85);
+                    loopSet.add(0x2028, 0x2029);
+                }
+            }
+            loopSet.complement();
+        }
+
+        // The op that must match next, past any capture group boundaries.
+        int32_t nextLoc = loc + 2;
+        int32_t nextOp  = (int32_t)fRXPat->fCompiledPat->elementAti(nextLoc);
+        while (URX_TYPE(nextOp) == URX_START_CAPTURE || URX_TYPE(nextOp) == URX_END_CAPTURE) {
+            if (++nextLoc >= end) {
+                break;
+            }
+            nextOp = (int32_t)fRXPat->fCompiledPat->elementAti(nextLoc);
+        }
+
+        UBool possessive = FALSE;
+        UnicodeSet nextSet;
+        switch (URX_TYPE(nextOp)) {
+        case URX_END:
+            // Nothing follows.  A shorter loop would only be tried for a match that must
+            //   reach the end of the input, which it would not.
+            possessive = TRUE;
+            break;
+
+        case URX_STRING:
+            possessive = !loopSet.contains(fRXPat->fLiteralText.char32At(URX_VAL(nextOp)));
+            break;
+
+        default:
+            if (setForOp(nextOp, nextSet)) {
+                possessive = !loopSet.containsSome(nextSet);
+            }
+            break;
+        }
+        if (possessive) {
+            fRXPat->fCompiledPat->setElementAt(buildOp(URX_NOP, 0), loc+1);
+        }
+    }
+}
+
+
 //------------------------------------------------------------------------------
 //
 //   minMatchLength    Calculate the length of the shortest string that could
@@ -119,7 +119,11 @@ private:
     int32_t     maxMatchLength(int32_t start,
                                int32_t end);
     void        matchStartType();
+    void        requiredLiteral();
     void        stripNOPs();
+    void        possessiveLoops();                   // Drop the backtracking of loops that can't use it.
+    UBool       setForOp(int32_t op, UnicodeSet &set); // The set of chars matched by a single op.
+    int32_t     loopSetNumber(int32_t op);           // A set for a URX_LOOP_SR_I repeating op.
 
     void        setEval(int32_t op);
     void        setPushOp(int32_t op);
@@ -0,0 +1,1591 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+//
+//  regexdfa.cpp
+//
+//  Copyright (C) 2016, International Business Machines Corporation and others.
+//  All Rights Reserved.
+//
+//  This file contains class RegexDFA, a lazily built DFA that is used by
+//  RegexMatcher to find matches in linear time.
+//
+//  This class is internal to the regular expression implementation.
+//  For the public Regular Expression API, see the file "unicode/regex.h"
+//
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_REGULAR_EXPRESSIONS
+
+#include "unicode/regex.h"
+#include "unicode/uchar.h"
+#include "unicode/uniset.h"
+#include "unicode/unistr.h"
+#include "unicode/utf16.h"
+#include "unicode/utf8.h"
+#include "cmemory.h"
+#include "regexdfa.h"
+#include "regeximp.h"
+#include "uassert.h"
+#include "uarrsort.h"
+#include "uvector.h"
+#include "uvectr32.h"
+#include "uvectr64.h"
+
+U_NAMESPACE_BEGIN
+
+//
+//  The NFA that the DFA states are built from.
+//    There is one node for each location in the compiled pattern, so that pattern
+//    jump targets can be used directly as node numbers, followed by extra nodes for
+//    the second and following characters of literal strings, for the bodies of the
+//    optimized [set]* and .* loops, for the LF that may follow a CR, and for leaving
+//    loops whose body matched an empty string.
+//
+//    Every node that consumes input is a set node, so that the DFA can work with
+//    classes of code points that all of the sets treat the same.
+//
+enum {
+    NFA_DEAD,          // No transitions.  Compiled FAIL and BACKTRACK ops, operand slots.
+    NFA_EPSILON,       // Continue at next without consuming input.
+    NFA_SPLIT,         // Continue at both next and alt without consuming input.
+    NFA_MATCH,         // End of pattern.  A match ends here.
+    NFA_SET,           // Consume a code point that is in the set, or not in it if negated.
+                       //   A NULL set matches any code point.  If alt is not -1,
+                       //   a CR may also continue at node alt, to consume a following LF.
+    NFA_SAVE_START,    // Start of a capture group.  Continue at next.
+    NFA_SAVE_END,      // End of a capture group.  Continue at next.
+    NFA_LOOP_START,    // Start of an iteration of a loop that may match an empty string.
+                       //   Continue at next.
+    NFA_LOOP_CHECK     // End of an iteration of such a loop.  If the iteration consumed
+                       //   input, continue at both next and alt, as for a split.
+                       //   Otherwise continue at alt, which leaves the loop.
+};
+
+struct RegexNFANode {
+    int32_t            fType;
+    int32_t            fNext;
+    int32_t            fAlt;
+    const UnicodeSet  *fSet;
+    UBool              fNegated;
+    int32_t            fSlot;       // Frame slot of a capture group.
+    int32_t            fLoopBit;    // Loop start and check nodes:  the bit for the nesting
+                                    //   level of the loop.
+    int32_t            fLoopMask;   // The bits for the loops that the node is inside of.
+    int32_t            fMarkBase;   // Index of the first of the node's entries in fMarks.
+};
+
+namespace {
+
+// The DFA gives up, rather than use an unbounded amount of memory,
+//   when a state table grows beyond this many states or transitions.
+const int32_t MAX_STATES = 1000;
+const int32_t MAX_TRANSITIONS = 0x100000;
+
+// Loops that may match an empty string can be nested this deep.
+//   A node inside such loops may be visited once for each combination of them
+//   that began an iteration at the current input position.
+const int32_t MAX_LOOP_DEPTH = 6;
+
+// Closure stack entries per node visit.  Each visit pushes at most three entries.
+const int32_t STACK_PER_VISIT = 3;
+
+// Transition table value for a transition that has not yet been computed.
+const int32_t UNKNOWN_STATE = -1;
+
+// State number of the state with no NFA nodes.  Once there, no match is possible.
+const int32_t DEAD_STATE = 0;
+
+// Results of RegexDFA::stepCaptures() other than a thread list index.
+const int32_t CAPTURES_MATCHED = -1;
+const int32_t CAPTURES_FAILED = -2;
+
+// Kinds of state tables.
+enum {
+    TABLE_LEFTMOST,    // Forward, for find().  New matches may begin at each position until
+                       //   one is found.  Nodes after a match node are dropped.
+    TABLE_TO_END,      // Forward, for matches().  Anchored at the start.
+    TABLE_REVERSE      // Backward from the end of a match.  States are sets of nodes
+                       //   from which the rest of the match can be reached.
+};
+
+// State flags.
+enum {
+    STATE_ACCEPTING = 1,   // Forward: a match ends here.  Reverse: a match may begin here.
+    STATE_LIVE = 2,        // Forward: a consuming node comes before any match node,
+                           //   so the backtracking engine would look at the next character
+                           //   before it reaches the match.
+    STATE_MATCHED = 4      // TABLE_LEFTMOST: a match has been found, and no new ones begin.
+};
+
+// Markers appended to state keys, for TABLE_LEFTMOST states with the same nodes
+//   that behave differently.  They are not node numbers.
+const int32_t MARK_NONE = 0;
+const int32_t MARK_IN_PROGRESS = 0xffff;    // A match begun before the last character continues.
+const int32_t MARK_MATCHED = 0xfffe;        // STATE_MATCHED.
+
+//
+//  Count the NFA nodes needed for a compiled pattern.
+//     Return -1 if the pattern uses an operation that the DFA does not support.
+//
+int32_t countNodes(const UVector64 &compiledPat) {
+    int32_t size = compiledPat.size();
+    int32_t count = size;
+    for (int32_t loc = 0; loc < size; loc++) {
+        int32_t op = (int32_t)compiledPat.elementAti(loc);
+        switch (URX_TYPE(op)) {
+        case URX_ONECHAR:
+        case URX_ONECHAR_I:
+        case URX_STATIC_SETREF:
+        case URX_STAT_SETREF_N:
+        case URX_SETREF:
+        case URX_DOTANY:
+        case URX_DOTANY_UNIX:
+        case URX_BACKSLASH_D:
+        case URX_BACKSLASH_H:
+        case URX_BACKSLASH_V:
+        case URX_NOP:
+        case URX_START_CAPTURE:
+        case URX_END_CAPTURE:
+        case URX_STO_INP_LOC:
+        case URX_JMP:
+        case URX_JMP_SAV:
+        case URX_STATE_SAVE:
+        case URX_LOOP_C:
+        case URX_END:
+        case URX_FAIL:
+        case URX_BACKTRACK:
+            break;
+        case URX_DOTANY_ALL:
+        case URX_BACKSLASH_R:
+            count += 1;             // The LF following a CR.
+            break;
+        case URX_LOOP_SR_I:
+            count += 1;             // The loop body.
+            break;
+        case URX_LOOP_DOT_I:
+            count += 2;             // The loop body, and the LF following a CR.
+            break;
+        case URX_STRING:
+            loc++;                  // The length operand.
+            if (loc >= size) {
+                return -1;
+            }
+            count += URX_VAL(compiledPat.elementAti(loc));   // At most one node per code unit.
+            break;
+        case URX_JMP_SAV_X:
+            count += 1;             // Leaving the loop after an empty iteration.
+            break;
+        case URX_JMPX:
+            loc++;                  // The data location operand.
+            break;
+        default:
+            // Anchors, look-around, back references, counted loops,
+            //   atomic and possessive constructs, \X, case insensitive strings.
+            return -1;
+        }
+    }
+    return count;
+}
+
+}  // namespace
+
+
+UBool RegexDFA::isSupported(const RegexPattern &pattern) {
+    if (U_FAILURE(pattern.fDeferredStatus) || pattern.fCompiledPat == NULL) {
+        return FALSE;
+    }
+    int32_t count = countNodes(*pattern.fCompiledPat);
+    // State keys hold one UChar per node, and a marker.
+    return count > 0 && count < MARK_MATCHED;
+}
+
+
+RegexDFA::StateTable::StateTable(int32_t kind, UErrorCode &status) :
+        fKind(kind), fStateNodes(status), fStateStarts(status), fFlags(status), fTransitions(status),
+        fStateMap(status), fStart(-1) {
+}
+
+
+RegexDFA::RegexDFA(const RegexPattern &pattern, UErrorCode &status) :
+        fNodes(NULL), fNodeCount(0), fExact(TRUE), fOwnedSets(uprv_deleteUObject, NULL, status),
+        fPredStarts(NULL), fPreds(NULL),
+        fIntervalStarts(status), fIntervalClasses(status), fClassChars(status), fClassCount(0),
+        fWork(NULL), fWorkCount(0), fMarks(NULL), fVisitCount(0), fMembers(NULL), fStack(NULL),
+        fGeneration(0),
+        fLeftmost(NULL), fToEnd(NULL), fReverse(NULL),
+        fSlotCount(pattern.fFrameSize - RESTACKFRAME_HDRCOUNT), fSlots(NULL), fSlotStack(NULL) {
+    fThreadNodes[0] = fThreadNodes[1] = NULL;
+    fThreadSlots[0] = fThreadSlots[1] = NULL;
+    fThreadCounts[0] = fThreadCounts[1] = 0;
+    if (U_FAILURE(status)) {
+        return;
+    }
+    fNodeCount = countNodes(*pattern.fCompiledPat);
+    if (fNodeCount <= 0) {
+        status = U_UNSUPPORTED_ERROR;
+        return;
+    }
+    const UVector64 &pat = *pattern.fCompiledPat;
+    int32_t size = pat.size();
+    fNodes = (RegexNFANode *)uprv_malloc(fNodeCount * sizeof(RegexNFANode));
+    fWork  = (int32_t *)uprv_malloc(fNodeCount * sizeof(int32_t));
+    fMembers = (int32_t *)uprv_malloc(fNodeCount * sizeof(int32_t));
+    fLeftmost = new StateTable(TABLE_LEFTMOST, status);
+    fToEnd = new StateTable(TABLE_TO_END, status);
+    fReverse = new StateTable(TABLE_REVERSE, status);
+    if (fNodes == NULL || fWork == NULL || fMembers == NULL ||
+            fLeftmost == NULL || fToEnd == NULL || fReverse == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    if (U_FAILURE(status)) {
+        return;
+    }
+    uprv_memset(fMembers, 0, fNodeCount * sizeof(int32_t));
+
+    // Sets for the built-in character classes, created when first needed.
+    const UnicodeSet *lineTerminators = NULL;
+    const UnicodeSet *lf = NULL;
+    const UnicodeSet *digits = NULL;
+    const UnicodeSet *hSpaces = NULL;
+
+    //
+    //  Translate the compiled pattern into NFA nodes.
+    //
+    const UChar *litText = pattern.fLiteralText.getBuffer();
+    int32_t extra = size;       // The next unused extra node.
+    int32_t loc;
+    for (loc = 0; loc < fNodeCount; loc++) {
+        RegexNFANode &node = fNodes[loc];
+        node.fType     = NFA_DEAD;
+        node.fNext     = loc + 1;
+        node.fAlt      = -1;
+        node.fSet      = NULL;
+        node.fNegated  = FALSE;
+        node.fSlot     = -1;
+        node.fLoopBit  = 0;
+        node.fLoopMask = 0;
+        node.fMarkBase = 0;
+    }
+
+    // The loops that may match an empty string run from a URX_STO_INP_LOC
+    //   to the URX_JMP_SAV_X that jumps back to the op after it.
+    //   For now, fMarkBase of each location is the number of such loops around it.
+    for (loc = 0; loc < size; loc++) {
+        int32_t op = (int32_t)pat.elementAti(loc);
+        if (URX_TYPE(op) == URX_JMP_SAV_X) {
+            for (int32_t i = URX_VAL(op) - 1; i <= loc; i++) {
+                fNodes[i].fMarkBase++;
+            }
+        } else if (URX_TYPE(op) == URX_STRING || URX_TYPE(op) == URX_JMPX) {
+            loc++;
+        }
+    }
+
+    for (loc = 0; loc < size && U_SUCCESS(status); loc++) {
+        int32_t op      = (int32_t)pat.elementAti(loc);
+        int32_t opType  = URX_TYPE(op);
+        int32_t opValue = URX_VAL(op);
+        int32_t firstExtra = extra;
+        RegexNFANode &node = fNodes[loc];
+        int32_t depth = node.fMarkBase;
+        if (depth > MAX_LOOP_DEPTH) {
+            status = U_UNSUPPORTED_ERROR;
+            break;
+        }
+        node.fLoopMask = (1 << depth) - 1;
+        switch (opType) {
+        case URX_ONECHAR:
+            node.fType = NFA_SET;
+            node.fSet  = adoptSet(new UnicodeSet(opValue, opValue), status);
+            break;
+        case URX_ONECHAR_I:
+            {
+                // The code points whose case folding is the operand.
+                UnicodeSet closure(opValue, opValue);
+                closure.closeOver(USET_CASE_INSENSITIVE);
+                UnicodeSet *folded = new UnicodeSet();
+                if (folded != NULL) {
+                    for (int32_t r = 0; r < closure.getRangeCount(); r++) {
+                        for (UChar32 c = closure.getRangeStart(r); c <= closure.getRangeEnd(r); c++) {
+                            if (u_foldCase(c, U_FOLD_CASE_DEFAULT) == opValue) {
+                                folded->add(c);
+                            }
+                        }
+                    }
+                }
+                node.fType = NFA_SET;
+                node.fSet  = adoptSet(folded, status);
+            }
+            break;
+        case URX_STRING:
+            {
+                // One node per code point, the first one at the location of the op.
+                int32_t stringLen = URX_VAL(pat.elementAti(loc + 1));
+                const UChar *s = litText + opValue;
+                int32_t i = 0;
+                int32_t current = loc;
+                for (;;) {
+                    UChar32 c;
+                    U16_NEXT(s, i, stringLen, c);
+                    fNodes[current].fType = NFA_SET;
+                    fNodes[current].fSet  = adoptSet(new UnicodeSet(c, c), status);
+                    if (i >= stringLen) {
+                        break;
+                    }
+                    fNodes[current].fNext = extra;
+                    current = extra++;
+                }
+                fNodes[current].fNext = loc + 2;
+                loc++;          // The length operand stays a dead node.
+            }
+            break;
+        case URX_STATIC_SETREF:
+            node.fType    = NFA_SET;
+            node.fSet     = pattern.fStaticSets[opValue & ~URX_NEG_SET];
+            node.fNegated = (opValue & URX_NEG_SET) != 0;
+            break;
+        case URX_STAT_SETREF_N:
+            node.fType    = NFA_SET;
+            node.fSet     = pattern.fStaticSets[opValue];
+            node.fNegated = TRUE;
+            break;
+        case URX_SETREF:
+            node.fType = NFA_SET;
+            node.fSet  = (const UnicodeSet *)pattern.fSets->elementAt(opValue);
+            break;
+        case URX_BACKSLASH_D:
+            if (digits == NULL) {
+                UnicodeSet *set = new UnicodeSet();
+                if (set != NULL) {
+                    set->applyIntPropertyValue(UCHAR_GENERAL_CATEGORY_MASK, U_GC_ND_MASK, status);
+                }
+                digits = adoptSet(set, status);
+            }
+            node.fType    = NFA_SET;
+            node.fSet     = digits;
+            node.fNegated = opValue != 0;
+            break;
+        case URX_BACKSLASH_H:
+            if (hSpaces == NULL) {
+                UnicodeSet *set = new UnicodeSet();
+                if (set != NULL) {
+                    set->applyIntPropertyValue(UCHAR_GENERAL_CATEGORY_MASK, U_GC_ZS_MASK, status);
+                    set->add(9);
+                }
+                hSpaces = adoptSet(set, status);
+            }
+            node.fType    = NFA_SET;
+            node.fSet     = hSpaces;
+            node.fNegated = opValue != 0;
+            break;
+        case URX_BACKSLASH_V:
+        case URX_BACKSLASH_R:
+        case URX_DOTANY:
+            if (lineTerminators == NULL) {
+                UnicodeSet *set = new UnicodeSet(0x0a, 0x0d);
+                if (set != NULL) {
+                    set->add(0x85);
+                    set->add(0x2028, 0x2029);
+                }
+                lineTerminators = adoptSet(set, status);
+            }
+            node.fType    = NFA_SET;
+            node.fSet     = lineTerminators;
+            node.fNegated = opType == URX_DOTANY || (opType == URX_BACKSLASH_V && opValue != 0);
+            break;
+        case URX_DOTANY_UNIX:
+            if (lf == NULL) {
+                lf = adoptSet(new UnicodeSet(0x0a, 0x0a), status);
+            }
+            node.fType    = NFA_SET;
+            node.fSet     = lf;
+            node.fNegated = TRUE;
+            break;
+        case URX_DOTANY_ALL:
+            node.fType = NFA_SET;
+            break;
+        case URX_START_CAPTURE:
+            node.fType = NFA_SAVE_START;
+            node.fSlot = opValue;
+            break;
+        case URX_END_CAPTURE:
+            node.fType = NFA_SAVE_END;
+            node.fSlot = opValue;
+            break;
+        case URX_STO_INP_LOC:
+            node.fType    = NFA_LOOP_START;
+            node.fLoopBit = depth > 0 ? 1 << (depth - 1) : 0;
+            break;
+        case URX_NOP:
+        case URX_LOOP_C:
+            node.fType = NFA_EPSILON;
+            break;
+        case URX_JMP:
+            node.fType = NFA_EPSILON;
+            node.fNext = opValue;
+            break;
+        case URX_JMPX:
+            // Not generated by the pattern compiler.  Without progress, the loop
+            //   comes back to a node that was already visited at this input position.
+            node.fType = NFA_EPSILON;
+            node.fNext = opValue;
+            loc++;              // The data location operand stays a dead node.
+            break;
+        case URX_STATE_SAVE:
+            node.fType = NFA_SPLIT;
+            node.fAlt  = opValue;
+            break;
+        case URX_JMP_SAV:
+            node.fType = NFA_SPLIT;
+            node.fNext = opValue;
+            node.fAlt  = loc + 1;
+            break;
+        case URX_JMP_SAV_X:
+            {
+                // The node that leaves the loop is outside of it.
+                int32_t exitNode = extra++;
+                node.fType    = NFA_LOOP_CHECK;
+                node.fNext    = opValue;
+                node.fAlt     = exitNode;
+                node.fLoopBit = 1 << (depth - 1);
+                fNodes[exitNode].fType = NFA_EPSILON;
+                fNodes[exitNode].fNext = loc + 1;
+                fNodes[exitNode].fLoopMask = node.fLoopMask >> 1;
+                firstExtra = extra;
+            }
+            break;
+        case URX_LOOP_SR_I:
+        case URX_LOOP_DOT_I:
+            {
+                // Either run the loop body, which returns here, or skip the following LOOP_C.
+                int32_t body = extra++;
+                node.fType = NFA_SPLIT;
+                node.fNext = body;
+                node.fAlt  = loc + 2;
+                RegexNFANode &bodyNode = fNodes[body];
+                bodyNode.fType = NFA_SET;
+                bodyNode.fNext = loc;
+                if (opType == URX_LOOP_SR_I) {
+                    bodyNode.fSet = (const UnicodeSet *)pattern.fSets->elementAt(opValue);
+                } else if ((opValue & 1) == 0) {
+                    if ((opValue & 2) != 0) {
+                        if (lf == NULL) {
+                            lf = adoptSet(new UnicodeSet(0x0a, 0x0a), status);
+                        }
+                        bodyNode.fSet = lf;
+                    } else {
+                        if (lineTerminators == NULL) {
+                            UnicodeSet *set = new UnicodeSet(0x0a, 0x0d);
+                            if (set != NULL) {
+                                set->add(0x85);
+                                set->add(0x2028, 0x2029);
+                            }
+                            lineTerminators = adoptSet(set, status);
+                        }
+                        bodyNode.fSet = lineTerminators;
+                    }
+                    bodyNode.fNegated = TRUE;
+                }
+            }
+            break;
+        case URX_END:
+            node.fType = NFA_MATCH;
+            break;
+        default:
+            // URX_FAIL, URX_BACKTRACK
+            node.fType = NFA_DEAD;
+            break;
+        }
+
+        if (opType == URX_DOTANY_ALL || opType == URX_BACKSLASH_R ||
+                (opType == URX_LOOP_DOT_I && (opValue & 1) != 0)) {
+            // The backtracking engine does not stop between a CR and an LF.
+            fExact = FALSE;
+        }
+        if (opType == URX_DOTANY_ALL || opType == URX_BACKSLASH_R) {
+            // CR LF is consumed as a single line ending.
+            if (lf == NULL) {
+                lf = adoptSet(new UnicodeSet(0x0a, 0x0a), status);
+            }
+            node.fAlt = extra;
+            fNodes[extra].fType = NFA_SET;
+            fNodes[extra].fSet  = lf;
+            fNodes[extra].fNext = loc + 1;
+            extra++;
+        }
+        for (int32_t i = firstExtra; i < extra; i++) {
+            fNodes[i].fLoopMask = node.fLoopMask;
+        }
+    }
+    if (U_FAILURE(status)) {
+        return;
+    }
+    U_ASSERT(extra <= fNodeCount);
+
+    // The nodes reachable from a consuming or match node do not depend on how it was
+    //   reached, so it is visited only once at an input position.  Other nodes have
+    //   an entry in fMarks for each combination of the loops that they are inside of.
+    fVisitCount = 0;
+    for (loc = 0; loc < fNodeCount; loc++) {
+        RegexNFANode &node = fNodes[loc];
+        if (node.fType == NFA_DEAD || node.fType == NFA_SET || node.fType == NFA_MATCH) {
+            node.fLoopMask = 0;
+        }
+        node.fMarkBase = fVisitCount;
+        fVisitCount += node.fLoopMask + 1;
+    }
+    fMarks = (int32_t *)uprv_malloc(fVisitCount * sizeof(int32_t));
+    fStack = (int32_t *)uprv_malloc((STACK_PER_VISIT * fVisitCount + 1) * 2 * sizeof(int32_t));
+    if (fMarks == NULL || fStack == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    uprv_memset(fMarks, 0, fVisitCount * sizeof(int32_t));
+
+    buildPredecessors(status);
+    buildClasses(status);
+}
+
+
+RegexDFA::~RegexDFA() {
+    uprv_free(fNodes);
+    uprv_free(fWork);
+    uprv_free(fMarks);
+    uprv_free(fMembers);
+    uprv_free(fStack);
+    uprv_free(fPredStarts);
+    uprv_free(fPreds);
+    delete fLeftmost;
+    delete fToEnd;
+    delete fReverse;
+    for (int32_t i = 0; i < 2; i++) {
+        uprv_free(fThreadNodes[i]);
+        uprv_free(fThreadSlots[i]);
+    }
+    uprv_free(fSlots);
+    uprv_free(fSlotStack);
+}
+
+
+//
+//  adoptSet    Take ownership of a set that is used by NFA nodes.
+//
+const UnicodeSet *RegexDFA::adoptSet(UnicodeSet *set, UErrorCode &status) {
+    if (set == NULL) {
+        if (U_SUCCESS(status)) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+        }
+        return NULL;
+    }
+    set->freeze();
+    fOwnedSets.addElement(set, status);
+    if (U_FAILURE(status)) {
+        delete set;
+        return NULL;
+    }
+    return set;
+}
+
+
+//
+//  buildPredecessors    For each node, list the nodes that continue at it without
+//                       consuming input, for the reverse automaton.
+//
+void RegexDFA::buildPredecessors(UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    fPredStarts = (int32_t *)uprv_malloc((fNodeCount + 1) * sizeof(int32_t));
+    fPreds = (int32_t *)uprv_malloc(2 * fNodeCount * sizeof(int32_t));
+    if (fPredStarts == NULL || fPreds == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    // Count the predecessors of each node, then place them.
+    int32_t i;
+    uprv_memset(fPredStarts, 0, (fNodeCount + 1) * sizeof(int32_t));
+    for (i = 0; i < fNodeCount; i++) {
+        const RegexNFANode &node = fNodes[i];
+        switch (node.fType) {
+        case NFA_SPLIT:
+        case NFA_LOOP_CHECK:
+            fPredStarts[node.fAlt + 1]++;
+            U_FALLTHROUGH;
+        case NFA_EPSILON:
+        case NFA_SAVE_START:
+        case NFA_SAVE_END:
+        case NFA_LOOP_START:
+            fPredStarts[node.fNext + 1]++;
+            break;
+        default:
+            break;
+        }
+    }
+    for (i = 0; i < fNodeCount; i++) {
+        fPredStarts[i + 1] += fPredStarts[i];
+    }
+    int32_t *fill = fWork;          // Per node: the number of predecessors placed so far.
+    uprv_memset(fill, 0, fNodeCount * sizeof(int32_t));
+    for (i = 0; i < fNodeCount; i++) {
+        const RegexNFANode &node = fNodes[i];
+        switch (node.fType) {
+        case NFA_SPLIT:
+        case NFA_LOOP_CHECK:
+            fPreds[fPredStarts[node.fAlt] + fill[node.fAlt]++] = i;
+            U_FALLTHROUGH;
+        case NFA_EPSILON:
+        case NFA_SAVE_START:
+        case NFA_SAVE_END:
+        case NFA_LOOP_START:
+            fPreds[fPredStarts[node.fNext] + fill[node.fNext]++] = i;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+
+//
+//  buildClasses    Divide the code points into classes, so that the code points
+//                  of a class are either in or out of each of the sets used by the NFA.
+//                  A class is a set of intervals of code points that need not be adjacent.
+//
+void RegexDFA::buildClasses(UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    UVector sets(status);
+    UnicodeSet cr(0x0d, 0x0d);
+    int32_t i;
+    for (i = 0; i < fNodeCount; i++) {
+        const RegexNFANode &node = fNodes[i];
+        if (node.fType != NFA_SET) {
+            continue;
+        }
+        if (node.fSet != NULL && !sets.contains((void *)node.fSet)) {
+            sets.addElement((void *)node.fSet, status);
+        }
+        if (node.fAlt >= 0 && !sets.contains(&cr)) {
+            // A CR is treated differently from the other code points in the set.
+            sets.addElement(&cr, status);
+        }
+    }
+
+    // The interval starts are the code points where membership in some set changes.
+    fIntervalStarts.addElement(0, status);
+    for (i = 0; i < sets.size(); i++) {
+        const UnicodeSet *set = (const UnicodeSet *)sets.elementAt(i);
+        for (int32_t r = 0; r < set->getRangeCount(); r++) {
+            fIntervalStarts.addElement(set->getRangeStart(r), status);
+            if (set->getRangeEnd(r) < 0x10ffff) {
+                fIntervalStarts.addElement(set->getRangeEnd(r) + 1, status);
+            }
+        }
+    }
+    if (U_FAILURE(status)) {
+        return;
+    }
+    int32_t *starts = fIntervalStarts.getBuffer();
+    int32_t count = fIntervalStarts.size();
+    uprv_sortArray(starts, count, sizeof(int32_t), uprv_int32Comparator, NULL, FALSE, &status);
+    int32_t unique = 1;
+    for (i = 1; i < count; i++) {
+        if (starts[i] != starts[unique - 1]) {
+            starts[unique++] = starts[i];
+        }
+    }
+    fIntervalStarts.setSize(unique);
+    count = unique;
+
+    // Refine the classes with one set at a time:  split each class into the
+    //   intervals that are in the set and those that are not.
+    int32_t *classes = fIntervalClasses.reserveBlock(count, status);
+    int32_t *remap = (int32_t *)uprv_malloc(2 * (count + 1) * sizeof(int32_t));
+    if (remap == NULL && U_SUCCESS(status)) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+    }
+    if (U_FAILURE(status)) {
+        uprv_free(remap);
+        return;
+    }
+    starts = fIntervalStarts.getBuffer();
+    for (i = 0; i < count; i++) {
+        classes[i] = 0;
+    }
+    fClassCount = 1;
+    for (int32_t setIndex = 0; setIndex < sets.size(); setIndex++) {
+        const UnicodeSet *set = (const UnicodeSet *)sets.elementAt(setIndex);
+        int32_t rangeCount = set->getRangeCount();
+        int32_t r = 0;
+        int32_t newCount = 0;
+        for (i = 0; i < 2 * fClassCount; i++) {
+            remap[i] = -1;
+        }
+        for (i = 0; i < count; i++) {
+            while (r < rangeCount && set->getRangeEnd(r) < starts[i]) {
+                r++;
+            }
+            int32_t key = 2 * classes[i] + (r < rangeCount && set->getRangeStart(r) <= starts[i]);
+            if (remap[key] < 0) {
+                remap[key] = newCount++;
+            }
+            classes[i] = remap[key];
+        }
+        fClassCount = newCount;
+    }
+    uprv_free(remap);
+
+    for (i = 0; i < fClassCount; i++) {
+        fClassChars.addElement(-1, status);
+    }
+    if (U_FAILURE(status)) {
+        return;
+    }
+    int32_t *classChars = fClassChars.getBuffer();
+    for (i = 0; i < count; i++) {
+        if (classChars[classes[i]] < 0) {
+            classChars[classes[i]] = starts[i];
+        }
+    }
+
+    // The first interval of each block of 256 BMP code points narrows the search in classOf().
+    int32_t interval = 0;
+    for (i = 0; i <= 0x100; i++) {
+        while (interval + 1 < count && starts[interval + 1] <= (i << 8)) {
+            interval++;
+        }
+        fBlockIntervals[i] = interval;
+    }
+    for (i = 0; i < 0x100; i++) {
+        fLatin1Classes[i] = (uint16_t)classOf(i);
+    }
+}
+
+
+//
+//  classOf     Return the character class of a code point.
+//
+inline int32_t RegexDFA::classOf(UChar32 c) const {
+    int32_t lo, hi;
+    if (c <= 0xffff) {
+        lo = fBlockIntervals[c >> 8];
+        hi = fBlockIntervals[(c >> 8) + 1];
+    } else {
+        lo = fBlockIntervals[0x100];
+        hi = fIntervalStarts.size() - 1;
+    }
+    // Find the last interval that starts at or before c.
+    const int32_t *starts = fIntervalStarts.getBuffer();
+    while (lo < hi) {
+        int32_t mid = (lo + hi + 1) / 2;
+        if (starts[mid] <= c) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return fIntervalClasses.elementAti(lo);
+}
+
+
+//
+//  addClosure    Add a node, and all nodes reachable from it without consuming input,
+//                to the node list being built in fWork.  Only consuming and match
+//                nodes are kept, in the order in which the backtracking engine would
+//                reach them.  A node that was already visited the same way is not
+//                visited again:  the backtracking engine would fail there again.
+//
+void RegexDFA::addClosure(int32_t node) {
+    // Stack entries are pairs:  a node to visit, and the bits for the loops that
+    //   began an iteration at this input position on the way to it.
+    int32_t sp = 0;
+    fStack[sp++] = node;
+    fStack[sp++] = 0;
+    while (sp > 0) {
+        sp -= 2;
+        int32_t n = fStack[sp];
+        int32_t loops = fStack[sp + 1];
+        const RegexNFANode &nfaNode = fNodes[n];
+        int32_t mark = nfaNode.fMarkBase + (loops & nfaNode.fLoopMask);
+        if (fMarks[mark] == fGeneration) {
+            continue;
+        }
+        fMarks[mark] = fGeneration;
+        switch (nfaNode.fType) {
+        case NFA_DEAD:
+            break;
+        case NFA_LOOP_CHECK:
+            // Leave the loop.  Unless the iteration began at this input position,
+            //   first try another one.
+            fStack[sp++] = nfaNode.fAlt;
+            fStack[sp++] = loops;
+            if ((loops & nfaNode.fLoopBit) == 0) {
+                fStack[sp++] = nfaNode.fNext;
+                fStack[sp++] = loops | nfaNode.fLoopBit;
+            }
+            break;
+        case NFA_SPLIT:
+            fStack[sp++] = nfaNode.fAlt;
+            fStack[sp++] = loops;
+            U_FALLTHROUGH;
+        case NFA_EPSILON:
+        case NFA_SAVE_START:
+        case NFA_SAVE_END:
+            fStack[sp++] = nfaNode.fNext;
+            fStack[sp++] = loops;
+            break;
+        case NFA_LOOP_START:
+            fStack[sp++] = nfaNode.fNext;
+            fStack[sp++] = loops | nfaNode.fLoopBit;
+            break;
+        default:
+            fWork[fWorkCount++] = n;
+            break;
+        }
+    }
+}
+
+
+//
+//  addReverseClosure    Add a node, and all nodes from which it can be reached
+//                       without consuming input, to the node set being built in fWork.
+//
+void RegexDFA::addReverseClosure(int32_t node) {
+    int32_t sp = 0;
+    fStack[sp++] = node;
+    while (sp > 0) {
+        int32_t n = fStack[--sp];
+        if (fMarks[fNodes[n].fMarkBase] == fGeneration) {
+            continue;
+        }
+        fMarks[fNodes[n].fMarkBase] = fGeneration;
+        fWork[fWorkCount++] = n;
+        for (int32_t i = fPredStarts[n]; i < fPredStarts[n + 1]; i++) {
+            if (fMarks[fNodes[fPreds[i]].fMarkBase] != fGeneration) {
+                fStack[sp++] = fPreds[i];
+            }
+        }
+    }
+}
+
+
+//
+//  truncateAfterMatch    Drop the nodes after the first match node in fWork.
+//                        The backtracking engine would try them only if that
+//                        match failed, which it does not in find().
+//                        Return TRUE if there is a match node.
+//
+UBool RegexDFA::truncateAfterMatch() {
+    for (int32_t i = 0; i < fWorkCount; i++) {
+        if (fNodes[fWork[i]].fType == NFA_MATCH) {
+            fWorkCount = i + 1;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+
+//
+//  addState     Look up the state for the node list in fWork, creating it if necessary.
+//               Return the state number, or -1 if the table is full.
+//
+//               marker distinguishes TABLE_LEFTMOST states with the same nodes.
+//               A state that continues a match begun before the last character is
+//               kept apart from the state that only starts new matches, so that the
+//               start state means that no match is in progress, and a state after
+//               a match is kept apart from one where new matches may still begin.
+//
+int32_t RegexDFA::addState(StateTable &table, int32_t marker, UErrorCode &status) {
+    int32_t i, j;
+    if (table.fKind == TABLE_REVERSE) {
+        // Sort the nodes, so that equal sets have equal keys.
+        //   Forward states are lists, where the order matters.
+        for (i = 1; i < fWorkCount; i++) {
+            int32_t n = fWork[i];
+            for (j = i; j > 0 && fWork[j - 1] > n; j--) {
+                fWork[j] = fWork[j - 1];
+            }
+            fWork[j] = n;
+        }
+    }
+    UnicodeString key;
+    int32_t flags = 0;
+    for (i = 0; i < fWorkCount; i++) {
+        int32_t n = fWork[i];
+        key.append((UChar)n);
+        if (table.fKind == TABLE_REVERSE) {
+            if (n == 0) {
+                flags |= STATE_ACCEPTING;
+            }
+        } else if (fNodes[n].fType == NFA_MATCH) {
+            flags |= STATE_ACCEPTING;
+        } else if ((flags & STATE_ACCEPTING) == 0) {
+            flags |= STATE_LIVE;
+        }
+    }
+    if (marker != MARK_NONE) {
+        key.append((UChar)marker);
+        if (marker == MARK_MATCHED) {
+            flags |= STATE_MATCHED;
+        }
+    }
+    int32_t state = table.fStateMap.geti(key) - 1;
+    if (state >= 0) {
+        return state;
+    }
+
+    state = table.fStateStarts.size();
+    if (state >= MAX_STATES || (state + 1) * fClassCount > MAX_TRANSITIONS) {
+        return -1;
+    }
+    table.fStateStarts.addElement(table.fStateNodes.size(), status);
+    table.fStateNodes.addElement(fWorkCount, status);
+    for (i = 0; i < fWorkCount; i++) {
+        table.fStateNodes.addElement(fWork[i], status);
+    }
+    table.fFlags.addElement(flags, status);
+    int32_t *transitions = table.fTransitions.reserveBlock(fClassCount, status);
+    if (U_FAILURE(status)) {
+        return -1;
+    }
+    for (i = 0; i < fClassCount; i++) {
+        transitions[i] = UNKNOWN_STATE;
+    }
+    table.fStateMap.puti(key, state + 1, status);
+    return U_SUCCESS(status) ? state : -1;
+}
+
+
+int32_t RegexDFA::getStartState(StateTable &table, UErrorCode &status) {
+    if (table.fStart < 0) {
+        // State 0 is the dead state, with no nodes.
+        fWorkCount = 0;
+        if (addState(table, MARK_NONE, status) != DEAD_STATE) {
+            return -1;
+        }
+        ++fGeneration;
+        fWorkCount = 0;
+        int32_t marker = MARK_NONE;
+        if (table.fKind == TABLE_REVERSE) {
+            for (int32_t n = 0; n < fNodeCount; n++) {
+                if (fNodes[n].fType == NFA_MATCH) {
+                    addReverseClosure(n);
+                }
+            }
+        } else {
+            addClosure(0);
+            if (table.fKind == TABLE_LEFTMOST && truncateAfterMatch()) {
+                marker = MARK_MATCHED;
+            }
+        }
+        table.fStart = addState(table, marker, status);
+    }
+    return table.fStart;
+}
+
+
+//
+//  computeNext    Compute the transition from a state on a character class,
+//                 and store it in the transition table.
+//                 Return the next state number, or -1 if the table is full.
+//
+int32_t RegexDFA::computeNext(StateTable &table, int32_t state, int32_t charClass,
+                              UErrorCode &status) {
+    UChar32 c = fClassChars.elementAti(charClass);
+    int32_t start = table.fStateStarts.elementAti(state);
+    int32_t count = table.fStateNodes.elementAti(start);
+    const int32_t *nodes = table.fStateNodes.getBuffer() + start + 1;
+    int32_t marker = MARK_NONE;
+    int32_t i;
+    fWorkCount = 0;
+    if (table.fKind == TABLE_REVERSE) {
+        // The nodes that consume c and continue at a node of this state.
+        int32_t members = ++fGeneration;
+        for (i = 0; i < count; i++) {
+            fMembers[nodes[i]] = members;
+        }
+        ++fGeneration;
+        for (i = 0; i < fNodeCount; i++) {
+            const RegexNFANode &node = fNodes[i];
+            if (node.fType == NFA_SET && (node.fSet == NULL || node.fSet->contains(c) != node.fNegated) &&
+                    (fMembers[node.fNext] == members ||
+                     (c == 0x0d && node.fAlt >= 0 && fMembers[node.fAlt] == members))) {
+                addReverseClosure(i);
+            }
+        }
+    } else {
+        ++fGeneration;
+        for (i = 0; i < count; i++) {
+            const RegexNFANode &node = fNodes[nodes[i]];
+            if (node.fType == NFA_SET && (node.fSet == NULL || node.fSet->contains(c) != node.fNegated)) {
+                addClosure(node.fNext);
+                if (c == 0x0d && node.fAlt >= 0) {
+                    addClosure(node.fAlt);
+                }
+            }
+        }
+        if (table.fKind == TABLE_LEFTMOST) {
+            UBool matched = (table.fFlags.elementAti(state) & STATE_MATCHED) != 0;
+            if (!matched) {
+                // A new match may begin after this character.
+                if (fWorkCount > 0) {
+                    marker = MARK_IN_PROGRESS;
+                }
+                addClosure(0);
+            }
+            if (truncateAfterMatch()) {
+                matched = TRUE;
+            }
+            if (matched && fWorkCount > 0) {
+                marker = MARK_MATCHED;
+            }
+        }
+    }
+    int32_t next = addState(table, marker, status);
+    if (next >= 0) {
+        table.fTransitions.getBuffer()[state * fClassCount + charClass] = next;
+    }
+    return next;
+}
+
+
+//
+//  nextState    Return the state after a code point, or -1 if the table is full.
+//
+inline int32_t RegexDFA::nextState(StateTable &table, int32_t state, UChar32 c, UErrorCode &status) {
+    int32_t charClass = c < 0x100 ? fLatin1Classes[c] : classOf(c);
+    int32_t next = table.fTransitions.getBuffer()[state * fClassCount + charClass];
+    if (next == UNKNOWN_STATE) {
+        next = computeNext(table, state, charClass, status);
+    }
+    return next;
+}
+
+
+int32_t RegexDFA::findEnd(UText *text, int64_t limit, int64_t &matchEnd, UBool &hitEnd,
+                          UErrorCode &status, UBool stopWhenIdle) {
+    if (U_FAILURE(status)) {
+        return DFA_GAVE_UP;
+    }
+    StateTable &table = *fLeftmost;
+    int32_t state = getStartState(table, status);
+    if (state < 0) {
+        return DFA_GAVE_UP;
+    }
+    // The start state is the only state with no match in progress.
+    int32_t idleState = stopWhenIdle ? state : -1;
+    int64_t lastEnd = -1;
+    UBool atLimit = FALSE;
+    for (;;) {
+        int32_t flags = table.fFlags.getBuffer()[state];
+        if ((flags & STATE_ACCEPTING) != 0) {
+            lastEnd = UTEXT_GETNATIVEINDEX(text);
+        }
+        if ((flags & STATE_LIVE) == 0) {
+            // Dead, or nothing is left that the backtracking engine would try before the match.
+            break;
+        }
+        UChar32 c;
+        if (text->chunkOffset < text->chunkLength && text->chunkNativeLimit <= limit &&
+                !U16_IS_SURROGATE(c = text->chunkContents[text->chunkOffset])) {
+            // Inside a chunk that ends before the limit, there is no need to check
+            //   the native index for each character.
+            text->chunkOffset++;
+        } else {
+            if (UTEXT_GETNATIVEINDEX(text) >= limit) {
+                atLimit = TRUE;
+                break;
+            }
+            c = UTEXT_NEXT32(text);
+        }
+        state = nextState(table, state, c, status);
+        if (state < 0) {
+            return DFA_GAVE_UP;
+        }
+        if (state == idleState && lastEnd < 0) {
+            matchEnd = UTEXT_GETNATIVEINDEX(text);
+            return DFA_IDLE;
+        }
+    }
+    if (lastEnd >= 0) {
+        matchEnd = lastEnd;
+        if (atLimit) {
+            hitEnd = TRUE;
+        }
+        return DFA_MATCH;
+    }
+    return atLimit ? DFA_HIT_END : DFA_NO_MATCH;
+}
+
+
+int32_t RegexDFA::findEnd(const UChar *s, int32_t start, int32_t limit, int64_t &matchEnd, UBool &hitEnd,
+                          UErrorCode &status, UBool stopWhenIdle) {
+    if (U_FAILURE(status)) {
+        return DFA_GAVE_UP;
+    }
+    StateTable &table = *fLeftmost;
+    int32_t state = getStartState(table, status);
+    if (state < 0) {
+        return DFA_GAVE_UP;
+    }
+    // The start state is the only state with no match in progress.
+    int32_t idleState = stopWhenIdle ? state : -1;
+    int32_t lastEnd = -1;
+    int32_t i = start;
+    for (;;) {
+        int32_t flags = table.fFlags.getBuffer()[state];
+        if ((flags & STATE_ACCEPTING) != 0) {
+            lastEnd = i;
+        }
+        if ((flags & STATE_LIVE) == 0 || i >= limit) {
+            break;
+        }
+        UChar32 c = s[i++];
+        if (U16_IS_LEAD(c) && i < limit && U16_IS_TRAIL(s[i])) {
+            c = U16_GET_SUPPLEMENTARY(c, s[i++]);
+        }
+        state = nextState(table, state, c, status);
+        if (state < 0) {
+            return DFA_GAVE_UP;
+        }
+        if (state == idleState && lastEnd < 0) {
+            matchEnd = i;
+            return DFA_IDLE;
+        }
+    }
+    UBool atLimit = (table.fFlags.getBuffer()[state] & STATE_LIVE) != 0;
+    if (lastEnd >= 0) {
+        matchEnd = lastEnd;
+        if (atLimit) {
+            hitEnd = TRUE;
+        }
+        return DFA_MATCH;
+    }
+    return atLimit ? DFA_HIT_END : DFA_NO_MATCH;
+}
+
+
+int32_t RegexDFA::findEnd(const uint8_t *s, int32_t start, int32_t limit, int64_t &matchEnd, UBool &hitEnd,
+                          UErrorCode &status, UBool stopWhenIdle) {
+    if (U_FAILURE(status)) {
+        return DFA_GAVE_UP;
+    }
+    StateTable &table = *fLeftmost;
+    int32_t state = getStartState(table, status);
+    if (state < 0) {
+        return DFA_GAVE_UP;
+    }
+    // The start state is the only state with no match in progress.
+    int32_t idleState = stopWhenIdle ? state : -1;
+    int32_t lastEnd = -1;
+    int32_t i = start;
+    for (;;) {
+        int32_t flags = table.fFlags.getBuffer()[state];
+        if ((flags & STATE_ACCEPTING) != 0) {
+            lastEnd = i;
+        }
+        if ((flags & STATE_LIVE) == 0 || i >= limit) {
+            break;
+        }
+        UChar32 c;
+        U8_NEXT_OR_FFFD(s, i, limit, c);
+        state = nextState(table, state, c, status);
+        if (state < 0) {
+            return DFA_GAVE_UP;
+        }
+        if (state == idleState && lastEnd < 0) {
+            matchEnd = i;
+            return DFA_IDLE;
+        }
+    }
+    UBool atLimit = (table.fFlags.getBuffer()[state] & STATE_LIVE) != 0;
+    if (lastEnd >= 0) {
+        matchEnd = lastEnd;
+        if (atLimit) {
+            hitEnd = TRUE;
+        }
+        return DFA_MATCH;
+    }
+    return atLimit ? DFA_HIT_END : DFA_NO_MATCH;
+}
+
+
+int32_t RegexDFA::matchToEnd(UText *text, int64_t limit, UBool &hitEnd, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return DFA_GAVE_UP;
+    }
+    StateTable &table = *fToEnd;
+    int32_t state = getStartState(table, status);
+    for (;;) {
+        if (state < 0) {
+            return DFA_GAVE_UP;
+        }
+        if (state == DEAD_STATE) {
+            return DFA_NO_MATCH;
+        }
+        if (UTEXT_GETNATIVEINDEX(text) >= limit) {
+            break;
+        }
+        state = nextState(table, state, UTEXT_NEXT32(text), status);
+    }
+    int32_t flags = table.fFlags.getBuffer()[state];
+    if ((flags & STATE_ACCEPTING) == 0) {
+        return DFA_HIT_END;
+    }
+    if ((flags & STATE_LIVE) != 0) {
+        hitEnd = TRUE;
+    }
+    return DFA_MATCH;
+}
+
+
+int32_t RegexDFA::matchToEnd(const UChar *s, int32_t start, int32_t limit, UBool &hitEnd,
+                             UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return DFA_GAVE_UP;
+    }
+    StateTable &table = *fToEnd;
+    int32_t state = getStartState(table, status);
+    int32_t i = start;
+    for (;;) {
+        if (state < 0) {
+            return DFA_GAVE_UP;
+        }
+        if (state == DEAD_STATE) {
+            return DFA_NO_MATCH;
+        }
+        if (i >= limit) {
+            break;
+        }
+        UChar32 c = s[i++];
+        if (U16_IS_LEAD(c) && i < limit && U16_IS_TRAIL(s[i])) {
+            c = U16_GET_SUPPLEMENTARY(c, s[i++]);
+        }
+        state = nextState(table, state, c, status);
+    }
+    int32_t flags = table.fFlags.getBuffer()[state];
+    if ((flags & STATE_ACCEPTING) == 0) {
+        return DFA_HIT_END;
+    }
+    if ((flags & STATE_LIVE) != 0) {
+        hitEnd = TRUE;
+    }
+    return DFA_MATCH;
+}
+
+
+int32_t RegexDFA::matchToEnd(const uint8_t *s, int32_t start, int32_t limit, UBool &hitEnd,
+                             UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return DFA_GAVE_UP;
+    }
+    StateTable &table = *fToEnd;
+    int32_t state = getStartState(table, status);
+    int32_t i = start;
+    for (;;) {
+        if (state < 0) {
+            return DFA_GAVE_UP;
+        }
+        if (state == DEAD_STATE) {
+            return DFA_NO_MATCH;
+        }
+        if (i >= limit) {
+            break;
+        }
+        UChar32 c;
+        U8_NEXT_OR_FFFD(s, i, limit, c);
+        state = nextState(table, state, c, status);
+    }
+    int32_t flags = table.fFlags.getBuffer()[state];
+    if ((flags & STATE_ACCEPTING) == 0) {
+        return DFA_HIT_END;
+    }
+    if ((flags & STATE_LIVE) != 0) {
+        hitEnd = TRUE;
+    }
+    return DFA_MATCH;
+}
+
+
+int32_t RegexDFA::findStart(UText *text, int64_t start, int64_t matchEnd, int64_t &matchStart,
+                            UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return DFA_GAVE_UP;
+    }
+    StateTable &table = *fReverse;
+    int32_t state = getStartState(table, status);
+    int64_t pos = matchEnd;
+    int64_t best = -1;
+    UTEXT_SETNATIVEINDEX(text, matchEnd);
+    for (;;) {
+        if (state < 0) {
+            return DFA_GAVE_UP;
+        }
+        if ((table.fFlags.getBuffer()[state] & STATE_ACCEPTING) != 0) {
+            best = pos;
+        }
+        if (state == DEAD_STATE || pos <= start) {
+            break;
+        }
+        UChar32 c = UTEXT_PREVIOUS32(text);
+        pos = UTEXT_GETNATIVEINDEX(text);
+        if (pos < start) {
+            break;
+        }
+        state = nextState(table, state, c, status);
+    }
+    if (best < 0) {
+        return DFA_NO_MATCH;
+    }
+    matchStart = best;
+    return DFA_MATCH;
+}
+
+
+int32_t RegexDFA::findStart(const uint8_t *s, int32_t start, int32_t matchEnd, int64_t &matchStart,
+                            UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return DFA_GAVE_UP;
+    }
+    StateTable &table = *fReverse;
+    int32_t state = getStartState(table, status);
+    int32_t pos = matchEnd;
+    int32_t best = -1;
+    for (;;) {
+        if (state < 0) {
+            return DFA_GAVE_UP;
+        }
+        if ((table.fFlags.getBuffer()[state] & STATE_ACCEPTING) != 0) {
+            best = pos;
+        }
+        if (state == DEAD_STATE || pos <= start) {
+            break;
+        }
+        UChar32 c;
+        U8_PREV_OR_FFFD(s, start, pos, c);
+        state = nextState(table, state, c, status);
+    }
+    if (best < 0) {
+        return DFA_NO_MATCH;
+    }
+    matchStart = best;
+    return DFA_MATCH;
+}
+
+
+//
+//  addThread    For getCaptures(), add a node and the nodes reachable from it without
+//               consuming input to a thread list, in the order of the backtracking engine,
+//               each with a copy of the frame slots in fSlots as they are when it is reached.
+//
+void RegexDFA::addThread(int32_t list, int32_t node, int64_t pos) {
+    // Stack entries are pairs:  a node to visit, and the loop bits as in addClosure(),
+    //   or -1 - a frame slot, and the value to restore the slot to once the nodes
+    //   reachable after a capture are done.
+    int64_t *stack = fSlotStack;
+    int32_t sp = 0;
+    stack[sp++] = node;
+    stack[sp++] = 0;
+    while (sp > 0) {
+        sp -= 2;
+        int64_t entry = stack[sp];
+        if (entry < 0) {
+            fSlots[-1 - entry] = stack[sp + 1];
+            continue;
+        }
+        int32_t n = (int32_t)entry;
+        int32_t loops = (int32_t)stack[sp + 1];
+        const RegexNFANode &nfaNode = fNodes[n];
+        int32_t mark = nfaNode.fMarkBase + (loops & nfaNode.fLoopMask);
+        if (fMarks[mark] == fGeneration) {
+            continue;
+        }
+        fMarks[mark] = fGeneration;
+        int32_t slot = nfaNode.fSlot;
+        switch (nfaNode.fType) {
+        case NFA_DEAD:
+            break;
+        case NFA_LOOP_CHECK:
+            stack[sp++] = nfaNode.fAlt;
+            stack[sp++] = loops;
+            if ((loops & nfaNode.fLoopBit) == 0) {
+                stack[sp++] = nfaNode.fNext;
+                stack[sp++] = loops | nfaNode.fLoopBit;
+            }
+            break;
+        case NFA_SPLIT:
+            stack[sp++] = nfaNode.fAlt;
+            stack[sp++] = loops;
+            U_FALLTHROUGH;
+        case NFA_EPSILON:
+            stack[sp++] = nfaNode.fNext;
+            stack[sp++] = loops;
+            break;
+        case NFA_LOOP_START:
+            stack[sp++] = nfaNode.fNext;
+            stack[sp++] = loops | nfaNode.fLoopBit;
+            break;
+        case NFA_SAVE_START:
+            // As URX_START_CAPTURE:  set the tentative start of the group.
+            stack[sp++] = -1 - (slot + 2);
+            stack[sp++] = fSlots[slot + 2];
+            fSlots[slot + 2] = pos;
+            stack[sp++] = nfaNode.fNext;
+            stack[sp++] = loops;
+            break;
+        case NFA_SAVE_END:
+            // As URX_END_CAPTURE:  the tentative start becomes real, and set the end.
+            stack[sp++] = -1 - slot;
+            stack[sp++] = fSlots[slot];
+            stack[sp++] = -1 - (slot + 1);
+            stack[sp++] = fSlots[slot + 1];
+            fSlots[slot] = fSlots[slot + 2];
+            fSlots[slot + 1] = pos;
+            stack[sp++] = nfaNode.fNext;
+            stack[sp++] = loops;
+            break;
+        default:
+            {
+                int32_t t = fThreadCounts[list]++;
+                fThreadNodes[list][t] = n;
+                uprv_memcpy(fThreadSlots[list] + t * fSlotCount, fSlots, fSlotCount * sizeof(int64_t));
+            }
+            break;
+        }
+    }
+}
+
+
+//
+//  initCaptures    Allocate the thread lists for getCaptures() on first use,
+//                  and start the simulation with the threads at the start position.
+//
+UBool RegexDFA::initCaptures(int64_t start, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return FALSE;
+    }
+    U_ASSERT(fExact);
+    int32_t i;
+    if (fSlotStack == NULL) {
+        int32_t slotCount = fSlotCount > 0 ? fSlotCount : 1;
+        for (i = 0; i < 2; i++) {
+            fThreadNodes[i] = (int32_t *)uprv_malloc(fNodeCount * sizeof(int32_t));
+            fThreadSlots[i] = (int64_t *)uprv_malloc(fNodeCount * slotCount * sizeof(int64_t));
+        }
+        fSlots = (int64_t *)uprv_malloc(slotCount * sizeof(int64_t));
+        fSlotStack = (int64_t *)uprv_malloc((STACK_PER_VISIT * fVisitCount + 1) * 2 * sizeof(int64_t));
+        if (fThreadNodes[0] == NULL || fThreadNodes[1] == NULL || fThreadSlots[0] == NULL ||
+                fThreadSlots[1] == NULL || fSlots == NULL || fSlotStack == NULL) {
+            for (i = 0; i < 2; i++) {
+                uprv_free(fThreadNodes[i]);
+                uprv_free(fThreadSlots[i]);
+                fThreadNodes[i] = NULL;
+                fThreadSlots[i] = NULL;
+            }
+            uprv_free(fSlots);
+            uprv_free(fSlotStack);
+            fSlots = NULL;
+            fSlotStack = NULL;
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return FALSE;
+        }
+    }
+
+    // Simulate the NFA, with the threads of each list in the order of the backtracking engine.
+    for (i = 0; i < fSlotCount; i++) {
+        fSlots[i] = -1;
+    }
+    ++fGeneration;
+    fThreadCounts[0] = 0;
+    addThread(0, 0, start);
+    return TRUE;
+}
+
+
+//
+//  stepCaptures    For getCaptures(), advance the threads in list current over the
+//                  character c at pos, which ends at nextPos.  c is U_SENTINEL at the limit.
+//                  Return the list with the new threads, or CAPTURES_MATCHED with the
+//                  capture groups in frameData, or CAPTURES_FAILED.
+//
+int32_t RegexDFA::stepCaptures(int32_t current, int64_t pos, int64_t limit, UChar32 c,
+                               int64_t nextPos, int64_t *frameData) {
+    int32_t next = 1 - current;
+    ++fGeneration;
+    fThreadCounts[next] = 0;
+    for (int32_t t = 0; t < fThreadCounts[current]; t++) {
+        const RegexNFANode &node = fNodes[fThreadNodes[current][t]];
+        const int64_t *slots = fThreadSlots[current] + t * fSlotCount;
+        if (node.fType == NFA_MATCH) {
+            if (pos == limit) {
+                // The first match at the limit is the one that the backtracking engine finds.
+                uprv_memcpy(frameData, slots, fSlotCount * sizeof(int64_t));
+                return CAPTURES_MATCHED;
+            }
+        } else if (c >= 0 && (node.fSet == NULL || node.fSet->contains(c) != node.fNegated)) {
+            uprv_memcpy(fSlots, slots, fSlotCount * sizeof(int64_t));
+            addThread(next, node.fNext, nextPos);
+            if (c == 0x0d && node.fAlt >= 0) {
+                addThread(next, node.fAlt, nextPos);
+            }
+        }
+    }
+    if (pos >= limit || fThreadCounts[next] == 0) {
+        return CAPTURES_FAILED;
+    }
+    return next;
+}
+
+
+UBool RegexDFA::getCaptures(UText *text, int64_t start, int64_t limit, int64_t *frameData,
+                            UErrorCode &status) {
+    if (!initCaptures(start, status)) {
+        return FALSE;
+    }
+    int32_t current = 0;
+    UTEXT_SETNATIVEINDEX(text, start);
+    int64_t pos = start;
+    for (;;) {
+        UChar32 c = U_SENTINEL;
+        int64_t nextPos = pos;
+        if (pos < limit) {
+            c = UTEXT_NEXT32(text);
+            nextPos = UTEXT_GETNATIVEINDEX(text);
+        }
+        current = stepCaptures(current, pos, limit, c, nextPos, frameData);
+        if (current < 0) {
+            return current == CAPTURES_MATCHED;
+        }
+        pos = nextPos;
+    }
+}
+
+
+UBool RegexDFA::getCaptures(const uint8_t *s, int32_t start, int32_t limit, int64_t *frameData,
+                            UErrorCode &status) {
+    if (!initCaptures(start, status)) {
+        return FALSE;
+    }
+    int32_t current = 0;
+    int32_t pos = start;
+    for (;;) {
+        UChar32 c = U_SENTINEL;
+        int32_t nextPos = pos;
+        if (pos < limit) {
+            U8_NEXT_OR_FFFD(s, nextPos, limit, c);
+        }
+        current = stepCaptures(current, pos, limit, c, nextPos, frameData);
+        if (current < 0) {
+            return current == CAPTURES_MATCHED;
+        }
+        pos = nextPos;
+    }
+}
+
+U_NAMESPACE_END
+
+#endif  // !UCONFIG_NO_REGULAR_EXPRESSIONS
@@ -0,0 +1,268 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+//
+//  regexdfa.h
+//
+//  Copyright (C) 2016, International Business Machines Corporation and others.
+//  All Rights Reserved.
+//
+//  This file contains declarations for the class RegexDFA
+//
+//  This class is internal to the regular expression implementation.
+//  For the public Regular Expression API, see the file "unicode/regex.h"
+//
+//  RegexDFA is a lazily built deterministic automaton for the subset of
+//   compiled patterns that use no back references, look-around, atomic or
+//   possessive constructs, counted loops or anchors.  It finds matches in time
+//   linear in the length of the input, without the exponential worst case of
+//   the backtracking engine in rematch.cpp.
+//
+//   The states of the forward automata are lists of NFA nodes in the order in
+//   which the backtracking engine would try them, so that the automaton finds
+//   the end of the match that the backtracking engine prefers.  A second,
+//   reverse automaton then finds where that match starts, and a simulation
+//   of the NFA over the match, keeping one set of capture groups per node,
+//   recovers the capture groups.
+//
+//   For most patterns these results are exact.  The special handling of CR LF
+//   by '.' in dot-all mode and by \R is not modeled, so for patterns with those
+//   the automaton accepts a superset of what the backtracking engine accepts:
+//   a "no match" answer is still exact, while a match must be confirmed by the
+//   backtracking engine.
+//
+//   Input code points are mapped to character classes, where all of the code
+//   points in a class are matched by the same pattern items.  DFA states have
+//   one transition per class, computed when first needed.
+//
+//   A RegexDFA caches its states, and belongs to a single RegexMatcher.
+//
+
+#ifndef REGEXDFA_H
+#define REGEXDFA_H
+
+#include "unicode/utypes.h"
+#if !UCONFIG_NO_REGULAR_EXPRESSIONS
+
+#include "unicode/utext.h"
+#include "hash.h"
+#include "uvector.h"
+#include "uvectr32.h"
+
+U_NAMESPACE_BEGIN
+
+class RegexPattern;
+class UnicodeSet;
+struct RegexNFANode;
+
+class RegexDFA : public UMemory {
+public:
+    /**
+     * Results of the run functions.
+     */
+    enum {
+        DFA_NO_MATCH,   // The automaton died before reaching the limit.
+        DFA_MATCH,      // A match was found.
+        DFA_HIT_END,    // Reached the limit without a match, but more input might match.
+        DFA_GAVE_UP,    // Too many states; use the backtracking engine instead.
+        DFA_IDLE        // No match is in progress at matchEnd.  See stopWhenIdle.
+    };
+
+    /**
+     * @return TRUE if the compiled pattern uses only operations that the DFA supports.
+     */
+    static UBool isSupported(const RegexPattern &pattern);
+
+    /**
+     * Constructor.  The pattern must be supported, and must outlive this object.
+     */
+    RegexDFA(const RegexPattern &pattern, UErrorCode &status);
+    ~RegexDFA();
+
+    /**
+     * @return TRUE if the matches found by the automaton are those of the backtracking
+     *         engine.  If FALSE, a match found by the automaton is only a possible match,
+     *         while "no match" is still exact.
+     */
+    UBool isExact() const { return fExact; }
+
+    /**
+     * Find the end of the match that find() would return, for matches that begin
+     * at or after the text's current native index, and end at or before the limit.
+     *
+     * @param text        The input text.  Its native index is left after the last character examined.
+     * @param limit       The native index at which to stop.
+     * @param matchEnd    Set to the native index where the match ends, for DFA_MATCH.
+     * @param hitEnd      For DFA_MATCH, set to TRUE if the backtracking engine would have
+     *                    looked at the limit before finding the match; otherwise not changed.
+     * @param status      Error code.
+     * @param stopWhenIdle  If TRUE, return DFA_IDLE with matchEnd set to the first position
+     *                    after the start where no match is in progress, so that the caller
+     *                    can look for the next possible match start in a faster way.
+     * @return            DFA_NO_MATCH, DFA_MATCH, DFA_HIT_END, DFA_GAVE_UP or DFA_IDLE.
+     */
+    int32_t findEnd(UText *text, int64_t limit, int64_t &matchEnd, UBool &hitEnd,
+                    UErrorCode &status, UBool stopWhenIdle = FALSE);
+
+    /**
+     * Find the end of a match in UTF-16 text in a buffer, from start to limit.
+     * Otherwise the same as findEnd() on a UText.
+     */
+    int32_t findEnd(const UChar *s, int32_t start, int32_t limit, int64_t &matchEnd, UBool &hitEnd,
+                    UErrorCode &status, UBool stopWhenIdle = FALSE);
+
+    /**
+     * Find the end of a match in UTF-8 text in a buffer, from start to limit.
+     * Otherwise the same as findEnd() on a UText.
+     */
+    int32_t findEnd(const uint8_t *s, int32_t start, int32_t limit, int64_t &matchEnd, UBool &hitEnd,
+                    UErrorCode &status, UBool stopWhenIdle = FALSE);
+
+    /**
+     * Find whether the text from its current native index to the limit matches the
+     * pattern, as for matches().
+     *
+     * @param text        The input text.
+     * @param limit       The native index where the match must end.
+     * @param hitEnd      For DFA_MATCH, set to TRUE if the backtracking engine would have
+     *                    tried to look past the limit before finding the match;
+     *                    otherwise not changed.
+     * @param status      Error code.
+     * @return            DFA_NO_MATCH, DFA_MATCH, DFA_HIT_END or DFA_GAVE_UP.
+     */
+    int32_t matchToEnd(UText *text, int64_t limit, UBool &hitEnd, UErrorCode &status);
+
+    /**
+     * Match UTF-16 text in a buffer, from start to limit.
+     * Otherwise the same as matchToEnd() on a UText.
+     */
+    int32_t matchToEnd(const UChar *s, int32_t start, int32_t limit, UBool &hitEnd,
+                       UErrorCode &status);
+
+    /**
+     * Match UTF-8 text in a buffer, from start to limit.
+     * Otherwise the same as matchToEnd() on a UText.
+     */
+    int32_t matchToEnd(const uint8_t *s, int32_t start, int32_t limit, UBool &hitEnd,
+                       UErrorCode &status);
+
+    /**
+     * Find the start of the match that ends at matchEnd, as found by findEnd():
+     * the smallest position, not before start, from which the pattern matches the text
+     * up to matchEnd.  Runs backwards from matchEnd.
+     *
+     * @param text        The input text.
+     * @param start       The native index before which no match may begin.
+     * @param matchEnd    The native index where the match ends.
+     * @param matchStart  Set to the start of the match, for DFA_MATCH.
+     * @param status      Error code.
+     * @return            DFA_MATCH, DFA_NO_MATCH or DFA_GAVE_UP.
+     */
+    int32_t findStart(UText *text, int64_t start, int64_t matchEnd, int64_t &matchStart,
+                      UErrorCode &status);
+
+    /**
+     * Find the start of a match in UTF-8 text in a buffer.
+     * Otherwise the same as findStart() on a UText.
+     */
+    int32_t findStart(const uint8_t *s, int32_t start, int32_t matchEnd, int64_t &matchStart,
+                      UErrorCode &status);
+
+    /**
+     * Set the capture groups for a match of the whole text from start to limit,
+     * as the backtracking engine would.  The pattern must be exact.
+     *
+     * @param text        The input text.
+     * @param start       The native index where the match starts.
+     * @param limit       The native index where the match ends.
+     * @param frameData   The capture group data of a backtracking stack frame,
+     *                    one int64_t per pattern frame slot.
+     * @param status      Error code.
+     * @return            TRUE if the text matches.
+     */
+    UBool getCaptures(UText *text, int64_t start, int64_t limit, int64_t *frameData,
+                      UErrorCode &status);
+
+    /**
+     * Set the capture groups for a match of UTF-8 text in a buffer.
+     * Otherwise the same as getCaptures() on a UText.
+     */
+    UBool getCaptures(const uint8_t *s, int32_t start, int32_t limit, int64_t *frameData,
+                      UErrorCode &status);
+
+private:
+    // A set of lazily computed states and their transitions.
+    struct StateTable : public UMemory {
+        StateTable(int32_t kind, UErrorCode &status);
+        int32_t       fKind;         // TABLE_LEFTMOST, TABLE_TO_END or TABLE_REVERSE.
+        UVector32     fStateNodes;   // Per state: NFA node count, then the nodes.
+        UVector32     fStateStarts;  // Index into fStateNodes for each state.
+        UVector32     fFlags;        // Per state: STATE_ACCEPTING etc.
+        UVector32     fTransitions;  // Per state: the next state for each character class.
+        Hashtable     fStateMap;     // Map from node list, as a string, to state number + 1.
+        int32_t       fStart;        // Start state, or -1 if not yet built.
+    };
+
+    const UnicodeSet *adoptSet(UnicodeSet *set, UErrorCode &status);
+    void     buildClasses(UErrorCode &status);
+    void     buildPredecessors(UErrorCode &status);
+    inline int32_t classOf(UChar32 c) const;
+    int32_t  getStartState(StateTable &table, UErrorCode &status);
+    int32_t  computeNext(StateTable &table, int32_t state, int32_t charClass, UErrorCode &status);
+    inline int32_t nextState(StateTable &table, int32_t state, UChar32 c, UErrorCode &status);
+    void     addClosure(int32_t node);
+    void     addReverseClosure(int32_t node);
+    UBool    truncateAfterMatch();
+    int32_t  addState(StateTable &table, int32_t marker, UErrorCode &status);
+    void     addThread(int32_t list, int32_t node, int64_t pos);
+    UBool    initCaptures(int64_t start, UErrorCode &status);
+    int32_t  stepCaptures(int32_t current, int64_t pos, int64_t limit, UChar32 c,
+                          int64_t nextPos, int64_t *frameData);
+
+    RegexNFANode   *fNodes;
+    int32_t         fNodeCount;
+    UBool           fExact;
+    UVector         fOwnedSets;      // Sets for nodes that do not use a set from the pattern.
+
+    // The nodes from which each node can be reached without consuming input.
+    int32_t        *fPredStarts;     // Per node, and one more: index into fPreds.
+    int32_t        *fPreds;
+
+    // Map from code point to character class.  The code points are divided into
+    //   intervals, where no set used by the NFA begins or ends inside an interval.
+    UVector32       fIntervalStarts; // Sorted, beginning with 0.
+    UVector32       fIntervalClasses;
+    int32_t         fBlockIntervals[0x101];  // Per 256 code points of the BMP: first interval.
+    uint16_t        fLatin1Classes[0x100];
+    UVector32       fClassChars;     // A code point from each character class.
+    int32_t         fClassCount;
+
+    // Work area for building node lists.
+    int32_t        *fWork;           // The nodes of the list being built.
+    int32_t         fWorkCount;
+    int32_t        *fMarks;          // Per way of visiting a node: generation at which
+                                     //   it was last visited.
+    int32_t         fVisitCount;     // Size of fMarks.
+    int32_t        *fMembers;        // Per node: generation at which it was in the current state.
+    int32_t        *fStack;          // Closure stack.
+    int32_t         fGeneration;
+
+    StateTable     *fLeftmost;       // find(): a match may begin anywhere.
+    StateTable     *fToEnd;          // matches(): anchored at both ends.
+    StateTable     *fReverse;        // Backwards from the end of a match.
+
+    // Work area for getCaptures(), allocated when first needed.
+    //   Two lists of threads, each with a node and a copy of the frame slots.
+    int32_t         fSlotCount;      // Frame slots per thread.
+    int32_t        *fThreadNodes[2];
+    int32_t         fThreadCounts[2];
+    int64_t        *fThreadSlots[2];
+    int64_t        *fSlots;          // The frame slots of the thread being added.
+    int64_t        *fSlotStack;      // Nodes to visit, and frame slots to restore.
+
+    RegexDFA(const RegexDFA &other); // forbid copying of this class
+    RegexDFA &operator=(const RegexDFA &other); // forbid copying of this class
+};
+
+U_NAMESPACE_END
+#endif   // !UCONFIG_NO_REGULAR_EXPRESSIONS
+#endif   // REGEXDFA_H
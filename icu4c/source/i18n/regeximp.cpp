@@ -14,7 +14,11 @@
 
 #if !UCONFIG_NO_REGULAR_EXPRESSIONS
 #include "regeximp.h"
+#include "regexdfa.h"
+#include "mutex.h"
+#include "uvectr64.h"
 #include "unicode/utf16.h"
+#include "unicode/utf8.h"
 
 U_NAMESPACE_BEGIN
 
@@ -116,6 +120,115 @@ int64_t CaseFoldingUCharIterator::getIndex() {
 }
 
 
+
+CaseFoldingUTF8Iterator::CaseFoldingUTF8Iterator(const uint8_t *bytes, int64_t start, int64_t limit) :
+   fBytes(bytes), fIndex((int32_t)start), fLimit((int32_t)limit), fcsp(NULL), fFoldChars(NULL), fFoldLength(0) {
+   fcsp = ucase_getSingleton();
+}
+
+
+CaseFoldingUTF8Iterator::~CaseFoldingUTF8Iterator() {}
+
+
+UChar32 CaseFoldingUTF8Iterator::next() {
+    UChar32  foldedC;
+    UChar32  originalC;
+    if (fFoldChars == NULL) {
+        // We are not in a string folding of an earlier character.
+        // Start handling the next char from the input bytes.
+        if (fIndex >= fLimit) {
+            return U_SENTINEL;
+        }
+        U8_NEXT_OR_FFFD(fBytes, fIndex, fLimit, originalC);
+
+        fFoldLength = ucase_toFullFolding(fcsp, originalC, &fFoldChars, U_FOLD_CASE_DEFAULT);
+        if (fFoldLength >= UCASE_MAX_STRING_LENGTH || fFoldLength < 0) {
+            // input code point folds to a single code point, possibly itself.
+            // See comment in ucase.h for explanation of return values from ucase_toFullFoldings.
+            if (fFoldLength < 0) {
+                fFoldLength = ~fFoldLength;
+            }
+            foldedC = (UChar32)fFoldLength;
+            fFoldChars = NULL;
+            return foldedC;
+        }
+        // String foldings fall through here.
+        fFoldIndex = 0;
+    }
+
+    U16_NEXT(fFoldChars, fFoldIndex, fFoldLength, foldedC);
+    if (fFoldIndex >= fFoldLength) {
+        fFoldChars = NULL;
+    }
+    return foldedC;
+}
+
+
+UBool CaseFoldingUTF8Iterator::inExpansion() {
+    return fFoldChars != NULL;
+}
+
+int64_t CaseFoldingUTF8Iterator::getIndex() {
+    return fIndex;
+}
+
+
+static UMutex gSparesMutex = U_MUTEX_INITIALIZER;
+
+RegexSpares::RegexSpares() : fStackCount(0), fDFACount(0) {}
+
+RegexSpares::~RegexSpares() {
+    int32_t i;
+    for (i = 0; i < fStackCount; i++) {
+        delete fStacks[i];
+    }
+    for (i = 0; i < fDFACount; i++) {
+        delete fDFAs[i];
+    }
+}
+
+UVector64 *RegexSpares::takeStack() {
+    Mutex lock(&gSparesMutex);
+    return fStackCount > 0 ? fStacks[--fStackCount] : NULL;
+}
+
+void RegexSpares::putStack(UVector64 *stack) {
+    if (stack == NULL) {
+        return;
+    }
+    // Keep the memory of a spare bounded.  The next owner sets its own limit.
+    stack->removeAllElements();
+    stack->setMaxCapacity(MAX_SPARE_STACK_CAPACITY);
+    {
+        Mutex lock(&gSparesMutex);
+        if (fStackCount < MAX_SPARES) {
+            fStacks[fStackCount++] = stack;
+            return;
+        }
+    }
+    delete stack;
+}
+
+RegexDFA *RegexSpares::takeDFA() {
+    Mutex lock(&gSparesMutex);
+    return fDFACount > 0 ? fDFAs[--fDFACount] : NULL;
+}
+
+void RegexSpares::putDFA(RegexDFA *dfa) {
+    if (dfa == NULL) {
+        return;
+    }
+    {
+        Mutex lock(&gSparesMutex);
+        if (fDFACount < MAX_SPARES) {
+            fDFAs[fDFACount++] = dfa;
+            return;
+        }
+    }
+    delete dfa;
+}
+
+
 U_NAMESPACE_END
 
 #endif
@@ -324,7 +324,7 @@ struct Regex8BitSet : public UMemory {
     inline Regex8BitSet();
     inline void operator = (const Regex8BitSet &s);
     inline void init(const UnicodeSet *src);
-    inline UBool contains(UChar32 c);
+    inline UBool contains(UChar32 c) const;
     inline void  add(UChar32 c);
     int8_t d[32];
 };
@@ -333,7 +333,7 @@ inline Regex8BitSet::Regex8BitSet() {
     uprv_memset(d, 0, sizeof(d));
 }
 
-inline UBool Regex8BitSet::contains(UChar32 c) {
+inline UBool Regex8BitSet::contains(UChar32 c) const {
     // No bounds checking!  This is deliberate.
     return ((d[c>>3] & 1 <<(c&7)) != 0);
 }
@@ -411,6 +411,63 @@ class CaseFoldingUCharIterator: public UMemory {
 
 };
 
+// Case folding UTF-8 iterator.
+//     Same as CaseFoldingUCharIterator, over a UTF-8 buffer.
+//     Ill-formed sequences read as U+FFFD.
+class CaseFoldingUTF8Iterator: public UMemory {
+      public:
+        CaseFoldingUTF8Iterator(const uint8_t *bytes, int64_t start, int64_t limit);
+        ~CaseFoldingUTF8Iterator();
+
+        UChar32 next();           // Next case folded character
+
+        UBool   inExpansion();    // True if last char returned from next() and the
+                                  //  next to be returned both originated from a string
+                                  //  folding of the same code point from the orignal text.
+
+        int64_t  getIndex();      // Return the current input buffer index.
+
+      private:
+        const  uint8_t    *fBytes;
+        int32_t            fIndex;
+        int32_t            fLimit;
+        const  UCaseProps *fcsp;
+        const  UChar      *fFoldChars;
+        int32_t            fFoldLength;
+        int32_t            fFoldIndex;
+
+};
+
+class RegexDFA;
+class UVector64;
+
+// Spare matcher buffers.
+//     The backtrack stacks and DFAs of deleted matchers, kept by their pattern
+//     for the next matchers created from it.  A matcher per request, as with
+//     uregex_clone(), then does not allocate and grow them each time.
+//     Matchers of a pattern may be created and deleted on any thread,
+//     so the spares are guarded by a mutex.
+class RegexSpares: public UMemory {
+      public:
+        RegexSpares();
+        ~RegexSpares();
+
+        UVector64 *takeStack();                 // A spare stack, or NULL.
+        void       putStack(UVector64 *stack);  // Adopts the stack.
+        RegexDFA  *takeDFA();                   // A spare DFA, or NULL.
+        void       putDFA(RegexDFA *dfa);       // Adopts the DFA.
+
+      private:
+        enum {
+            MAX_SPARES = 4,                  // Of each kind, per pattern.
+            MAX_SPARE_STACK_CAPACITY = 0x4000   // In stack elements.  Larger stacks shrink.
+        };
+        UVector64         *fStacks[MAX_SPARES];
+        int32_t            fStackCount;
+        RegexDFA          *fDFAs[MAX_SPARES];
+        int32_t            fDFACount;
+};
+
 U_NAMESPACE_END
 #endif
 
@@ -0,0 +1,449 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+//
+//  file:  regexset.cpp
+//
+/*
+***************************************************************************
+*   Copyright (C) 2016 International Business Machines Corporation
+*   and others. All rights reserved.
+***************************************************************************
+*/
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_REGULAR_EXPRESSIONS
+
+#include "unicode/localpointer.h"
+#include "unicode/regex.h"
+#include "unicode/regexset.h"
+#include "unicode/utext.h"
+#include "cmemory.h"
+#include "uassert.h"
+#include "uvector.h"
+#include "uvectr32.h"
+
+U_NAMESPACE_BEGIN
+
+//--------------------------------------------------------------------------
+//
+//   RegexLiteralFilter    An Aho-Corasick automaton over the required literals
+//                         of the patterns of a RegexSet.  A pattern whose literal
+//                         does not occur in a text cannot match it.
+//
+//                         The trie is built with child and sibling links, with
+//                         siblings in code unit order, then flattened into sorted
+//                         edge arrays for the search.
+//
+//--------------------------------------------------------------------------
+class RegexLiteralFilter : public UMemory {
+public:
+    RegexLiteralFilter(const UVector &patterns, UErrorCode &status);
+
+    // Set candidates[i] to TRUE for each pattern i that may match the text.
+    void filter(const UChar *text, int32_t length, UBool *candidates);
+
+private:
+    int32_t addNode(UChar c, UErrorCode &status);
+    int32_t child(int32_t node, UChar c) const;
+
+    int32_t     fPatternCount;
+    UVector32   fUnfiltered;      // Patterns without a required literal.
+
+    // Trie nodes.  Node 0 is the root.
+    UVector32   fFirstChild;      // Building only.
+    UVector32   fNextSibling;     // Building only.
+    UVector32   fNodeChar;        // The code unit leading to the node.
+    UVector32   fFirstPattern;    // The first pattern whose literal ends at the node, or -1.
+    UVector32   fFail;            // The node for the longest proper suffix that is in the trie.
+    UVector32   fOutput;          // The nearest node along the fail links at which
+                                  //   a literal ends, or 0.
+    UVector32   fFound;           // Per node: generation at which its literal was last found.
+    int32_t     fGeneration;
+
+    UVector32   fNextPattern;     // Per pattern: the next pattern with the same literal, or -1.
+
+    // Edges, sorted by code unit for each node.
+    UVector32   fEdgeStarts;      // Per node, and one more: index into fEdgeChars.
+    UVector32   fEdgeChars;
+    UVector32   fEdgeTargets;
+    int32_t     fRootLatin1[0x100];   // Children of the root for the Latin-1 code units, or -1.
+};
+
+
+RegexLiteralFilter::RegexLiteralFilter(const UVector &patterns, UErrorCode &status) :
+        fPatternCount(patterns.size()), fUnfiltered(status),
+        fFirstChild(status), fNextSibling(status), fNodeChar(status), fFirstPattern(status),
+        fFail(status), fOutput(status), fFound(status), fGeneration(0),
+        fNextPattern(status), fEdgeStarts(status), fEdgeChars(status), fEdgeTargets(status) {
+    addNode(0, status);        // The root.
+    if (U_FAILURE(status)) {
+        return;
+    }
+
+    //
+    //  Add the literals to the trie.
+    //
+    int32_t i;
+    for (i = 0; i < fPatternCount && U_SUCCESS(status); i++) {
+        fNextPattern.addElement(-1, status);
+        const UnicodeString &literal = ((const RegexPattern *)patterns.elementAt(i))->fRequiredLiteral;
+        if (literal.isEmpty()) {
+            fUnfiltered.addElement(i, status);
+            continue;
+        }
+        int32_t node = 0;
+        for (int32_t j = 0; j < literal.length() && U_SUCCESS(status); j++) {
+            UChar c = literal.charAt(j);
+            // Find the child for c, or the sibling to insert a new child after.
+            int32_t previous = -1;
+            int32_t next = fFirstChild.elementAti(node);
+            while (next >= 0 && fNodeChar.elementAti(next) < c) {
+                previous = next;
+                next = fNextSibling.elementAti(next);
+            }
+            if (next < 0 || fNodeChar.elementAti(next) != c) {
+                int32_t newNode = addNode(c, status);
+                if (U_FAILURE(status)) {
+                    break;
+                }
+                fNextSibling.setElementAt(next, newNode);
+                if (previous < 0) {
+                    fFirstChild.setElementAt(newNode, node);
+                } else {
+                    fNextSibling.setElementAt(newNode, previous);
+                }
+                next = newNode;
+            }
+            node = next;
+        }
+        if (U_FAILURE(status)) {
+            break;
+        }
+        // Keep the patterns with the same literal in a list, in order.
+        int32_t last = fFirstPattern.elementAti(node);
+        if (last < 0) {
+            fFirstPattern.setElementAt(i, node);
+        } else {
+            while (fNextPattern.elementAti(last) >= 0) {
+                last = fNextPattern.elementAti(last);
+            }
+            fNextPattern.setElementAt(i, last);
+        }
+    }
+    if (U_FAILURE(status)) {
+        return;
+    }
+
+    //
+    //  Flatten the child lists into edge arrays.  Nodes are numbered in the order
+    //  in which they were added, so the edges are grouped by a pass over the nodes.
+    //
+    int32_t nodeCount = fNodeChar.size();
+    for (int32_t node = 0; node < nodeCount; node++) {
+        fEdgeStarts.addElement(fEdgeChars.size(), status);
+        for (int32_t c = fFirstChild.elementAti(node); c >= 0; c = fNextSibling.elementAti(c)) {
+            fEdgeChars.addElement(fNodeChar.elementAti(c), status);
+            fEdgeTargets.addElement(c, status);
+        }
+    }
+    fEdgeStarts.addElement(fEdgeChars.size(), status);
+    if (U_FAILURE(status)) {
+        return;
+    }
+    for (i = 0; i < 0x100; i++) {
+        fRootLatin1[i] = -1;
+    }
+    for (i = fEdgeStarts.elementAti(0); i < fEdgeStarts.elementAti(1); i++) {
+        if (fEdgeChars.elementAti(i) < 0x100) {
+            fRootLatin1[fEdgeChars.elementAti(i)] = fEdgeTargets.elementAti(i);
+        }
+    }
+
+    //
+    //  Fail and output links, breadth first, so that the links of shorter
+    //  suffixes are known before they are needed.
+    //
+    fFail.setSize(nodeCount);
+    fOutput.setSize(nodeCount);
+    fFound.setSize(nodeCount);
+    UVector32 queue(nodeCount, status);
+    queue.addElement(0, status);
+    for (int32_t head = 0; head < queue.size() && U_SUCCESS(status); head++) {
+        int32_t node = queue.elementAti(head);
+        for (int32_t c = fFirstChild.elementAti(node); c >= 0; c = fNextSibling.elementAti(c)) {
+            int32_t fail = 0;
+            if (node != 0) {
+                UChar cu = (UChar)fNodeChar.elementAti(c);
+                int32_t f = fFail.elementAti(node);
+                for (;;) {
+                    int32_t target = child(f, cu);
+                    if (target >= 0) {
+                        fail = target;
+                        break;
+                    }
+                    if (f == 0) {
+                        break;
+                    }
+                    f = fFail.elementAti(f);
+                }
+            }
+            fFail.setElementAt(fail, c);
+            fOutput.setElementAt(fFirstPattern.elementAti(fail) >= 0 ? fail : fOutput.elementAti(fail), c);
+            queue.addElement(c, status);
+        }
+    }
+}
+
+
+int32_t RegexLiteralFilter::addNode(UChar c, UErrorCode &status) {
+    int32_t node = fNodeChar.size();
+    fNodeChar.addElement(c, status);
+    fFirstChild.addElement(-1, status);
+    fNextSibling.addElement(-1, status);
+    fFirstPattern.addElement(-1, status);
+    return node;
+}
+
+
+//
+//  child     Return the child of a node for a code unit, or -1.
+//
+inline int32_t RegexLiteralFilter::child(int32_t node, UChar c) const {
+    if (node == 0 && c < 0x100) {
+        return fRootLatin1[c];
+    }
+    const int32_t *chars = fEdgeChars.getBuffer();
+    int32_t lo = fEdgeStarts.elementAti(node);
+    int32_t hi = fEdgeStarts.elementAti(node + 1);
+    while (lo < hi) {
+        int32_t mid = (lo + hi) / 2;
+        if (chars[mid] < c) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < fEdgeStarts.elementAti(node + 1) && chars[lo] == c) {
+        return fEdgeTargets.elementAti(lo);
+    }
+    return -1;
+}
+
+
+void RegexLiteralFilter::filter(const UChar *text, int32_t length, UBool *candidates) {
+    int32_t i;
+    for (i = 0; i < fPatternCount; i++) {
+        candidates[i] = FALSE;
+    }
+    for (i = 0; i < fUnfiltered.size(); i++) {
+        candidates[fUnfiltered.elementAti(i)] = TRUE;
+    }
+    int32_t remaining = fPatternCount - fUnfiltered.size();
+    ++fGeneration;
+    int32_t *found = fFound.getBuffer();
+    const int32_t *fail = fFail.getBuffer();
+    const int32_t *output = fOutput.getBuffer();
+    int32_t node = 0;
+    for (i = 0; i < length && remaining > 0; i++) {
+        UChar c = text[i];
+        for (;;) {
+            int32_t target = child(node, c);
+            if (target >= 0) {
+                node = target;
+                break;
+            }
+            if (node == 0) {
+                break;
+            }
+            node = fail[node];
+        }
+        // The literals that end here:  the one at the node, if any, and those along the output links.
+        for (int32_t n = fFirstPattern.elementAti(node) >= 0 ? node : output[node];
+                n != 0 && found[n] != fGeneration; n = output[n]) {
+            found[n] = fGeneration;
+            for (int32_t p = fFirstPattern.elementAti(n); p >= 0; p = fNextPattern.elementAti(p)) {
+                candidates[p] = TRUE;
+                --remaining;
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------
+//
+//   RegexSet
+//
+//--------------------------------------------------------------------------
+RegexSet::RegexSet(UErrorCode &status) :
+        fPatterns(NULL), fMatchers(NULL), fFilter(NULL), fMatches(NULL) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    fPatterns = new UVector(uprv_deleteUObject, NULL, status);
+    fMatchers = new UVector(uprv_deleteUObject, NULL, status);
+    fMatches  = new UVector32(status);
+    if (U_SUCCESS(status) && (fPatterns == NULL || fMatchers == NULL || fMatches == NULL)) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+    }
+}
+
+
+RegexSet::~RegexSet() {
+    delete fFilter;
+    delete fMatchers;
+    delete fPatterns;
+    delete fMatches;
+}
+
+
+int32_t RegexSet::add(const UnicodeString &regex, uint32_t flags, UParseError &pe, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return -1;
+    }
+    LocalPointer<RegexPattern> pattern(RegexPattern::compile(regex, flags, pe, status));
+    if (U_FAILURE(status)) {
+        return -1;
+    }
+    LocalPointer<RegexMatcher> matcher(pattern->matcher(status));
+    if (U_FAILURE(status)) {
+        return -1;
+    }
+    fPatterns->addElement(pattern.getAlias(), status);
+    if (U_FAILURE(status)) {
+        return -1;
+    }
+    pattern.orphan();
+    fMatchers->addElement(matcher.getAlias(), status);
+    if (U_FAILURE(status)) {
+        fPatterns->removeElementAt(fPatterns->size() - 1);
+        return -1;
+    }
+    matcher.orphan();
+    delete fFilter;
+    fFilter = NULL;
+    return fPatterns->size() - 1;
+}
+
+
+int32_t RegexSet::add(const UnicodeString &regex, uint32_t flags, UErrorCode &status) {
+    UParseError pe;
+    return add(regex, flags, pe, status);
+}
+
+
+int32_t RegexSet::size() const {
+    return fPatterns != NULL ? fPatterns->size() : 0;
+}
+
+
+const RegexPattern *RegexSet::getPattern(int32_t index) const {
+    if (index < 0 || index >= size()) {
+        return NULL;
+    }
+    return (const RegexPattern *)fPatterns->elementAt(index);
+}
+
+
+UBool RegexSet::find(const UnicodeString &input, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return FALSE;
+    }
+    if (fMatches == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return FALSE;
+    }
+    fMatches->removeAllElements();
+    if (input.isBogus()) {
+        status = U_ILLEGAL_ARGUMENT_ERROR;
+        return FALSE;
+    }
+    int32_t count = size();
+    if (count == 0) {
+        return FALSE;
+    }
+    if (fFilter == NULL) {
+        fFilter = new RegexLiteralFilter(*fPatterns, status);
+        if (fFilter == NULL) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+        }
+        if (U_FAILURE(status)) {
+            delete fFilter;
+            fFilter = NULL;
+            return FALSE;
+        }
+    }
+    MaybeStackArray<UBool, 64> candidates;
+    if (count > candidates.getCapacity() && candidates.resize(count) == NULL) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return FALSE;
+    }
+    fFilter->filter(input.getBuffer(), input.length(), candidates.getAlias());
+
+    // Verify the candidates.  The matchers only keep the text until the next find().
+    UText text = UTEXT_INITIALIZER;
+    utext_openUChars(&text, input.getBuffer(), input.length(), &status);
+    for (int32_t i = 0; i < count && U_SUCCESS(status); i++) {
+        if (!candidates[i]) {
+            continue;
+        }
+        RegexMatcher *matcher = (RegexMatcher *)fMatchers->elementAt(i);
+        matcher->reset(&text);
+        if (matcher->find(status)) {
+            fMatches->addElement(i, status);
+            fMatches->addElement(matcher->start(status), status);
+            fMatches->addElement(matcher->end(status), status);
+        }
+    }
+    utext_close(&text);
+    if (U_FAILURE(status)) {
+        fMatches->removeAllElements();
+        return FALSE;
+    }
+    return fMatches->size() > 0;
+}
+
+
+int32_t RegexSet::getMatchCount() const {
+    return fMatches != NULL ? fMatches->size() / 3 : 0;
+}
+
+
+int32_t RegexSet::getMatch(int32_t matchIndex) const {
+    if (matchIndex < 0 || matchIndex >= getMatchCount()) {
+        return -1;
+    }
+    return fMatches->elementAti(matchIndex * 3);
+}
+
+
+int32_t RegexSet::start(int32_t matchIndex, UErrorCode &status) const {
+    if (U_FAILURE(status)) {
+        return -1;
+    }
+    if (matchIndex < 0 || matchIndex >= getMatchCount()) {
+        status = U_INDEX_OUTOFBOUNDS_ERROR;
+        return -1;
+    }
+    return fMatches->elementAti(matchIndex * 3 + 1);
+}
+
+
+int32_t RegexSet::end(int32_t matchIndex, UErrorCode &status) const {
+    if (U_FAILURE(status)) {
+        return -1;
+    }
+    if (matchIndex < 0 || matchIndex >= getMatchCount()) {
+        status = U_INDEX_OUTOFBOUNDS_ERROR;
+        return -1;
+    }
+    return fMatches->elementAti(matchIndex * 3 + 2);
+}
+
+
+UOBJECT_DEFINE_RTTI_IMPLEMENTATION(RegexSet)
+
+U_NAMESPACE_END
+
+#endif  // !UCONFIG_NO_REGULAR_EXPRESSIONS
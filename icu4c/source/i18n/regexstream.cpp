@@ -0,0 +1,327 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+//
+//  file:  regexstream.cpp
+//
+/*
+***************************************************************************
+*   Copyright (C) 2016 International Business Machines Corporation
+*   and others. All rights reserved.
+***************************************************************************
+*/
+
+#include "unicode/utypes.h"
+
+#if !UCONFIG_NO_REGULAR_EXPRESSIONS
+
+#include "unicode/regex.h"
+#include "unicode/regexstream.h"
+#include "unicode/uniset.h"
+#include "unicode/utf16.h"
+#include "regeximp.h"
+#include "uvectr64.h"
+
+U_NAMESPACE_BEGIN
+
+UOBJECT_DEFINE_RTTI_IMPLEMENTATION(RegexStreamMatcher)
+
+// The text kept before the next search position, in addition to the longest
+//   look-behind of the pattern.  It is for the tests of \b, ^ and $ in multi-line
+//   mode, which look at the preceding character.
+static const int32_t MIN_CONTEXT_LENGTH = 16;
+
+static const int32_t DEFAULT_MAX_PENDING_LENGTH = 0x10000;
+
+
+RegexStreamMatcher::RegexStreamMatcher(const RegexPattern &pattern, UErrorCode &status) :
+        fPattern(&pattern), fMatcher(NULL), fTextStart(0), fPos(0), fContextLength(MIN_CONTEXT_LENGTH),
+        fMaxPendingLength(DEFAULT_MAX_PENDING_LENGTH),
+        fTextChanged(TRUE), fFinished(FALSE), fMatch(FALSE) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    fMatcher = pattern.matcher(status);
+    if (U_FAILURE(status)) {
+        return;
+    }
+    // Searches see the text before the search position, and the start of the kept
+    //   text is not the start of the stream.
+    fMatcher->useTransparentBounds(TRUE);
+    fMatcher->useAnchoringBounds(FALSE);
+
+    // Keep enough text for the longest look-behind.
+    const UVector64 *compiledPat = pattern.fCompiledPat;
+    for (int32_t i = 0; i + 2 < compiledPat->size(); i++) {
+        int32_t type = URX_TYPE(compiledPat->elementAti(i));
+        if (type == URX_LB_CONT || type == URX_LBN_CONT) {
+            int32_t maxML = (int32_t)compiledPat->elementAti(i + 2);
+            if (maxML > fContextLength - MIN_CONTEXT_LENGTH) {
+                fContextLength = maxML + MIN_CONTEXT_LENGTH;
+            }
+        }
+    }
+}
+
+
+RegexStreamMatcher::~RegexStreamMatcher() {
+    delete fMatcher;
+}
+
+
+void RegexStreamMatcher::append(const UnicodeString &text, UErrorCode &status) {
+    append(text.getBuffer(), text.length(), status);
+}
+
+
+void RegexStreamMatcher::append(const UChar *text, int32_t length, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    if (fFinished) {
+        status = U_REGEX_INVALID_STATE;
+        return;
+    }
+    if (text == NULL || length < -1) {
+        status = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    fMatch = FALSE;
+
+    // Drop the text that neither a match nor the context of one needs.
+    //   This is done here, rather than in find(), so that the text is moved
+    //   once per append() and not once per match.
+    int32_t keepStart = fPos - fContextLength;
+    if (keepStart > 0) {
+        if (U16_IS_TRAIL(fText.charAt(keepStart)) && U16_IS_LEAD(fText.charAt(keepStart - 1))) {
+            --keepStart;
+        }
+        fText.remove(0, keepStart);
+        fTextStart += keepStart;
+        fPos -= keepStart;
+    }
+    fText.append(text, 0, length < 0 ? u_strlen(text) : length);
+    if (fText.isBogus()) {
+        status = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    fTextChanged = TRUE;
+
+    // Give up on matches that would start too long ago.
+    int32_t pendingLimit = fText.length() - fMaxPendingLength;
+    if (fPos < pendingLimit) {
+        fPos = pendingLimit;
+        if (U16_IS_TRAIL(fText.charAt(fPos)) && U16_IS_LEAD(fText.charAt(fPos - 1))) {
+            ++fPos;
+        }
+    }
+}
+
+
+void RegexStreamMatcher::finish(UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    fFinished = TRUE;
+}
+
+
+UBool RegexStreamMatcher::find(UErrorCode &status) {
+    fMatch = FALSE;
+    if (U_FAILURE(status)) {
+        return FALSE;
+    }
+    int32_t length = fText.length();
+    if (fPos > length) {
+        return FALSE;
+    }
+    if (fTextChanged) {
+        fMatcher->reset(fText);
+        fTextChanged = FALSE;
+    }
+    fMatcher->region(fPos, length, status);
+    if (!fMatcher->find(status)) {
+        // find() always reaches the end of the text when it fails.
+        skipDeadPositions(length, status);
+        return FALSE;
+    }
+    int32_t matchStart = fMatcher->start(status);
+    int32_t matchEnd   = fMatcher->end(status);
+    if (U_FAILURE(status)) {
+        return FALSE;
+    }
+    if (fMatcher->hitEnd() && !fFinished) {
+        // More text could extend this match, or make it fail if requireEnd() is set.
+        //   It could also let an attempt at an earlier position succeed, if that attempt
+        //   was the one that reached the end.
+        skipDeadPositions(matchStart, status);
+        return FALSE;
+    }
+    fMatch = TRUE;
+    fPos = matchEnd;
+    if (matchStart == matchEnd) {
+        // Continue after an empty match at the next code point, as RegexMatcher::find() does.
+        if (fPos < length) {
+            U16_FWD_1(fText.getBuffer(), fPos, length);
+        } else {
+            ++fPos;
+        }
+    }
+    return TRUE;
+}
+
+
+//
+//  skipDeadPositions     Advance fPos past the positions from which a match attempt fails
+//                        without looking at the end of the text.  More text cannot change
+//                        the result of such an attempt, so no match will start there.
+//
+void RegexStreamMatcher::skipDeadPositions(int32_t limit, UErrorCode &status) {
+    int32_t length = fText.length();
+    if (fFinished) {
+        fPos = limit;
+        return;
+    }
+    while (U_SUCCESS(status)) {
+        fPos = nextCandidate(fPos, limit);
+        if (fPos >= limit) {
+            fPos = limit;
+            break;
+        }
+        fMatcher->region(fPos, length, status);
+        if (fMatcher->lookingAt(status) || fMatcher->hitEnd()) {
+            break;
+        }
+        U16_FWD_1(fText.getBuffer(), fPos, length);
+    }
+}
+
+
+//
+//  nextCandidate     Return the first position from pos at which the start of match
+//                    information of the pattern allows a match, as RegexMatcher::find()
+//                    uses it, or limit if there is none.  Trying a match at the positions
+//                    that are skipped fails at once, without reaching the end of the text.
+//
+int32_t RegexStreamMatcher::nextCandidate(int32_t pos, int32_t limit) const {
+    const UChar *text = fText.getBuffer();
+    switch (fPattern->fStartType) {
+    case START_START:
+        return pos == 0 ? pos : limit;
+    case START_LINE:
+        if (pos == 0) {
+            return pos;
+        }
+        for (; pos < limit; ++pos) {
+            UChar prev = text[pos - 1];
+            if (fPattern->fFlags & UREGEX_UNIX_LINES) {
+                if (prev == 0x0a) {
+                    break;
+                }
+            } else if ((prev >= 0x0a && prev <= 0x0d) || prev == 0x85 || prev == 0x2028 || prev == 0x2029) {
+                break;
+            }
+        }
+        return pos;
+    case START_CHAR:
+    case START_STRING:
+        pos = fText.indexOf(fPattern->fInitialChar, pos, limit - pos);
+        return pos < 0 ? limit : pos;
+    case START_SET:
+        return pos + fPattern->fInitialChars->span(text + pos, limit - pos, USET_SPAN_NOT_CONTAINED);
+    default:
+        return pos;
+    }
+}
+
+
+UBool RegexStreamMatcher::checkGroup(int32_t groupNum, UErrorCode &status) const {
+    if (U_FAILURE(status)) {
+        return FALSE;
+    }
+    if (!fMatch) {
+        status = U_REGEX_INVALID_STATE;
+        return FALSE;
+    }
+    if (groupNum < 0 || groupNum > fMatcher->groupCount()) {
+        status = U_INDEX_OUTOFBOUNDS_ERROR;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+
+int64_t RegexStreamMatcher::start(UErrorCode &status) const {
+    return start(0, status);
+}
+
+
+int64_t RegexStreamMatcher::start(int32_t groupNum, UErrorCode &status) const {
+    if (!checkGroup(groupNum, status)) {
+        return -1;
+    }
+    int64_t index = fMatcher->start64(groupNum, status);
+    return index < 0 ? -1 : fTextStart + index;
+}
+
+
+int64_t RegexStreamMatcher::end(UErrorCode &status) const {
+    return end(0, status);
+}
+
+
+int64_t RegexStreamMatcher::end(int32_t groupNum, UErrorCode &status) const {
+    if (!checkGroup(groupNum, status)) {
+        return -1;
+    }
+    int64_t index = fMatcher->end64(groupNum, status);
+    return index < 0 ? -1 : fTextStart + index;
+}
+
+
+UnicodeString RegexStreamMatcher::group(int32_t groupNum, UErrorCode &status) const {
+    if (!checkGroup(groupNum, status)) {
+        return UnicodeString();
+    }
+    return fMatcher->group(groupNum, status);
+}
+
+
+int32_t RegexStreamMatcher::groupCount() const {
+    return fMatcher == NULL ? 0 : fMatcher->groupCount();
+}
+
+
+void RegexStreamMatcher::setMaxPendingLength(int32_t length, UErrorCode &status) {
+    if (U_FAILURE(status)) {
+        return;
+    }
+    if (length < 1) {
+        status = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    fMaxPendingLength = length;
+}
+
+
+int32_t RegexStreamMatcher::getMaxPendingLength() const {
+    return fMaxPendingLength;
+}
+
+
+int64_t RegexStreamMatcher::getPendingStart() const {
+    return fTextStart + (fPos <= fText.length() ? fPos : fText.length());
+}
+
+
+void RegexStreamMatcher::reset() {
+    fText.remove();
+    fTextStart   = 0;
+    fPos         = 0;
+    fTextChanged = TRUE;
+    fFinished    = FALSE;
+    fMatch       = FALSE;
+}
+
+U_NAMESPACE_END
+
+#endif  // !UCONFIG_NO_REGULAR_EXPRESSIONS
@@ -23,16 +23,19 @@
 #include "unicode/rbbi.h"
 #include "unicode/utf.h"
 #include "unicode/utf16.h"
+#include "unicode/utf8.h"
 #include "uassert.h"
 #include "cmemory.h"
 #include "cstr.h"
 #include "uvector.h"
 #include "uvectr32.h"
 #include "uvectr64.h"
+#include "regexdfa.h"
 #include "regeximp.h"
 #include "regexst.h"
 #include "regextxt.h"
 #include "ucase.h"
+#include "utextimp.h"
 
 // #include <malloc.h>        // Needed for heapcheck testing
 
@@ -62,6 +65,204 @@ static inline UBool isLineTerminator(UChar32 c) {
     return (c<=0x0d && c>=0x0a) || c==0x85 || c==0x2028 || c==0x2029;
 }
 
+//-----------------------------------------------------------------------------
+//
+//   Scanning for possible match start positions in UTF-16 text.
+//
+//   For patterns that must start with a particular character, find() skips
+//   over text that cannot begin a match with these functions, rather than
+//   decoding and testing one code point at a time.
+//   scanForUnit() and scanForUnitPair() test four code units per step,
+//   held in a 64-bit word.  scanForSetMember() is not vectorized: it tests one
+//   code unit at a time against the Latin-1 bit set of the possible start chars.
+//
+//-----------------------------------------------------------------------------
+
+// Return the index of the first occurrence of the code unit c in s[start..limit[,
+//   or limit if there is none.
+static int32_t scanForUnit(const UChar *s, int32_t start, int32_t limit, UChar c) {
+    const uint64_t ones  = UINT64_C(0x0001000100010001);
+    const uint64_t highs = UINT64_C(0x8000800080008000);
+    const uint64_t pattern = ones * c;
+    int32_t i = start;
+    while ((limit - i) >= 4) {
+        uint64_t word;
+        uprv_memcpy(&word, s + i, 8);
+        word ^= pattern;
+        // Units equal to c are now zero. Detect any zero unit in the word.
+        if (((word - ones) & ~word & highs) != 0) {
+            break;
+        }
+        i += 4;
+    }
+    while (i < limit && s[i] != c) {
+        i++;
+    }
+    return i;
+}
+
+// Return the index of the first occurrence of the code unit c followed by the
+//   code unit d in s[start..limit[, or of c as the last unit before limit,
+//   or limit if there is neither.
+static int32_t scanForUnitPair(const UChar *s, int32_t start, int32_t limit, UChar c, UChar d) {
+    const uint64_t ones  = UINT64_C(0x0001000100010001);
+    const uint64_t highs = UINT64_C(0x8000800080008000);
+    const uint64_t patternC = ones * c;
+    const uint64_t patternD = ones * d;
+    int32_t i = start;
+    while ((limit - i) >= 5) {
+        uint64_t word, nextWord;
+        uprv_memcpy(&word, s + i, 8);
+        uprv_memcpy(&nextWord, s + i + 1, 8);
+        // A unit is zero where it equals c and the following unit equals d.
+        word = (word ^ patternC) | (nextWord ^ patternD);
+        if (((word - ones) & ~word & highs) != 0) {
+            break;
+        }
+        i += 4;
+    }
+    while (i < limit && !(s[i] == c && (i + 1 == limit || s[i + 1] == d))) {
+        i++;
+    }
+    return i;
+}
+
+// Return the index of the first code unit in s[start..limit[ that may begin a
+//   code point from a set: a Latin-1 unit contained in set8, or any other unit
+//   unless the set contains only Latin-1 characters. Return limit if there is none.
+static int32_t scanForSetMember(const UChar *s, int32_t start, int32_t limit,
+                                const Regex8BitSet &set8, UBool isLatin1Set) {
+    int32_t i = start;
+    if (isLatin1Set) {
+        while (i < limit && (s[i] > 0xff || !set8.contains(s[i]))) {
+            i++;
+        }
+    } else {
+        while (i < limit && s[i] <= 0xff && !set8.contains(s[i])) {
+            i++;
+        }
+    }
+    return i;
+}
+
+// TRUE if the set contains no characters beyond U+00FF.
+static inline UBool isLatin1Set(const UnicodeSet &set) {
+    int32_t rangeCount = set.getRangeCount();
+    return rangeCount == 0 || set.getRangeEnd(rangeCount - 1) <= 0xff;
+}
+
+//-----------------------------------------------------------------------------
+//
+//   Scanning for possible match start positions in UTF-8 text.
+//
+//   The same as the UTF-16 scans above, over bytes.  A match that begins with
+//   a particular character begins with the lead byte of its UTF-8 form, and
+//   with the byte after that.  Lead bytes never occur inside another character,
+//   so the positions found are code point boundaries.
+//
+//-----------------------------------------------------------------------------
+
+// Return the index of the first occurrence of the byte b in s[start..limit[,
+//   or limit if there is none.
+static int32_t scanForByte(const uint8_t *s, int32_t start, int32_t limit, uint8_t b) {
+    const uint64_t ones  = UINT64_C(0x0101010101010101);
+    const uint64_t highs = UINT64_C(0x8080808080808080);
+    const uint64_t pattern = ones * b;
+    int32_t i = start;
+    while ((limit - i) >= 8) {
+        uint64_t word;
+        uprv_memcpy(&word, s + i, 8);
+        word ^= pattern;
+        // Bytes equal to b are now zero. Detect any zero byte in the word.
+        if (((word - ones) & ~word & highs) != 0) {
+            break;
+        }
+        i += 8;
+    }
+    while (i < limit && s[i] != b) {
+        i++;
+    }
+    return i;
+}
+
+// Return the index of the first occurrence of the byte b followed by the
+//   byte c in s[start..limit[, or of b as the last byte before limit,
+//   or limit if there is neither.
+static int32_t scanForBytePair(const uint8_t *s, int32_t start, int32_t limit, uint8_t b, uint8_t c) {
+    const uint64_t ones  = UINT64_C(0x0101010101010101);
+    const uint64_t highs = UINT64_C(0x8080808080808080);
+    const uint64_t patternB = ones * b;
+    const uint64_t patternC = ones * c;
+    int32_t i = start;
+    while ((limit - i) >= 9) {
+        uint64_t word, nextWord;
+        uprv_memcpy(&word, s + i, 8);
+        uprv_memcpy(&nextWord, s + i + 1, 8);
+        // A byte is zero where it equals b and the following byte equals c.
+        word = (word ^ patternB) | (nextWord ^ patternC);
+        if (((word - ones) & ~word & highs) != 0) {
+            break;
+        }
+        i += 8;
+    }
+    while (i < limit && !(s[i] == b && (i + 1 == limit || s[i + 1] == c))) {
+        i++;
+    }
+    return i;
+}
+
+// Return the index of the first code point in s[start..limit[ that may be a
+//   member of a set: a Latin-1 character contained in set8, or any other
+//   character unless the set contains only Latin-1 characters.
+//   Return limit if there is none.  start must be on a code point boundary.
+static int32_t scanUTF8ForSetMember(const uint8_t *s, int32_t start, int32_t limit,
+                                    const Regex8BitSet &set8, UBool isLatin1Set) {
+    int32_t i = start;
+    while (i < limit) {
+        uint8_t b = s[i];
+        if (b < 0x80) {
+            if (set8.contains(b)) {
+                break;
+            }
+            i++;
+        } else if ((b == 0xc2 || b == 0xc3) && (i + 1) < limit && U8_IS_TRAIL(s[i + 1])) {
+            // U+0080..U+00FF
+            if (set8.contains(((b & 0x1f) << 6) | (s[i + 1] & 0x3f))) {
+                break;
+            }
+            i += 2;
+        } else if (isLatin1Set) {
+            // Part of a character beyond Latin-1, or of an ill-formed sequence,
+            //   which is read as U+FFFD.  Neither is in the set.
+            i++;
+        } else {
+            break;
+        }
+    }
+    return i;
+}
+
+// Get the first two bytes of the UTF-8 text that any match of a START_CHAR or
+//   START_STRING pattern begins with: the UTF-8 form of its initial character c,
+//   followed by that of the next character if it is known (next >= 0).
+//   Return the number of bytes found, 0, 1 or 2.  0 means that the text cannot
+//   be found by its bytes: c is a surrogate, which UTF-8 cannot represent, or
+//   U+FFFD, which ill-formed sequences are also read as.
+static int32_t getInitialBytes(UChar32 c, UChar32 next, uint8_t bytes[2]) {
+    if (U_IS_SURROGATE(c) || c == 0xfffd) {
+        return 0;
+    }
+    uint8_t buf[2 * U8_MAX_LENGTH];
+    int32_t length = 0;
+    U8_APPEND_UNSAFE(buf, length, c);
+    if (length == 1 && next >= 0 && !U_IS_SURROGATE(next) && next != 0xfffd) {
+        U8_APPEND_UNSAFE(buf, length, next);
+    }
+    bytes[0] = buf[0];
+    bytes[1] = length >= 2 ? buf[1] : 0;
+    return length >= 2 ? 2 : 1;
+}
+
 //-----------------------------------------------------------------------------
 //
 //   Constructor and Destructor
@@ -154,6 +355,13 @@ RegexMatcher::RegexMatcher(UText *regexp,
 
 
 RegexMatcher::~RegexMatcher() {
+    if (fPattern != NULL && fPatternOwned == NULL && fPattern->fSpares != NULL) {
+        // Leave the stack and the DFA to the next matcher of the pattern.
+        fPattern->fSpares->putStack(fStack);
+        fPattern->fSpares->putDFA(fDFA);
+        fStack = NULL;
+        fDFA = NULL;
+    }
     delete fStack;
     if (fData != fSmallData) {
         uprv_free(fData);
@@ -178,6 +386,7 @@ RegexMatcher::~RegexMatcher() {
     #if UCONFIG_NO_BREAK_ITERATION==0
     delete fWordBreakItr;
     #endif
+    delete fDFA;
 }
 
 //
@@ -205,6 +414,7 @@ void RegexMatcher::init(UErrorCode &status) {
     fMatchStart        = 0;
     fMatchEnd          = 0;
     fLastMatchEnd      = -1;
+    fRequiredLiteralPos = -1;
     fAppendPosition    = 0;
     fHitEnd            = FALSE;
     fRequireEnd        = FALSE;
@@ -222,12 +432,15 @@ void RegexMatcher::init(UErrorCode &status) {
     fDeferredStatus    = status;
     fData              = fSmallData;
     fWordBreakItr      = NULL;
+    fDFA               = NULL;
+    fDFAChecked        = FALSE;
 
     fStack             = NULL;
     fInputText         = NULL;
     fAltInputText      = NULL;
     fInput             = NULL;
     fInputLength       = 0;
+    fInputUTF8         = NULL;
     fInputUniStrMaybeMutable = FALSE;
 }
 
@@ -249,7 +462,12 @@ void RegexMatcher::init2(UText *input, UErrorCode &status) {
         }
     }
 
-    fStack = new UVector64(status);
+    if (fPattern->fSpares != NULL) {
+        fStack = fPattern->fSpares->takeStack();
+    }
+    if (fStack == NULL) {
+        fStack = new UVector64(status);
+    }
     if (fStack == NULL) {
         status = fDeferredStatus = U_MEMORY_ALLOCATION_ERROR;
         return;
@@ -604,6 +822,368 @@ UBool RegexMatcher::findProgressInterrupt(int64_t pos, UErrorCode &status) {
     return FALSE;
 }
 
+//--------------------------------------------------------------------------------
+//
+//   requiredLiteralFound   Before find() searches for a match, check that the input
+//                          contains the literal string that every match of the
+//                          pattern must contain (RegexPattern::fRequiredLiteral).
+//                          If it does not occur between startPos and the end of
+//                          the active region, no match is possible.
+//
+//                          The position of the literal is remembered, so that a
+//                          sequence of find() calls looks at each part of the
+//                          input only once.
+//
+//         Return:  FALSE if the input can not contain a match.
+//
+//   useRequiredLiteral     TRUE if the check is worth doing, and allowed.
+//
+//--------------------------------------------------------------------------------
+UBool RegexMatcher::useRequiredLiteral() const {
+    // Patterns that start with a known character or string already skip
+    //   quickly to the possible starts of a match.
+    //   Like the DFA, this is not used with a time limit or callbacks,
+    //   which count the steps of the backtracking engine.
+    return fPattern->fStartType != START_CHAR && fPattern->fStartType != START_STRING &&
+           fTimeLimit == 0 && fCallbackFn == NULL && fFindProgressCallbackFn == NULL;
+}
+
+UBool RegexMatcher::requiredLiteralFound(const UChar *inputBuf, int32_t startPos) {
+    const UnicodeString &literal = fPattern->fRequiredLiteral;
+    int32_t literalLength = literal.length();
+    if (literalLength == 0 || !useRequiredLiteral()) {
+        return TRUE;
+    }
+    if (fRequiredLiteralPos >= startPos) {
+        return TRUE;
+    }
+
+    // Code units are compared without regard to surrogate pairs, as URX_STRING does.
+    const UChar *lit = literal.getBuffer();
+    int32_t limit = (int32_t)fActiveLimit - (literalLength - 1);
+    for (int32_t i = startPos; i < limit; ++i) {
+        if (literalLength == 1) {
+            i = scanForUnit(inputBuf, i, limit, lit[0]);
+        } else {
+            i = scanForUnitPair(inputBuf, i, limit, lit[0], lit[1]);
+        }
+        if (i < limit && u_memcmp(inputBuf + i + 1, lit + 1, literalLength - 1) == 0) {
+            fRequiredLiteralPos = i;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+UBool RegexMatcher::requiredLiteralFound(const uint8_t *inputBuf, int32_t startPos) {
+    const UnicodeString &literal = fPattern->fRequiredLiteral;
+    if (literal.isEmpty() || !useRequiredLiteral()) {
+        return TRUE;
+    }
+    if (fRequiredLiteralPos >= startPos) {
+        return TRUE;
+    }
+
+    // Look for the UTF-8 form of as much of the literal as fits in a small buffer.
+    //   Stop before a surrogate or U+FFFD, which the match engine may see where
+    //   the input is not well-formed UTF-8.
+    uint8_t lit[64];
+    int32_t literalLength = 0;
+    for (int32_t i = 0; i < literal.length();) {
+        UChar32 c = literal.char32At(i);
+        if (U_IS_SURROGATE(c) || c == 0xfffd || literalLength + U8_LENGTH(c) > UPRV_LENGTHOF(lit)) {
+            break;
+        }
+        U8_APPEND_UNSAFE(lit, literalLength, c);
+        i += U16_LENGTH(c);
+    }
+    if (literalLength == 0) {
+        return TRUE;
+    }
+
+    int32_t limit = (int32_t)fActiveLimit - (literalLength - 1);
+    for (int32_t i = startPos; i < limit; ++i) {
+        if (literalLength == 1) {
+            i = scanForByte(inputBuf, i, limit, lit[0]);
+        } else {
+            i = scanForBytePair(inputBuf, i, limit, lit[0], lit[1]);
+        }
+        if (i < limit && uprv_memcmp(inputBuf + i + 1, lit + 1, literalLength - 1) == 0) {
+            fRequiredLiteralPos = i;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+//--------------------------------------------------------------------------------
+//
+//   dfaFindEnd()   Run the DFA forward from a start position, over the UTF-16 buffer
+//                  directly when the whole input is in one chunk, or over the
+//                  UTF-8 bytes when the input is UTF-8.
+//
+//--------------------------------------------------------------------------------
+static int32_t dfaFindEnd(RegexDFA *dfa, UText *text, UBool inChunk, const uint8_t *utf8,
+                          int64_t start, int64_t limit,
+                          int64_t &matchEnd, UBool &hitEnd, UErrorCode &status, UBool stopWhenIdle) {
+    if (utf8 != NULL) {
+        return dfa->findEnd(utf8, (int32_t)start, (int32_t)limit,
+                            matchEnd, hitEnd, status, stopWhenIdle);
+    }
+    if (inChunk) {
+        return dfa->findEnd(text->chunkContents, (int32_t)start, (int32_t)limit,
+                            matchEnd, hitEnd, status, stopWhenIdle);
+    }
+    UTEXT_SETNATIVEINDEX(text, start);
+    return dfa->findEnd(text, limit, matchEnd, hitEnd, status, stopWhenIdle);
+}
+
+
+//--------------------------------------------------------------------------------
+//
+//   getDFA()     Return the DFA for the pattern, building it on first use,
+//                or NULL if the pattern or the matcher settings do not allow one.
+//                A time limit and the callbacks are defined in terms of the steps
+//                of the backtracking engine, so they disable the DFA.
+//
+//--------------------------------------------------------------------------------
+RegexDFA *RegexMatcher::getDFA() {
+    if (fTimeLimit > 0 || fCallbackFn != NULL || fFindProgressCallbackFn != NULL) {
+        return NULL;
+    }
+    if (!fDFAChecked) {
+        fDFAChecked = TRUE;
+        if (fPattern->fSpares != NULL) {
+            fDFA = fPattern->fSpares->takeDFA();
+        }
+        if (fDFA == NULL && RegexDFA::isSupported(*fPattern)) {
+            UErrorCode dfaStatus = U_ZERO_ERROR;
+            fDFA = new RegexDFA(*fPattern, dfaStatus);
+            if (U_FAILURE(dfaStatus)) {
+                delete fDFA;
+                fDFA = NULL;
+            }
+        }
+    }
+    return fDFA;
+}
+
+
+//--------------------------------------------------------------------------------
+//
+//   findUsingDFA()   find(), using the DFA.  A forward pass finds where the match
+//                    ends, and a backward pass from there finds where it starts.
+//                    The capture groups are then recovered within the match.
+//
+//                    Return TRUE or FALSE as for find(), or -1 if the backtracking
+//                    engine must be used.  In that case, startPos is left at the
+//                    first position still to be tried.  That happens when the DFA
+//                    is not available, and when the DFA can only find possible
+//                    matches for the pattern.  See RegexDFA::isExact().
+//
+//--------------------------------------------------------------------------------
+int32_t RegexMatcher::findUsingDFA(int64_t &startPos, int64_t testStartLimit, UErrorCode &status) {
+    RegexDFA *dfa = getDFA();
+    if (dfa == NULL) {
+        return -1;
+    }
+    UBool   inChunk = UTEXT_FULL_TEXT_IN_CHUNK(fInputText, fInputLength);
+    const uint8_t *utf8 = inChunk ? NULL : fInputUTF8;
+    UBool   hitEnd = FALSE;
+    int64_t matchEnd = 0;
+    int32_t result;
+
+    // The scans for the possible first characters of a match are faster than the DFA.
+    //   Use them while no match is in progress.
+    int32_t startType = fPattern->fStartType;
+    UChar32 initialChar = fPattern->fInitialChar;
+    uint8_t initialBytes[2];
+    int32_t initialByteCount = 0;
+    if (utf8 != NULL && (startType == START_CHAR || startType == START_STRING)) {
+        UChar32 next = startType == START_STRING && !fPattern->fNeedsAltInput &&
+                       fPattern->fInitialStringLen >= 2 ?
+                       fPattern->fLiteralText.char32At(fPattern->fInitialStringIdx + 1) : U_SENTINEL;
+        initialByteCount = getInitialBytes(initialChar, next, initialBytes);
+        if (initialByteCount == 0) {
+            startType = START_NO_INFO;
+        }
+    } else if ((startType == START_CHAR || startType == START_STRING) &&
+            (U_IS_SURROGATE(initialChar) || initialChar > 0xffff)) {
+        startType = START_NO_INFO;
+    }
+    UBool latin1Set = startType == START_SET && isLatin1Set(*fPattern->fInitialChars);
+    // For START_STRING, also look for the second unit of the string, unless a
+    //   back reference may match text before the string.
+    UBool isPair = startType == START_STRING && !fPattern->fNeedsAltInput &&
+                   fPattern->fInitialStringLen >= 2;
+    UChar secondUnit = isPair ? fPattern->fLiteralText.charAt(fPattern->fInitialStringIdx + 1) : 0;
+
+    for (;;) {
+        if (utf8 != NULL && startType == START_SET) {
+            startPos = scanUTF8ForSetMember(utf8, (int32_t)startPos, (int32_t)fActiveLimit,
+                                            *fPattern->fInitialChars8, latin1Set);
+        } else if (utf8 != NULL && (startType == START_CHAR || startType == START_STRING)) {
+            startPos = initialByteCount == 2 ?
+                scanForBytePair(utf8, (int32_t)startPos, (int32_t)fActiveLimit,
+                                initialBytes[0], initialBytes[1]) :
+                scanForByte(utf8, (int32_t)startPos, (int32_t)fActiveLimit, initialBytes[0]);
+        } else if (startType == START_SET || startType == START_CHAR || startType == START_STRING) {
+            // Skip to a possible match start, or to the end of the current UText chunk.
+            int32_t chunkStart, chunkLimit;
+            if (inChunk) {
+                chunkStart = (int32_t)startPos;
+                chunkLimit = (int32_t)fActiveLimit;
+            } else {
+                UTEXT_SETNATIVEINDEX(fInputText, startPos);
+                chunkStart = fInputText->chunkOffset;
+                chunkLimit = fInputText->chunkLength;
+            }
+            int32_t pos;
+            if (startType == START_SET) {
+                pos = scanForSetMember(fInputText->chunkContents, chunkStart, chunkLimit,
+                                       *fPattern->fInitialChars8, latin1Set);
+            } else if (isPair) {
+                pos = scanForUnitPair(fInputText->chunkContents, chunkStart, chunkLimit,
+                                      (UChar)initialChar, secondUnit);
+            } else {
+                pos = scanForUnit(fInputText->chunkContents, chunkStart, chunkLimit, (UChar)initialChar);
+            }
+            if (inChunk) {
+                startPos = pos;
+            } else {
+                fInputText->chunkOffset = pos;
+                startPos = UTEXT_GETNATIVEINDEX(fInputText);
+            }
+        }
+        if (startPos > testStartLimit) {
+            fMatch = FALSE;
+            fHitEnd = TRUE;
+            return FALSE;
+        }
+        result = dfaFindEnd(dfa, fInputText, inChunk, utf8, startPos, fActiveLimit, matchEnd, hitEnd,
+                            status, startType != START_NO_INFO);
+        if (result != RegexDFA::DFA_IDLE) {
+            break;
+        }
+        // No match begins before matchEnd.
+        startPos = matchEnd;
+    }
+
+    if (result == RegexDFA::DFA_NO_MATCH || result == RegexDFA::DFA_HIT_END) {
+        fMatch = FALSE;
+        fHitEnd = TRUE;
+        return FALSE;
+    }
+    int64_t matchStart = 0;
+    if (result == RegexDFA::DFA_MATCH) {
+        result = utf8 != NULL ?
+            dfa->findStart(utf8, (int32_t)startPos, (int32_t)matchEnd, matchStart, status) :
+            dfa->findStart(fInputText, startPos, matchEnd, matchStart, status);
+        U_ASSERT(result != RegexDFA::DFA_NO_MATCH);
+    }
+    if (result != RegexDFA::DFA_MATCH) {
+        // Too many DFA states for this pattern.  Leave it to the backtracking engine.
+        delete fDFA;
+        fDFA = NULL;
+        return U_FAILURE(status) ? FALSE : -1;
+    }
+    if (!dfa->isExact()) {
+        // No match begins before matchStart.  The backtracking engine may skip those
+        //   positions unless it would have reached the end of the input from them.
+        if (!hitEnd) {
+            startPos = matchStart;
+        }
+        return -1;
+    }
+    setMatchFromDFA(matchStart, matchEnd, hitEnd, status);
+    return U_SUCCESS(status);
+}
+
+
+//--------------------------------------------------------------------------------
+//
+//   matchesUsingDFA()   matches() from startIdx to the end of the region, using the DFA.
+//                       Return TRUE or FALSE as for matches(), or -1 if the backtracking
+//                       engine must be used.
+//
+//--------------------------------------------------------------------------------
+int32_t RegexMatcher::matchesUsingDFA(int64_t startIdx, UErrorCode &status) {
+    RegexDFA *dfa = getDFA();
+    if (dfa == NULL || U_FAILURE(status)) {
+        return -1;
+    }
+    UBool hitEnd = FALSE;
+    int32_t result;
+    if (UTEXT_FULL_TEXT_IN_CHUNK(fInputText, fInputLength)) {
+        result = dfa->matchToEnd(fInputText->chunkContents, (int32_t)startIdx, (int32_t)fActiveLimit,
+                                 hitEnd, status);
+    } else if (fInputUTF8 != NULL) {
+        result = dfa->matchToEnd(fInputUTF8, (int32_t)startIdx, (int32_t)fActiveLimit, hitEnd, status);
+    } else {
+        UTEXT_SETNATIVEINDEX(fInputText, startIdx);
+        result = dfa->matchToEnd(fInputText, fActiveLimit, hitEnd, status);
+    }
+    switch (result) {
+    case RegexDFA::DFA_NO_MATCH:
+        fMatch = FALSE;
+        return FALSE;
+    case RegexDFA::DFA_HIT_END:
+        fMatch = FALSE;
+        fHitEnd = TRUE;
+        return FALSE;
+    case RegexDFA::DFA_MATCH:
+        if (dfa->isExact()) {
+            setMatchFromDFA(startIdx, fActiveLimit, hitEnd, status);
+            return U_SUCCESS(status);
+        }
+        break;
+    default:
+        delete fDFA;
+        fDFA = NULL;
+        break;
+    }
+    return U_FAILURE(status) ? FALSE : -1;
+}
+
+
+//--------------------------------------------------------------------------------
+//
+//   setMatchFromDFA()   Set the match state for a match found by the DFA, as the
+//                       backtracking engine would have, with the capture groups
+//                       recovered by the DFA.
+//
+//--------------------------------------------------------------------------------
+void RegexMatcher::setMatchFromDFA(int64_t matchStart, int64_t matchEnd, UBool hitEnd,
+                                   UErrorCode &status) {
+    fFrameSize = fPattern->fFrameSize;
+    REStackFrame *fp = resetStack();
+    if (U_FAILURE(fDeferredStatus)) {
+        status = fDeferredStatus;
+        return;
+    }
+    UBool matched = TRUE;
+    if (fPattern->fGroupMap->size() > 0) {
+        matched = fInputUTF8 != NULL && !UTEXT_FULL_TEXT_IN_CHUNK(fInputText, fInputLength) ?
+            fDFA->getCaptures(fInputUTF8, (int32_t)matchStart, (int32_t)matchEnd, fp->fExtra, status) :
+            fDFA->getCaptures(fInputText, matchStart, matchEnd, fp->fExtra, status);
+    }
+    if (!matched) {
+        U_ASSERT(U_FAILURE(status));
+        return;
+    }
+    fp->fPatIdx   = 0;
+    fp->fInputIdx = matchEnd;
+    if (hitEnd) {
+        fHitEnd = TRUE;
+    }
+    fMatch        = TRUE;
+    fLastMatchEnd = fMatchEnd;
+    fMatchStart   = matchStart;
+    fMatchEnd     = matchEnd;
+    fFrame        = fp;
+}
+
+
 //--------------------------------------------------------------------------------
 //
 //   find()
@@ -638,6 +1218,9 @@ UBool RegexMatcher::find(UErrorCode &status) {
     if (UTEXT_FULL_TEXT_IN_CHUNK(fInputText, fInputLength)) {
         return findUsingChunk(status);
     }
+    if (fInputUTF8 != NULL) {
+        return findUsingUTF8(status);
+    }
 
     int64_t startPos = fMatchEnd;
     if (startPos==0) {
@@ -692,6 +1275,11 @@ UBool RegexMatcher::find(UErrorCode &status) {
     UChar32  c;
     U_ASSERT(startPos >= 0);
 
+    int32_t dfaResult = findUsingDFA(startPos, testStartLimit, status);
+    if (dfaResult >= 0) {
+        return (UBool)dfaResult;
+    }
+
     switch (fPattern->fStartType) {
     case START_NO_INFO:
         // No optimization was found.
@@ -737,9 +1325,19 @@ UBool RegexMatcher::find(UErrorCode &status) {
         {
             // Match may start on any char from a pre-computed set.
             U_ASSERT(fPattern->fMinMatchLen > 0);
+            UBool latin1Set = isLatin1Set(*fPattern->fInitialChars);
             UTEXT_SETNATIVEINDEX(fInputText, startPos);
             for (;;) {
-                int64_t pos = startPos;
+                // Skip the rest of the UText's current chunk up to a possible start char.
+                fInputText->chunkOffset = scanForSetMember(fInputText->chunkContents,
+                    fInputText->chunkOffset, fInputText->chunkLength,
+                    *fPattern->fInitialChars8, latin1Set);
+                int64_t pos = UTEXT_GETNATIVEINDEX(fInputText);
+                if (pos > testStartLimit) {
+                    fMatch = FALSE;
+                    fHitEnd = TRUE;
+                    return FALSE;
+                }
                 c = UTEXT_NEXT32(fInputText);
                 startPos = UTEXT_GETNATIVEINDEX(fInputText);
                 // c will be -1 (U_SENTINEL) at end of text, in which case we
@@ -754,7 +1352,7 @@ UBool RegexMatcher::find(UErrorCode &status) {
                     if (fMatch) {
                         return TRUE;
                     }
-                    UTEXT_SETNATIVEINDEX(fInputText, pos);
+                    UTEXT_SETNATIVEINDEX(fInputText, startPos);
                 }
                 if (startPos > testStartLimit) {
                     fMatch = FALSE;
@@ -773,9 +1371,37 @@ UBool RegexMatcher::find(UErrorCode &status) {
             // Match starts on exactly one char.
             U_ASSERT(fPattern->fMinMatchLen > 0);
             UChar32 theChar = fPattern->fInitialChar;
+            UBool isUnit = !U_IS_SURROGATE(theChar) && theChar <= 0xffff;
+            // For START_STRING, also look for the second unit of the string, unless a
+            //   back reference may match text before the string.
+            UBool isPair = isUnit && fPattern->fStartType == START_STRING &&
+                           !fPattern->fNeedsAltInput && fPattern->fInitialStringLen >= 2;
+            UChar secondUnit = isPair ? fPattern->fLiteralText.charAt(fPattern->fInitialStringIdx + 1) : 0;
             UTEXT_SETNATIVEINDEX(fInputText, startPos);
             for (;;) {
                 int64_t pos = startPos;
+                if (isPair) {
+                    // Skip the rest of the UText's current chunk up to the next theChar
+                    //   that is followed by secondUnit or by the end of the chunk.
+                    fInputText->chunkOffset = scanForUnitPair(fInputText->chunkContents,
+                        fInputText->chunkOffset, fInputText->chunkLength, (UChar)theChar, secondUnit);
+                    pos = UTEXT_GETNATIVEINDEX(fInputText);
+                    if (pos > testStartLimit) {
+                        fMatch = FALSE;
+                        fHitEnd = TRUE;
+                        return FALSE;
+                    }
+                } else if (isUnit) {
+                    // Skip the rest of the UText's current chunk up to the next theChar.
+                    fInputText->chunkOffset = scanForUnit(fInputText->chunkContents,
+                        fInputText->chunkOffset, fInputText->chunkLength, (UChar)theChar);
+                    pos = UTEXT_GETNATIVEINDEX(fInputText);
+                    if (pos > testStartLimit) {
+                        fMatch = FALSE;
+                        fHitEnd = TRUE;
+                        return FALSE;
+                    }
+                }
                 c = UTEXT_NEXT32(fInputText);
                 startPos = UTEXT_GETNATIVEINDEX(fInputText);
                 if (c == theChar) {
@@ -965,10 +1591,22 @@ UBool RegexMatcher::findUsingChunk(UErrorCode &status) {
         fHitEnd = TRUE;
         return FALSE;
     }
+    if (!requiredLiteralFound(inputBuf, startPos)) {
+        fMatch = FALSE;
+        fHitEnd = TRUE;
+        return FALSE;
+    }
 
     UChar32  c;
     U_ASSERT(startPos >= 0);
 
+    int64_t dfaStartPos = startPos;
+    int32_t dfaResult = findUsingDFA(dfaStartPos, testLen, status);
+    if (dfaResult >= 0) {
+        return (UBool)dfaResult;
+    }
+    startPos = (int32_t)dfaStartPos;
+
     switch (fPattern->fStartType) {
     case START_NO_INFO:
         // No optimization was found.
@@ -1012,8 +1650,16 @@ UBool RegexMatcher::findUsingChunk(UErrorCode &status) {
     {
         // Match may start on any char from a pre-computed set.
         U_ASSERT(fPattern->fMinMatchLen > 0);
+        UBool latin1Set = isLatin1Set(*fPattern->fInitialChars);
         for (;;) {
-            int32_t pos = startPos;
+            int32_t pos = scanForSetMember(inputBuf, startPos, (int32_t)fActiveLimit,
+                                           *fPattern->fInitialChars8, latin1Set);
+            if (pos > testLen) {
+                fMatch = FALSE;
+                fHitEnd = TRUE;
+                return FALSE;
+            }
+            startPos = pos;
             U16_NEXT(inputBuf, startPos, fActiveLimit, c);  // like c = inputBuf[startPos++];
             if ((c<256 && fPattern->fInitialChars8->contains(c)) ||
                 (c>=256 && fPattern->fInitialChars->contains(c))) {
@@ -1042,6 +1688,38 @@ UBool RegexMatcher::findUsingChunk(UErrorCode &status) {
         // Match starts on exactly one char.
         U_ASSERT(fPattern->fMinMatchLen > 0);
         UChar32 theChar = fPattern->fInitialChar;
+        if (!U_IS_SURROGATE(theChar) && theChar <= 0xffff) {
+            // Scan for the code unit. For START_STRING, also look for the second unit
+            //   of the string, unless a back reference may match text before the string.
+            UBool isPair = fPattern->fStartType == START_STRING &&
+                           !fPattern->fNeedsAltInput && fPattern->fInitialStringLen >= 2;
+            UChar secondUnit = isPair ? fPattern->fLiteralText.charAt(fPattern->fInitialStringIdx + 1) : 0;
+            for (;;) {
+                int32_t pos = isPair ?
+                    scanForUnitPair(inputBuf, startPos, (int32_t)fActiveLimit, (UChar)theChar, secondUnit) :
+                    scanForUnit(inputBuf, startPos, (int32_t)fActiveLimit, (UChar)theChar);
+                if (pos > testLen) {
+                    fMatch = FALSE;
+                    fHitEnd = TRUE;
+                    return FALSE;
+                }
+                MatchChunkAt(pos, FALSE, status);
+                if (U_FAILURE(status)) {
+                    return FALSE;
+                }
+                if (fMatch) {
+                    return TRUE;
+                }
+                startPos = pos + 1;
+                if (startPos > testLen) {
+                    fMatch = FALSE;
+                    fHitEnd = TRUE;
+                    return FALSE;
+                }
+                if  (findProgressInterrupt(startPos, status))
+                    return FALSE;
+            }
+        }
         for (;;) {
             int32_t pos = startPos;
             U16_NEXT(inputBuf, startPos, fActiveLimit, c);  // like c = inputBuf[startPos++];
@@ -1145,15 +1823,311 @@ UBool RegexMatcher::findUsingChunk(UErrorCode &status) {
 
 //--------------------------------------------------------------------------------
 //
-//  group()
+//   findUsingUTF8() -- like findUsingChunk(), for input that is a UTF-8 string.
+//                      Positions are byte indexes into the string.
 //
 //--------------------------------------------------------------------------------
-UnicodeString RegexMatcher::group(UErrorCode &status) const {
-    return group(0, status);
-}
+UBool RegexMatcher::findUsingUTF8(UErrorCode &status) {
+    // Start at the position of the last match end.  (Will be zero if the
+    //   matcher has been reset.
+    //
 
-//  Return immutable shallow clone
-UText *RegexMatcher::group(UText *dest, int64_t &group_len, UErrorCode &status) const {
+    int32_t startPos = (int32_t)fMatchEnd;
+    if (startPos==0) {
+        startPos = (int32_t)fActiveStart;
+    }
+
+    const uint8_t *inputBuf = fInputUTF8;
+    int32_t activeLimit = (int32_t)fActiveLimit;
+
+    if (fMatch) {
+        // Save the position of any previous successful match.
+        fLastMatchEnd = fMatchEnd;
+
+        if (fMatchStart == fMatchEnd) {
+            // Previous match had zero length.  Move start position up one position
+            //  to avoid sending find() into a loop on zero-length matches.
+            if (startPos >= fActiveLimit) {
+                fMatch = FALSE;
+                fHitEnd = TRUE;
+                return FALSE;
+            }
+            U8_FWD_1(inputBuf, startPos, activeLimit);
+        }
+    } else {
+        if (fLastMatchEnd >= 0) {
+            // A previous find() failed to match.  Don't try again.
+            //   (without this test, a pattern with a zero-length match
+            //    could match again at the end of an input string.)
+            fHitEnd = TRUE;
+            return FALSE;
+        }
+    }
+
+
+    // Compute the position in the input string beyond which a match can not begin, because
+    //   the minimum length match would extend past the end of the input.
+    //   The minimum length is in UTF-16 code units, which is never more than
+    //   the length of the same text in UTF-8 bytes.
+    //   Note:  some patterns that cannot match anything will have fMinMatchLength==Max Int.
+    //          Be aware of possible overflows if making changes here.
+    //   Note:  a match can begin at inputBuf + testLen; it is an inclusive limit.
+    int32_t testLen  = (int32_t)(fActiveLimit - fPattern->fMinMatchLen);
+    if (startPos > testLen) {
+        fMatch = FALSE;
+        fHitEnd = TRUE;
+        return FALSE;
+    }
+    if (!requiredLiteralFound(inputBuf, startPos)) {
+        fMatch = FALSE;
+        fHitEnd = TRUE;
+        return FALSE;
+    }
+
+    UChar32  c;
+    U_ASSERT(startPos >= 0);
+
+    int64_t dfaStartPos = startPos;
+    int32_t dfaResult = findUsingDFA(dfaStartPos, testLen, status);
+    if (dfaResult >= 0) {
+        return (UBool)dfaResult;
+    }
+    startPos = (int32_t)dfaStartPos;
+
+    switch (fPattern->fStartType) {
+    case START_NO_INFO:
+        // No optimization was found.
+        //  Try a match at each input position.
+        for (;;) {
+            MatchUTF8At(startPos, FALSE, status);
+            if (U_FAILURE(status)) {
+                return FALSE;
+            }
+            if (fMatch) {
+                return TRUE;
+            }
+            if (startPos >= testLen) {
+                fHitEnd = TRUE;
+                return FALSE;
+            }
+            U8_FWD_1(inputBuf, startPos, activeLimit);
+            // Note that it's perfectly OK for a pattern to have a zero-length
+            //   match at the end of a string, so we must make sure that the loop
+            //   runs with startPos == testLen the last time through.
+            if  (findProgressInterrupt(startPos, status))
+                return FALSE;
+        }
+        U_ASSERT(FALSE);
+
+    case START_START:
+        // Matches are only possible at the start of the input string
+        //   (pattern begins with ^ or \A)
+        if (startPos > fActiveStart) {
+            fMatch = FALSE;
+            return FALSE;
+        }
+        MatchUTF8At(startPos, FALSE, status);
+        if (U_FAILURE(status)) {
+            return FALSE;
+        }
+        return fMatch;
+
+
+    case START_SET:
+    {
+        // Match may start on any char from a pre-computed set.
+        U_ASSERT(fPattern->fMinMatchLen > 0);
+        UBool latin1Set = isLatin1Set(*fPattern->fInitialChars);
+        for (;;) {
+            int32_t pos = scanUTF8ForSetMember(inputBuf, startPos, activeLimit,
+                                               *fPattern->fInitialChars8, latin1Set);
+            if (pos > testLen) {
+                fMatch = FALSE;
+                fHitEnd = TRUE;
+                return FALSE;
+            }
+            startPos = pos;
+            U8_NEXT_OR_FFFD(inputBuf, startPos, activeLimit, c);  // like c = inputBuf[startPos++];
+            if ((c<256 && fPattern->fInitialChars8->contains(c)) ||
+                (c>=256 && fPattern->fInitialChars->contains(c))) {
+                MatchUTF8At(pos, FALSE, status);
+                if (U_FAILURE(status)) {
+                    return FALSE;
+                }
+                if (fMatch) {
+                    return TRUE;
+                }
+            }
+            if (startPos > testLen) {
+                fMatch = FALSE;
+                fHitEnd = TRUE;
+                return FALSE;
+            }
+            if  (findProgressInterrupt(startPos, status))
+                return FALSE;
+        }
+    }
+        U_ASSERT(FALSE);
+
+    case START_STRING:
+    case START_CHAR:
+    {
+        // Match starts on exactly one char.
+        U_ASSERT(fPattern->fMinMatchLen > 0);
+        UChar32 theChar = fPattern->fInitialChar;
+        // Scan for the first byte of the char, or for its first two bytes.  For a one-byte
+        //   START_STRING char, the second byte is that of the next char of the string,
+        //   unless a back reference may match text before the string.
+        UChar32 nextChar = U_SENTINEL;
+        if (fPattern->fStartType == START_STRING &&
+                !fPattern->fNeedsAltInput && fPattern->fInitialStringLen >= 2) {
+            nextChar = fPattern->fLiteralText.char32At(fPattern->fInitialStringIdx + 1);
+        }
+        uint8_t initialBytes[2];
+        int32_t initialByteCount = getInitialBytes(theChar, nextChar, initialBytes);
+        if (initialByteCount > 0) {
+            for (;;) {
+                int32_t pos = initialByteCount == 2 ?
+                    scanForBytePair(inputBuf, startPos, activeLimit, initialBytes[0], initialBytes[1]) :
+                    scanForByte(inputBuf, startPos, activeLimit, initialBytes[0]);
+                if (pos > testLen) {
+                    fMatch = FALSE;
+                    fHitEnd = TRUE;
+                    return FALSE;
+                }
+                MatchUTF8At(pos, FALSE, status);
+                if (U_FAILURE(status)) {
+                    return FALSE;
+                }
+                if (fMatch) {
+                    return TRUE;
+                }
+                startPos = pos;
+                U8_FWD_1(inputBuf, startPos, activeLimit);
+                if (startPos > testLen) {
+                    fMatch = FALSE;
+                    fHitEnd = TRUE;
+                    return FALSE;
+                }
+                if  (findProgressInterrupt(startPos, status))
+                    return FALSE;
+            }
+        }
+        for (;;) {
+            int32_t pos = startPos;
+            U8_NEXT_OR_FFFD(inputBuf, startPos, activeLimit, c);  // like c = inputBuf[startPos++];
+            if (c == theChar) {
+                MatchUTF8At(pos, FALSE, status);
+                if (U_FAILURE(status)) {
+                    return FALSE;
+                }
+                if (fMatch) {
+                    return TRUE;
+                }
+            }
+            if (startPos > testLen) {
+                fMatch = FALSE;
+                fHitEnd = TRUE;
+                return FALSE;
+            }
+            if  (findProgressInterrupt(startPos, status))
+                return FALSE;
+        }
+    }
+    U_ASSERT(FALSE);
+
+    case START_LINE:
+    {
+        UChar32  c;
+        if (startPos == fAnchorStart) {
+            MatchUTF8At(startPos, FALSE, status);
+            if (U_FAILURE(status)) {
+                return FALSE;
+            }
+            if (fMatch) {
+                return TRUE;
+            }
+            U8_FWD_1(inputBuf, startPos, activeLimit);
+        }
+
+        if (fPattern->fFlags & UREGEX_UNIX_LINES) {
+            for (;;) {
+                c = inputBuf[startPos-1];
+                if (c == 0x0a) {
+                    MatchUTF8At(startPos, FALSE, status);
+                    if (U_FAILURE(status)) {
+                        return FALSE;
+                    }
+                    if (fMatch) {
+                        return TRUE;
+                    }
+                }
+                if (startPos >= testLen) {
+                    fMatch = FALSE;
+                    fHitEnd = TRUE;
+                    return FALSE;
+                }
+                U8_FWD_1(inputBuf, startPos, activeLimit);
+                // Note that it's perfectly OK for a pattern to have a zero-length
+                //   match at the end of a string, so we must make sure that the loop
+                //   runs with startPos == testLen the last time through.
+                if  (findProgressInterrupt(startPos, status))
+                    return FALSE;
+            }
+        } else {
+            // The line terminators beyond ASCII, U+0085, U+2028 and U+2029,
+            //   are several bytes long.  Decode the char before each position.
+            int32_t prevStart = startPos;
+            U8_PREV_OR_FFFD(inputBuf, 0, prevStart, c);
+            for (;;) {
+                if (isLineTerminator(c)) {
+                    if (c == 0x0d && startPos < fActiveLimit && inputBuf[startPos] == 0x0a) {
+                        startPos++;
+                    }
+                    MatchUTF8At(startPos, FALSE, status);
+                    if (U_FAILURE(status)) {
+                        return FALSE;
+                    }
+                    if (fMatch) {
+                        return TRUE;
+                    }
+                }
+                if (startPos >= testLen) {
+                    fMatch = FALSE;
+                    fHitEnd = TRUE;
+                    return FALSE;
+                }
+                U8_NEXT_OR_FFFD(inputBuf, startPos, activeLimit, c);
+                // Note that it's perfectly OK for a pattern to have a zero-length
+                //   match at the end of a string, so we must make sure that the loop
+                //   runs with startPos == testLen the last time through.
+                if  (findProgressInterrupt(startPos, status))
+                    return FALSE;
+            }
+        }
+    }
+
+    default:
+        U_ASSERT(FALSE);
+    }
+
+    U_ASSERT(FALSE);
+    return FALSE;
+}
+
+
+
+//--------------------------------------------------------------------------------
+//
+//  group()
+//
+//--------------------------------------------------------------------------------
+UnicodeString RegexMatcher::group(UErrorCode &status) const {
+    return group(0, status);
+}
+
+//  Return immutable shallow clone
+UText *RegexMatcher::group(UText *dest, int64_t &group_len, UErrorCode &status) const {
     return group(0, dest, group_len, status);
 }
 
@@ -1471,6 +2445,8 @@ UBool RegexMatcher::lookingAt(UErrorCode &status) {
     }
     if (UTEXT_FULL_TEXT_IN_CHUNK(fInputText, fInputLength)) {
         MatchChunkAt((int32_t)fActiveStart, FALSE, status);
+    } else if (fInputUTF8 != NULL) {
+        MatchUTF8At((int32_t)fActiveStart, FALSE, status);
     } else {
         MatchAt(fActiveStart, FALSE, status);
     }
@@ -1509,6 +2485,8 @@ UBool RegexMatcher::lookingAt(int64_t start, UErrorCode &status) {
 
     if (UTEXT_FULL_TEXT_IN_CHUNK(fInputText, fInputLength)) {
         MatchChunkAt((int32_t)nativeStart, FALSE, status);
+    } else if (fInputUTF8 != NULL) {
+        MatchUTF8At((int32_t)nativeStart, FALSE, status);
     } else {
         MatchAt(nativeStart, FALSE, status);
     }
@@ -1541,8 +2519,14 @@ UBool RegexMatcher::matches(UErrorCode &status) {
         resetPreserveRegion();
     }
 
+    int32_t dfaResult = matchesUsingDFA(fActiveStart, status);
+    if (dfaResult >= 0) {
+        return (UBool)dfaResult;
+    }
     if (UTEXT_FULL_TEXT_IN_CHUNK(fInputText, fInputLength)) {
         MatchChunkAt((int32_t)fActiveStart, TRUE, status);
+    } else if (fInputUTF8 != NULL) {
+        MatchUTF8At((int32_t)fActiveStart, TRUE, status);
     } else {
         MatchAt(fActiveStart, TRUE, status);
     }
@@ -1579,8 +2563,14 @@ UBool RegexMatcher::matches(int64_t start, UErrorCode &status) {
         return FALSE;
     }
 
+    int32_t dfaResult = matchesUsingDFA(nativeStart, status);
+    if (dfaResult >= 0) {
+        return (UBool)dfaResult;
+    }
     if (UTEXT_FULL_TEXT_IN_CHUNK(fInputText, fInputLength)) {
         MatchChunkAt((int32_t)nativeStart, TRUE, status);
+    } else if (fInputUTF8 != NULL) {
+        MatchUTF8At((int32_t)nativeStart, TRUE, status);
     } else {
         MatchAt(nativeStart, TRUE, status);
     }
@@ -1828,6 +2818,7 @@ void RegexMatcher::resetPreserveRegion() {
     fMatchStart     = 0;
     fMatchEnd       = 0;
     fLastMatchEnd   = -1;
+    fRequiredLiteralPos = -1;
     fAppendPosition = 0;
     fMatch          = FALSE;
     fHitEnd         = FALSE;
@@ -1847,6 +2838,7 @@ RegexMatcher &RegexMatcher::reset(const UnicodeString &input) {
         return *this;
     }
     fInputLength = utext_nativeLength(fInputText);
+    fInputUTF8 = NULL;
 
     reset();
     delete fInput;
@@ -1874,6 +2866,8 @@ RegexMatcher &RegexMatcher::reset(UText *input) {
             return *this;
         }
         fInputLength = utext_nativeLength(fInputText);
+        int32_t utf8Length;
+        fInputUTF8 = utext_getUTF8Contents(fInputText, &utf8Length);
 
         delete fInput;
         fInput = NULL;
@@ -1935,6 +2929,9 @@ RegexMatcher &RegexMatcher::refreshInputText(UText *input, UErrorCode &status) {
         return *this;
     }
     utext_setNativeIndex(fInputText, pos);
+    int32_t utf8Length;
+    fInputUTF8 = utext_getUTF8Contents(fInputText, &utf8Length);
+    fRequiredLiteralPos = -1;
 
     if (fAltInputText != NULL) {
         pos = utext_getNativeIndex(fAltInputText);
@@ -2606,16 +3603,64 @@ UBool RegexMatcher::isChunkWordBoundary(int32_t pos) {
 
 //--------------------------------------------------------------------------------
 //
-//   isUWordBoundary
-//
-//         Test for a word boundary using RBBI word break.
+//   isUTF8WordBoundary
 //
-//          parameters:   pos   - the current position in the input buffer
+//         Like isChunkWordBoundary(), for UTF-8 input.  The position is a byte index.
 //
 //--------------------------------------------------------------------------------
-UBool RegexMatcher::isUWordBoundary(int64_t pos) {
-    UBool       returnVal = FALSE;
-#if UCONFIG_NO_BREAK_ITERATION==0
+UBool RegexMatcher::isUTF8WordBoundary(int32_t pos) {
+    UBool isBoundary = FALSE;
+    UBool cIsWord    = FALSE;
+
+    const uint8_t *inputBuf = fInputUTF8;
+    int32_t lookStart = (int32_t)fLookStart;
+    int32_t lookLimit = (int32_t)fLookLimit;
+
+    if (pos >= lookLimit) {
+        fHitEnd = TRUE;
+    } else {
+        // Determine whether char c at current position is a member of the word set of chars.
+        // If we're off the end of the string, behave as though we're not at a word char.
+        UChar32 c;
+        U8_GET_OR_FFFD(inputBuf, lookStart, pos, lookLimit, c);
+        if (u_hasBinaryProperty(c, UCHAR_GRAPHEME_EXTEND) || u_charType(c) == U_FORMAT_CHAR) {
+            // Current char is a combining one.  Not a boundary.
+            return FALSE;
+        }
+        cIsWord = fPattern->fStaticSets[URX_ISWORD_SET]->contains(c);
+    }
+
+    // Back up until we come to a non-combining char, determine whether
+    //  that char is a word char.
+    UBool prevCIsWord = FALSE;
+    for (;;) {
+        if (pos <= lookStart) {
+            break;
+        }
+        UChar32 prevChar;
+        U8_PREV_OR_FFFD(inputBuf, lookStart, pos, prevChar);
+        if (!(u_hasBinaryProperty(prevChar, UCHAR_GRAPHEME_EXTEND)
+              || u_charType(prevChar) == U_FORMAT_CHAR)) {
+            prevCIsWord = fPattern->fStaticSets[URX_ISWORD_SET]->contains(prevChar);
+            break;
+        }
+    }
+    isBoundary = cIsWord ^ prevCIsWord;
+    return isBoundary;
+}
+
+//--------------------------------------------------------------------------------
+//
+//   isUWordBoundary
+//
+//         Test for a word boundary using RBBI word break.
+//
+//          parameters:   pos   - the current position in the input buffer
+//
+//--------------------------------------------------------------------------------
+UBool RegexMatcher::isUWordBoundary(int64_t pos) {
+    UBool       returnVal = FALSE;
+#if UCONFIG_NO_BREAK_ITERATION==0
 
     // If we haven't yet created a break iterator for this matcher, do it now.
     if (fWordBreakItr == NULL) {
@@ -3871,34 +4916,1577 @@ GC_Done:
                     int32_t patternStringLen = opValue;  // Length of the string from the pattern.
 
 
-                    UChar32   cPattern;
-                    UChar32   cText;
-                    UBool     success = TRUE;
+                    UChar32   cPattern;
+                    UChar32   cText;
+                    UBool     success = TRUE;
+
+                    UTEXT_SETNATIVEINDEX(fInputText, fp->fInputIdx);
+                    CaseFoldingUTextIterator inputIterator(*fInputText);
+                    while (patternStringIdx < patternStringLen) {
+                        if (!inputIterator.inExpansion() && UTEXT_GETNATIVEINDEX(fInputText) >= fActiveLimit) {
+                            success = FALSE;
+                            fHitEnd = TRUE;
+                            break;
+                        }
+                        U16_NEXT(patternString, patternStringIdx, patternStringLen, cPattern);
+                        cText = inputIterator.next();
+                        if (cText != cPattern) {
+                            success = FALSE;
+                            break;
+                        }
+                    }
+                    if (inputIterator.inExpansion()) {
+                        success = FALSE;
+                    }
+
+                    if (success) {
+                        fp->fInputIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                    } else {
+                        fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    }
+                }
+            }
+            break;
+
+        case URX_LB_START:
+            {
+                // Entering a look-behind block.
+                // Save Stack Ptr, Input Pos.
+                //   TODO:  implement transparent bounds.  Ticket #6067
+                U_ASSERT(opValue>=0 && opValue+1<fPattern->fDataSize);
+                fData[opValue]   = fStack->size();
+                fData[opValue+1] = fp->fInputIdx;
+                // Init the variable containing the start index for attempted matches.
+                fData[opValue+2] = -1;
+                // Save input string length, then reset to pin any matches to end at
+                //   the current position.
+                fData[opValue+3] = fActiveLimit;
+                fActiveLimit     = fp->fInputIdx;
+            }
+            break;
+
+
+        case URX_LB_CONT:
+            {
+                // Positive Look-Behind, at top of loop checking for matches of LB expression
+                //    at all possible input starting positions.
+
+                // Fetch the min and max possible match lengths.  They are the operands
+                //   of this op in the pattern.
+                int32_t minML = (int32_t)pat[fp->fPatIdx++];
+                int32_t maxML = (int32_t)pat[fp->fPatIdx++];
+                if (!UTEXT_USES_U16(fInputText)) {
+                    // utf-8 fix to maximum match length. The pattern compiler assumes utf-16.
+                    // The max length need not be exact; it just needs to be >= actual maximum.
+                    maxML *= 3;
+                }
+                U_ASSERT(minML <= maxML);
+                U_ASSERT(minML >= 0);
+
+                // Fetch (from data) the last input index where a match was attempted.
+                U_ASSERT(opValue>=0 && opValue+1<fPattern->fDataSize);
+                int64_t  &lbStartIdx = fData[opValue+2];
+                if (lbStartIdx < 0) {
+                    // First time through loop.
+                    lbStartIdx = fp->fInputIdx - minML;
+                    if (lbStartIdx > 0) {
+                        // move index to a code point boudary, if it's not on one already.
+                        UTEXT_SETNATIVEINDEX(fInputText, lbStartIdx);
+                        lbStartIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                    }
+                } else {
+                    // 2nd through nth time through the loop.
+                    // Back up start position for match by one.
+                    if (lbStartIdx == 0) {
+                        (lbStartIdx)--;
+                    } else {
+                        UTEXT_SETNATIVEINDEX(fInputText, lbStartIdx);
+                        (void)UTEXT_PREVIOUS32(fInputText);
+                        lbStartIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                    }
+                }
+
+                if (lbStartIdx < 0 || lbStartIdx < fp->fInputIdx - maxML) {
+                    // We have tried all potential match starting points without
+                    //  getting a match.  Backtrack out, and out of the
+                    //   Look Behind altogether.
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    int64_t restoreInputLen = fData[opValue+3];
+                    U_ASSERT(restoreInputLen >= fActiveLimit);
+                    U_ASSERT(restoreInputLen <= fInputLength);
+                    fActiveLimit = restoreInputLen;
+                    break;
+                }
+
+                //    Save state to this URX_LB_CONT op, so failure to match will repeat the loop.
+                //      (successful match will fall off the end of the loop.)
+                fp = StateSave(fp, fp->fPatIdx-3, status);
+                fp->fInputIdx = lbStartIdx;
+            }
+            break;
+
+        case URX_LB_END:
+            // End of a look-behind block, after a successful match.
+            {
+                U_ASSERT(opValue>=0 && opValue+1<fPattern->fDataSize);
+                if (fp->fInputIdx != fActiveLimit) {
+                    //  The look-behind expression matched, but the match did not
+                    //    extend all the way to the point that we are looking behind from.
+                    //  FAIL out of here, which will take us back to the LB_CONT, which
+                    //     will retry the match starting at another position or fail
+                    //     the look-behind altogether, whichever is appropriate.
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+
+                // Look-behind match is good.  Restore the orignal input string length,
+                //   which had been truncated to pin the end of the lookbehind match to the
+                //   position being looked-behind.
+                int64_t originalInputLen = fData[opValue+3];
+                U_ASSERT(originalInputLen >= fActiveLimit);
+                U_ASSERT(originalInputLen <= fInputLength);
+                fActiveLimit = originalInputLen;
+            }
+            break;
+
+
+        case URX_LBN_CONT:
+            {
+                // Negative Look-Behind, at top of loop checking for matches of LB expression
+                //    at all possible input starting positions.
+
+                // Fetch the extra parameters of this op.
+                int32_t minML       = (int32_t)pat[fp->fPatIdx++];
+                int32_t maxML       = (int32_t)pat[fp->fPatIdx++];
+                if (!UTEXT_USES_U16(fInputText)) {
+                    // utf-8 fix to maximum match length. The pattern compiler assumes utf-16.
+                    // The max length need not be exact; it just needs to be >= actual maximum.
+                    maxML *= 3;
+                }
+                int32_t continueLoc = (int32_t)pat[fp->fPatIdx++];
+                        continueLoc = URX_VAL(continueLoc);
+                U_ASSERT(minML <= maxML);
+                U_ASSERT(minML >= 0);
+                U_ASSERT(continueLoc > fp->fPatIdx);
+
+                // Fetch (from data) the last input index where a match was attempted.
+                U_ASSERT(opValue>=0 && opValue+1<fPattern->fDataSize);
+                int64_t  &lbStartIdx = fData[opValue+2];
+                if (lbStartIdx < 0) {
+                    // First time through loop.
+                    lbStartIdx = fp->fInputIdx - minML;
+                    if (lbStartIdx > 0) {
+                        // move index to a code point boudary, if it's not on one already.
+                        UTEXT_SETNATIVEINDEX(fInputText, lbStartIdx);
+                        lbStartIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                    }
+                } else {
+                    // 2nd through nth time through the loop.
+                    // Back up start position for match by one.
+                    if (lbStartIdx == 0) {
+                        (lbStartIdx)--;
+                    } else {
+                        UTEXT_SETNATIVEINDEX(fInputText, lbStartIdx);
+                        (void)UTEXT_PREVIOUS32(fInputText);
+                        lbStartIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                    }
+                }
+
+                if (lbStartIdx < 0 || lbStartIdx < fp->fInputIdx - maxML) {
+                    // We have tried all potential match starting points without
+                    //  getting a match, which means that the negative lookbehind as
+                    //  a whole has succeeded.  Jump forward to the continue location
+                    int64_t restoreInputLen = fData[opValue+3];
+                    U_ASSERT(restoreInputLen >= fActiveLimit);
+                    U_ASSERT(restoreInputLen <= fInputLength);
+                    fActiveLimit = restoreInputLen;
+                    fp->fPatIdx = continueLoc;
+                    break;
+                }
+
+                //    Save state to this URX_LB_CONT op, so failure to match will repeat the loop.
+                //      (successful match will cause a FAIL out of the loop altogether.)
+                fp = StateSave(fp, fp->fPatIdx-4, status);
+                fp->fInputIdx = lbStartIdx;
+            }
+            break;
+
+        case URX_LBN_END:
+            // End of a negative look-behind block, after a successful match.
+            {
+                U_ASSERT(opValue>=0 && opValue+1<fPattern->fDataSize);
+                if (fp->fInputIdx != fActiveLimit) {
+                    //  The look-behind expression matched, but the match did not
+                    //    extend all the way to the point that we are looking behind from.
+                    //  FAIL out of here, which will take us back to the LB_CONT, which
+                    //     will retry the match starting at another position or succeed
+                    //     the look-behind altogether, whichever is appropriate.
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+
+                // Look-behind expression matched, which means look-behind test as
+                //   a whole Fails
+
+                //   Restore the orignal input string length, which had been truncated
+                //   inorder to pin the end of the lookbehind match
+                //   to the position being looked-behind.
+                int64_t originalInputLen = fData[opValue+3];
+                U_ASSERT(originalInputLen >= fActiveLimit);
+                U_ASSERT(originalInputLen <= fInputLength);
+                fActiveLimit = originalInputLen;
+
+                // Restore original stack position, discarding any state saved
+                //   by the successful pattern match.
+                U_ASSERT(opValue>=0 && opValue+1<fPattern->fDataSize);
+                int32_t newStackSize = (int32_t)fData[opValue];
+                U_ASSERT(fStack->size() > newStackSize);
+                fStack->setSize(newStackSize);
+
+                //  FAIL, which will take control back to someplace
+                //  prior to entering the look-behind test.
+                fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            }
+            break;
+
+
+        case URX_LOOP_SR_I:
+            // Loop Initialization for the optimized implementation of
+            //     [some character set]*
+            //   This op scans through all matching input.
+            //   The following LOOP_C op emulates stack unwinding if the following pattern fails.
+            {
+                U_ASSERT(opValue > 0 && opValue < sets->size());
+                Regex8BitSet *s8 = &fPattern->fSets8[opValue];
+                UnicodeSet   *s  = (UnicodeSet *)sets->elementAt(opValue);
+
+                // Loop through input, until either the input is exhausted or
+                //   we reach a character that is not a member of the set.
+                int64_t ix = fp->fInputIdx;
+                UTEXT_SETNATIVEINDEX(fInputText, ix);
+                for (;;) {
+                    if (ix >= fActiveLimit) {
+                        fHitEnd = TRUE;
+                        break;
+                    }
+                    UChar32 c = UTEXT_NEXT32(fInputText);
+                    if (c<256) {
+                        if (s8->contains(c) == FALSE) {
+                            break;
+                        }
+                    } else {
+                        if (s->contains(c) == FALSE) {
+                            break;
+                        }
+                    }
+                    ix = UTEXT_GETNATIVEINDEX(fInputText);
+                }
+
+                // If there were no matching characters, skip over the loop altogether.
+                //   The loop doesn't run at all, a * op always succeeds.
+                if (ix == fp->fInputIdx) {
+                    fp->fPatIdx++;   // skip the URX_LOOP_C op.
+                    break;
+                }
+
+                // Peek ahead in the compiled pattern, to the URX_LOOP_C that
+                //   normally follows.  It's operand is the stack location
+                //   that holds the starting input index for the match of this [set]*
+                int32_t loopcOp = (int32_t)pat[fp->fPatIdx];
+                if (URX_TYPE(loopcOp) == URX_NOP) {
+                    // The compiler replaced the LOOP_C with a NOP because what follows the loop
+                    //   can not match at any of the positions that backing up would reach.
+                    //   Keep all of the input matched by the loop, with no state to come back to.
+                    fp->fInputIdx = ix;
+                    fp->fPatIdx++;
+                    break;
+                }
+                U_ASSERT(URX_TYPE(loopcOp) == URX_LOOP_C);
+                int32_t stackLoc = URX_VAL(loopcOp);
+                U_ASSERT(stackLoc >= 0 && stackLoc < fFrameSize);
+                fp->fExtra[stackLoc] = fp->fInputIdx;
+                fp->fInputIdx = ix;
+
+                // Save State to the URX_LOOP_C op that follows this one,
+                //   so that match failures in the following code will return to there.
+                //   Then bump the pattern idx so the LOOP_C is skipped on the way out of here.
+                fp = StateSave(fp, fp->fPatIdx, status);
+                fp->fPatIdx++;
+            }
+            break;
+
+
+        case URX_LOOP_DOT_I:
+            // Loop Initialization for the optimized implementation of .*
+            //   This op scans through all remaining input.
+            //   The following LOOP_C op emulates stack unwinding if the following pattern fails.
+            {
+                // Loop through input until the input is exhausted (we reach an end-of-line)
+                // In DOTALL mode, we can just go straight to the end of the input.
+                int64_t ix;
+                if ((opValue & 1) == 1) {
+                    // Dot-matches-All mode.  Jump straight to the end of the string.
+                    ix = fActiveLimit;
+                    fHitEnd = TRUE;
+                } else {
+                    // NOT DOT ALL mode.  Line endings do not match '.'
+                    // Scan forward until a line ending or end of input.
+                    ix = fp->fInputIdx;
+                    UTEXT_SETNATIVEINDEX(fInputText, ix);
+                    for (;;) {
+                        if (ix >= fActiveLimit) {
+                            fHitEnd = TRUE;
+                            break;
+                        }
+                        UChar32 c = UTEXT_NEXT32(fInputText);
+                        if ((c & 0x7f) <= 0x29) {          // Fast filter of non-new-line-s
+                            if ((c == 0x0a) ||             //  0x0a is newline in both modes.
+                               (((opValue & 2) == 0) &&    // IF not UNIX_LINES mode
+                                    isLineTerminator(c))) {
+                                //  char is a line ending.  Exit the scanning loop.
+                                break;
+                            }
+                        }
+                        ix = UTEXT_GETNATIVEINDEX(fInputText);
+                    }
+                }
+
+                // If there were no matching characters, skip over the loop altogether.
+                //   The loop doesn't run at all, a * op always succeeds.
+                if (ix == fp->fInputIdx) {
+                    fp->fPatIdx++;   // skip the URX_LOOP_C op.
+                    break;
+                }
+
+                // Peek ahead in the compiled pattern, to the URX_LOOP_C that
+                //   normally follows.  It's operand is the stack location
+                //   that holds the starting input index for the match of this .*
+                int32_t loopcOp = (int32_t)pat[fp->fPatIdx];
+                if (URX_TYPE(loopcOp) == URX_NOP) {
+                    // The compiler replaced the LOOP_C with a NOP because what follows the loop
+                    //   can not match at any of the positions that backing up would reach.
+                    //   Keep all of the input matched by the loop, with no state to come back to.
+                    fp->fInputIdx = ix;
+                    fp->fPatIdx++;
+                    break;
+                }
+                U_ASSERT(URX_TYPE(loopcOp) == URX_LOOP_C);
+                int32_t stackLoc = URX_VAL(loopcOp);
+                U_ASSERT(stackLoc >= 0 && stackLoc < fFrameSize);
+                fp->fExtra[stackLoc] = fp->fInputIdx;
+                fp->fInputIdx = ix;
+
+                // Save State to the URX_LOOP_C op that follows this one,
+                //   so that match failures in the following code will return to there.
+                //   Then bump the pattern idx so the LOOP_C is skipped on the way out of here.
+                fp = StateSave(fp, fp->fPatIdx, status);
+                fp->fPatIdx++;
+            }
+            break;
+
+
+        case URX_LOOP_C:
+            {
+                U_ASSERT(opValue>=0 && opValue<fFrameSize);
+                backSearchIndex = fp->fExtra[opValue];
+                U_ASSERT(backSearchIndex <= fp->fInputIdx);
+                if (backSearchIndex == fp->fInputIdx) {
+                    // We've backed up the input idx to the point that the loop started.
+                    // The loop is done.  Leave here without saving state.
+                    //  Subsequent failures won't come back here.
+                    break;
+                }
+                // Set up for the next iteration of the loop, with input index
+                //   backed up by one from the last time through,
+                //   and a state save to this instruction in case the following code fails again.
+                //   (We're going backwards because this loop emulates stack unwinding, not
+                //    the initial scan forward.)
+                U_ASSERT(fp->fInputIdx > 0);
+                UTEXT_SETNATIVEINDEX(fInputText, fp->fInputIdx);
+                UChar32 prevC = UTEXT_PREVIOUS32(fInputText);
+                fp->fInputIdx = UTEXT_GETNATIVEINDEX(fInputText);
+
+                UChar32 twoPrevC = UTEXT_PREVIOUS32(fInputText);
+                if (prevC == 0x0a &&
+                    fp->fInputIdx > backSearchIndex &&
+                    twoPrevC == 0x0d) {
+                    int32_t prevOp = (int32_t)pat[fp->fPatIdx-2];
+                    if (URX_TYPE(prevOp) == URX_LOOP_DOT_I) {
+                        // .*, stepping back over CRLF pair.
+                        fp->fInputIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                    }
+                }
+
+
+                fp = StateSave(fp, fp->fPatIdx-1, status);
+            }
+            break;
+
+
+
+        default:
+            // Trouble.  The compiled pattern contains an entry with an
+            //           unrecognized type tag.
+            U_ASSERT(FALSE);
+        }
+
+        if (U_FAILURE(status)) {
+            isMatch = FALSE;
+            break;
+        }
+    }
+
+breakFromLoop:
+    fMatch = isMatch;
+    if (isMatch) {
+        fLastMatchEnd = fMatchEnd;
+        fMatchStart   = startIdx;
+        fMatchEnd     = fp->fInputIdx;
+    }
+
+#ifdef REGEX_RUN_DEBUG
+    if (fTraceDebug) {
+        if (isMatch) {
+            printf("Match.  start=%ld   end=%ld\n\n", fMatchStart, fMatchEnd);
+        } else {
+            printf("No match\n\n");
+        }
+    }
+#endif
+
+    fFrame = fp;                // The active stack frame when the engine stopped.
+                                //   Contains the capture group results that we need to
+                                //    access later.
+    return;
+}
+
+
+//--------------------------------------------------------------------------------
+//
+//   MatchChunkAt   This is the actual matching engine. Like MatchAt, but with the
+//                  assumption that the entire string is available in the UText's
+//                  chunk buffer. For now, that means we can use int32_t indexes,
+//                  except for anything that needs to be saved (like group starts
+//                  and ends).
+//
+//                  startIdx:    begin matching a this index.
+//                  toEnd:       if true, match must extend to end of the input region
+//
+//--------------------------------------------------------------------------------
+void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &status) {
+    UBool       isMatch  = FALSE;      // True if the we have a match.
+
+    int32_t     backSearchIndex = INT32_MAX; // used after greedy single-character matches for searching backwards
+
+    int32_t     op;                    // Operation from the compiled pattern, split into
+    int32_t     opType;                //    the opcode
+    int32_t     opValue;               //    and the operand value.
+
+#ifdef REGEX_RUN_DEBUG
+    if (fTraceDebug) {
+        printf("MatchAt(startIdx=%d)\n", startIdx);
+        printf("Original Pattern: \"%s\"\n", CStr(StringFromUText(fPattern->fPattern))());
+        printf("Input String:     \"%s\"\n\n", CStr(StringFromUText(fInputText))());
+    }
+#endif
+
+    if (U_FAILURE(status)) {
+        return;
+    }
+
+    //  Cache frequently referenced items from the compiled pattern
+    //
+    int64_t             *pat           = fPattern->fCompiledPat->getBuffer();
+
+    const UChar         *litText       = fPattern->fLiteralText.getBuffer();
+    UVector             *sets          = fPattern->fSets;
+
+    const UChar         *inputBuf      = fInputText->chunkContents;
+
+    fFrameSize = fPattern->fFrameSize;
+    REStackFrame        *fp            = resetStack();
+    if (U_FAILURE(fDeferredStatus)) {
+        status = fDeferredStatus;
+        return;
+    }
+
+    fp->fPatIdx   = 0;
+    fp->fInputIdx = startIdx;
+
+    // Zero out the pattern's static data
+    int32_t i;
+    for (i = 0; i<fPattern->fDataSize; i++) {
+        fData[i] = 0;
+    }
+
+    //
+    //  Main loop for interpreting the compiled pattern.
+    //  One iteration of the loop per pattern operation performed.
+    //
+    for (;;) {
+        op      = (int32_t)pat[fp->fPatIdx];
+        opType  = URX_TYPE(op);
+        opValue = URX_VAL(op);
+#ifdef REGEX_RUN_DEBUG
+        if (fTraceDebug) {
+            UTEXT_SETNATIVEINDEX(fInputText, fp->fInputIdx);
+            printf("inputIdx=%ld   inputChar=%x   sp=%3ld   activeLimit=%ld  ", fp->fInputIdx,
+                   UTEXT_CURRENT32(fInputText), (int64_t *)fp-fStack->getBuffer(), fActiveLimit);
+            fPattern->dumpOp(fp->fPatIdx);
+        }
+#endif
+        fp->fPatIdx++;
+
+        switch (opType) {
+
+
+        case URX_NOP:
+            break;
+
+
+        case URX_BACKTRACK:
+            // Force a backtrack.  In some circumstances, the pattern compiler
+            //   will notice that the pattern can't possibly match anything, and will
+            //   emit one of these at that point.
+            fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            break;
+
+
+        case URX_ONECHAR:
+            if (fp->fInputIdx < fActiveLimit) {
+                UChar32 c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                if (c == opValue) {
+                    break;
+                }
+            } else {
+                fHitEnd = TRUE;
+            }
+            fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            break;
+
+
+        case URX_STRING:
+            {
+                // Test input against a literal string.
+                // Strings require two slots in the compiled pattern, one for the
+                //   offset to the string text, and one for the length.
+                int32_t   stringStartIdx = opValue;
+                int32_t   stringLen;
+
+                op      = (int32_t)pat[fp->fPatIdx];     // Fetch the second operand
+                fp->fPatIdx++;
+                opType    = URX_TYPE(op);
+                stringLen = URX_VAL(op);
+                U_ASSERT(opType == URX_STRING_LEN);
+                U_ASSERT(stringLen >= 2);
+
+                const UChar * pInp = inputBuf + fp->fInputIdx;
+                const UChar * pInpLimit = inputBuf + fActiveLimit;
+                const UChar * pPat = litText+stringStartIdx;
+                const UChar * pEnd = pInp + stringLen;
+                UBool success = TRUE;
+                while (pInp < pEnd) {
+                    if (pInp >= pInpLimit) {
+                        fHitEnd = TRUE;
+                        success = FALSE;
+                        break;
+                    }
+                    if (*pInp++ != *pPat++) {
+                        success = FALSE;
+                        break;
+                    }
+                }
+
+                if (success) {
+                    fp->fInputIdx += stringLen;
+                } else {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+
+        case URX_STATE_SAVE:
+            if (fp->fInputIdx < fActiveLimit) {
+                // If the op that follows is a literal that can not match here, as for most
+                //   branches of an alternation of literals, go straight to the alternative
+                //   instead of saving a state only to return to it right away.
+                int32_t nextOp = (int32_t)pat[fp->fPatIdx];
+                UChar32 nextChar = -1;
+                if (URX_TYPE(nextOp) == URX_ONECHAR) {
+                    nextChar = URX_VAL(nextOp);
+                    if (nextChar > 0xffff) {
+                        nextChar = U16_LEAD(nextChar);
+                    }
+                } else if (URX_TYPE(nextOp) == URX_STRING) {
+                    nextChar = litText[URX_VAL(nextOp)];
+                }
+                if (nextChar >= 0 && inputBuf[fp->fInputIdx] != nextChar) {
+                    fp->fPatIdx = opValue;
+                    break;
+                }
+            }
+            fp = StateSave(fp, opValue, status);
+            break;
+
+
+        case URX_END:
+            // The match loop will exit via this path on a successful match,
+            //   when we reach the end of the pattern.
+            if (toEnd && fp->fInputIdx != fActiveLimit) {
+                // The pattern matched, but not to the end of input.  Try some more.
+                fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                break;
+            }
+            isMatch = TRUE;
+            goto  breakFromLoop;
+
+            // Start and End Capture stack frame variables are laid out out like this:
+            //  fp->fExtra[opValue]  - The start of a completed capture group
+            //             opValue+1 - The end   of a completed capture group
+            //             opValue+2 - the start of a capture group whose end
+            //                          has not yet been reached (and might not ever be).
+        case URX_START_CAPTURE:
+            U_ASSERT(opValue >= 0 && opValue < fFrameSize-3);
+            fp->fExtra[opValue+2] = fp->fInputIdx;
+            break;
+
+
+        case URX_END_CAPTURE:
+            U_ASSERT(opValue >= 0 && opValue < fFrameSize-3);
+            U_ASSERT(fp->fExtra[opValue+2] >= 0);            // Start pos for this group must be set.
+            fp->fExtra[opValue]   = fp->fExtra[opValue+2];   // Tentative start becomes real.
+            fp->fExtra[opValue+1] = fp->fInputIdx;           // End position
+            U_ASSERT(fp->fExtra[opValue] <= fp->fExtra[opValue+1]);
+            break;
+
+
+        case URX_DOLLAR:                   //  $, test for End of line
+            //     or for position before new line at end of input
+            if (fp->fInputIdx < fAnchorLimit-2) {
+                // We are no where near the end of input.  Fail.
+                //   This is the common case.  Keep it first.
+                fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                break;
+            }
+            if (fp->fInputIdx >= fAnchorLimit) {
+                // We really are at the end of input.  Success.
+                fHitEnd = TRUE;
+                fRequireEnd = TRUE;
+                break;
+            }
+
+            // If we are positioned just before a new-line that is located at the
+            //   end of input, succeed.
+            if (fp->fInputIdx == fAnchorLimit-1) {
+                UChar32 c;
+                U16_GET(inputBuf, fAnchorStart, fp->fInputIdx, fAnchorLimit, c);
+
+                if (isLineTerminator(c)) {
+                    if ( !(c==0x0a && fp->fInputIdx>fAnchorStart && inputBuf[fp->fInputIdx-1]==0x0d)) {
+                        // At new-line at end of input. Success
+                        fHitEnd = TRUE;
+                        fRequireEnd = TRUE;
+                        break;
+                    }
+                }
+            } else if (fp->fInputIdx == fAnchorLimit-2 &&
+                inputBuf[fp->fInputIdx]==0x0d && inputBuf[fp->fInputIdx+1]==0x0a) {
+                    fHitEnd = TRUE;
+                    fRequireEnd = TRUE;
+                    break;                         // At CR/LF at end of input.  Success
+            }
+
+            fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+
+            break;
+
+
+        case URX_DOLLAR_D:                   //  $, test for End of Line, in UNIX_LINES mode.
+            if (fp->fInputIdx >= fAnchorLimit-1) {
+                // Either at the last character of input, or off the end.
+                if (fp->fInputIdx == fAnchorLimit-1) {
+                    // At last char of input.  Success if it's a new line.
+                    if (inputBuf[fp->fInputIdx] == 0x0a) {
+                        fHitEnd = TRUE;
+                        fRequireEnd = TRUE;
+                        break;
+                    }
+                } else {
+                    // Off the end of input.  Success.
+                    fHitEnd = TRUE;
+                    fRequireEnd = TRUE;
+                    break;
+                }
+            }
+
+            // Not at end of input.  Back-track out.
+            fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            break;
+
+
+        case URX_DOLLAR_M:                //  $, test for End of line in multi-line mode
+            {
+                if (fp->fInputIdx >= fAnchorLimit) {
+                    // We really are at the end of input.  Success.
+                    fHitEnd = TRUE;
+                    fRequireEnd = TRUE;
+                    break;
+                }
+                // If we are positioned just before a new-line, succeed.
+                // It makes no difference where the new-line is within the input.
+                UChar32 c = inputBuf[fp->fInputIdx];
+                if (isLineTerminator(c)) {
+                    // At a line end, except for the odd chance of  being in the middle of a CR/LF sequence
+                    //  In multi-line mode, hitting a new-line just before the end of input does not
+                    //   set the hitEnd or requireEnd flags
+                    if ( !(c==0x0a && fp->fInputIdx>fAnchorStart && inputBuf[fp->fInputIdx-1]==0x0d)) {
+                        break;
+                    }
+                }
+                // not at a new line.  Fail.
+                fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            }
+            break;
+
+
+        case URX_DOLLAR_MD:                //  $, test for End of line in multi-line and UNIX_LINES mode
+            {
+                if (fp->fInputIdx >= fAnchorLimit) {
+                    // We really are at the end of input.  Success.
+                    fHitEnd = TRUE;
+                    fRequireEnd = TRUE;  // Java set requireEnd in this case, even though
+                    break;               //   adding a new-line would not lose the match.
+                }
+                // If we are not positioned just before a new-line, the test fails; backtrack out.
+                // It makes no difference where the new-line is within the input.
+                if (inputBuf[fp->fInputIdx] != 0x0a) {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+
+        case URX_CARET:                    //  ^, test for start of line
+            if (fp->fInputIdx != fAnchorStart) {
+                fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            }
+            break;
+
+
+        case URX_CARET_M:                   //  ^, test for start of line in mulit-line mode
+            {
+                if (fp->fInputIdx == fAnchorStart) {
+                    // We are at the start input.  Success.
+                    break;
+                }
+                // Check whether character just before the current pos is a new-line
+                //   unless we are at the end of input
+                UChar  c = inputBuf[fp->fInputIdx - 1];
+                if ((fp->fInputIdx < fAnchorLimit) &&
+                    isLineTerminator(c)) {
+                    //  It's a new-line.  ^ is true.  Success.
+                    //  TODO:  what should be done with positions between a CR and LF?
+                    break;
+                }
+                // Not at the start of a line.  Fail.
+                fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            }
+            break;
+
+
+        case URX_CARET_M_UNIX:       //  ^, test for start of line in mulit-line + Unix-line mode
+            {
+                U_ASSERT(fp->fInputIdx >= fAnchorStart);
+                if (fp->fInputIdx <= fAnchorStart) {
+                    // We are at the start input.  Success.
+                    break;
+                }
+                // Check whether character just before the current pos is a new-line
+                U_ASSERT(fp->fInputIdx <= fAnchorLimit);
+                UChar  c = inputBuf[fp->fInputIdx - 1];
+                if (c != 0x0a) {
+                    // Not at the start of a line.  Back-track out.
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+        case URX_BACKSLASH_B:          // Test for word boundaries
+            {
+                UBool success = isChunkWordBoundary((int32_t)fp->fInputIdx);
+                success ^= (UBool)(opValue != 0);     // flip sense for \B
+                if (!success) {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+
+        case URX_BACKSLASH_BU:          // Test for word boundaries, Unicode-style
+            {
+                UBool success = isUWordBoundary(fp->fInputIdx);
+                success ^= (UBool)(opValue != 0);     // flip sense for \B
+                if (!success) {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+
+        case URX_BACKSLASH_D:            // Test for decimal digit
+            {
+                if (fp->fInputIdx >= fActiveLimit) {
+                    fHitEnd = TRUE;
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+
+                UChar32 c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                int8_t ctype = u_charType(c);     // TODO:  make a unicode set for this.  Will be faster.
+                UBool success = (ctype == U_DECIMAL_DIGIT_NUMBER);
+                success ^= (UBool)(opValue != 0);        // flip sense for \D
+                if (!success) {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+
+        case URX_BACKSLASH_G:          // Test for position at end of previous match
+            if (!((fMatch && fp->fInputIdx==fMatchEnd) || (fMatch==FALSE && fp->fInputIdx==fActiveStart))) {
+                fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            }
+            break;
+
+
+        case URX_BACKSLASH_H:            // Test for \h, horizontal white space.
+            {
+                if (fp->fInputIdx >= fActiveLimit) {
+                    fHitEnd = TRUE;
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+                UChar32 c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                int8_t ctype = u_charType(c);
+                UBool success = (ctype == U_SPACE_SEPARATOR || c == 9);  // SPACE_SEPARATOR || TAB
+                success ^= (UBool)(opValue != 0);        // flip sense for \H
+                if (!success) {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+
+        case URX_BACKSLASH_R:            // Test for \R, any line break sequence.
+            {
+                if (fp->fInputIdx >= fActiveLimit) {
+                    fHitEnd = TRUE;
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+                UChar32 c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                if (isLineTerminator(c)) {
+                    if (c == 0x0d && fp->fInputIdx < fActiveLimit) {
+                        // Check for CR/LF sequence. Consume both together when found.
+                        UChar c2;
+                        U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c2);
+                        if (c2 != 0x0a) {
+                            U16_PREV(inputBuf, 0, fp->fInputIdx, c2);
+                        }
+                    }
+                } else {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+
+        case URX_BACKSLASH_V:         // Any single code point line ending.
+            {
+                if (fp->fInputIdx >= fActiveLimit) {
+                    fHitEnd = TRUE;
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+                UChar32 c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                UBool success = isLineTerminator(c);
+                success ^= (UBool)(opValue != 0);        // flip sense for \V
+                if (!success) {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+
+
+        case URX_BACKSLASH_X:
+        //  Match a Grapheme, as defined by Unicode TR 29.
+        //  Differs slightly from Perl, which consumes combining marks independently
+        //    of context.
+        {
+
+            // Fail if at end of input
+            if (fp->fInputIdx >= fActiveLimit) {
+                fHitEnd = TRUE;
+                fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                break;
+            }
+
+            // Examine (and consume) the current char.
+            //   Dispatch into a little state machine, based on the char.
+            UChar32  c;
+            U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+            UnicodeSet **sets = fPattern->fStaticSets;
+            if (sets[URX_GC_NORMAL]->contains(c))  goto GC_Extend;
+            if (sets[URX_GC_CONTROL]->contains(c)) goto GC_Control;
+            if (sets[URX_GC_L]->contains(c))       goto GC_L;
+            if (sets[URX_GC_LV]->contains(c))      goto GC_V;
+            if (sets[URX_GC_LVT]->contains(c))     goto GC_T;
+            if (sets[URX_GC_V]->contains(c))       goto GC_V;
+            if (sets[URX_GC_T]->contains(c))       goto GC_T;
+            goto GC_Extend;
+
+
+
+GC_L:
+            if (fp->fInputIdx >= fActiveLimit)         goto GC_Done;
+            U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+            if (sets[URX_GC_L]->contains(c))       goto GC_L;
+            if (sets[URX_GC_LV]->contains(c))      goto GC_V;
+            if (sets[URX_GC_LVT]->contains(c))     goto GC_T;
+            if (sets[URX_GC_V]->contains(c))       goto GC_V;
+            U16_PREV(inputBuf, 0, fp->fInputIdx, c);
+            goto GC_Extend;
+
+GC_V:
+            if (fp->fInputIdx >= fActiveLimit)         goto GC_Done;
+            U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+            if (sets[URX_GC_V]->contains(c))       goto GC_V;
+            if (sets[URX_GC_T]->contains(c))       goto GC_T;
+            U16_PREV(inputBuf, 0, fp->fInputIdx, c);
+            goto GC_Extend;
+
+GC_T:
+            if (fp->fInputIdx >= fActiveLimit)         goto GC_Done;
+            U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+            if (sets[URX_GC_T]->contains(c))       goto GC_T;
+            U16_PREV(inputBuf, 0, fp->fInputIdx, c);
+            goto GC_Extend;
+
+GC_Extend:
+            // Combining characters are consumed here
+            for (;;) {
+                if (fp->fInputIdx >= fActiveLimit) {
+                    break;
+                }
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                if (sets[URX_GC_EXTEND]->contains(c) == FALSE) {
+                    U16_BACK_1(inputBuf, 0, fp->fInputIdx);
+                    break;
+                }
+            }
+            goto GC_Done;
+
+GC_Control:
+            // Most control chars stand alone (don't combine with combining chars),
+            //   except for that CR/LF sequence is a single grapheme cluster.
+            if (c == 0x0d && fp->fInputIdx < fActiveLimit && inputBuf[fp->fInputIdx] == 0x0a) {
+                fp->fInputIdx++;
+            }
+
+GC_Done:
+            if (fp->fInputIdx >= fActiveLimit) {
+                fHitEnd = TRUE;
+            }
+            break;
+        }
+
+
+
+
+        case URX_BACKSLASH_Z:          // Test for end of Input
+            if (fp->fInputIdx < fAnchorLimit) {
+                fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            } else {
+                fHitEnd = TRUE;
+                fRequireEnd = TRUE;
+            }
+            break;
+
+
+
+        case URX_STATIC_SETREF:
+            {
+                // Test input character against one of the predefined sets
+                //    (Word Characters, for example)
+                // The high bit of the op value is a flag for the match polarity.
+                //    0:   success if input char is in set.
+                //    1:   success if input char is not in set.
+                if (fp->fInputIdx >= fActiveLimit) {
+                    fHitEnd = TRUE;
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+
+                UBool success = ((opValue & URX_NEG_SET) == URX_NEG_SET);
+                opValue &= ~URX_NEG_SET;
+                U_ASSERT(opValue > 0 && opValue < URX_LAST_SET);
+
+                UChar32 c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                if (c < 256) {
+                    Regex8BitSet *s8 = &fPattern->fStaticSets8[opValue];
+                    if (s8->contains(c)) {
+                        success = !success;
+                    }
+                } else {
+                    const UnicodeSet *s = fPattern->fStaticSets[opValue];
+                    if (s->contains(c)) {
+                        success = !success;
+                    }
+                }
+                if (!success) {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+
+        case URX_STAT_SETREF_N:
+            {
+                // Test input character for NOT being a member of  one of
+                //    the predefined sets (Word Characters, for example)
+                if (fp->fInputIdx >= fActiveLimit) {
+                    fHitEnd = TRUE;
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+
+                U_ASSERT(opValue > 0 && opValue < URX_LAST_SET);
+
+                UChar32  c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                if (c < 256) {
+                    Regex8BitSet *s8 = &fPattern->fStaticSets8[opValue];
+                    if (s8->contains(c) == FALSE) {
+                        break;
+                    }
+                } else {
+                    const UnicodeSet *s = fPattern->fStaticSets[opValue];
+                    if (s->contains(c) == FALSE) {
+                        break;
+                    }
+                }
+                fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            }
+            break;
+
+
+        case URX_SETREF:
+            {
+                if (fp->fInputIdx >= fActiveLimit) {
+                    fHitEnd = TRUE;
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+
+                U_ASSERT(opValue > 0 && opValue < sets->size());
+
+                // There is input left.  Pick up one char and test it for set membership.
+                UChar32  c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                if (c<256) {
+                    Regex8BitSet *s8 = &fPattern->fSets8[opValue];
+                    if (s8->contains(c)) {
+                        // The character is in the set.  A Match.
+                        break;
+                    }
+                } else {
+                    UnicodeSet *s = (UnicodeSet *)sets->elementAt(opValue);
+                    if (s->contains(c)) {
+                        // The character is in the set.  A Match.
+                        break;
+                    }
+                }
+
+                // the character wasn't in the set.
+                fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            }
+            break;
+
+
+        case URX_DOTANY:
+            {
+                // . matches anything, but stops at end-of-line.
+                if (fp->fInputIdx >= fActiveLimit) {
+                    // At end of input.  Match failed.  Backtrack out.
+                    fHitEnd = TRUE;
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+
+                // There is input left.  Advance over one char, unless we've hit end-of-line
+                UChar32  c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                if (isLineTerminator(c)) {
+                    // End of line in normal mode.   . does not match.
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+            }
+            break;
+
+
+        case URX_DOTANY_ALL:
+            {
+                // . in dot-matches-all (including new lines) mode
+                if (fp->fInputIdx >= fActiveLimit) {
+                    // At end of input.  Match failed.  Backtrack out.
+                    fHitEnd = TRUE;
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+
+                // There is input left.  Advance over one char, except if we are
+                //   at a cr/lf, advance over both of them.
+                UChar32 c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                if (c==0x0d && fp->fInputIdx < fActiveLimit) {
+                    // In the case of a CR/LF, we need to advance over both.
+                    if (inputBuf[fp->fInputIdx] == 0x0a) {
+                        U16_FWD_1(inputBuf, fp->fInputIdx, fActiveLimit);
+                    }
+                }
+            }
+            break;
+
+
+        case URX_DOTANY_UNIX:
+            {
+                // '.' operator, matches all, but stops at end-of-line.
+                //   UNIX_LINES mode, so 0x0a is the only recognized line ending.
+                if (fp->fInputIdx >= fActiveLimit) {
+                    // At end of input.  Match failed.  Backtrack out.
+                    fHitEnd = TRUE;
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                    break;
+                }
+
+                // There is input left.  Advance over one char, unless we've hit end-of-line
+                UChar32 c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                if (c == 0x0a) {
+                    // End of line in normal mode.   '.' does not match the \n
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+
+        case URX_JMP:
+            fp->fPatIdx = opValue;
+            break;
+
+        case URX_FAIL:
+            isMatch = FALSE;
+            goto breakFromLoop;
+
+        case URX_JMP_SAV:
+            U_ASSERT(opValue < fPattern->fCompiledPat->size());
+            fp = StateSave(fp, fp->fPatIdx, status);       // State save to loc following current
+            fp->fPatIdx = opValue;                         // Then JMP.
+            break;
+
+        case URX_JMP_SAV_X:
+            // This opcode is used with (x)+, when x can match a zero length string.
+            // Same as JMP_SAV, except conditional on the match having made forward progress.
+            // Destination of the JMP must be a URX_STO_INP_LOC, from which we get the
+            //   data address of the input position at the start of the loop.
+            {
+                U_ASSERT(opValue > 0 && opValue < fPattern->fCompiledPat->size());
+                int32_t  stoOp = (int32_t)pat[opValue-1];
+                U_ASSERT(URX_TYPE(stoOp) == URX_STO_INP_LOC);
+                int32_t  frameLoc = URX_VAL(stoOp);
+                U_ASSERT(frameLoc >= 0 && frameLoc < fFrameSize);
+                int32_t prevInputIdx = (int32_t)fp->fExtra[frameLoc];
+                U_ASSERT(prevInputIdx <= fp->fInputIdx);
+                if (prevInputIdx < fp->fInputIdx) {
+                    // The match did make progress.  Repeat the loop.
+                    fp = StateSave(fp, fp->fPatIdx, status);  // State save to loc following current
+                    fp->fPatIdx = opValue;
+                    fp->fExtra[frameLoc] = fp->fInputIdx;
+                }
+                // If the input position did not advance, we do nothing here,
+                //   execution will fall out of the loop.
+            }
+            break;
+
+        case URX_CTR_INIT:
+            {
+                U_ASSERT(opValue >= 0 && opValue < fFrameSize-2);
+                fp->fExtra[opValue] = 0;                 //  Set the loop counter variable to zero
+
+                // Pick up the three extra operands that CTR_INIT has, and
+                //    skip the pattern location counter past
+                int32_t instrOperandLoc = (int32_t)fp->fPatIdx;
+                fp->fPatIdx += 3;
+                int32_t loopLoc  = URX_VAL(pat[instrOperandLoc]);
+                int32_t minCount = (int32_t)pat[instrOperandLoc+1];
+                int32_t maxCount = (int32_t)pat[instrOperandLoc+2];
+                U_ASSERT(minCount>=0);
+                U_ASSERT(maxCount>=minCount || maxCount==-1);
+                U_ASSERT(loopLoc>=fp->fPatIdx);
+
+                if (minCount == 0) {
+                    fp = StateSave(fp, loopLoc+1, status);
+                }
+                if (maxCount == -1) {
+                    fp->fExtra[opValue+1] = fp->fInputIdx;   //  For loop breaking.
+                } else if (maxCount == 0) {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+        case URX_CTR_LOOP:
+            {
+                U_ASSERT(opValue>0 && opValue < fp->fPatIdx-2);
+                int32_t initOp = (int32_t)pat[opValue];
+                U_ASSERT(URX_TYPE(initOp) == URX_CTR_INIT);
+                int64_t *pCounter = &fp->fExtra[URX_VAL(initOp)];
+                int32_t minCount  = (int32_t)pat[opValue+2];
+                int32_t maxCount  = (int32_t)pat[opValue+3];
+                (*pCounter)++;
+                if ((uint64_t)*pCounter >= (uint32_t)maxCount && maxCount != -1) {
+                    U_ASSERT(*pCounter == maxCount);
+                    break;
+                }
+                if (*pCounter >= minCount) {
+                    if (maxCount == -1) {
+                        // Loop has no hard upper bound.
+                        // Check that it is progressing through the input, break if it is not.
+                        int64_t *pLastInputIdx =  &fp->fExtra[URX_VAL(initOp) + 1];
+                        if (fp->fInputIdx == *pLastInputIdx) {
+                            break;
+                        } else {
+                            *pLastInputIdx = fp->fInputIdx;
+                        }
+                    }
+                    fp = StateSave(fp, fp->fPatIdx, status);
+                }
+                fp->fPatIdx = opValue + 4;    // Loop back.
+            }
+            break;
+
+        case URX_CTR_INIT_NG:
+            {
+                // Initialize a non-greedy loop
+                U_ASSERT(opValue >= 0 && opValue < fFrameSize-2);
+                fp->fExtra[opValue] = 0;                 //  Set the loop counter variable to zero
+
+                // Pick up the three extra operands that CTR_INIT_NG has, and
+                //    skip the pattern location counter past
+                int32_t instrOperandLoc = (int32_t)fp->fPatIdx;
+                fp->fPatIdx += 3;
+                int32_t loopLoc  = URX_VAL(pat[instrOperandLoc]);
+                int32_t minCount = (int32_t)pat[instrOperandLoc+1];
+                int32_t maxCount = (int32_t)pat[instrOperandLoc+2];
+                U_ASSERT(minCount>=0);
+                U_ASSERT(maxCount>=minCount || maxCount==-1);
+                U_ASSERT(loopLoc>fp->fPatIdx);
+                if (maxCount == -1) {
+                    fp->fExtra[opValue+1] = fp->fInputIdx;   //  Save initial input index for loop breaking.
+                }
+
+                if (minCount == 0) {
+                    if (maxCount != 0) {
+                        fp = StateSave(fp, fp->fPatIdx, status);
+                    }
+                    fp->fPatIdx = loopLoc+1;   // Continue with stuff after repeated block
+                }
+            }
+            break;
+
+        case URX_CTR_LOOP_NG:
+            {
+                // Non-greedy {min, max} loops
+                U_ASSERT(opValue>0 && opValue < fp->fPatIdx-2);
+                int32_t initOp = (int32_t)pat[opValue];
+                U_ASSERT(URX_TYPE(initOp) == URX_CTR_INIT_NG);
+                int64_t *pCounter = &fp->fExtra[URX_VAL(initOp)];
+                int32_t minCount  = (int32_t)pat[opValue+2];
+                int32_t maxCount  = (int32_t)pat[opValue+3];
+
+                (*pCounter)++;
+                if ((uint64_t)*pCounter >= (uint32_t)maxCount && maxCount != -1) {
+                    // The loop has matched the maximum permitted number of times.
+                    //   Break out of here with no action.  Matching will
+                    //   continue with the following pattern.
+                    U_ASSERT(*pCounter == maxCount);
+                    break;
+                }
+
+                if (*pCounter < minCount) {
+                    // We haven't met the minimum number of matches yet.
+                    //   Loop back for another one.
+                    fp->fPatIdx = opValue + 4;    // Loop back.
+                } else {
+                    // We do have the minimum number of matches.
+
+                    // If there is no upper bound on the loop iterations, check that the input index
+                    // is progressing, and stop the loop if it is not.
+                    if (maxCount == -1) {
+                        int64_t *pLastInputIdx =  &fp->fExtra[URX_VAL(initOp) + 1];
+                        if (fp->fInputIdx == *pLastInputIdx) {
+                            break;
+                        }
+                        *pLastInputIdx = fp->fInputIdx;
+                    }
+
+                    // Loop Continuation: we will fall into the pattern following the loop
+                    //   (non-greedy, don't execute loop body first), but first do
+                    //   a state save to the top of the loop, so that a match failure
+                    //   in the following pattern will try another iteration of the loop.
+                    fp = StateSave(fp, opValue + 4, status);
+                }
+            }
+            break;
+
+        case URX_STO_SP:
+            U_ASSERT(opValue >= 0 && opValue < fPattern->fDataSize);
+            fData[opValue] = fStack->size();
+            break;
+
+        case URX_LD_SP:
+            {
+                U_ASSERT(opValue >= 0 && opValue < fPattern->fDataSize);
+                int32_t newStackSize = (int32_t)fData[opValue];
+                U_ASSERT(newStackSize <= fStack->size());
+                int64_t *newFP = fStack->getBuffer() + newStackSize - fFrameSize;
+                if (newFP == (int64_t *)fp) {
+                    break;
+                }
+                int32_t i;
+                for (i=0; i<fFrameSize; i++) {
+                    newFP[i] = ((int64_t *)fp)[i];
+                }
+                fp = (REStackFrame *)newFP;
+                fStack->setSize(newStackSize);
+            }
+            break;
+
+        case URX_BACKREF:
+            {
+                U_ASSERT(opValue < fFrameSize);
+                int64_t groupStartIdx = fp->fExtra[opValue];
+                int64_t groupEndIdx   = fp->fExtra[opValue+1];
+                U_ASSERT(groupStartIdx <= groupEndIdx);
+                int64_t inputIndex = fp->fInputIdx;
+                if (groupStartIdx < 0) {
+                    // This capture group has not participated in the match thus far,
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);   // FAIL, no match.
+                    break;
+                }
+                UBool success = TRUE;
+                for (int64_t groupIndex = groupStartIdx; groupIndex < groupEndIdx; ++groupIndex,++inputIndex) {
+                    if (inputIndex >= fActiveLimit) {
+                        success = FALSE;
+                        fHitEnd = TRUE;
+                        break;
+                    }
+                    if (inputBuf[groupIndex] != inputBuf[inputIndex]) {
+                        success = FALSE;
+                        break;
+                    }
+                }
+                if (success && groupStartIdx < groupEndIdx && U16_IS_LEAD(inputBuf[groupEndIdx-1]) &&
+                        inputIndex < fActiveLimit && U16_IS_TRAIL(inputBuf[inputIndex])) {
+                    // Capture group ended with an unpaired lead surrogate.
+                    // Back reference is not permitted to match lead only of a surrogatge pair.
+                    success = FALSE;
+                }
+                if (success) {
+                    fp->fInputIdx = inputIndex;
+                } else {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+        case URX_BACKREF_I:
+            {
+                U_ASSERT(opValue < fFrameSize);
+                int64_t groupStartIdx = fp->fExtra[opValue];
+                int64_t groupEndIdx   = fp->fExtra[opValue+1];
+                U_ASSERT(groupStartIdx <= groupEndIdx);
+                if (groupStartIdx < 0) {
+                    // This capture group has not participated in the match thus far,
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);   // FAIL, no match.
+                    break;
+                }
+                CaseFoldingUCharIterator captureGroupItr(inputBuf, groupStartIdx, groupEndIdx);
+                CaseFoldingUCharIterator inputItr(inputBuf, fp->fInputIdx, fActiveLimit);
+
+                //   Note: if the capture group match was of an empty string the backref
+                //         match succeeds.  Verified by testing:  Perl matches succeed
+                //         in this case, so we do too.
+
+                UBool success = TRUE;
+                for (;;) {
+                    UChar32 captureGroupChar = captureGroupItr.next();
+                    if (captureGroupChar == U_SENTINEL) {
+                        success = TRUE;
+                        break;
+                    }
+                    UChar32 inputChar = inputItr.next();
+                    if (inputChar == U_SENTINEL) {
+                        success = FALSE;
+                        fHitEnd = TRUE;
+                        break;
+                    }
+                    if (inputChar != captureGroupChar) {
+                        success = FALSE;
+                        break;
+                    }
+                }
+
+                if (success && inputItr.inExpansion()) {
+                    // We otained a match by consuming part of a string obtained from
+                    // case-folding a single code point of the input text.
+                    // This does not count as an overall match.
+                    success = FALSE;
+                }
+
+                if (success) {
+                    fp->fInputIdx = inputItr.getIndex();
+                } else {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+                }
+            }
+            break;
+
+        case URX_STO_INP_LOC:
+            {
+                U_ASSERT(opValue >= 0 && opValue < fFrameSize);
+                fp->fExtra[opValue] = fp->fInputIdx;
+            }
+            break;
+
+        case URX_JMPX:
+            {
+                int32_t instrOperandLoc = (int32_t)fp->fPatIdx;
+                fp->fPatIdx += 1;
+                int32_t dataLoc  = URX_VAL(pat[instrOperandLoc]);
+                U_ASSERT(dataLoc >= 0 && dataLoc < fFrameSize);
+                int32_t savedInputIdx = (int32_t)fp->fExtra[dataLoc];
+                U_ASSERT(savedInputIdx <= fp->fInputIdx);
+                if (savedInputIdx < fp->fInputIdx) {
+                    fp->fPatIdx = opValue;                               // JMP
+                } else {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);   // FAIL, no progress in loop.
+                }
+            }
+            break;
+
+        case URX_LA_START:
+            {
+                // Entering a lookahead block.
+                // Save Stack Ptr, Input Pos.
+                U_ASSERT(opValue>=0 && opValue+1<fPattern->fDataSize);
+                fData[opValue]   = fStack->size();
+                fData[opValue+1] = fp->fInputIdx;
+                fActiveStart     = fLookStart;          // Set the match region change for
+                fActiveLimit     = fLookLimit;          //   transparent bounds.
+            }
+            break;
+
+        case URX_LA_END:
+            {
+                // Leaving a look-ahead block.
+                //  restore Stack Ptr, Input Pos to positions they had on entry to block.
+                U_ASSERT(opValue>=0 && opValue+1<fPattern->fDataSize);
+                int32_t stackSize = fStack->size();
+                int32_t newStackSize = (int32_t)fData[opValue];
+                U_ASSERT(stackSize >= newStackSize);
+                if (stackSize > newStackSize) {
+                    // Copy the current top frame back to the new (cut back) top frame.
+                    //   This makes the capture groups from within the look-ahead
+                    //   expression available.
+                    int64_t *newFP = fStack->getBuffer() + newStackSize - fFrameSize;
+                    int32_t i;
+                    for (i=0; i<fFrameSize; i++) {
+                        newFP[i] = ((int64_t *)fp)[i];
+                    }
+                    fp = (REStackFrame *)newFP;
+                    fStack->setSize(newStackSize);
+                }
+                fp->fInputIdx = fData[opValue+1];
+
+                // Restore the active region bounds in the input string; they may have
+                //    been changed because of transparent bounds on a Region.
+                fActiveStart = fRegionStart;
+                fActiveLimit = fRegionLimit;
+            }
+            break;
+
+        case URX_ONECHAR_I:
+            if (fp->fInputIdx < fActiveLimit) {
+                UChar32 c;
+                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                if (u_foldCase(c, U_FOLD_CASE_DEFAULT) == opValue) {
+                    break;
+                }
+            } else {
+                fHitEnd = TRUE;
+            }
+            fp = (REStackFrame *)fStack->popFrame(fFrameSize);
+            break;
+
+        case URX_STRING_I:
+            // Case-insensitive test input against a literal string.
+            // Strings require two slots in the compiled pattern, one for the
+            //   offset to the string text, and one for the length.
+            //   The compiled string has already been case folded.
+            {
+                const UChar *patternString = litText + opValue;
+
+                op      = (int32_t)pat[fp->fPatIdx];
+                fp->fPatIdx++;
+                opType  = URX_TYPE(op);
+                opValue = URX_VAL(op);
+                U_ASSERT(opType == URX_STRING_LEN);
+                int32_t patternStringLen = opValue;  // Length of the string from the pattern.
 
-                    UTEXT_SETNATIVEINDEX(fInputText, fp->fInputIdx);
-                    CaseFoldingUTextIterator inputIterator(*fInputText);
-                    while (patternStringIdx < patternStringLen) {
-                        if (!inputIterator.inExpansion() && UTEXT_GETNATIVEINDEX(fInputText) >= fActiveLimit) {
-                            success = FALSE;
+                UChar32      cText;
+                UChar32      cPattern;
+                UBool        success = TRUE;
+                int32_t      patternStringIdx  = 0;
+                CaseFoldingUCharIterator inputIterator(inputBuf, fp->fInputIdx, fActiveLimit);
+                while (patternStringIdx < patternStringLen) {
+                    U16_NEXT(patternString, patternStringIdx, patternStringLen, cPattern);
+                    cText = inputIterator.next();
+                    if (cText != cPattern) {
+                        success = FALSE;
+                        if (cText == U_SENTINEL) {
                             fHitEnd = TRUE;
-                            break;
-                        }
-                        U16_NEXT(patternString, patternStringIdx, patternStringLen, cPattern);
-                        cText = inputIterator.next();
-                        if (cText != cPattern) {
-                            success = FALSE;
-                            break;
                         }
+                        break;
                     }
-                    if (inputIterator.inExpansion()) {
-                        success = FALSE;
-                    }
+                }
+                if (inputIterator.inExpansion()) {
+                    success = FALSE;
+                }
 
-                    if (success) {
-                        fp->fInputIdx = UTEXT_GETNATIVEINDEX(fInputText);
-                    } else {
-                        fp = (REStackFrame *)fStack->popFrame(fFrameSize);
-                    }
+                if (success) {
+                    fp->fInputIdx = inputIterator.getIndex();
+                } else {
+                    fp = (REStackFrame *)fStack->popFrame(fFrameSize);
                 }
             }
             break;
@@ -3930,11 +6518,6 @@ GC_Done:
                 //   of this op in the pattern.
                 int32_t minML = (int32_t)pat[fp->fPatIdx++];
                 int32_t maxML = (int32_t)pat[fp->fPatIdx++];
-                if (!UTEXT_USES_U16(fInputText)) {
-                    // utf-8 fix to maximum match length. The pattern compiler assumes utf-16.
-                    // The max length need not be exact; it just needs to be >= actual maximum.
-                    maxML *= 3;
-                }
                 U_ASSERT(minML <= maxML);
                 U_ASSERT(minML >= 0);
 
@@ -3945,19 +6528,15 @@ GC_Done:
                     // First time through loop.
                     lbStartIdx = fp->fInputIdx - minML;
                     if (lbStartIdx > 0) {
-                        // move index to a code point boudary, if it's not on one already.
-                        UTEXT_SETNATIVEINDEX(fInputText, lbStartIdx);
-                        lbStartIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                        U16_SET_CP_START(inputBuf, 0, lbStartIdx);
                     }
                 } else {
                     // 2nd through nth time through the loop.
                     // Back up start position for match by one.
                     if (lbStartIdx == 0) {
-                        (lbStartIdx)--;
+                        lbStartIdx--;
                     } else {
-                        UTEXT_SETNATIVEINDEX(fInputText, lbStartIdx);
-                        (void)UTEXT_PREVIOUS32(fInputText);
-                        lbStartIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                        U16_BACK_1(inputBuf, 0, lbStartIdx);
                     }
                 }
 
@@ -3976,7 +6555,7 @@ GC_Done:
                 //    Save state to this URX_LB_CONT op, so failure to match will repeat the loop.
                 //      (successful match will fall off the end of the loop.)
                 fp = StateSave(fp, fp->fPatIdx-3, status);
-                fp->fInputIdx = lbStartIdx;
+                fp->fInputIdx =  lbStartIdx;
             }
             break;
 
@@ -4013,13 +6592,8 @@ GC_Done:
                 // Fetch the extra parameters of this op.
                 int32_t minML       = (int32_t)pat[fp->fPatIdx++];
                 int32_t maxML       = (int32_t)pat[fp->fPatIdx++];
-                if (!UTEXT_USES_U16(fInputText)) {
-                    // utf-8 fix to maximum match length. The pattern compiler assumes utf-16.
-                    // The max length need not be exact; it just needs to be >= actual maximum.
-                    maxML *= 3;
-                }
                 int32_t continueLoc = (int32_t)pat[fp->fPatIdx++];
-                        continueLoc = URX_VAL(continueLoc);
+                continueLoc = URX_VAL(continueLoc);
                 U_ASSERT(minML <= maxML);
                 U_ASSERT(minML >= 0);
                 U_ASSERT(continueLoc > fp->fPatIdx);
@@ -4031,19 +6605,15 @@ GC_Done:
                     // First time through loop.
                     lbStartIdx = fp->fInputIdx - minML;
                     if (lbStartIdx > 0) {
-                        // move index to a code point boudary, if it's not on one already.
-                        UTEXT_SETNATIVEINDEX(fInputText, lbStartIdx);
-                        lbStartIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                        U16_SET_CP_START(inputBuf, 0, lbStartIdx);
                     }
                 } else {
                     // 2nd through nth time through the loop.
                     // Back up start position for match by one.
                     if (lbStartIdx == 0) {
-                        (lbStartIdx)--;
+                        lbStartIdx--;   // Because U16_BACK is unsafe starting at 0.
                     } else {
-                        UTEXT_SETNATIVEINDEX(fInputText, lbStartIdx);
-                        (void)UTEXT_PREVIOUS32(fInputText);
-                        lbStartIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                        U16_BACK_1(inputBuf, 0, lbStartIdx);
                     }
                 }
 
@@ -4062,7 +6632,7 @@ GC_Done:
                 //    Save state to this URX_LB_CONT op, so failure to match will repeat the loop.
                 //      (successful match will cause a FAIL out of the loop altogether.)
                 fp = StateSave(fp, fp->fPatIdx-4, status);
-                fp->fInputIdx = lbStartIdx;
+                fp->fInputIdx =  lbStartIdx;
             }
             break;
 
@@ -4117,24 +6687,25 @@ GC_Done:
 
                 // Loop through input, until either the input is exhausted or
                 //   we reach a character that is not a member of the set.
-                int64_t ix = fp->fInputIdx;
-                UTEXT_SETNATIVEINDEX(fInputText, ix);
+                int32_t ix = (int32_t)fp->fInputIdx;
                 for (;;) {
                     if (ix >= fActiveLimit) {
                         fHitEnd = TRUE;
                         break;
                     }
-                    UChar32 c = UTEXT_NEXT32(fInputText);
+                    UChar32   c;
+                    U16_NEXT(inputBuf, ix, fActiveLimit, c);
                     if (c<256) {
                         if (s8->contains(c) == FALSE) {
+                            U16_BACK_1(inputBuf, 0, ix);
                             break;
                         }
                     } else {
                         if (s->contains(c) == FALSE) {
+                            U16_BACK_1(inputBuf, 0, ix);
                             break;
                         }
                     }
-                    ix = UTEXT_GETNATIVEINDEX(fInputText);
                 }
 
                 // If there were no matching characters, skip over the loop altogether.
@@ -4145,9 +6716,17 @@ GC_Done:
                 }
 
                 // Peek ahead in the compiled pattern, to the URX_LOOP_C that
-                //   must follow.  It's operand is the stack location
+                //   normally follows.  It's operand is the stack location
                 //   that holds the starting input index for the match of this [set]*
                 int32_t loopcOp = (int32_t)pat[fp->fPatIdx];
+                if (URX_TYPE(loopcOp) == URX_NOP) {
+                    // The compiler replaced the LOOP_C with a NOP because what follows the loop
+                    //   can not match at any of the positions that backing up would reach.
+                    //   Keep all of the input matched by the loop, with no state to come back to.
+                    fp->fInputIdx = ix;
+                    fp->fPatIdx++;
+                    break;
+                }
                 U_ASSERT(URX_TYPE(loopcOp) == URX_LOOP_C);
                 int32_t stackLoc = URX_VAL(loopcOp);
                 U_ASSERT(stackLoc >= 0 && stackLoc < fFrameSize);
@@ -4170,31 +6749,32 @@ GC_Done:
             {
                 // Loop through input until the input is exhausted (we reach an end-of-line)
                 // In DOTALL mode, we can just go straight to the end of the input.
-                int64_t ix;
+                int32_t ix;
                 if ((opValue & 1) == 1) {
                     // Dot-matches-All mode.  Jump straight to the end of the string.
-                    ix = fActiveLimit;
+                    ix = (int32_t)fActiveLimit;
                     fHitEnd = TRUE;
                 } else {
                     // NOT DOT ALL mode.  Line endings do not match '.'
                     // Scan forward until a line ending or end of input.
-                    ix = fp->fInputIdx;
-                    UTEXT_SETNATIVEINDEX(fInputText, ix);
+                    ix = (int32_t)fp->fInputIdx;
                     for (;;) {
                         if (ix >= fActiveLimit) {
                             fHitEnd = TRUE;
                             break;
                         }
-                        UChar32 c = UTEXT_NEXT32(fInputText);
+                        UChar32   c;
+                        U16_NEXT(inputBuf, ix, fActiveLimit, c);   // c = inputBuf[ix++]
                         if ((c & 0x7f) <= 0x29) {          // Fast filter of non-new-line-s
                             if ((c == 0x0a) ||             //  0x0a is newline in both modes.
-                               (((opValue & 2) == 0) &&    // IF not UNIX_LINES mode
-                                    isLineTerminator(c))) {
-                                //  char is a line ending.  Exit the scanning loop.
+                                (((opValue & 2) == 0) &&    // IF not UNIX_LINES mode
+                                   isLineTerminator(c))) {
+                                //  char is a line ending.  Put the input pos back to the
+                                //    line ending char, and exit the scanning loop.
+                                U16_BACK_1(inputBuf, 0, ix);
                                 break;
                             }
                         }
-                        ix = UTEXT_GETNATIVEINDEX(fInputText);
                     }
                 }
 
@@ -4206,9 +6786,17 @@ GC_Done:
                 }
 
                 // Peek ahead in the compiled pattern, to the URX_LOOP_C that
-                //   must follow.  It's operand is the stack location
+                //   normally follows.  It's operand is the stack location
                 //   that holds the starting input index for the match of this .*
                 int32_t loopcOp = (int32_t)pat[fp->fPatIdx];
+                if (URX_TYPE(loopcOp) == URX_NOP) {
+                    // The compiler replaced the LOOP_C with a NOP because what follows the loop
+                    //   can not match at any of the positions that backing up would reach.
+                    //   Keep all of the input matched by the loop, with no state to come back to.
+                    fp->fInputIdx = ix;
+                    fp->fPatIdx++;
+                    break;
+                }
                 U_ASSERT(URX_TYPE(loopcOp) == URX_LOOP_C);
                 int32_t stackLoc = URX_VAL(loopcOp);
                 U_ASSERT(stackLoc >= 0 && stackLoc < fFrameSize);
@@ -4227,7 +6815,7 @@ GC_Done:
         case URX_LOOP_C:
             {
                 U_ASSERT(opValue>=0 && opValue<fFrameSize);
-                backSearchIndex = fp->fExtra[opValue];
+                backSearchIndex = (int32_t)fp->fExtra[opValue];
                 U_ASSERT(backSearchIndex <= fp->fInputIdx);
                 if (backSearchIndex == fp->fInputIdx) {
                     // We've backed up the input idx to the point that the loop started.
@@ -4241,18 +6829,16 @@ GC_Done:
                 //   (We're going backwards because this loop emulates stack unwinding, not
                 //    the initial scan forward.)
                 U_ASSERT(fp->fInputIdx > 0);
-                UTEXT_SETNATIVEINDEX(fInputText, fp->fInputIdx);
-                UChar32 prevC = UTEXT_PREVIOUS32(fInputText);
-                fp->fInputIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                UChar32 prevC;
+                U16_PREV(inputBuf, 0, fp->fInputIdx, prevC); // !!!: should this 0 be one of f*Limit?
 
-                UChar32 twoPrevC = UTEXT_PREVIOUS32(fInputText);
                 if (prevC == 0x0a &&
                     fp->fInputIdx > backSearchIndex &&
-                    twoPrevC == 0x0d) {
+                    inputBuf[fp->fInputIdx-1] == 0x0d) {
                     int32_t prevOp = (int32_t)pat[fp->fPatIdx-2];
                     if (URX_TYPE(prevOp) == URX_LOOP_DOT_I) {
                         // .*, stepping back over CRLF pair.
-                        fp->fInputIdx = UTEXT_GETNATIVEINDEX(fInputText);
+                        U16_BACK_1(inputBuf, 0, fp->fInputIdx);
                     }
                 }
 
@@ -4296,23 +6882,47 @@ breakFromLoop:
     fFrame = fp;                // The active stack frame when the engine stopped.
                                 //   Contains the capture group results that we need to
                                 //    access later.
+
     return;
 }
 
 
 //--------------------------------------------------------------------------------
 //
-//   MatchChunkAt   This is the actual matching engine. Like MatchAt, but with the
-//                  assumption that the entire string is available in the UText's
-//                  chunk buffer. For now, that means we can use int32_t indexes,
-//                  except for anything that needs to be saved (like group starts
-//                  and ends).
+//   utf8Next(), utf8Previous()   Step over one code point in UTF-8 text, reading
+//                                ill-formed sequences as U+FFFD like a UTF-8 UText.
+//                                The index is an int64_t, as in the stack frames.
+//
+//--------------------------------------------------------------------------------
+static inline UChar32 utf8Next(const uint8_t *s, int64_t &i, int64_t limit) {
+    int32_t ix = (int32_t)i;
+    UChar32 c;
+    U8_NEXT_OR_FFFD(s, ix, (int32_t)limit, c);
+    i = ix;
+    return c;
+}
+
+static inline UChar32 utf8Previous(const uint8_t *s, int64_t &i) {
+    int32_t ix = (int32_t)i;
+    UChar32 c;
+    U8_PREV_OR_FFFD(s, 0, ix, c);
+    i = ix;
+    return c;
+}
+
+
+//--------------------------------------------------------------------------------
+//
+//   MatchUTF8At    This is the actual matching engine. Like MatchChunkAt, but for
+//                  UTF-8 input, which is read directly from its byte buffer.
+//                  Indexes are byte offsets, the native indexes of the UTF-8 UText.
+//                  Ill-formed sequences read as U+FFFD, as they do through the UText.
 //
 //                  startIdx:    begin matching a this index.
 //                  toEnd:       if true, match must extend to end of the input region
 //
 //--------------------------------------------------------------------------------
-void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &status) {
+void RegexMatcher::MatchUTF8At(int32_t startIdx, UBool toEnd, UErrorCode &status) {
     UBool       isMatch  = FALSE;      // True if the we have a match.
 
     int32_t     backSearchIndex = INT32_MAX; // used after greedy single-character matches for searching backwards
@@ -4340,7 +6950,7 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
     const UChar         *litText       = fPattern->fLiteralText.getBuffer();
     UVector             *sets          = fPattern->fSets;
 
-    const UChar         *inputBuf      = fInputText->chunkContents;
+    const uint8_t       *inputBuf      = fInputUTF8;
 
     fFrameSize = fPattern->fFrameSize;
     REStackFrame        *fp            = resetStack();
@@ -4394,7 +7004,7 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
         case URX_ONECHAR:
             if (fp->fInputIdx < fActiveLimit) {
                 UChar32 c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 if (c == opValue) {
                     break;
                 }
@@ -4420,25 +7030,36 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
                 U_ASSERT(opType == URX_STRING_LEN);
                 U_ASSERT(stringLen >= 2);
 
-                const UChar * pInp = inputBuf + fp->fInputIdx;
-                const UChar * pInpLimit = inputBuf + fActiveLimit;
+                // The string is UTF-16. Compare ASCII characters directly with the
+                //   input bytes, and others as code points.
                 const UChar * pPat = litText+stringStartIdx;
-                const UChar * pEnd = pInp + stringLen;
+                int32_t patIdx = 0;
+                int64_t inputIdx = fp->fInputIdx;
                 UBool success = TRUE;
-                while (pInp < pEnd) {
-                    if (pInp >= pInpLimit) {
+                while (patIdx < stringLen) {
+                    if (inputIdx >= fActiveLimit) {
                         fHitEnd = TRUE;
                         success = FALSE;
                         break;
                     }
-                    if (*pInp++ != *pPat++) {
-                        success = FALSE;
-                        break;
+                    UChar32 patternChar = pPat[patIdx];
+                    if (patternChar < 0x80) {
+                        patIdx++;
+                        if (inputBuf[inputIdx++] != patternChar) {
+                            success = FALSE;
+                            break;
+                        }
+                    } else {
+                        U16_NEXT(pPat, patIdx, stringLen, patternChar);
+                        if (utf8Next(inputBuf, inputIdx, fActiveLimit) != patternChar) {
+                            success = FALSE;
+                            break;
+                        }
                     }
                 }
 
                 if (success) {
-                    fp->fInputIdx += stringLen;
+                    fp->fInputIdx = inputIdx;
                 } else {
                     fp = (REStackFrame *)fStack->popFrame(fFrameSize);
                 }
@@ -4447,6 +7068,23 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
 
 
         case URX_STATE_SAVE:
+            if (fp->fInputIdx < fActiveLimit) {
+                // If the op that follows is a literal that can not match here, as for most
+                //   branches of an alternation of literals, go straight to the alternative
+                //   instead of saving a state only to return to it right away.
+                //   Only ASCII literal characters are compared directly with the input bytes.
+                int32_t nextOp = (int32_t)pat[fp->fPatIdx];
+                UChar32 nextChar = -1;
+                if (URX_TYPE(nextOp) == URX_ONECHAR) {
+                    nextChar = URX_VAL(nextOp);
+                } else if (URX_TYPE(nextOp) == URX_STRING) {
+                    nextChar = litText[URX_VAL(nextOp)];
+                }
+                if (nextChar >= 0 && nextChar < 0x80 && inputBuf[fp->fInputIdx] != nextChar) {
+                    fp->fPatIdx = opValue;
+                    break;
+                }
+            }
             fp = StateSave(fp, opValue, status);
             break;
 
@@ -4484,9 +7122,10 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
 
         case URX_DOLLAR:                   //  $, test for End of line
             //     or for position before new line at end of input
-            if (fp->fInputIdx < fAnchorLimit-2) {
+            if (fp->fInputIdx < fAnchorLimit-3) {
                 // We are no where near the end of input.  Fail.
                 //   This is the common case.  Keep it first.
+                //   (The longest line ending, U+2028 or U+2029, has three bytes.)
                 fp = (REStackFrame *)fStack->popFrame(fFrameSize);
                 break;
             }
@@ -4499,23 +7138,23 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
 
             // If we are positioned just before a new-line that is located at the
             //   end of input, succeed.
-            if (fp->fInputIdx == fAnchorLimit-1) {
-                UChar32 c;
-                U16_GET(inputBuf, fAnchorStart, fp->fInputIdx, fAnchorLimit, c);
-
-                if (isLineTerminator(c)) {
-                    if ( !(c==0x0a && fp->fInputIdx>fAnchorStart && inputBuf[fp->fInputIdx-1]==0x0d)) {
-                        // At new-line at end of input. Success
-                        fHitEnd = TRUE;
-                        fRequireEnd = TRUE;
-                        break;
+            {
+                int64_t nextIdx = fp->fInputIdx;
+                UChar32 c = utf8Next(inputBuf, nextIdx, fAnchorLimit);
+                if (nextIdx >= fAnchorLimit) {
+                    if (isLineTerminator(c)) {
+                        if ( !(c==0x0a && fp->fInputIdx>fAnchorStart && inputBuf[fp->fInputIdx-1]==0x0d)) {
+                            // At new-line at end of input. Success
+                            fHitEnd = TRUE;
+                            fRequireEnd = TRUE;
+                            break;
+                        }
                     }
-                }
-            } else if (fp->fInputIdx == fAnchorLimit-2 &&
-                inputBuf[fp->fInputIdx]==0x0d && inputBuf[fp->fInputIdx+1]==0x0a) {
+                } else if (nextIdx == fAnchorLimit-1 && c == 0x0d && inputBuf[nextIdx] == 0x0a) {
                     fHitEnd = TRUE;
                     fRequireEnd = TRUE;
                     break;                         // At CR/LF at end of input.  Success
+                }
             }
 
             fp = (REStackFrame *)fStack->popFrame(fFrameSize);
@@ -4556,7 +7195,8 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
                 }
                 // If we are positioned just before a new-line, succeed.
                 // It makes no difference where the new-line is within the input.
-                UChar32 c = inputBuf[fp->fInputIdx];
+                int64_t nextIdx = fp->fInputIdx;
+                UChar32 c = utf8Next(inputBuf, nextIdx, fInputLength);
                 if (isLineTerminator(c)) {
                     // At a line end, except for the odd chance of  being in the middle of a CR/LF sequence
                     //  In multi-line mode, hitting a new-line just before the end of input does not
@@ -4603,7 +7243,8 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
                 }
                 // Check whether character just before the current pos is a new-line
                 //   unless we are at the end of input
-                UChar  c = inputBuf[fp->fInputIdx - 1];
+                int64_t prevIdx = fp->fInputIdx;
+                UChar32 c = utf8Previous(inputBuf, prevIdx);
                 if ((fp->fInputIdx < fAnchorLimit) &&
                     isLineTerminator(c)) {
                     //  It's a new-line.  ^ is true.  Success.
@@ -4625,7 +7266,7 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
                 }
                 // Check whether character just before the current pos is a new-line
                 U_ASSERT(fp->fInputIdx <= fAnchorLimit);
-                UChar  c = inputBuf[fp->fInputIdx - 1];
+                uint8_t  c = inputBuf[fp->fInputIdx - 1];
                 if (c != 0x0a) {
                     // Not at the start of a line.  Back-track out.
                     fp = (REStackFrame *)fStack->popFrame(fFrameSize);
@@ -4635,7 +7276,7 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
 
         case URX_BACKSLASH_B:          // Test for word boundaries
             {
-                UBool success = isChunkWordBoundary((int32_t)fp->fInputIdx);
+                UBool success = isUTF8WordBoundary((int32_t)fp->fInputIdx);
                 success ^= (UBool)(opValue != 0);     // flip sense for \B
                 if (!success) {
                     fp = (REStackFrame *)fStack->popFrame(fFrameSize);
@@ -4664,7 +7305,7 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
                 }
 
                 UChar32 c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 int8_t ctype = u_charType(c);     // TODO:  make a unicode set for this.  Will be faster.
                 UBool success = (ctype == U_DECIMAL_DIGIT_NUMBER);
                 success ^= (UBool)(opValue != 0);        // flip sense for \D
@@ -4690,7 +7331,7 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
                     break;
                 }
                 UChar32 c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 int8_t ctype = u_charType(c);
                 UBool success = (ctype == U_SPACE_SEPARATOR || c == 9);  // SPACE_SEPARATOR || TAB
                 success ^= (UBool)(opValue != 0);        // flip sense for \H
@@ -4709,14 +7350,12 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
                     break;
                 }
                 UChar32 c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 if (isLineTerminator(c)) {
                     if (c == 0x0d && fp->fInputIdx < fActiveLimit) {
                         // Check for CR/LF sequence. Consume both together when found.
-                        UChar c2;
-                        U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c2);
-                        if (c2 != 0x0a) {
-                            U16_PREV(inputBuf, 0, fp->fInputIdx, c2);
+                        if (inputBuf[fp->fInputIdx] == 0x0a) {
+                            fp->fInputIdx++;
                         }
                     }
                 } else {
@@ -4734,7 +7373,7 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
                     break;
                 }
                 UChar32 c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 UBool success = isLineTerminator(c);
                 success ^= (UBool)(opValue != 0);        // flip sense for \V
                 if (!success) {
@@ -4761,7 +7400,7 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
             // Examine (and consume) the current char.
             //   Dispatch into a little state machine, based on the char.
             UChar32  c;
-            U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+            c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
             UnicodeSet **sets = fPattern->fStaticSets;
             if (sets[URX_GC_NORMAL]->contains(c))  goto GC_Extend;
             if (sets[URX_GC_CONTROL]->contains(c)) goto GC_Control;
@@ -4776,27 +7415,27 @@ void RegexMatcher::MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &statu
 
 GC_L:
             if (fp->fInputIdx >= fActiveLimit)         goto GC_Done;
-            U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+            c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
             if (sets[URX_GC_L]->contains(c))       goto GC_L;
             if (sets[URX_GC_LV]->contains(c))      goto GC_V;
             if (sets[URX_GC_LVT]->contains(c))     goto GC_T;
             if (sets[URX_GC_V]->contains(c))       goto GC_V;
-            U16_PREV(inputBuf, 0, fp->fInputIdx, c);
+            c = utf8Previous(inputBuf, fp->fInputIdx);
             goto GC_Extend;
 
 GC_V:
             if (fp->fInputIdx >= fActiveLimit)         goto GC_Done;
-            U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+            c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
             if (sets[URX_GC_V]->contains(c))       goto GC_V;
             if (sets[URX_GC_T]->contains(c))       goto GC_T;
-            U16_PREV(inputBuf, 0, fp->fInputIdx, c);
+            c = utf8Previous(inputBuf, fp->fInputIdx);
             goto GC_Extend;
 
 GC_T:
             if (fp->fInputIdx >= fActiveLimit)         goto GC_Done;
-            U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+            c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
             if (sets[URX_GC_T]->contains(c))       goto GC_T;
-            U16_PREV(inputBuf, 0, fp->fInputIdx, c);
+            c = utf8Previous(inputBuf, fp->fInputIdx);
             goto GC_Extend;
 
 GC_Extend:
@@ -4805,9 +7444,9 @@ GC_Extend:
                 if (fp->fInputIdx >= fActiveLimit) {
                     break;
                 }
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 if (sets[URX_GC_EXTEND]->contains(c) == FALSE) {
-                    U16_BACK_1(inputBuf, 0, fp->fInputIdx);
+                    (void)utf8Previous(inputBuf, fp->fInputIdx);
                     break;
                 }
             }
@@ -4859,7 +7498,7 @@ GC_Done:
                 U_ASSERT(opValue > 0 && opValue < URX_LAST_SET);
 
                 UChar32 c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 if (c < 256) {
                     Regex8BitSet *s8 = &fPattern->fStaticSets8[opValue];
                     if (s8->contains(c)) {
@@ -4891,7 +7530,7 @@ GC_Done:
                 U_ASSERT(opValue > 0 && opValue < URX_LAST_SET);
 
                 UChar32  c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 if (c < 256) {
                     Regex8BitSet *s8 = &fPattern->fStaticSets8[opValue];
                     if (s8->contains(c) == FALSE) {
@@ -4920,7 +7559,7 @@ GC_Done:
 
                 // There is input left.  Pick up one char and test it for set membership.
                 UChar32  c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 if (c<256) {
                     Regex8BitSet *s8 = &fPattern->fSets8[opValue];
                     if (s8->contains(c)) {
@@ -4953,7 +7592,7 @@ GC_Done:
 
                 // There is input left.  Advance over one char, unless we've hit end-of-line
                 UChar32  c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 if (isLineTerminator(c)) {
                     // End of line in normal mode.   . does not match.
                     fp = (REStackFrame *)fStack->popFrame(fFrameSize);
@@ -4976,11 +7615,11 @@ GC_Done:
                 // There is input left.  Advance over one char, except if we are
                 //   at a cr/lf, advance over both of them.
                 UChar32 c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 if (c==0x0d && fp->fInputIdx < fActiveLimit) {
                     // In the case of a CR/LF, we need to advance over both.
                     if (inputBuf[fp->fInputIdx] == 0x0a) {
-                        U16_FWD_1(inputBuf, fp->fInputIdx, fActiveLimit);
+                        fp->fInputIdx++;
                     }
                 }
             }
@@ -5000,7 +7639,7 @@ GC_Done:
 
                 // There is input left.  Advance over one char, unless we've hit end-of-line
                 UChar32 c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 if (c == 0x0a) {
                     // End of line in normal mode.   '.' does not match the \n
                     fp = (REStackFrame *)fStack->popFrame(fFrameSize);
@@ -5213,24 +7852,23 @@ GC_Done:
                     fp = (REStackFrame *)fStack->popFrame(fFrameSize);   // FAIL, no match.
                     break;
                 }
+                // Compare code points rather than bytes, so that the match
+                //   ends on a code point boundary even in ill-formed input.
                 UBool success = TRUE;
-                for (int64_t groupIndex = groupStartIdx; groupIndex < groupEndIdx; ++groupIndex,++inputIndex) {
+                int64_t groupIndex = groupStartIdx;
+                while (groupIndex < groupEndIdx) {
                     if (inputIndex >= fActiveLimit) {
                         success = FALSE;
                         fHitEnd = TRUE;
                         break;
                     }
-                    if (inputBuf[groupIndex] != inputBuf[inputIndex]) {
+                    UChar32 captureGroupChar = utf8Next(inputBuf, groupIndex, groupEndIdx);
+                    UChar32 inputChar = utf8Next(inputBuf, inputIndex, fActiveLimit);
+                    if (inputChar != captureGroupChar) {
                         success = FALSE;
                         break;
                     }
                 }
-                if (success && groupStartIdx < groupEndIdx && U16_IS_LEAD(inputBuf[groupEndIdx-1]) &&
-                        inputIndex < fActiveLimit && U16_IS_TRAIL(inputBuf[inputIndex])) {
-                    // Capture group ended with an unpaired lead surrogate.
-                    // Back reference is not permitted to match lead only of a surrogatge pair.
-                    success = FALSE;
-                }
                 if (success) {
                     fp->fInputIdx = inputIndex;
                 } else {
@@ -5250,8 +7888,8 @@ GC_Done:
                     fp = (REStackFrame *)fStack->popFrame(fFrameSize);   // FAIL, no match.
                     break;
                 }
-                CaseFoldingUCharIterator captureGroupItr(inputBuf, groupStartIdx, groupEndIdx);
-                CaseFoldingUCharIterator inputItr(inputBuf, fp->fInputIdx, fActiveLimit);
+                CaseFoldingUTF8Iterator captureGroupItr(inputBuf, groupStartIdx, groupEndIdx);
+                CaseFoldingUTF8Iterator inputItr(inputBuf, fp->fInputIdx, fActiveLimit);
 
                 //   Note: if the capture group match was of an empty string the backref
                 //         match succeeds.  Verified by testing:  Perl matches succeed
@@ -5358,7 +7996,7 @@ GC_Done:
         case URX_ONECHAR_I:
             if (fp->fInputIdx < fActiveLimit) {
                 UChar32 c;
-                U16_NEXT(inputBuf, fp->fInputIdx, fActiveLimit, c);
+                c = utf8Next(inputBuf, fp->fInputIdx, fActiveLimit);
                 if (u_foldCase(c, U_FOLD_CASE_DEFAULT) == opValue) {
                     break;
                 }
@@ -5387,7 +8025,7 @@ GC_Done:
                 UChar32      cPattern;
                 UBool        success = TRUE;
                 int32_t      patternStringIdx  = 0;
-                CaseFoldingUCharIterator inputIterator(inputBuf, fp->fInputIdx, fActiveLimit);
+                CaseFoldingUTF8Iterator inputIterator(inputBuf, fp->fInputIdx, fActiveLimit);
                 while (patternStringIdx < patternStringLen) {
                     U16_NEXT(patternString, patternStringIdx, patternStringLen, cPattern);
                     cText = inputIterator.next();
@@ -5440,6 +8078,9 @@ GC_Done:
                 int32_t maxML = (int32_t)pat[fp->fPatIdx++];
                 U_ASSERT(minML <= maxML);
                 U_ASSERT(minML >= 0);
+                // utf-8 fix to maximum match length. The pattern compiler assumes utf-16.
+                // The max length need not be exact; it just needs to be >= actual maximum.
+                maxML *= 3;
 
                 // Fetch (from data) the last input index where a match was attempted.
                 U_ASSERT(opValue>=0 && opValue+1<fPattern->fDataSize);
@@ -5448,7 +8089,9 @@ GC_Done:
                     // First time through loop.
                     lbStartIdx = fp->fInputIdx - minML;
                     if (lbStartIdx > 0) {
-                        U16_SET_CP_START(inputBuf, 0, lbStartIdx);
+                        int32_t ix = (int32_t)lbStartIdx;
+                        U8_SET_CP_START(inputBuf, 0, ix);
+                        lbStartIdx = ix;
                     }
                 } else {
                     // 2nd through nth time through the loop.
@@ -5456,7 +8099,9 @@ GC_Done:
                     if (lbStartIdx == 0) {
                         lbStartIdx--;
                     } else {
-                        U16_BACK_1(inputBuf, 0, lbStartIdx);
+                        int32_t ix = (int32_t)lbStartIdx;
+                        U8_BACK_1(inputBuf, 0, ix);
+                        lbStartIdx = ix;
                     }
                 }
 
@@ -5517,6 +8162,9 @@ GC_Done:
                 U_ASSERT(minML <= maxML);
                 U_ASSERT(minML >= 0);
                 U_ASSERT(continueLoc > fp->fPatIdx);
+                // utf-8 fix to maximum match length. The pattern compiler assumes utf-16.
+                // The max length need not be exact; it just needs to be >= actual maximum.
+                maxML *= 3;
 
                 // Fetch (from data) the last input index where a match was attempted.
                 U_ASSERT(opValue>=0 && opValue+1<fPattern->fDataSize);
@@ -5525,15 +8173,19 @@ GC_Done:
                     // First time through loop.
                     lbStartIdx = fp->fInputIdx - minML;
                     if (lbStartIdx > 0) {
-                        U16_SET_CP_START(inputBuf, 0, lbStartIdx);
+                        int32_t ix = (int32_t)lbStartIdx;
+                        U8_SET_CP_START(inputBuf, 0, ix);
+                        lbStartIdx = ix;
                     }
                 } else {
                     // 2nd through nth time through the loop.
                     // Back up start position for match by one.
                     if (lbStartIdx == 0) {
-                        lbStartIdx--;   // Because U16_BACK is unsafe starting at 0.
+                        lbStartIdx--;   // Because U8_BACK is unsafe starting at 0.
                     } else {
-                        U16_BACK_1(inputBuf, 0, lbStartIdx);
+                        int32_t ix = (int32_t)lbStartIdx;
+                        U8_BACK_1(inputBuf, 0, ix);
+                        lbStartIdx = ix;
                     }
                 }
 
@@ -5608,21 +8260,23 @@ GC_Done:
                 // Loop through input, until either the input is exhausted or
                 //   we reach a character that is not a member of the set.
                 int32_t ix = (int32_t)fp->fInputIdx;
+                int32_t limit = (int32_t)fActiveLimit;
                 for (;;) {
-                    if (ix >= fActiveLimit) {
+                    if (ix >= limit) {
                         fHitEnd = TRUE;
                         break;
                     }
+                    int32_t   charStart = ix;
                     UChar32   c;
-                    U16_NEXT(inputBuf, ix, fActiveLimit, c);
+                    U8_NEXT_OR_FFFD(inputBuf, ix, limit, c);
                     if (c<256) {
                         if (s8->contains(c) == FALSE) {
-                            U16_BACK_1(inputBuf, 0, ix);
+                            ix = charStart;
                             break;
                         }
                     } else {
                         if (s->contains(c) == FALSE) {
-                            U16_BACK_1(inputBuf, 0, ix);
+                            ix = charStart;
                             break;
                         }
                     }
@@ -5636,9 +8290,17 @@ GC_Done:
                 }
 
                 // Peek ahead in the compiled pattern, to the URX_LOOP_C that
-                //   must follow.  It's operand is the stack location
+                //   normally follows.  It's operand is the stack location
                 //   that holds the starting input index for the match of this [set]*
                 int32_t loopcOp = (int32_t)pat[fp->fPatIdx];
+                if (URX_TYPE(loopcOp) == URX_NOP) {
+                    // The compiler replaced the LOOP_C with a NOP because what follows the loop
+                    //   can not match at any of the positions that backing up would reach.
+                    //   Keep all of the input matched by the loop, with no state to come back to.
+                    fp->fInputIdx = ix;
+                    fp->fPatIdx++;
+                    break;
+                }
                 U_ASSERT(URX_TYPE(loopcOp) == URX_LOOP_C);
                 int32_t stackLoc = URX_VAL(loopcOp);
                 U_ASSERT(stackLoc >= 0 && stackLoc < fFrameSize);
@@ -5670,20 +8332,22 @@ GC_Done:
                     // NOT DOT ALL mode.  Line endings do not match '.'
                     // Scan forward until a line ending or end of input.
                     ix = (int32_t)fp->fInputIdx;
+                    int32_t limit = (int32_t)fActiveLimit;
                     for (;;) {
-                        if (ix >= fActiveLimit) {
+                        if (ix >= limit) {
                             fHitEnd = TRUE;
                             break;
                         }
+                        int32_t   charStart = ix;
                         UChar32   c;
-                        U16_NEXT(inputBuf, ix, fActiveLimit, c);   // c = inputBuf[ix++]
+                        U8_NEXT_OR_FFFD(inputBuf, ix, limit, c);   // c = inputBuf[ix++]
                         if ((c & 0x7f) <= 0x29) {          // Fast filter of non-new-line-s
                             if ((c == 0x0a) ||             //  0x0a is newline in both modes.
                                 (((opValue & 2) == 0) &&    // IF not UNIX_LINES mode
                                    isLineTerminator(c))) {
                                 //  char is a line ending.  Put the input pos back to the
                                 //    line ending char, and exit the scanning loop.
-                                U16_BACK_1(inputBuf, 0, ix);
+                                ix = charStart;
                                 break;
                             }
                         }
@@ -5698,9 +8362,17 @@ GC_Done:
                 }
 
                 // Peek ahead in the compiled pattern, to the URX_LOOP_C that
-                //   must follow.  It's operand is the stack location
+                //   normally follows.  It's operand is the stack location
                 //   that holds the starting input index for the match of this .*
                 int32_t loopcOp = (int32_t)pat[fp->fPatIdx];
+                if (URX_TYPE(loopcOp) == URX_NOP) {
+                    // The compiler replaced the LOOP_C with a NOP because what follows the loop
+                    //   can not match at any of the positions that backing up would reach.
+                    //   Keep all of the input matched by the loop, with no state to come back to.
+                    fp->fInputIdx = ix;
+                    fp->fPatIdx++;
+                    break;
+                }
                 U_ASSERT(URX_TYPE(loopcOp) == URX_LOOP_C);
                 int32_t stackLoc = URX_VAL(loopcOp);
                 U_ASSERT(stackLoc >= 0 && stackLoc < fFrameSize);
@@ -5733,8 +8405,7 @@ GC_Done:
                 //   (We're going backwards because this loop emulates stack unwinding, not
                 //    the initial scan forward.)
                 U_ASSERT(fp->fInputIdx > 0);
-                UChar32 prevC;
-                U16_PREV(inputBuf, 0, fp->fInputIdx, prevC); // !!!: should this 0 be one of f*Limit?
+                UChar32 prevC = utf8Previous(inputBuf, fp->fInputIdx);
 
                 if (prevC == 0x0a &&
                     fp->fInputIdx > backSearchIndex &&
@@ -5742,7 +8413,7 @@ GC_Done:
                     int32_t prevOp = (int32_t)pat[fp->fPatIdx-2];
                     if (URX_TYPE(prevOp) == URX_LOOP_DOT_I) {
                         // .*, stepping back over CRLF pair.
-                        U16_BACK_1(inputBuf, 0, fp->fInputIdx);
+                        fp->fInputIdx--;
                     }
                 }
 
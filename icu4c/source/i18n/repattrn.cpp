@@ -23,6 +23,7 @@
 #include "uvector.h"
 #include "uvectr32.h"
 #include "uvectr64.h"
+#include "regexcache.h"
 #include "regexcmp.h"
 #include "regeximp.h"
 #include "regexst.h"
@@ -107,6 +108,7 @@ RegexPattern &RegexPattern::operator = (const RegexPattern &other) {
     fInitialChar      = other.fInitialChar;
     *fInitialChars8   = *other.fInitialChars8;
     fNeedsAltInput    = other.fNeedsAltInput;
+    fRequiredLiteral  = other.fRequiredLiteral;
 
     //  Copy the pattern.  It's just values, nothing deep to copy.
     fCompiledPat->assign(*other.fCompiledPat, fDeferredStatus);
@@ -182,7 +184,9 @@ void RegexPattern::init() {
     fInitialChar      = 0;
     fInitialChars8    = NULL;
     fNeedsAltInput    = FALSE;
+    fRequiredLiteral.remove();
     fNamedCaptureMap  = NULL;
+    fSpares           = NULL;
 
     fPattern          = NULL; // will be set later
     fPatternString    = NULL; // may be set later
@@ -191,6 +195,7 @@ void RegexPattern::init() {
     fSets             = new UVector(fDeferredStatus);
     fInitialChars     = new UnicodeSet;
     fInitialChars8    = new Regex8BitSet;
+    fSpares           = new RegexSpares;
     fNamedCaptureMap  = uhash_open(uhash_hashUnicodeString,     // Key hash function
                                    uhash_compareUnicodeString,  // Key comparator function
                                    uhash_compareLong,           // Value comparator function
@@ -199,7 +204,8 @@ void RegexPattern::init() {
         return;
     }
     if (fCompiledPat == NULL  || fGroupMap == NULL || fSets == NULL ||
-            fInitialChars == NULL || fInitialChars8 == NULL || fNamedCaptureMap == NULL) {
+            fInitialChars == NULL || fInitialChars8 == NULL || fNamedCaptureMap == NULL ||
+            fSpares == NULL) {
         fDeferredStatus = U_MEMORY_ALLOCATION_ERROR;
         return;
     }
@@ -248,6 +254,8 @@ void RegexPattern::zap() {
     }
     uhash_close(fNamedCaptureMap);
     fNamedCaptureMap = NULL;
+    delete fSpares;
+    fSpares = NULL;
 }
 
 
@@ -314,7 +322,8 @@ RegexPattern::compile(const UnicodeString &regex,
 
     const uint32_t allFlags = UREGEX_CANON_EQ | UREGEX_CASE_INSENSITIVE | UREGEX_COMMENTS |
     UREGEX_DOTALL   | UREGEX_MULTILINE        | UREGEX_UWORD |
-    UREGEX_ERROR_ON_UNKNOWN_ESCAPES           | UREGEX_UNIX_LINES | UREGEX_LITERAL;
+    UREGEX_ERROR_ON_UNKNOWN_ESCAPES           | UREGEX_UNIX_LINES | UREGEX_LITERAL |
+    UREGEX_CACHE_PATTERN;
 
     if ((flags & ~allFlags) != 0) {
         status = U_REGEX_INVALID_FLAG;
@@ -326,6 +335,32 @@ RegexPattern::compile(const UnicodeString &regex,
         return NULL;
     }
 
+    if ((flags & UREGEX_CACHE_PATTERN) != 0) {
+        // The caller owns the returned pattern, so hand out a copy of the shared one.
+        //   Copying the compiled code is much cheaper than compiling it again.
+        const SharedRegexPattern *shared = SharedRegexPattern::getFromCache(regex, flags, status);
+        if (U_SUCCESS(status)) {
+            RegexPattern *This = new RegexPattern(**shared);
+            shared->removeRef();
+            if (This == NULL) {
+                status = U_MEMORY_ALLOCATION_ERROR;
+                return NULL;
+            }
+            if (U_FAILURE(This->fDeferredStatus)) {
+                status = This->fDeferredStatus;
+                delete This;
+                return NULL;
+            }
+            return This;
+        }
+        if (status == U_MEMORY_ALLOCATION_ERROR) {
+            return NULL;
+        }
+        // A syntax error.  Compile the pattern here, to report where the error is.
+        status = U_ZERO_ERROR;
+        flags &= ~UREGEX_CACHE_PATTERN;
+    }
+
     RegexPattern *This = new RegexPattern;
     if (This == NULL) {
         status = U_MEMORY_ALLOCATION_ERROR;
@@ -365,7 +400,8 @@ RegexPattern::compile(UText                *regex,
 
     const uint32_t allFlags = UREGEX_CANON_EQ | UREGEX_CASE_INSENSITIVE | UREGEX_COMMENTS |
                               UREGEX_DOTALL   | UREGEX_MULTILINE        | UREGEX_UWORD |
-                              UREGEX_ERROR_ON_UNKNOWN_ESCAPES           | UREGEX_UNIX_LINES | UREGEX_LITERAL;
+                              UREGEX_ERROR_ON_UNKNOWN_ESCAPES           | UREGEX_UNIX_LINES | UREGEX_LITERAL |
+                              UREGEX_CACHE_PATTERN;
 
     if ((flags & ~allFlags) != 0) {
         status = U_REGEX_INVALID_FLAG;
@@ -377,6 +413,21 @@ RegexPattern::compile(UText                *regex,
         return NULL;
     }
 
+    if ((flags & UREGEX_CACHE_PATTERN) != 0) {
+        // The cache is keyed by the pattern string.
+        UErrorCode lengthStatus = U_ZERO_ERROR;
+        int32_t    regexLength  = utext_extract(regex, 0, utext_nativeLength(regex), NULL, 0, &lengthStatus);
+        UnicodeString regexString;
+        UChar *buffer = regexString.getBuffer(regexLength + 1);
+        if (buffer == NULL) {
+            status = U_MEMORY_ALLOCATION_ERROR;
+            return NULL;
+        }
+        utext_extract(regex, 0, utext_nativeLength(regex), buffer, regexLength + 1, &status);
+        regexString.releaseBuffer(regexLength);
+        return compile(regexString, flags, pe, status);
+    }
+
     RegexPattern *This = new RegexPattern;
     if (This == NULL) {
         status = U_MEMORY_ALLOCATION_ERROR;
@@ -833,6 +884,9 @@ void RegexPattern::dumpPattern() const {
                 printf("%#x\n", fInitialChar);
             }
     }
+    if (!fRequiredLiteral.isEmpty()) {
+        printf("   Required literal:  \"%s\"\n", CStr(fRequiredLiteral)());
+    }
 
     printf("Named Capture Groups:\n");
     if (uhash_count(fNamedCaptureMap) == 0) {
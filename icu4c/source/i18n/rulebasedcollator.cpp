@@ -22,6 +22,7 @@
 #include "unicode/localpointer.h"
 #include "unicode/locid.h"
 #include "unicode/sortkey.h"
+#include "unicode/bytestream.h"
 #include "unicode/tblcoll.h"
 #include "unicode/ucol.h"
 #include "unicode/uiter.h"
@@ -44,6 +45,7 @@
 #include "collationroot.h"
 #include "collationsets.h"
 #include "collationsettings.h"
+#include "collationsort.h"
 #include "collationtailoring.h"
 #include "cstring.h"
 #include "uassert.h"
@@ -87,6 +89,83 @@ FixedSortKeyByteSink::Resize(int32_t /*appendCapacity*/, int32_t /*length*/) {
     return FALSE;
 }
 
+/**
+ * Collects the sort keys of a batch contiguously in a growable buffer
+ * and passes them on to the caller's ByteSink in large blocks.
+ * The buffer is reused after each block, so it grows at most to about
+ * FLUSH_LENGTH plus the length of the longest key.
+ */
+class ArenaSortKeyByteSink : public SortKeyByteSink {
+public:
+    ArenaSortKeyByteSink(ByteSink &sink)
+            : SortKeyByteSink(NULL, 0), sink_(sink), flushed_(0) {
+        buffer_ = arena_.getAlias();
+        capacity_ = arena_.getCapacity();
+    }
+    virtual ~ArenaSortKeyByteSink();
+
+    /** @return the number of bytes of complete keys so far */
+    int32_t KeysLength() const { return flushed_ + appended_; }
+
+    /**
+     * To be called after each complete key.
+     * @return FALSE if the total length overflows an int32_t
+     */
+    UBool EndKey() {
+        if(appended_ > INT32_MAX - flushed_) { return FALSE; }
+        if(appended_ >= FLUSH_LENGTH) { Flush(); }
+        return TRUE;
+    }
+
+    void Flush() {
+        if(appended_ > 0) {
+            if(IsOk()) { sink_.Append(buffer_, appended_); }
+            flushed_ += appended_;
+            appended_ = 0;
+        }
+    }
+
+private:
+    static const int32_t FLUSH_LENGTH = 16 * 1024;
+
+    virtual void AppendBeyondCapacity(const char *bytes, int32_t n, int32_t length);
+    virtual UBool Resize(int32_t appendCapacity, int32_t length);
+
+    MaybeStackArray<char, 1024> arena_;
+    ByteSink &sink_;
+    int32_t flushed_;
+};
+
+ArenaSortKeyByteSink::~ArenaSortKeyByteSink() {}
+
+void
+ArenaSortKeyByteSink::AppendBeyondCapacity(const char *bytes, int32_t n, int32_t length) {
+    // buffer_ != NULL && bytes != NULL && n > 0 && appended_ > capacity_
+    if (Resize(n, length)) {
+        uprv_memcpy(buffer_ + length, bytes, n);
+    }
+}
+
+UBool
+ArenaSortKeyByteSink::Resize(int32_t appendCapacity, int32_t length) {
+    if (buffer_ == NULL) {
+        return FALSE;  // allocation failed before already
+    }
+    int32_t newCapacity = 2 * capacity_;
+    int32_t altCapacity = length + 2 * appendCapacity;
+    if (newCapacity < altCapacity) {
+        newCapacity = altCapacity;
+    }
+    char *newBuffer = arena_.resize(newCapacity, length);
+    if (newBuffer == NULL) {
+        SetNotOk();
+        return FALSE;
+    }
+    buffer_ = newBuffer;
+    capacity_ = newCapacity;
+    return TRUE;
+}
+
 }  // namespace
 
 // Not in an anonymous namespace, so that it can be a friend of CollationKey.
@@ -1328,24 +1407,357 @@ RuleBasedCollator::getSortKey(const UChar *s, int32_t length,
     return U_SUCCESS(errorCode) ? sink.NumberOfBytesAppended() : 0;
 }
 
+void
+RuleBasedCollator::getSortKeys(const UChar *const sources[], const int32_t sourceLengths[],
+                               int32_t count,
+                               ByteSink &sink, int32_t offsets[],
+                               UErrorCode &errorCode) const {
+    if(U_FAILURE(errorCode)) { return; }
+    if(count < 0 || (sources == NULL && count > 0) || offsets == NULL) {
+        errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    ArenaSortKeyByteSink arena(sink);
+    // One iterator for the whole batch, set to each string in turn.
+    UBool numeric = settings->isNumeric();
+    UBool checkFCD = !settings->dontCheckFCD();
+    UTF16CollationIterator iter(data, numeric, NULL, NULL, NULL);
+    FCDUTF16CollationIterator fcdIter(data, numeric, NULL, NULL, NULL);
+    for(int32_t i = 0; i < count; ++i) {
+        offsets[i] = arena.KeysLength();
+        const UChar *s = sources[i];
+        int32_t length = sourceLengths != NULL ? sourceLengths[i] : -1;
+        if(s == NULL && length != 0) {
+            errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+            return;
+        }
+        const UChar *limit = (length >= 0) ? s + length : NULL;
+        if(checkFCD) {
+            fcdIter.setText(s, limit);
+            writeSortKey(fcdIter, s, limit, arena, errorCode);
+        } else {
+            iter.setText(s, limit);
+            writeSortKey(iter, s, limit, arena, errorCode);
+        }
+        if(U_FAILURE(errorCode)) { return; }
+        if(!arena.EndKey()) {
+            errorCode = U_INDEX_OUTOFBOUNDS_ERROR;
+            return;
+        }
+    }
+    arena.Flush();
+    if(!arena.IsOk()) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    offsets[count] = arena.KeysLength();
+}
+
+void
+RuleBasedCollator::getSortKeysUTF8(const char *const sources[], const int32_t sourceLengths[],
+                                   int32_t count,
+                                   ByteSink &sink, int32_t offsets[],
+                                   UErrorCode &errorCode) const {
+    if(U_FAILURE(errorCode)) { return; }
+    if(count < 0 || (sources == NULL && count > 0) || offsets == NULL) {
+        errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+        return;
+    }
+    ArenaSortKeyByteSink arena(sink);
+    UBool numeric = settings->isNumeric();
+    UBool checkFCD = !settings->dontCheckFCD();
+    // The identical level is computed from UTF-16 text,
+    // so at identical strength each string is converted first.
+    UBool identical = settings->getStrength() == UCOL_IDENTICAL;
+    UTF8CollationIterator iter(data, numeric, NULL, 0, 0);
+    FCDUTF8CollationIterator fcdIter(data, numeric, NULL, 0, 0);
+    UTF16CollationIterator iter16(data, numeric, NULL, NULL, NULL);
+    FCDUTF16CollationIterator fcdIter16(data, numeric, NULL, NULL, NULL);
+    UnicodeString s16;
+    for(int32_t i = 0; i < count; ++i) {
+        offsets[i] = arena.KeysLength();
+        const uint8_t *s = reinterpret_cast<const uint8_t *>(sources[i]);
+        int32_t length = sourceLengths != NULL ? sourceLengths[i] : -1;
+        if(s == NULL && length != 0) {
+            errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+            return;
+        }
+        if(identical) {
+            if(length < 0) { length = (int32_t)uprv_strlen(sources[i]); }
+            // A UTF-8 string has at least as many bytes as it has UTF-16 code units.
+            UChar *buffer = s16.getBuffer(length);
+            if(buffer == NULL) {
+                errorCode = U_MEMORY_ALLOCATION_ERROR;
+                return;
+            }
+            // Same handling of ill-formed sequences as in the UTF-8 collation iterators.
+            int32_t length16 = 0;
+            for(int32_t j = 0; j < length;) {
+                UChar32 c;
+                U8_NEXT_OR_FFFD(s, j, length, c);
+                U16_APPEND_UNSAFE(buffer, length16, c);
+            }
+            s16.releaseBuffer(length16);
+            const UChar *start16 = s16.getBuffer();
+            const UChar *limit16 = start16 + length16;
+            if(checkFCD) {
+                fcdIter16.setText(start16, limit16);
+                writeSortKey(fcdIter16, start16, limit16, arena, errorCode);
+            } else {
+                iter16.setText(start16, limit16);
+                writeSortKey(iter16, start16, limit16, arena, errorCode);
+            }
+        } else if(checkFCD) {
+            fcdIter.setText(s, length);
+            writeSortKey(fcdIter, NULL, NULL, arena, errorCode);
+        } else {
+            iter.setText(s, length);
+            writeSortKey(iter, NULL, NULL, arena, errorCode);
+        }
+        if(U_FAILURE(errorCode)) { return; }
+        if(!arena.EndKey()) {
+            errorCode = U_INDEX_OUTOFBOUNDS_ERROR;
+            return;
+        }
+    }
+    arena.Flush();
+    if(!arena.IsOk()) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    offsets[count] = arena.KeysLength();
+}
+
+namespace {
+
+/**
+ * Appends sort keys to a CharString, for sorting via sort keys.
+ */
+class CharStringByteSink : public ByteSink {
+public:
+    CharStringByteSink(CharString &dest, UErrorCode &errorCode)
+            : dest_(dest), errorCode_(errorCode) {}
+    virtual ~CharStringByteSink();
+    virtual void Append(const char *bytes, int32_t n);
+
+private:
+    CharString &dest_;
+    UErrorCode &errorCode_;
+};
+
+CharStringByteSink::~CharStringByteSink() {}
+
+void
+CharStringByteSink::Append(const char *bytes, int32_t n) {
+    dest_.append(bytes, n, errorCode_);
+}
+
+/**
+ * Sorting a large array via sort keys is faster than sorting with comparisons,
+ * because each string is processed once rather than about log2(count) times.
+ * Below this count, comparisons with the fast Latin path win.
+ */
+const int32_t MIN_COUNT_FOR_SORT_KEYS = 1024;
+
+/**
+ * Comparison sort context: The strings with their lengths,
+ * and which ones contain only characters that the fast Latin path can handle.
+ */
+struct CollatorSortContext {
+    CollatorSortContext(const RuleBasedCollator &c, UErrorCode &ec)
+            : coll(c), sources(NULL), fastLatinTable(NULL), fastLatinPrimaries(NULL),
+              fastLatinOptions(-1), identical(FALSE), errorCode(ec) {}
+
+    const RuleBasedCollator &coll;
+    const void *sources;
+    MaybeStackArray<int32_t, 64> lengths;
+    MaybeStackArray<UBool, 64> isLatin;
+    const uint16_t *fastLatinTable;
+    const uint16_t *fastLatinPrimaries;
+    int32_t fastLatinOptions;
+    UBool identical;
+    UErrorCode &errorCode;
+};
+
+int32_t U_CALLCONV
+compareIndexedStrings(const void *context, const void *left, const void *right) {
+    const CollatorSortContext &sc = *static_cast<const CollatorSortContext *>(context);
+    const UChar *const *sources = static_cast<const UChar *const *>(sc.sources);
+    int32_t l = *static_cast<const int32_t *>(left);
+    int32_t r = *static_cast<const int32_t *>(right);
+    if(sc.fastLatinOptions >= 0 && sc.isLatin[l] && sc.isLatin[r]) {
+        int32_t result = CollationFastLatin::compareUTF16(sc.fastLatinTable,
+                                                          sc.fastLatinPrimaries,
+                                                          sc.fastLatinOptions,
+                                                          sources[l], sc.lengths[l],
+                                                          sources[r], sc.lengths[r]);
+        if(result != CollationFastLatin::BAIL_OUT_RESULT &&
+                (result != UCOL_EQUAL || !sc.identical)) {
+            return result;
+        }
+    }
+    return sc.coll.compare(sources[l], sc.lengths[l], sources[r], sc.lengths[r], sc.errorCode);
+}
+
+int32_t U_CALLCONV
+compareIndexedUTF8Strings(const void *context, const void *left, const void *right) {
+    const CollatorSortContext &sc = *static_cast<const CollatorSortContext *>(context);
+    const char *const *sources = static_cast<const char *const *>(sc.sources);
+    int32_t l = *static_cast<const int32_t *>(left);
+    int32_t r = *static_cast<const int32_t *>(right);
+    if(sc.fastLatinOptions >= 0 && sc.isLatin[l] && sc.isLatin[r]) {
+        int32_t result = CollationFastLatin::compareUTF8(
+                sc.fastLatinTable, sc.fastLatinPrimaries, sc.fastLatinOptions,
+                reinterpret_cast<const uint8_t *>(sources[l]), sc.lengths[l],
+                reinterpret_cast<const uint8_t *>(sources[r]), sc.lengths[r]);
+        if(result != CollationFastLatin::BAIL_OUT_RESULT &&
+                (result != UCOL_EQUAL || !sc.identical)) {
+            return result;
+        }
+    }
+    return sc.coll.internalCompareUTF8(sources[l], sc.lengths[l],
+                                       sources[r], sc.lengths[r], sc.errorCode);
+}
+
+}  // namespace
+
+void
+RuleBasedCollator::sort(const UChar *const sources[], const int32_t sourceLengths[],
+                        int32_t count, int32_t permutation[],
+                        UErrorCode &errorCode) const {
+    if(!CollationSort::initIndexes(sources, count, permutation, errorCode)) { return; }
+    if(count >= MIN_COUNT_FOR_SORT_KEYS) {
+        LocalMemory<int32_t> offsets((int32_t *)uprv_malloc((count + 1) * 4));
+        if(offsets.isNull()) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return;
+        }
+        CharString keys;
+        UErrorCode keysErrorCode = U_ZERO_ERROR;
+        CharStringByteSink sink(keys, keysErrorCode);
+        getSortKeys(sources, sourceLengths, count, sink, offsets.getAlias(), keysErrorCode);
+        if(U_SUCCESS(keysErrorCode)) {
+            CollationSort::sortIndexesByKeys(reinterpret_cast<const uint8_t *>(keys.data()),
+                                             offsets.getAlias(), permutation, count, errorCode);
+            return;
+        }
+        if(keysErrorCode != U_INDEX_OUTOFBOUNDS_ERROR) {
+            errorCode = keysErrorCode;
+            return;
+        }
+        // Too many key bytes for int32_t offsets: Sort with comparisons after all.
+    }
+    CollatorSortContext context(*this, errorCode);
+    context.sources = sources;
+    if(context.lengths.resize(count) == NULL || context.isLatin.resize(count) == NULL) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    context.fastLatinTable = data->fastLatinTable;
+    context.fastLatinPrimaries = settings->fastLatinPrimaries;
+    context.fastLatinOptions = settings->fastLatinOptions;
+    context.identical = settings->getStrength() == UCOL_IDENTICAL;
+    for(int32_t i = 0; i < count; ++i) {
+        const UChar *s = sources[i];
+        int32_t length = sourceLengths != NULL ? sourceLengths[i] : -1;
+        if(s == NULL && length != 0) {
+            errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+            return;
+        }
+        if(length < 0) { length = u_strlen(s); }
+        context.lengths[i] = length;
+        UBool isLatin = TRUE;
+        for(int32_t j = 0; j < length; ++j) {
+            if(s[j] > CollationFastLatin::LATIN_MAX) {
+                isLatin = FALSE;
+                break;
+            }
+        }
+        context.isLatin[i] = isLatin;
+    }
+    CollationSort::sortIndexes(permutation, count, compareIndexedStrings, &context, errorCode);
+}
+
+void
+RuleBasedCollator::sortUTF8(const char *const sources[], const int32_t sourceLengths[],
+                            int32_t count, int32_t permutation[],
+                            UErrorCode &errorCode) const {
+    if(!CollationSort::initIndexes(sources, count, permutation, errorCode)) { return; }
+    if(count >= MIN_COUNT_FOR_SORT_KEYS) {
+        LocalMemory<int32_t> offsets((int32_t *)uprv_malloc((count + 1) * 4));
+        if(offsets.isNull()) {
+            errorCode = U_MEMORY_ALLOCATION_ERROR;
+            return;
+        }
+        CharString keys;
+        UErrorCode keysErrorCode = U_ZERO_ERROR;
+        CharStringByteSink sink(keys, keysErrorCode);
+        getSortKeysUTF8(sources, sourceLengths, count, sink, offsets.getAlias(), keysErrorCode);
+        if(U_SUCCESS(keysErrorCode)) {
+            CollationSort::sortIndexesByKeys(reinterpret_cast<const uint8_t *>(keys.data()),
+                                             offsets.getAlias(), permutation, count, errorCode);
+            return;
+        }
+        if(keysErrorCode != U_INDEX_OUTOFBOUNDS_ERROR) {
+            errorCode = keysErrorCode;
+            return;
+        }
+        // Too many key bytes for int32_t offsets: Sort with comparisons after all.
+    }
+    CollatorSortContext context(*this, errorCode);
+    context.sources = sources;
+    if(context.lengths.resize(count) == NULL || context.isLatin.resize(count) == NULL) {
+        errorCode = U_MEMORY_ALLOCATION_ERROR;
+        return;
+    }
+    context.fastLatinTable = data->fastLatinTable;
+    context.fastLatinPrimaries = settings->fastLatinPrimaries;
+    context.fastLatinOptions = settings->fastLatinOptions;
+    context.identical = settings->getStrength() == UCOL_IDENTICAL;
+    for(int32_t i = 0; i < count; ++i) {
+        const uint8_t *s = reinterpret_cast<const uint8_t *>(sources[i]);
+        int32_t length = sourceLengths != NULL ? sourceLengths[i] : -1;
+        if(s == NULL && length != 0) {
+            errorCode = U_ILLEGAL_ARGUMENT_ERROR;
+            return;
+        }
+        if(length < 0) { length = (int32_t)uprv_strlen(sources[i]); }
+        context.lengths[i] = length;
+        UBool isLatin = TRUE;
+        for(int32_t j = 0; j < length; ++j) {
+            if(s[j] > CollationFastLatin::LATIN_MAX_UTF8_LEAD) {
+                isLatin = FALSE;
+                break;
+            }
+        }
+        context.isLatin[i] = isLatin;
+    }
+    CollationSort::sortIndexes(permutation, count, compareIndexedUTF8Strings, &context, errorCode);
+}
+
 void
 RuleBasedCollator::writeSortKey(const UChar *s, int32_t length,
                                 SortKeyByteSink &sink, UErrorCode &errorCode) const {
     if(U_FAILURE(errorCode)) { return; }
     const UChar *limit = (length >= 0) ? s + length : NULL;
     UBool numeric = settings->isNumeric();
-    CollationKeys::LevelCallback callback;
     if(settings->dontCheckFCD()) {
         UTF16CollationIterator iter(data, numeric, s, s, limit);
-        CollationKeys::writeSortKeyUpToQuaternary(iter, data->compressibleBytes, *settings,
-                                                  sink, Collation::PRIMARY_LEVEL,
-                                                  callback, TRUE, errorCode);
+        writeSortKey(iter, s, limit, sink, errorCode);
     } else {
         FCDUTF16CollationIterator iter(data, numeric, s, s, limit);
-        CollationKeys::writeSortKeyUpToQuaternary(iter, data->compressibleBytes, *settings,
-                                                  sink, Collation::PRIMARY_LEVEL,
-                                                  callback, TRUE, errorCode);
+        writeSortKey(iter, s, limit, sink, errorCode);
     }
+}
+
+void
+RuleBasedCollator::writeSortKey(CollationIterator &iter, const UChar *s, const UChar *limit,
+                                SortKeyByteSink &sink, UErrorCode &errorCode) const {
+    if(U_FAILURE(errorCode)) { return; }
+    CollationKeys::LevelCallback callback;
+    CollationKeys::writeSortKeyUpToQuaternary(iter, data->compressibleBytes, *settings,
+                                              sink, Collation::PRIMARY_LEVEL,
+                                              callback, TRUE, errorCode);
     if(settings->getStrength() == UCOL_IDENTICAL) {
         writeIdenticalLevel(s, limit, sink, errorCode);
     }
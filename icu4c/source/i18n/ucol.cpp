@@ -208,6 +208,60 @@ ucol_getSortKey(const    UCollator    *coll,
     return keySize;
 }
 
+U_CAPI int32_t U_EXPORT2
+ucol_getSortKeys(const UCollator *coll,
+                 const UChar *const *sources, const int32_t *sourceLengths,
+                 int32_t count,
+                 uint8_t *dest, int32_t destCapacity,
+                 int32_t *offsets,
+                 UErrorCode *status) {
+    if(U_FAILURE(*status)) { return 0; }
+    if(destCapacity < 0 || (dest == NULL && destCapacity > 0)) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    const RuleBasedCollator *rbc = RuleBasedCollator::rbcFromUCollator(coll);
+    if(rbc == NULL) {
+        *status = U_UNSUPPORTED_ERROR;
+        return 0;
+    }
+    CheckedArrayByteSink sink(reinterpret_cast<char *>(dest), destCapacity);
+    rbc->getSortKeys(sources, sourceLengths, count, sink, offsets, *status);
+    if(U_FAILURE(*status)) { return 0; }
+    int32_t length = sink.NumberOfBytesAppended();
+    if(length > destCapacity) {
+        *status = U_BUFFER_OVERFLOW_ERROR;
+    }
+    return length;
+}
+
+U_CAPI int32_t U_EXPORT2
+ucol_getSortKeysUTF8(const UCollator *coll,
+                     const char *const *sources, const int32_t *sourceLengths,
+                     int32_t count,
+                     uint8_t *dest, int32_t destCapacity,
+                     int32_t *offsets,
+                     UErrorCode *status) {
+    if(U_FAILURE(*status)) { return 0; }
+    if(destCapacity < 0 || (dest == NULL && destCapacity > 0)) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    const RuleBasedCollator *rbc = RuleBasedCollator::rbcFromUCollator(coll);
+    if(rbc == NULL) {
+        *status = U_UNSUPPORTED_ERROR;
+        return 0;
+    }
+    CheckedArrayByteSink sink(reinterpret_cast<char *>(dest), destCapacity);
+    rbc->getSortKeysUTF8(sources, sourceLengths, count, sink, offsets, *status);
+    if(U_FAILURE(*status)) { return 0; }
+    int32_t length = sink.NumberOfBytesAppended();
+    if(length > destCapacity) {
+        *status = U_BUFFER_OVERFLOW_ERROR;
+    }
+    return length;
+}
+
 U_CAPI int32_t U_EXPORT2
 ucol_nextSortKeyPart(const UCollator *coll,
                      UCharIterator *iter,
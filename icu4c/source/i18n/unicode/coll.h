@@ -1023,6 +1023,51 @@ public:
     virtual int32_t getSortKey(const UChar*source, int32_t sourceLength,
                                uint8_t*result, int32_t resultLength) const = 0;
 
+    /* Cannot use #ifndef U_HIDE_DRAFT_API for the following draft methods since they are virtual. */
+    /**
+     * Sorts an array of strings according to this Collator.
+     * The strings are not moved. Instead, the permutation array receives
+     * the indexes of the strings in sorted order:
+     * sources[permutation[0]] is the first string in collation order.
+     * The sort is stable: Indexes of equal strings stay in ascending order.
+     *
+     * This is faster than sorting with compare() as the comparison function.
+     * The implementation may generate sort keys for a large number of strings,
+     * but that does not change the resulting order.
+     *
+     * @param sources array of count strings
+     * @param sourceLengths array of count string lengths; a length of -1
+     *        means that the string is NUL-terminated.
+     *        If sourceLengths is NULL, then all of the strings are NUL-terminated.
+     * @param count number of strings
+     * @param permutation array of count indexes, receives the sorted order
+     * @param errorCode ICU error code in/out parameter.
+     *                  Must fulfill U_SUCCESS before the function call.
+     * @draft ICU 59
+     */
+    virtual void sort(const UChar *const sources[], const int32_t sourceLengths[],
+                      int32_t count, int32_t permutation[],
+                      UErrorCode &errorCode) const;
+
+    /**
+     * Sorts an array of UTF-8 strings according to this Collator,
+     * otherwise the same as the UTF-16 version of sort().
+     * The order is the same as with compareUTF8().
+     *
+     * @param sources array of count UTF-8 strings
+     * @param sourceLengths array of count string lengths in bytes; a length of -1
+     *        means that the string is NUL-terminated.
+     *        If sourceLengths is NULL, then all of the strings are NUL-terminated.
+     * @param count number of strings
+     * @param permutation array of count indexes, receives the sorted order
+     * @param errorCode ICU error code in/out parameter.
+     *                  Must fulfill U_SUCCESS before the function call.
+     * @draft ICU 59
+     */
+    virtual void sortUTF8(const char *const sources[], const int32_t sourceLengths[],
+                          int32_t count, int32_t permutation[],
+                          UErrorCode &errorCode) const;
+
     /**
      * Produce a bound for a given sortkey and a number of levels.
      * Return value is always the number of bytes needed, regardless of
@@ -63,8 +63,10 @@ U_NAMESPACE_BEGIN
 
 struct Regex8BitSet;
 class  RegexCImpl;
+class  RegexDFA;
 class  RegexMatcher;
 class  RegexPattern;
+class  RegexSpares;
 struct REStackFrame;
 class  RuleBasedBreakIterator;
 class  UnicodeSet;
@@ -221,6 +223,10 @@ public:
     *    from a pattern string instead of than separately compiling the pattern and
     *    then creating a RegexMatcher object from the pattern.</p>
     *
+    * <p>With the flag UREGEX_CACHE_PATTERN, the pattern is compiled only once
+    *    per process and kept in a cache, and this function returns a copy of the
+    *    cached pattern.</p>
+    *
     * @param regex The regular expression to be compiled.
     * @param flags The match mode flags to be used.
     * @param pe    Receives the position (line and column numbers) of any error
@@ -626,11 +632,20 @@ private:
     Regex8BitSet   *fInitialChars8;
     UBool           fNeedsAltInput;
 
+    UnicodeString   fRequiredLiteral;  // A string that the input must contain for
+                                       //   a match to be possible.  May be empty.
+
     UHashtable     *fNamedCaptureMap;  // Map from capture group names to numbers.
 
+    RegexSpares    *fSpares;       // Backtrack stacks and DFAs of deleted matchers,
+                                   //   for reuse by new matchers.
+
     friend class RegexCompile;
     friend class RegexMatcher;
     friend class RegexCImpl;
+    friend class RegexDFA;
+    friend class RegexLiteralFilter;
+    friend class RegexStreamMatcher;
 
     //
     //  Implementation Methods
@@ -1797,6 +1812,22 @@ private:
     void                 MatchChunkAt(int32_t startIdx, UBool toEnd, UErrorCode &status);
     UBool                isChunkWordBoundary(int32_t pos);
 
+    UBool                findUsingUTF8(UErrorCode &status);
+    void                 MatchUTF8At(int32_t startIdx, UBool toEnd, UErrorCode &status);
+    UBool                isUTF8WordBoundary(int32_t pos);
+
+    // Check for the pattern's required literal before searching for a match.
+    UBool                useRequiredLiteral() const;
+    UBool                requiredLiteralFound(const UChar *inputBuf, int32_t startPos);
+    UBool                requiredLiteralFound(const uint8_t *inputBuf, int32_t startPos);
+
+    // Linear-time matching with a DFA, for patterns that allow one.
+    RegexDFA            *getDFA();
+    int32_t              findUsingDFA(int64_t &startPos, int64_t testStartLimit, UErrorCode &status);
+    int32_t              matchesUsingDFA(int64_t startIdx, UErrorCode &status);
+    void                 setMatchFromDFA(int64_t matchStart, int64_t matchEnd, UBool hitEnd,
+                                         UErrorCode &status);
+
     const RegexPattern  *fPattern;
     RegexPattern        *fPatternOwned;    // Non-NULL if this matcher owns the pattern, and
                                            //   should delete it when through.
@@ -1806,6 +1837,9 @@ private:
     UText               *fAltInputText;    // A shallow copy of the text being matched.
                                            //   Only created if the pattern contains backreferences.
     int64_t              fInputLength;     // Full length of the input text.
+    const uint8_t       *fInputUTF8;       // The bytes of the input text when it is a UTF-8 UText,
+                                           //   for matching without going through the UText.
+                                           //   NULL for other input.
     int32_t              fFrameSize;       // The size of a frame in the backtrack stack.
     
     int64_t              fRegionStart;     // Start of the input region, default = 0.
@@ -1833,6 +1867,8 @@ private:
                                            //   is active.
     int64_t              fLastMatchEnd;    // First position after the end of the previous match,
                                            //   or -1 if there was no previous match.
+    int64_t              fRequiredLiteralPos;  // Where find() last found the pattern's required
+                                               //   literal, or -1.  See requiredLiteralFound().
     int64_t              fAppendPosition;  // First position after the end of the previous
                                            //   appendReplacement().  As described by the
                                            //   JavaDoc for Java Matcher, where it is called 
@@ -1878,6 +1914,9 @@ private:
                                            //   reported, or that permanently disables this matcher.
 
     RuleBasedBreakIterator  *fWordBreakItr;
+
+    RegexDFA           *fDFA;              // Lazily built DFA for the pattern, or NULL.
+    UBool               fDFAChecked;       // TRUE once the pattern has been checked for DFA support.
 };
 
 U_NAMESPACE_END
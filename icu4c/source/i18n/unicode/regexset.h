@@ -0,0 +1,205 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   Copyright (C) 2016, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*******************************************************************************
+*   file name:  regexset.h
+*   encoding:   US-ASCII
+*   indentation:4
+*
+*   ICU Regular Expressions, matching a set of patterns in one pass over the text.
+*/
+
+#ifndef REGEXSET_H
+#define REGEXSET_H
+
+#include "unicode/utypes.h"
+
+/**
+ * \file
+ * \brief C++ API: Find which of a set of regular expressions match a text.
+ */
+
+#if !UCONFIG_NO_REGULAR_EXPRESSIONS
+
+#include "unicode/uobject.h"
+#include "unicode/unistr.h"
+#include "unicode/parseerr.h"
+
+#ifndef U_HIDE_DRAFT_API
+
+U_NAMESPACE_BEGIN
+
+class RegexLiteralFilter;
+class RegexMatcher;
+class RegexPattern;
+class UVector;
+class UVector32;
+
+/**
+ * A RegexSet holds any number of regular expressions and finds out which of
+ * them match a text, without searching the text once per pattern.
+ *
+ * When a pattern is compiled, ICU finds the longest literal string that any
+ * match of the pattern must contain.  find() looks for the literal strings of
+ * all of the patterns at once, in a single pass over the text.  Only the
+ * patterns whose literal occurs, and the patterns that have no literal,
+ * are then searched for with their own RegexMatcher.
+ * The results are exactly those of calling RegexMatcher::find() for each pattern.
+ *
+ * Typical usage is
+ * <pre>
+ * \code
+ *     RegexSet set(status);
+ *     set.add(UNICODE_STRING_SIMPLE("colou?r"), 0, status);
+ *     set.add(UNICODE_STRING_SIMPLE("\\bflavou?r\\b"), UREGEX_CASE_INSENSITIVE, status);
+ *     if (set.find(text, status)) {
+ *         for (int32_t i = 0; i < set.getMatchCount(); i++) {
+ *             int32_t pattern = set.getMatch(i);
+ *             // set.start(i, status), set.end(i, status)
+ *         }
+ *     }
+ * \endcode
+ * </pre>
+ *
+ * A RegexSet keeps a matcher for each pattern, so it must not be used
+ * concurrently by multiple threads.
+ *
+ * This class is not intended for public subclassing.
+ * @draft ICU 59
+ */
+class U_I18N_API RegexSet U_FINAL : public UObject {
+public:
+    /**
+     * Constructs an empty set.
+     * @param status Receives any errors.
+     * @draft ICU 59
+     */
+    RegexSet(UErrorCode &status);
+
+    /**
+     * Destructor.
+     * @draft ICU 59
+     */
+    virtual ~RegexSet();
+
+    /**
+     * Compiles a regular expression and adds it to the set.
+     *
+     * @param regex The regular expression to be compiled.
+     * @param flags The URegexpFlag match mode flags to be used, as for RegexPattern::compile().
+     * @param pe Receives the position (line and column numbers) of any syntax error.
+     * @param status Receives any errors.
+     * @return The index of the pattern in the set, which find() reports for its matches,
+     *         or -1 if there was an error.
+     * @draft ICU 59
+     */
+    int32_t add(const UnicodeString &regex, uint32_t flags, UParseError &pe, UErrorCode &status);
+
+    /**
+     * Compiles a regular expression and adds it to the set.
+     *
+     * @param regex The regular expression to be compiled.
+     * @param flags The URegexpFlag match mode flags to be used, as for RegexPattern::compile().
+     * @param status Receives any errors.
+     * @return The index of the pattern in the set, or -1 if there was an error.
+     * @draft ICU 59
+     */
+    int32_t add(const UnicodeString &regex, uint32_t flags, UErrorCode &status);
+
+    /**
+     * Returns the number of patterns in the set.
+     * @return The number of patterns.
+     * @draft ICU 59
+     */
+    int32_t size() const;
+
+    /**
+     * Returns one of the patterns in the set.
+     * @param index The index of the pattern, as returned by add().
+     * @return The pattern, owned by the set, or NULL if the index is out of range.
+     * @draft ICU 59
+     */
+    const RegexPattern *getPattern(int32_t index) const;
+
+    /**
+     * Finds the patterns that match somewhere in a text, and the first match of each of them.
+     * The results of any previous call are replaced.
+     *
+     * @param input The text to search.
+     * @param status Receives any errors.
+     * @return TRUE if at least one of the patterns matched.
+     * @draft ICU 59
+     */
+    UBool find(const UnicodeString &input, UErrorCode &status);
+
+    /**
+     * Returns the number of patterns that matched in the last call to find().
+     * @return The number of patterns that matched.
+     * @draft ICU 59
+     */
+    int32_t getMatchCount() const;
+
+    /**
+     * Returns the index of a pattern that matched in the last call to find().
+     * The patterns are in ascending order of their indexes.
+     *
+     * @param matchIndex A number from 0 to getMatchCount()-1.
+     * @return The index of the pattern in the set, or -1 if matchIndex is out of range.
+     * @draft ICU 59
+     */
+    int32_t getMatch(int32_t matchIndex) const;
+
+    /**
+     * Returns the start index of the first match of a pattern that matched
+     * in the last call to find().
+     *
+     * @param matchIndex A number from 0 to getMatchCount()-1.
+     * @param status Set to U_INDEX_OUTOFBOUNDS_ERROR if matchIndex is out of range.
+     * @return The index in the input of the start of the match.
+     * @draft ICU 59
+     */
+    int32_t start(int32_t matchIndex, UErrorCode &status) const;
+
+    /**
+     * Returns the index following the end of the first match of a pattern that matched
+     * in the last call to find().
+     *
+     * @param matchIndex A number from 0 to getMatchCount()-1.
+     * @param status Set to U_INDEX_OUTOFBOUNDS_ERROR if matchIndex is out of range.
+     * @return The index in the input following the end of the match.
+     * @draft ICU 59
+     */
+    int32_t end(int32_t matchIndex, UErrorCode &status) const;
+
+    /**
+     * ICU "poor man's RTTI", returns a UClassID for the actual class.
+     * @draft ICU 59
+     */
+    virtual UClassID getDynamicClassID() const;
+
+    /**
+     * ICU "poor man's RTTI", returns a UClassID for this class.
+     * @draft ICU 59
+     */
+    static UClassID U_EXPORT2 getStaticClassID();
+
+private:
+    RegexSet(const RegexSet &other);             // forbid copying of this class
+    RegexSet &operator=(const RegexSet &other);  // forbid copying of this class
+
+    UVector            *fPatterns;      // The RegexPatterns, owned.
+    UVector            *fMatchers;      // A RegexMatcher for each pattern, owned.
+    RegexLiteralFilter *fFilter;        // The required literals of the patterns,
+                                        //   or NULL until the next find().
+    UVector32          *fMatches;       // From the last find(): triples of pattern index,
+                                        //   match start and match end.
+};
+
+U_NAMESPACE_END
+
+#endif  // U_HIDE_DRAFT_API
+#endif  // !UCONFIG_NO_REGULAR_EXPRESSIONS
+#endif
@@ -0,0 +1,263 @@
+// Copyright (C) 2016 and later: Unicode, Inc. and others.
+// License & terms of use: http://www.unicode.org/copyright.html
+/*
+*******************************************************************************
+*   Copyright (C) 2016, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+*******************************************************************************
+*   file name:  regexstream.h
+*   encoding:   US-ASCII
+*   indentation:4
+*
+*   ICU Regular Expressions, finding matches in text that arrives in pieces.
+*/
+
+#ifndef REGEXSTREAM_H
+#define REGEXSTREAM_H
+
+#include "unicode/utypes.h"
+
+/**
+ * \file
+ * \brief C++ API: Find regular expression matches in a stream of text.
+ */
+
+#if !UCONFIG_NO_REGULAR_EXPRESSIONS
+
+#include "unicode/uobject.h"
+#include "unicode/unistr.h"
+
+#ifndef U_HIDE_DRAFT_API
+
+U_NAMESPACE_BEGIN
+
+class RegexMatcher;
+class RegexPattern;
+
+/**
+ * A RegexStreamMatcher finds the matches of a regular expression in text that
+ * is supplied in pieces, such as data read from a network connection, without
+ * keeping all of the text.
+ *
+ * The text is added with append().  find() returns each match as soon as more
+ * text can no longer change it, with indexes counted from the start of the stream.
+ * The matcher keeps only the text from which a match could still start,
+ * and a little text before that for look-behind and word boundary tests.
+ * Once all of the text has been appended, finish() lets find() return
+ * the matches that extend to the end of the stream.
+ *
+ * The matches are those that RegexMatcher::find() would find in the whole text,
+ * as long as no match, and no unsuccessful match attempt, extends over more
+ * than getMaxPendingLength() code units.  Text older than that is dropped,
+ * which bounds the memory used for patterns like <code>.*</code>.
+ *
+ * Typical usage is
+ * <pre>
+ * \code
+ *     RegexStreamMatcher stream(*pattern, status);
+ *     while (readChunk(chunk)) {
+ *         stream.append(chunk, status);
+ *         while (stream.find(status)) {
+ *             report(stream.start(status), stream.end(status));
+ *         }
+ *     }
+ *     stream.finish(status);
+ *     while (stream.find(status)) {
+ *         report(stream.start(status), stream.end(status));
+ *     }
+ * \endcode
+ * </pre>
+ *
+ * This class is not intended for public subclassing.
+ * @draft ICU 59
+ */
+class U_I18N_API RegexStreamMatcher U_FINAL : public UObject {
+public:
+    /**
+     * Constructs a stream matcher for a compiled pattern.
+     * The pattern must not be deleted while the stream matcher exists.
+     *
+     * @param pattern The pattern to find.
+     * @param status Receives any errors.
+     * @draft ICU 59
+     */
+    RegexStreamMatcher(const RegexPattern &pattern, UErrorCode &status);
+
+    /**
+     * Destructor.
+     * @draft ICU 59
+     */
+    virtual ~RegexStreamMatcher();
+
+    /**
+     * Adds text at the end of the stream.
+     * Any match returned by the last find() is no longer available.
+     *
+     * @param text The next piece of the stream.
+     * @param status Receives any errors.  Set to U_REGEX_INVALID_STATE after finish().
+     * @draft ICU 59
+     */
+    void append(const UnicodeString &text, UErrorCode &status);
+
+    /**
+     * Adds text at the end of the stream.
+     * Any match returned by the last find() is no longer available.
+     *
+     * @param text The next piece of the stream.
+     * @param length The length of the text, or -1 if it is NUL-terminated.
+     * @param status Receives any errors.  Set to U_REGEX_INVALID_STATE after finish().
+     * @draft ICU 59
+     */
+    void append(const UChar *text, int32_t length, UErrorCode &status);
+
+    /**
+     * Marks the end of the stream.  Matches that more text could have changed
+     * are now returned by find().
+     *
+     * @param status Receives any errors.
+     * @draft ICU 59
+     */
+    void finish(UErrorCode &status);
+
+    /**
+     * Finds the next match in the stream that more text cannot change.
+     *
+     * @param status Receives any errors.
+     * @return TRUE if a match was found.  FALSE if there is none in the text
+     *         so far, or if the next one may still change with more text.
+     * @draft ICU 59
+     */
+    UBool find(UErrorCode &status);
+
+    /**
+     * Returns the index in the stream of the start of the match returned by find().
+     *
+     * @param status Set to U_REGEX_INVALID_STATE if there is no match.
+     * @return The index of the start of the match.
+     * @draft ICU 59
+     */
+    int64_t start(UErrorCode &status) const;
+
+    /**
+     * Returns the index in the stream of the start of a capture group
+     * in the match returned by find().
+     *
+     * @param groupNum The capture group number, or 0 for the whole match.
+     * @param status Set to U_REGEX_INVALID_STATE if there is no match,
+     *               or to U_INDEX_OUTOFBOUNDS_ERROR for a bad group number.
+     * @return The index of the start of the group, or -1 if the group did not participate.
+     * @draft ICU 59
+     */
+    int64_t start(int32_t groupNum, UErrorCode &status) const;
+
+    /**
+     * Returns the index in the stream following the end of the match returned by find().
+     *
+     * @param status Set to U_REGEX_INVALID_STATE if there is no match.
+     * @return The index following the end of the match.
+     * @draft ICU 59
+     */
+    int64_t end(UErrorCode &status) const;
+
+    /**
+     * Returns the index in the stream following the end of a capture group
+     * in the match returned by find().
+     *
+     * @param groupNum The capture group number, or 0 for the whole match.
+     * @param status Set to U_REGEX_INVALID_STATE if there is no match,
+     *               or to U_INDEX_OUTOFBOUNDS_ERROR for a bad group number.
+     * @return The index following the end of the group, or -1 if the group did not participate.
+     * @draft ICU 59
+     */
+    int64_t end(int32_t groupNum, UErrorCode &status) const;
+
+    /**
+     * Returns the text of a capture group in the match returned by find().
+     *
+     * @param groupNum The capture group number, or 0 for the whole match.
+     * @param status Set to U_REGEX_INVALID_STATE if there is no match,
+     *               or to U_INDEX_OUTOFBOUNDS_ERROR for a bad group number.
+     * @return The text of the group, which is empty if the group did not participate.
+     * @draft ICU 59
+     */
+    UnicodeString group(int32_t groupNum, UErrorCode &status) const;
+
+    /**
+     * Returns the number of capture groups in the pattern.
+     * @return The number of capture groups.
+     * @draft ICU 59
+     */
+    int32_t groupCount() const;
+
+    /**
+     * Sets the length of the longest match, or unsuccessful match attempt, that
+     * the stream matcher keeps text for.  The default is 0x10000 code units.
+     *
+     * @param length The maximum length in UTF-16 code units.
+     * @param status Set to U_ILLEGAL_ARGUMENT_ERROR if the length is less than 1.
+     * @draft ICU 59
+     */
+    void setMaxPendingLength(int32_t length, UErrorCode &status);
+
+    /**
+     * Returns the length of the longest match, or unsuccessful match attempt, that
+     * the stream matcher keeps text for.
+     * @return The maximum length in UTF-16 code units.
+     * @draft ICU 59
+     */
+    int32_t getMaxPendingLength() const;
+
+    /**
+     * Returns the index in the stream of the first position at which a match
+     * that find() has not returned yet could start.  The text before it
+     * does not need to be kept for this matcher.
+     * @return The index of the first undecided position.
+     * @draft ICU 59
+     */
+    int64_t getPendingStart() const;
+
+    /**
+     * Starts a new stream with the same pattern.
+     * @draft ICU 59
+     */
+    void reset();
+
+    /**
+     * ICU "poor man's RTTI", returns a UClassID for the actual class.
+     * @draft ICU 59
+     */
+    virtual UClassID getDynamicClassID() const;
+
+    /**
+     * ICU "poor man's RTTI", returns a UClassID for this class.
+     * @draft ICU 59
+     */
+    static UClassID U_EXPORT2 getStaticClassID();
+
+private:
+    RegexStreamMatcher(const RegexStreamMatcher &other);             // forbid copying of this class
+    RegexStreamMatcher &operator=(const RegexStreamMatcher &other);  // forbid copying of this class
+
+    void    skipDeadPositions(int32_t limit, UErrorCode &status);
+    int32_t nextCandidate(int32_t pos, int32_t limit) const;
+    UBool   checkGroup(int32_t groupNum, UErrorCode &status) const;
+
+    const RegexPattern *fPattern;      // Not owned.
+    RegexMatcher   *fMatcher;          // Matcher over fText, owned.
+    UnicodeString   fText;             // The text that is kept.
+    int64_t         fTextStart;        // The index in the stream of fText[0].
+    int32_t         fPos;              // The index in fText where the next find() starts.
+                                       //   fText.length()+1 after an empty match at
+                                       //   the end of the stream.
+    int32_t         fContextLength;    // The length of the text kept before fPos.
+    int32_t         fMaxPendingLength;
+    UBool           fTextChanged;      // fMatcher must be reset to fText.
+    UBool           fFinished;         // finish() was called.
+    UBool           fMatch;            // The last find() returned a match.
+};
+
+U_NAMESPACE_END
+
+#endif  // U_HIDE_DRAFT_API
+#endif  // !UCONFIG_NO_REGULAR_EXPRESSIONS
+#endif
@@ -85,6 +85,8 @@ class StringSearch;
 * @stable ICU 2.0
 */
 class CollationElementIterator;
+class ByteSink;
+class CollationIterator;
 class CollationKey;
 class SortKeyByteSink;
 class UnicodeSet;
@@ -649,6 +651,84 @@ public:
     virtual int32_t getSortKey(const UChar *source, int32_t sourceLength,
                                uint8_t *result, int32_t resultLength) const;
 
+    /**
+     * Sorts an array of strings according to this Collator.
+     * See Collator::sort() for details.
+     * Large arrays are sorted via their sort keys.
+     * @draft ICU 59
+     */
+    virtual void sort(const UChar *const sources[], const int32_t sourceLengths[],
+                      int32_t count, int32_t permutation[],
+                      UErrorCode &errorCode) const;
+
+    /**
+     * Sorts an array of UTF-8 strings according to this Collator.
+     * See Collator::sortUTF8() for details.
+     * @draft ICU 59
+     */
+    virtual void sortUTF8(const char *const sources[], const int32_t sourceLengths[],
+                          int32_t count, int32_t permutation[],
+                          UErrorCode &errorCode) const;
+
+#ifndef U_HIDE_DRAFT_API
+    /**
+     * Gets the sort keys for an array of UTF-16 strings.
+     * The keys are appended to the sink one after the other,
+     * each with its terminating zero byte, and are the same as those from getSortKey().
+     * Collation iterator state and key buffers are reused from one string to the next,
+     * and the sink receives the keys in large blocks,
+     * so that a growable sink (e.g., a StringByteSink) serves as an arena for the whole batch.
+     *
+     * The sort key for sources[i] has the bytes from offsets[i] to offsets[i+1]
+     * (exclusive), relative to the first byte this function appends.
+     *
+     * This function does not modify the collator and may be called concurrently,
+     * for example on separate parts of a large batch with separate sinks.
+     *
+     * @param sources array of count strings
+     * @param sourceLengths array of count string lengths; a length of -1
+     *        means that the string is NUL-terminated.
+     *        If sourceLengths is NULL, then all of the strings are NUL-terminated.
+     * @param count number of strings
+     * @param sink the sort key bytes are appended to this sink
+     * @param offsets array with room for count+1 offsets;
+     *        offsets[count] receives the total number of bytes appended
+     * @param errorCode ICU error code in/out parameter.
+     *                  Must fulfill U_SUCCESS before the function call.
+     *                  Set to U_INDEX_OUTOFBOUNDS_ERROR if the total length
+     *                  does not fit into an int32_t.
+     * @draft ICU 59
+     */
+    void getSortKeys(const UChar *const sources[], const int32_t sourceLengths[],
+                     int32_t count,
+                     ByteSink &sink, int32_t offsets[],
+                     UErrorCode &errorCode) const;
+
+    /**
+     * Gets the sort keys for an array of UTF-8 strings.
+     * Otherwise the same as the UTF-16 version of getSortKeys():
+     * The keys are the same as for the equivalent UTF-16 strings,
+     * with ill-formed UTF-8 sequences treated like U+FFFD as in compareUTF8().
+     *
+     * @param sources array of count UTF-8 strings
+     * @param sourceLengths array of count string lengths in bytes; a length of -1
+     *        means that the string is NUL-terminated.
+     *        If sourceLengths is NULL, then all of the strings are NUL-terminated.
+     * @param count number of strings
+     * @param sink the sort key bytes are appended to this sink
+     * @param offsets array with room for count+1 offsets;
+     *        offsets[count] receives the total number of bytes appended
+     * @param errorCode ICU error code in/out parameter.
+     *                  Must fulfill U_SUCCESS before the function call.
+     * @see getSortKeys
+     * @draft ICU 59
+     */
+    void getSortKeysUTF8(const char *const sources[], const int32_t sourceLengths[],
+                         int32_t count,
+                         ByteSink &sink, int32_t offsets[],
+                         UErrorCode &errorCode) const;
+#endif  /* U_HIDE_DRAFT_API */
+
     /**
      * Retrieves the reordering codes for this collator.
      * @param dest The array to fill with the script ordering.
@@ -831,6 +911,9 @@ private:
     void writeSortKey(const UChar *s, int32_t length,
                       SortKeyByteSink &sink, UErrorCode &errorCode) const;
 
+    void writeSortKey(CollationIterator &iter, const UChar *s, const UChar *limit,
+                      SortKeyByteSink &sink, UErrorCode &errorCode) const;
+
     void writeIdenticalLevel(const UChar *s, const UChar *limit,
                              SortKeyByteSink &sink, UErrorCode &errorCode) const;
 
@@ -1019,6 +1019,75 @@ ucol_getSortKey(const    UCollator    *coll,
         uint8_t        *result,
         int32_t        resultLength);
 
+#ifndef U_HIDE_DRAFT_API
+/**
+ * Gets the sort keys for an array of strings, written one after the other
+ * into a single buffer. Each key is the same as the one from ucol_getSortKey(),
+ * including its terminating zero byte.
+ * Collation iterator state is reused from one string to the next,
+ * which makes this faster than calling ucol_getSortKey() for each string.
+ *
+ * The sort key for sources[i] is at dest+offsets[i] and has
+ * offsets[i+1]-offsets[i] bytes.
+ * The offsets are set even if the keys do not all fit into dest,
+ * in which case U_BUFFER_OVERFLOW_ERROR is set and the caller can
+ * grow the buffer to the returned length and call this function again.
+ *
+ * This function may be called concurrently with the same collator.
+ *
+ * @param coll The UCollator containing the collation rules.
+ * @param sources array of count strings
+ * @param sourceLengths array of count string lengths; a length of -1
+ *        means that the string is NUL-terminated.
+ *        If sourceLengths is NULL, then all of the strings are NUL-terminated.
+ * @param count number of strings
+ * @param dest buffer for the sort keys, can be NULL if destCapacity==0
+ * @param destCapacity the number of bytes in the dest buffer
+ * @param offsets array with room for count+1 offsets
+ * @param status A pointer to a UErrorCode to receive any errors.
+ *        U_UNSUPPORTED_ERROR if coll is not a rule-based collator.
+ * @return the total length of the sort keys, same as offsets[count]
+ * @see ucol_getSortKey
+ * @draft ICU 59
+ */
+U_DRAFT int32_t U_EXPORT2
+ucol_getSortKeys(const UCollator *coll,
+                 const UChar *const *sources, const int32_t *sourceLengths,
+                 int32_t count,
+                 uint8_t *dest, int32_t destCapacity,
+                 int32_t *offsets,
+                 UErrorCode *status);
+
+/**
+ * Gets the sort keys for an array of UTF-8 strings, written one after the other
+ * into a single buffer.
+ * Otherwise the same as ucol_getSortKeys():
+ * The keys are the same as for the equivalent UTF-16 strings,
+ * with ill-formed UTF-8 sequences treated like U+FFFD as in ucol_strcollUTF8().
+ *
+ * @param coll The UCollator containing the collation rules.
+ * @param sources array of count UTF-8 strings
+ * @param sourceLengths array of count string lengths in bytes; a length of -1
+ *        means that the string is NUL-terminated.
+ *        If sourceLengths is NULL, then all of the strings are NUL-terminated.
+ * @param count number of strings
+ * @param dest buffer for the sort keys, can be NULL if destCapacity==0
+ * @param destCapacity the number of bytes in the dest buffer
+ * @param offsets array with room for count+1 offsets
+ * @param status A pointer to a UErrorCode to receive any errors.
+ * @return the total length of the sort keys, same as offsets[count]
+ * @see ucol_getSortKeys
+ * @draft ICU 59
+ */
+U_DRAFT int32_t U_EXPORT2
+ucol_getSortKeysUTF8(const UCollator *coll,
+                     const char *const *sources, const int32_t *sourceLengths,
+                     int32_t count,
+                     uint8_t *dest, int32_t destCapacity,
+                     int32_t *offsets,
+                     UErrorCode *status);
+#endif  /* U_HIDE_DRAFT_API */
+
 
 /** Gets the next count bytes of a sort key. Caller needs
  *  to preserve state array between calls and to provide
@@ -98,6 +98,18 @@ typedef enum URegexpFlag{
       */
     UREGEX_UWORD            = 256,
 
+#ifndef U_HIDE_DRAFT_API
+     /**  Share the compiled pattern.
+       *     If set, the pattern is compiled only once per process for each
+       *     combination of pattern string and other flags, and kept in a cache.
+       *     Opening a pattern that is already in the cache only creates a new
+       *     matcher for it.  This flag is not part of the flags of the
+       *     compiled pattern, as returned by uregex_flags().
+       *     @draft ICU 59
+       */
+     UREGEX_CACHE_PATTERN = 1024,
+#endif  /* U_HIDE_DRAFT_API */
+
      /**  Error on Unrecognized backslash escapes.
        *     If set, fail with an error on patterns that contain
        *     backslash-escaped ASCII letters without a known special
@@ -1610,5 +1622,115 @@ uregex_getFindProgressCallback(const URegularExpression          *regexp,
                                 const void                        **context,
                                 UErrorCode                        *status);
 
+#ifndef U_HIDE_DRAFT_API
+
+struct URegexSet;
+/**
+  * Structure representing a set of compiled regular expressions, for finding
+  * which of them match a text without searching the text once per pattern.
+  * See the C++ class icu::RegexSet.
+  * @draft ICU 59
+  */
+typedef struct URegexSet URegexSet;
+
+/**
+  *  Open an empty set of regular expressions.
+  *
+  * @param status   Receives error detected by this function.
+  * @return         The URegexSet object.  It must be closed with uregex_closeSet().
+  * @draft ICU 59
+  */
+U_DRAFT URegexSet * U_EXPORT2
+uregex_openSet(UErrorCode *status);
+
+/**
+  *  Close a set of regular expressions, recovering all resources it was holding.
+  *
+  * @param set   The set to be closed.
+  * @draft ICU 59
+  */
+U_DRAFT void U_EXPORT2
+uregex_closeSet(URegexSet *set);
+
+#if U_SHOW_CPLUSPLUS_API
+
+U_NAMESPACE_BEGIN
+
+/**
+ * \class LocalURegexSetPointer
+ * "Smart pointer" class, closes a URegexSet via uregex_closeSet().
+ * For most methods see the LocalPointerBase base class.
+ *
+ * @see LocalPointerBase
+ * @see LocalPointer
+ * @draft ICU 59
+ */
+U_DEFINE_LOCAL_OPEN_POINTER(LocalURegexSetPointer, URegexSet, uregex_closeSet);
+
+U_NAMESPACE_END
+
+#endif
+
+/**
+  *  Compile a regular expression and add it to a set.
+  *
+  * @param set           The set.
+  * @param pattern       The regular expression pattern to be compiled.
+  * @param patternLength The length of the pattern, or -1 if the pattern is
+  *                      NUL terminated.
+  * @param flags         Flags that alter the default matching behavior for
+  *                      the regular expression, UREGEX_CASE_INSENSITIVE, for
+  *                      example.  For default behavior, set this parameter to zero.
+  *                      See <code>enum URegexpFlag</code>.  All desired flags
+  *                      are bitwise-ORed together.
+  * @param pe            Receives the position (line and column numbers) of any syntax
+  *                      error within the source regular expression string.  If this
+  *                      information is not wanted, pass NULL for this parameter.
+  * @param status        Receives error detected by this function.
+  * @return              The index of the pattern in the set, which uregex_findInSet()
+  *                      reports for its matches, or -1 if there was an error.
+  * @draft ICU 59
+  */
+U_DRAFT int32_t U_EXPORT2
+uregex_addToSet(URegexSet       *set,
+                const UChar     *pattern,
+                int32_t          patternLength,
+                uint32_t         flags,
+                UParseError     *pe,
+                UErrorCode      *status);
+
+/**
+  *  Find the patterns of a set that match somewhere in a text, and the first
+  *  match of each of them, in a single pass over the text for the literal
+  *  strings that the patterns require.  The results are those of uregex_findNext()
+  *  with each pattern after uregex_setText().
+  *
+  * @param set           The set.
+  * @param text          The text to search.
+  * @param textLength    The length of the text, or -1 if the text is NUL terminated.
+  * @param indexes       Receives the indexes of the patterns that match, in ascending order.
+  *                      May be NULL if capacity is 0.
+  * @param starts        If not NULL, receives the start index of the first match of each
+  *                      of those patterns.
+  * @param limits        If not NULL, receives the index following the end of the first
+  *                      match of each of those patterns.
+  * @param capacity      The number of elements available in indexes, starts and limits.
+  * @param status        Receives error detected by this function.  Set to
+  *                      U_BUFFER_OVERFLOW_ERROR if more patterns match than fit.
+  * @return              The number of patterns that match.
+  * @draft ICU 59
+  */
+U_DRAFT int32_t U_EXPORT2
+uregex_findInSet(URegexSet      *set,
+                 const UChar    *text,
+                 int32_t         textLength,
+                 int32_t        *indexes,
+                 int32_t        *starts,
+                 int32_t        *limits,
+                 int32_t         capacity,
+                 UErrorCode     *status);
+
+#endif  /* U_HIDE_DRAFT_API */
+
 #endif   /*  !UCONFIG_NO_REGULAR_EXPRESSIONS  */
 #endif   /*  UREGEX_H  */
@@ -13,6 +13,7 @@
 #if !UCONFIG_NO_REGULAR_EXPRESSIONS
 
 #include "unicode/regex.h"
+#include "unicode/regexset.h"
 #include "unicode/uregex.h"
 #include "unicode/unistr.h"
 #include "unicode/ustring.h"
@@ -25,6 +26,7 @@
 #include "umutex.h"
 #include "uvectr32.h"
 
+#include "regexcache.h"
 #include "regextxt.h"
 
 U_NAMESPACE_BEGIN
@@ -37,6 +39,8 @@ public:
     ~RegularExpression();
     int32_t           fMagic;
     RegexPattern     *fPat;
+    const SharedRegexPattern *fSharedPat;   // The cache entry holding fPat, if
+                                            //   opened with UREGEX_CACHE_PATTERN.
     u_atomic_int32_t *fPatRefCount;
     UChar            *fPatString;
     int32_t           fPatStringLen;
@@ -52,6 +56,7 @@ static const int32_t REXP_MAGIC = 0x72657870; // "rexp" in ASCII
 RegularExpression::RegularExpression() {
     fMagic        = REXP_MAGIC;
     fPat          = NULL;
+    fSharedPat    = NULL;
     fPatRefCount  = NULL;
     fPatString    = NULL;
     fPatStringLen = 0;
@@ -65,7 +70,11 @@ RegularExpression::~RegularExpression() {
     delete fMatcher;
     fMatcher = NULL;
     if (fPatRefCount!=NULL && umtx_atomic_dec(fPatRefCount)==0) {
-        delete fPat;
+        if (fSharedPat != NULL) {
+            fSharedPat->removeRef();
+        } else {
+            delete fPat;
+        }
         uprv_free(fPatString);
         uprv_free((void *)fPatRefCount);
     }
@@ -100,6 +109,41 @@ static UBool validateRE(const RegularExpression *re, UBool requiresText, UErrorC
     return TRUE;
 }
 
+//----------------------------------------------------------------------------------------
+//
+//   compilePattern    Compile the pattern of a new RegularExpression from its copy of the
+//                     pattern string, or share the compiled pattern from the cache.
+//
+//----------------------------------------------------------------------------------------
+static void compilePattern(RegularExpression *re, uint32_t flags, UParseError *pe, UErrorCode *status) {
+    if (U_FAILURE(*status)) {
+        return;
+    }
+    if ((flags & UREGEX_CACHE_PATTERN) != 0) {
+        re->fSharedPat = SharedRegexPattern::getFromCache(
+            UnicodeString(TRUE, re->fPatString, re->fPatStringLen), flags, *status);
+        if (U_SUCCESS(*status)) {
+            re->fPat = const_cast<RegexPattern *>(&**re->fSharedPat);
+            return;
+        }
+        if (*status == U_MEMORY_ALLOCATION_ERROR) {
+            return;
+        }
+        // A syntax error.  Compile the pattern here, to report where the error is.
+        *status = U_ZERO_ERROR;
+        flags &= ~UREGEX_CACHE_PATTERN;
+    }
+
+    UText patText = UTEXT_INITIALIZER;
+    utext_openUChars(&patText, re->fPatString, re->fPatStringLen, status);
+    if (pe != NULL) {
+        re->fPat = RegexPattern::compile(&patText, flags, *pe, *status);
+    } else {
+        re->fPat = RegexPattern::compile(&patText, flags, *status);
+    }
+    utext_close(&patText);
+}
+
 //----------------------------------------------------------------------------------------
 //
 //    uregex_open
@@ -147,18 +191,10 @@ uregex_open( const  UChar          *pattern,
     u_memcpy(patBuf, pattern, actualPatLen);
     patBuf[actualPatLen] = 0;
 
-    UText patText = UTEXT_INITIALIZER;
-    utext_openUChars(&patText, patBuf, patternLength, status);
-
     //
     // Compile the pattern
     //
-    if (pe != NULL) {
-        re->fPat = RegexPattern::compile(&patText, flags, *pe, *status);
-    } else {
-        re->fPat = RegexPattern::compile(&patText, flags, *status);
-    }
-    utext_close(&patText);
+    compilePattern(re, flags, pe, status);
 
     if (U_FAILURE(*status)) {
         goto ErrorExit;
@@ -230,18 +266,10 @@ uregex_openUText(UText          *pattern,
     re->fPatStringLen = pattern16Length;
     utext_extract(pattern, 0, patternNativeLength, patBuf, pattern16Length+1, status);
 
-    UText patText = UTEXT_INITIALIZER;
-    utext_openUChars(&patText, patBuf, pattern16Length, status);
-
     //
     // Compile the pattern
     //
-    if (pe != NULL) {
-        re->fPat = RegexPattern::compile(&patText, flags, *pe, *status);
-    } else {
-        re->fPat = RegexPattern::compile(&patText, flags, *status);
-    }
-    utext_close(&patText);
+    compilePattern(re, flags, pe, status);
 
     if (U_FAILURE(*status)) {
         goto ErrorExit;
@@ -302,6 +330,7 @@ uregex_clone(const URegularExpression *source2, UErrorCode *status)  {
     }
 
     clone->fPat          = source->fPat;
+    clone->fSharedPat    = source->fSharedPat;
     clone->fPatRefCount  = source->fPatRefCount;
     clone->fPatString    = source->fPatString;
     clone->fPatStringLen = source->fPatStringLen;
@@ -1973,5 +2002,101 @@ uregex_splitUText(URegularExpression    *regexp2,
 }
 
 
+//------------------------------------------------------------------------------
+//
+//    uregex_openSet, uregex_closeSet
+//
+//------------------------------------------------------------------------------
+U_CAPI URegexSet * U_EXPORT2
+uregex_openSet(UErrorCode *status) {
+    if (U_FAILURE(*status)) {
+        return NULL;
+    }
+    RegexSet *set = new RegexSet(*status);
+    if (set == NULL) {
+        *status = U_MEMORY_ALLOCATION_ERROR;
+        return NULL;
+    }
+    if (U_FAILURE(*status)) {
+        delete set;
+        return NULL;
+    }
+    return (URegexSet *)set;
+}
+
+
+U_CAPI void U_EXPORT2
+uregex_closeSet(URegexSet *set) {
+    delete (RegexSet *)set;
+}
+
+
+//------------------------------------------------------------------------------
+//
+//    uregex_addToSet
+//
+//------------------------------------------------------------------------------
+U_CAPI int32_t U_EXPORT2
+uregex_addToSet(URegexSet       *set,
+                const UChar     *pattern,
+                int32_t          patternLength,
+                uint32_t         flags,
+                UParseError     *pe,
+                UErrorCode      *status) {
+    if (U_FAILURE(*status)) {
+        return -1;
+    }
+    if (set == NULL || pattern == NULL || patternLength < -1 || patternLength == 0) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return -1;
+    }
+    UnicodeString patString(patternLength == -1, pattern, patternLength);
+    UParseError localPe;
+    return ((RegexSet *)set)->add(patString, flags, pe != NULL ? *pe : localPe, *status);
+}
+
+
+//------------------------------------------------------------------------------
+//
+//    uregex_findInSet
+//
+//------------------------------------------------------------------------------
+U_CAPI int32_t U_EXPORT2
+uregex_findInSet(URegexSet      *set2,
+                 const UChar    *text,
+                 int32_t         textLength,
+                 int32_t        *indexes,
+                 int32_t        *starts,
+                 int32_t        *limits,
+                 int32_t         capacity,
+                 UErrorCode     *status) {
+    if (U_FAILURE(*status)) {
+        return 0;
+    }
+    if (set2 == NULL || (text == NULL && textLength != 0) || textLength < -1 ||
+            capacity < 0 || (indexes == NULL && capacity > 0)) {
+        *status = U_ILLEGAL_ARGUMENT_ERROR;
+        return 0;
+    }
+    RegexSet *set = (RegexSet *)set2;
+    UnicodeString input(textLength == -1, text, textLength);
+    set->find(input, *status);
+    int32_t count = set->getMatchCount();
+    for (int32_t i = 0; i < count && i < capacity && U_SUCCESS(*status); i++) {
+        indexes[i] = set->getMatch(i);
+        if (starts != NULL) {
+            starts[i] = set->start(i, *status);
+        }
+        if (limits != NULL) {
+            limits[i] = set->end(i, *status);
+        }
+    }
+    if (U_SUCCESS(*status) && count > capacity) {
+        *status = U_BUFFER_OVERFLOW_ERROR;
+    }
+    return count;
+}
+
+
 #endif   // !UCONFIG_NO_REGULAR_EXPRESSIONS
 
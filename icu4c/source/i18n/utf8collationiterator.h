@@ -44,6 +44,13 @@ public:
 
     virtual int32_t getOffset() const;
 
+    void setText(const uint8_t *s, int32_t len) {
+        reset();
+        u8 = s;
+        pos = 0;
+        length = len;
+    }
+
     virtual UChar32 nextCodePoint(UErrorCode &errorCode);
 
     virtual UChar32 previousCodePoint(UErrorCode &errorCode);
@@ -91,6 +98,12 @@ public:
 
     virtual int32_t getOffset() const;
 
+    void setText(const uint8_t *s, int32_t len) {
+        UTF8CollationIterator::setText(s, len);
+        state = CHECK_FWD;
+        start = 0;
+    }
+
     virtual UChar32 nextCodePoint(UErrorCode &errorCode);
 
     virtual UChar32 previousCodePoint(UErrorCode &errorCode);
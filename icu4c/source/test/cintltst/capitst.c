@@ -89,6 +89,7 @@ void addCollAPITest(TestNode** root)
     addTest(root, &TestBengaliSortKey, "tscoll/capitst/TestBengaliSortKey");
     addTest(root, &TestGetKeywordValuesForLocale, "tscoll/capitst/TestGetKeywordValuesForLocale");
     addTest(root, &TestStrcollNull, "tscoll/capitst/TestStrcollNull");
+    addTest(root, &TestGetSortKeys, "tscoll/capitst/TestGetSortKeys");
 }
 
 void TestGetSetAttr(void) {
@@ -2560,4 +2561,59 @@ static void TestStrcollNull(void) {
     ucol_close(coll);
 }
 
+static void TestGetSortKeys(void) {
+    static const UChar a[] = { 0x61, 0x62, 0x63, 0 };
+    static const UChar b[] = { 0x41, 0x300, 0x62, 0 };
+    static const UChar c[] = { 0x5c71, 0x5ddd, 0 };
+    static const char *const u8[] = { "abc", "A\xCC\x80" "b", "\xE5\xB1\xB1\xE5\xB7\x9D" };
+    const UChar *sources[3];
+    int32_t lengths[3] = { 3, -1, 2 };
+    int32_t offsets[4], offsets8[4];
+    uint8_t keys[200], keys8[200], key[100];
+    int32_t i, length, length8, keyLength;
+    UErrorCode status = U_ZERO_ERROR;
+    UCollator *coll = ucol_open("", &status);
+    if (U_FAILURE(status)) {
+        log_err_status(status, "Default Collator creation failed.: %s\n", myErrorName(status));
+        return;
+    }
+    sources[0] = a;
+    sources[1] = b;
+    sources[2] = c;
+
+    /* preflighting */
+    length = ucol_getSortKeys(coll, sources, lengths, 3, NULL, 0, offsets, &status);
+    if (status != U_BUFFER_OVERFLOW_ERROR || length != offsets[3] || length <= 0) {
+        log_err("ucol_getSortKeys(preflighting) = %d, %s\n", length, myErrorName(status));
+    }
+    status = U_ZERO_ERROR;
+    length = ucol_getSortKeys(coll, sources, lengths, 3, keys, UPRV_LENGTHOF(keys), offsets, &status);
+    if (U_FAILURE(status) || length != offsets[3] || offsets[0] != 0) {
+        log_err("ucol_getSortKeys() = %d, %s\n", length, myErrorName(status));
+        ucol_close(coll);
+        return;
+    }
+    for (i = 0; i < 3; ++i) {
+        keyLength = ucol_getSortKey(coll, sources[i], lengths[i], key, UPRV_LENGTHOF(key));
+        if (keyLength != offsets[i + 1] - offsets[i] ||
+                uprv_memcmp(key, keys + offsets[i], keyLength) != 0) {
+            log_err("ucol_getSortKeys()[%d] != ucol_getSortKey()\n", i);
+        }
+    }
+
+    length8 = ucol_getSortKeysUTF8(coll, u8, NULL, 3, keys8, UPRV_LENGTHOF(keys8), offsets8, &status);
+    if (U_FAILURE(status) || length8 != length ||
+            uprv_memcmp(offsets8, offsets, sizeof(offsets)) != 0 ||
+            uprv_memcmp(keys8, keys, length) != 0) {
+        log_err("ucol_getSortKeysUTF8() != ucol_getSortKeys() - %s\n", myErrorName(status));
+    }
+
+    status = U_ZERO_ERROR;
+    ucol_getSortKeys(coll, sources, lengths, 3, keys, -1, offsets, &status);
+    if (status != U_ILLEGAL_ARGUMENT_ERROR) {
+        log_err("ucol_getSortKeys(destCapacity<0) did not fail - %s\n", myErrorName(status));
+    }
+    ucol_close(coll);
+}
+
 #endif /* #if !UCONFIG_NO_COLLATION */
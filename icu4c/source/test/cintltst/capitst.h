@@ -137,6 +137,11 @@
      */
     static void TestStrcollNull(void);
 
+    /**
+     * Test batch sort key generation
+     */
+    static void TestGetSortKeys(void);
+
 #endif /* #if !UCONFIG_NO_COLLATION */
 
 #endif
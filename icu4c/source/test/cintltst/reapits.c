@@ -162,6 +162,8 @@ static void TestUTextAPI(void);
 static void TestRefreshInput(void);
 static void TestBug8421(void);
 static void TestBug10815(void);
+static void TestRegexSet(void);
+static void TestCachedPattern(void);
 
 void addURegexTest(TestNode** root);
 
@@ -173,6 +175,8 @@ void addURegexTest(TestNode** root)
     addTest(root, &TestRefreshInput, "regex/TestRefreshInput");
     addTest(root, &TestBug8421,   "regex/TestBug8421");
     addTest(root, &TestBug10815,   "regex/TestBug10815");
+    addTest(root, &TestRegexSet,   "regex/TestRegexSet");
+    addTest(root, &TestCachedPattern, "regex/TestCachedPattern");
 }
 
 /*
@@ -2306,4 +2310,136 @@ static void TestBug10815() {
 }
 
     
+static void TestRegexSet(void) {
+    UErrorCode status = U_ZERO_ERROR;
+    URegexSet *set;
+    UChar      pat[30];
+    UChar      text[60];
+    int32_t    indexes[3];
+    int32_t    starts[3];
+    int32_t    limits[3];
+    int32_t    count;
+
+    set = uregex_openSet(&status);
+    TEST_ASSERT_SUCCESS(status);
+    u_uastrncpy(pat, "colou?r", UPRV_LENGTHOF(pat));
+    TEST_ASSERT(uregex_addToSet(set, pat, -1, 0, NULL, &status) == 0);
+    u_uastrncpy(pat, "fl[ae]vou?r", UPRV_LENGTHOF(pat));
+    TEST_ASSERT(uregex_addToSet(set, pat, -1, UREGEX_CASE_INSENSITIVE, NULL, &status) == 1);
+    u_uastrncpy(pat, "quick", UPRV_LENGTHOF(pat));
+    TEST_ASSERT(uregex_addToSet(set, pat, -1, 0, NULL, &status) == 2);
+    u_uastrncpy(pat, "b(?:a|o)x", UPRV_LENGTHOF(pat));
+    TEST_ASSERT(uregex_addToSet(set, pat, -1, 0, NULL, &status) == 3);
+    TEST_ASSERT_SUCCESS(status);
+
+    u_uastrncpy(text, "The color and FLAVOUR of the box.", UPRV_LENGTHOF(text));
+    count = uregex_findInSet(set, text, -1, indexes, starts, limits, UPRV_LENGTHOF(indexes), &status);
+    TEST_ASSERT_SUCCESS(status);
+    TEST_ASSERT(count == 3);
+    TEST_ASSERT(indexes[0] == 0 && starts[0] == 4 && limits[0] == 9);
+    TEST_ASSERT(indexes[1] == 1 && starts[1] == 14 && limits[1] == 21);
+    TEST_ASSERT(indexes[2] == 3 && starts[2] == 29 && limits[2] == 32);
+
+    /* Preflighting, and no spans. */
+    count = uregex_findInSet(set, text, -1, NULL, NULL, NULL, 0, &status);
+    TEST_ASSERT(status == U_BUFFER_OVERFLOW_ERROR);
+    TEST_ASSERT(count == 3);
+    status = U_ZERO_ERROR;
+    count = uregex_findInSet(set, text, 9, indexes, NULL, NULL, 1, &status);
+    TEST_ASSERT_SUCCESS(status);
+    TEST_ASSERT(count == 1 && indexes[0] == 0);
+
+    /* No match. */
+    count = uregex_findInSet(set, text, 0, indexes, starts, limits, UPRV_LENGTHOF(indexes), &status);
+    TEST_ASSERT_SUCCESS(status);
+    TEST_ASSERT(count == 0);
+
+    /* A syntax error does not change the set. */
+    u_uastrncpy(pat, "(quick", UPRV_LENGTHOF(pat));
+    TEST_ASSERT(uregex_addToSet(set, pat, -1, 0, NULL, &status) == -1);
+    TEST_ASSERT(status == U_REGEX_MISMATCHED_PAREN);
+    status = U_ZERO_ERROR;
+    u_uastrncpy(text, "quick", UPRV_LENGTHOF(text));
+    count = uregex_findInSet(set, text, -1, indexes, starts, limits, UPRV_LENGTHOF(indexes), &status);
+    TEST_ASSERT_SUCCESS(status);
+    TEST_ASSERT(count == 1 && indexes[0] == 2 && starts[0] == 0 && limits[0] == 5);
+
+    uregex_closeSet(set);
+}
+
+/*
+ *  TestCachedPattern   Patterns opened with UREGEX_CACHE_PATTERN match the same
+ *                      as patterns compiled for themselves.
+ */
+static void TestCachedPattern(void) {
+    UErrorCode          status = U_ZERO_ERROR;
+    UParseError         pe;
+    UChar               pat[20];
+    UChar               text[50];
+    URegularExpression *re1;
+    URegularExpression *re2;
+    URegularExpression *clone;
+    URegularExpression *plain;
+    int32_t             i;
+
+    u_uastrncpy(pat, "(\\w+)@(\\w+)", UPRV_LENGTHOF(pat));
+    u_uastrncpy(text, "mail bob@example or ALICE@host", UPRV_LENGTHOF(text));
+
+    re1 = uregex_open(pat, -1, UREGEX_CACHE_PATTERN | UREGEX_CASE_INSENSITIVE, &pe, &status);
+    re2 = uregex_open(pat, -1, UREGEX_CACHE_PATTERN | UREGEX_CASE_INSENSITIVE, NULL, &status);
+    plain = uregex_open(pat, -1, UREGEX_CASE_INSENSITIVE, NULL, &status);
+    TEST_ASSERT_SUCCESS(status);
+
+    /* The cache flag is not part of the pattern's flags. */
+    TEST_ASSERT(uregex_flags(re1, &status) == UREGEX_CASE_INSENSITIVE);
+    TEST_ASSERT(uregex_pattern(re1, NULL, &status) != pat);
+
+    /* Matchers of the shared pattern are independent. */
+    uregex_setText(re1, text, -1, &status);
+    uregex_setText(re2, text, -1, &status);
+    uregex_setText(plain, text, -1, &status);
+    TEST_ASSERT(uregex_findNext(re1, &status));
+    TEST_ASSERT(uregex_findNext(re1, &status));
+    TEST_ASSERT(uregex_findNext(re2, &status));
+    TEST_ASSERT(uregex_findNext(plain, &status));
+    TEST_ASSERT(uregex_findNext(plain, &status));
+    TEST_ASSERT(uregex_start(re1, 2, &status) == uregex_start(plain, 2, &status));
+    TEST_ASSERT(uregex_end(re1, 2, &status) == 30);
+    TEST_ASSERT(uregex_start(re2, 1, &status) == 5 && uregex_end(re2, 1, &status) == 8);
+    TEST_ASSERT_SUCCESS(status);
+
+    /* Clones, and closing the openers in any order. */
+    clone = uregex_clone(re2, &status);
+    uregex_close(re2);
+    uregex_close(re1);
+    uregex_setText(clone, text, -1, &status);
+    TEST_ASSERT(uregex_matches(clone, 5, &status) == FALSE);
+    TEST_ASSERT(uregex_lookingAt(clone, 5, &status));
+    TEST_ASSERT(uregex_end(clone, 0, &status) == 16);
+    TEST_ASSERT_SUCCESS(status);
+    uregex_close(clone);
+
+    /* Different flags are different patterns. */
+    re1 = uregex_open(pat, -1, UREGEX_CACHE_PATTERN, NULL, &status);
+    uregex_setText(re1, text, -1, &status);
+    TEST_ASSERT(uregex_flags(re1, &status) == 0);
+    TEST_ASSERT(uregex_findNext(re1, &status));
+    TEST_ASSERT(uregex_findNext(re1, &status));
+    TEST_ASSERT_SUCCESS(status);
+    uregex_close(re1);
+    uregex_close(plain);
+
+    /* Syntax errors are reported as without the cache, and again for each open. */
+    u_uastrncpy(pat, "abc(de", UPRV_LENGTHOF(pat));
+    for (i = 0; i < 2; i++) {
+        pe.line = -2;
+        pe.offset = -2;
+        re1 = uregex_open(pat, -1, UREGEX_CACHE_PATTERN, &pe, &status);
+        TEST_ASSERT(re1 == NULL);
+        TEST_ASSERT(status == U_REGEX_MISMATCHED_PAREN);
+        TEST_ASSERT(pe.line == 1 && pe.offset == 6);
+        status = U_ZERO_ERROR;
+    }
+}
+
 #endif   /*  !UCONFIG_NO_REGULAR_EXPRESSIONS */
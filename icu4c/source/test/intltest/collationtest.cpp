@@ -15,6 +15,7 @@
 
 #if !UCONFIG_NO_COLLATION
 
+#include "unicode/bytestream.h"
 #include "unicode/coll.h"
 #include "unicode/errorcode.h"
 #include "unicode/localpointer.h"
@@ -71,6 +72,7 @@ public:
     void TestImplicits();
     void TestNulTerminated();
     void TestIllegalUTF8();
+    void TestBatchSortKeys();
     void TestShortFCDData();
     void TestFCD();
     void TestCollationWeights();
@@ -141,6 +143,7 @@ void CollationTest::runIndexedTest(int32_t index, UBool exec, const char *&name,
     TESTCASE_AUTO(TestImplicits);
     TESTCASE_AUTO(TestNulTerminated);
     TESTCASE_AUTO(TestIllegalUTF8);
+    TESTCASE_AUTO(TestBatchSortKeys);
     TESTCASE_AUTO(TestShortFCDData);
     TESTCASE_AUTO(TestFCD);
     TESTCASE_AUTO(TestCollationWeights);
@@ -317,6 +320,124 @@ void CollationTest::TestIllegalUTF8() {
     }
 }
 
+void CollationTest::TestBatchSortKeys() {
+    IcuTestErrorCode errorCode(*this, "TestBatchSortKeys");
+
+    setRootCollator(errorCode);
+    if(errorCode.isFailure()) {
+        errorCode.reset();
+        return;
+    }
+    RuleBasedCollator *rbc = dynamic_cast<RuleBasedCollator *>(coll);
+    if(rbc == NULL) {
+        errln("the root collator is not a RuleBasedCollator");
+        return;
+    }
+
+    static const char *const strings[] = {
+        "",
+        "abc",
+        "ABC",
+        "a\\u0323\\u0302",  // not FCD
+        "\\u1EAD",
+        "x12y",
+        "x9y",
+        "\\uD800\\uDC00\\u4E00",
+        "\\uFFFD"
+    };
+    // Repeat the strings so that the keys span several arena blocks.
+    const int32_t count = 3000;
+    UnicodeString s16[count];
+    std::string s8[count];
+    const UChar *sources16[count];
+    const char *sources8[count];
+    int32_t lengths16[count], lengths8[count];
+    for(int32_t i = 0; i < count; ++i) {
+        s16[i] = UnicodeString(strings[i % UPRV_LENGTHOF(strings)], -1, US_INV).unescape();
+        if(i >= UPRV_LENGTHOF(strings)) {
+            s16[i].append((UChar)(0x61 + i % 26));
+        }
+        s16[i].toUTF8String(s8[i]);
+        sources16[i] = s16[i].getTerminatedBuffer();
+        sources8[i] = s8[i].c_str();
+        // Use NUL-terminated strings for every third one.
+        lengths16[i] = (i % 3) == 2 ? -1 : s16[i].length();
+        lengths8[i] = (i % 3) == 2 ? -1 : (int32_t)s8[i].length();
+    }
+
+    static const UColAttributeValue strengths[] = {
+        UCOL_PRIMARY, UCOL_SECONDARY, UCOL_TERTIARY, UCOL_QUATERNARY, UCOL_IDENTICAL
+    };
+    int32_t offsets[count + 1];
+    for(int32_t si = 0; si < UPRV_LENGTHOF(strengths); ++si) {
+        for(int32_t options = 0; options < 4; ++options) {
+            coll->setAttribute(UCOL_STRENGTH, strengths[si], errorCode);
+            coll->setAttribute(UCOL_NORMALIZATION_MODE,
+                               (options & 1) ? UCOL_ON : UCOL_OFF, errorCode);
+            coll->setAttribute(UCOL_NUMERIC_COLLATION,
+                               (options & 2) ? UCOL_ON : UCOL_OFF, errorCode);
+            std::string keys16, keys8;
+            StringByteSink<std::string> sink16(&keys16);
+            rbc->getSortKeys(sources16, lengths16, count, sink16, offsets, errorCode);
+            if(errorCode.logIfFailureAndReset("getSortKeys(strength %d options %d)",
+                                              (int)si, (int)options)) {
+                return;
+            }
+            if(offsets[count] != (int32_t)keys16.length()) {
+                errln("getSortKeys(strength %d options %d) offsets[count]=%d != %d bytes appended",
+                      (int)si, (int)options, (int)offsets[count], (int)keys16.length());
+                return;
+            }
+            for(int32_t i = 0; i < count; ++i) {
+                uint8_t key[100];
+                int32_t keyLength = rbc->getSortKey(s16[i], key, UPRV_LENGTHOF(key));
+                if(keyLength != (offsets[i + 1] - offsets[i]) ||
+                        uprv_memcmp(key, keys16.data() + offsets[i], keyLength) != 0) {
+                    errln("getSortKeys(strength %d options %d)[%d] != getSortKey()",
+                          (int)si, (int)options, (int)i);
+                    return;
+                }
+            }
+            StringByteSink<std::string> sink8(&keys8);
+            rbc->getSortKeysUTF8(sources8, lengths8, count, sink8, offsets, errorCode);
+            if(errorCode.logIfFailureAndReset("getSortKeysUTF8(strength %d options %d)",
+                                              (int)si, (int)options)) {
+                return;
+            }
+            if(keys8 != keys16) {
+                errln("getSortKeysUTF8(strength %d options %d) != getSortKeys() of UTF-16 strings",
+                      (int)si, (int)options);
+            }
+        }
+    }
+
+    // Ill-formed UTF-8 is treated like U+FFFD, as in compareUTF8().
+    static const char *const utf8[] = {
+        "a\xef\xbf\xbdz",  // U+FFFD
+        "a\x80z",  // trail byte
+        "a\xed\xa0\x80z"  // lead surrogate
+    };
+    std::string keys;
+    StringByteSink<std::string> sink(&keys);
+    rbc->getSortKeysUTF8(utf8, NULL, UPRV_LENGTHOF(utf8), sink, offsets, errorCode);
+    errorCode.assertSuccess();
+    for(int32_t i = 1; i < UPRV_LENGTHOF(utf8); ++i) {
+        if((offsets[i + 1] - offsets[i]) != offsets[1] ||
+                uprv_memcmp(keys.data() + offsets[i], keys.data(), offsets[1]) != 0) {
+            errln("getSortKeysUTF8(string %d with illegal UTF-8) != key for U+FFFD", (int)i);
+        }
+    }
+
+    // A fixed-capacity sink receives only what fits, but the offsets are all set.
+    char small[20];
+    CheckedArrayByteSink checked(small, UPRV_LENGTHOF(small));
+    rbc->getSortKeys(sources16, lengths16, 10, checked, offsets, errorCode);
+    errorCode.assertSuccess();
+    assertTrue("fixed sink overflowed", checked.Overflowed());
+    assertEquals("fixed sink total length",
+                 checked.NumberOfBytesAppended(), offsets[10]);
+}
+
 namespace {
 
 void addLeadSurrogatesForSupplementary(const UnicodeSet &src, UnicodeSet &dest) {
@@ -19,6 +19,7 @@
 #include <string.h>
 
 #include "unicode/brkiter.h"
+#include "unicode/brkpart.h"
 #include "unicode/localpointer.h"
 #include "unicode/numfmt.h"
 #include "unicode/rbbi.h"
@@ -27,8 +28,10 @@
 #endif
 #include "unicode/schriter.h"
 #include "unicode/uchar.h"
+#include "unicode/ucharstriebuilder.h"
 #include "unicode/utf16.h"
 #include "unicode/ucnv.h"
+#include "unicode/udata.h"
 #include "unicode/uniset.h"
 #include "unicode/uscript.h"
 #include "unicode/ustring.h"
@@ -37,8 +40,11 @@
 #include "charstr.h"
 #include "cmemory.h"
 #include "intltest.h"
+#include "rbbidata.h"
 #include "rbbitst.h"
+#include "simplethread.h"
 #include "utypeinfo.h"  // for 'typeid' to work
+#include "ustr_imp.h"
 #include "uvector.h"
 #include "uvectr32.h"
 
@@ -103,6 +109,11 @@ void RBBITest::runIndexedTest( int32_t index, UBool exec, const char* &name, cha
     TESTCASE_AUTO(TestBug5532);
     TESTCASE_AUTO(TestBug7547);
     TESTCASE_AUTO(TestBug12797);
+    TESTCASE_AUTO(TestLineBreakPartitioner);
+#if !UCONFIG_NO_FILE_IO
+    TESTCASE_AUTO(TestCachedRules);
+    TESTCASE_AUTO(TestCustomDictionary);
+#endif
     TESTCASE_AUTO_END;
 }
 
@@ -4653,6 +4664,395 @@ void RBBITest::TestBug12797() {
 }
 
 
+//
+//  TestLineBreakPartitioner   Boundaries merged from independently broken partitions
+//                             must match those from iterating over the whole text.
+//
+namespace {
+
+class PartitionThread : public SimpleThread {
+  public:
+    PartitionThread(LineBreakPartitioner &partitioner, int32_t first, int32_t stride) :
+        fPartitioner(partitioner), fFirst(first), fStride(stride), fStatus(U_ZERO_ERROR) {}
+    virtual void run() {
+        int32_t count = fPartitioner.countPartitions();
+        for (int32_t i = fFirst; i < count; i += fStride) {
+            fPartitioner.breakPartition(i, fStatus);
+        }
+    }
+    LineBreakPartitioner &fPartitioner;
+    int32_t fFirst;
+    int32_t fStride;
+    UErrorCode fStatus;
+};
+
+}  // namespace
+
+static void collectBoundaries(BreakIterator &bi, UVector32 &boundaries, UErrorCode &status) {
+    boundaries.removeAllElements();
+    for (int32_t b = bi.first(); b != BreakIterator::DONE; b = bi.next()) {
+        boundaries.addElement(b, status);
+    }
+}
+
+void RBBITest::checkPartitionedBreaks(BreakIterator &bi, const UnicodeString &text,
+                                      int32_t minLength, int32_t numThreads) {
+    UErrorCode status = U_ZERO_ERROR;
+    bi.setText(text);
+    UVector32 expected(status);
+    collectBoundaries(bi, expected, status);
+
+    LineBreakPartitioner partitioner(bi, status);
+    UText ut = UTEXT_INITIALIZER;
+    utext_openConstUnicodeString(&ut, &text, &status);
+    partitioner.setText(&ut, minLength, status);
+    if (U_FAILURE(status)) {
+        dataerrln("%s:%d LineBreakPartitioner setup failed - %s", __FILE__, __LINE__, u_errorName(status));
+        utext_close(&ut);
+        return;
+    }
+    if (minLength * 2 < text.length()) {
+        TEST_ASSERT(partitioner.countPartitions() > 1);
+    }
+    int32_t i;
+    for (i = 1; i < partitioner.countPartitions(); ++i) {
+        int32_t start = partitioner.getPartitionStart(i);
+        int32_t lb = u_getIntPropertyValue(text.char32At(start - 1), UCHAR_LINE_BREAK);
+        if (start != partitioner.getPartitionLimit(i - 1) ||
+                (lb != U_LB_MANDATORY_BREAK && lb != U_LB_CARRIAGE_RETURN &&
+                 lb != U_LB_LINE_FEED && lb != U_LB_NEXT_LINE)) {
+            errln("%s:%d partition %d starts at an unexpected index %d", __FILE__, __LINE__, i, start);
+        }
+    }
+
+    if (numThreads > 1) {
+        PartitionThread **threads = new PartitionThread *[numThreads];
+        for (i = 0; i < numThreads; ++i) {
+            threads[i] = new PartitionThread(partitioner, i, numThreads);
+            threads[i]->start();
+        }
+        for (i = 0; i < numThreads; ++i) {
+            threads[i]->join();
+            TEST_ASSERT_SUCCESS(threads[i]->fStatus);
+            delete threads[i];
+        }
+        delete[] threads;
+    }
+
+    int32_t length = partitioner.getBoundaries(NULL, 0, status);
+    if (status == U_BUFFER_OVERFLOW_ERROR) {
+        status = U_ZERO_ERROR;
+    }
+    MaybeStackArray<int32_t, 100> actual;
+    if (actual.resize(length) == NULL) {
+        errln("%s:%d out of memory", __FILE__, __LINE__);
+        utext_close(&ut);
+        return;
+    }
+    partitioner.getBoundaries(actual.getAlias(), length, status);
+    TEST_ASSERT_SUCCESS(status);
+    if (length != expected.size()) {
+        errln("%s:%d expected %d boundaries, got %d (minLength %d, %d partitions)", __FILE__, __LINE__,
+              expected.size(), length, minLength, partitioner.countPartitions());
+    }
+    for (i = 0; i < length && i < expected.size(); ++i) {
+        if (actual[i] != expected.elementAti(i)) {
+            errln("%s:%d boundary %d: expected %d, got %d (minLength %d)", __FILE__, __LINE__,
+                  i, expected.elementAti(i), actual[i], minLength);
+            break;
+        }
+    }
+    utext_close(&ut);
+}
+
+void RBBITest::TestLineBreakPartitioner() {
+    UErrorCode status = U_ZERO_ERROR;
+    LocalPointer<BreakIterator> bi(BreakIterator::createLineInstance(Locale::getEnglish(), status));
+    if (U_FAILURE(status)) {
+        dataerrln("%s:%d createLineInstance failed - %s", __FILE__, __LINE__, u_errorName(status));
+        return;
+    }
+    UnicodeString paragraph = UnicodeString(
+        "The quick (\"brown\") fox can't jump 32.3 feet, right?\r\n"
+        "\\u0E01\\u0E23\\u0E30\\u0E17\\u0E48\\u0E2D\\u0E21\\u0E23\\u0E08\\u0E19\\u0E32\\u0E21\\u0E31\\u0E22\\u0E0A\\u0E32\\u0E27\\u0E44\\u0E23\\n"
+        "\\u3042\\u3044\\u3046 \\u00E9t\\u00E9\\u2028\\u00A0non-break\\u0085"
+        "x\\r\\ry\\n\\n  \\u000B12,345.67\\u000C", -1, US_INV).unescape();
+    UnicodeString text;
+    for (int32_t i = 0; i < 50; ++i) {
+        text.append(paragraph);
+    }
+    checkPartitionedBreaks(*bi, UnicodeString(), 10, 1);
+    checkPartitionedBreaks(*bi, paragraph, 1, 1);
+    checkPartitionedBreaks(*bi, text, 1, 1);
+    checkPartitionedBreaks(*bi, text, 200, 1);
+    checkPartitionedBreaks(*bi, text, 100000, 1);
+    checkPartitionedBreaks(*bi, text, 50, 4);
+
+    // Rules that do not restart after mandatory breaks:
+    // merging must still reproduce the serial boundaries.
+    UParseError parseError;
+    RuleBasedBreakIterator greedy(UNICODE_STRING_SIMPLE("!!forward; .*; !!reverse; .*;"), parseError, status);
+    if (U_FAILURE(status)) {
+        errln("%s:%d rule compilation failed - %s", __FILE__, __LINE__, u_errorName(status));
+        return;
+    }
+    checkPartitionedBreaks(greedy, text, 20, 1);
+    checkPartitionedBreaks(greedy, text, 20, 3);
+}
+
+
+//
+//  TestCachedRules   Break iterators built from rules with a compiled-rules cache directory.
+//
+#if !UCONFIG_NO_FILE_IO
+void RBBITest::TestCachedRules() {
+    // Rules without comments or control characters, so that the cache file name
+    // is derived from a hash of exactly this string.
+    UnicodeString rules = "!!forward;[a-z]+{100};[^a-z];!!reverse;.*;";
+    UnicodeString commentedRules = "!!forward;[a-z]+{100};# letters\n[^a-z];!!reverse;.*;";
+    UnicodeString text = "abc12 de";
+    const char *cacheDir = ".";
+    char fileName[32];
+    sprintf(fileName, "." U_FILE_SEP_STRING "rbbi_%08x.brk",
+            (unsigned)ustr_hashUCharsN(rules.getBuffer(), rules.length()));
+    remove(fileName);
+
+    UErrorCode status = U_ZERO_ERROR;
+    UParseError parseError;
+    RuleBasedBreakIterator compiled(rules, parseError, status);
+    RuleBasedBreakIterator first(rules, cacheDir, parseError, status);
+    if (U_FAILURE(status)) {
+        errln("%s:%d status = %s", __FILE__, __LINE__, u_errorName(status));
+        return;
+    }
+    FILE *f = fopen(fileName, "rb");
+    if (f == NULL) {
+        errln("%s:%d cache file %s was not written", __FILE__, __LINE__, fileName);
+    } else {
+        fclose(f);
+    }
+
+    // Same rules apart from a comment: served from the cache file.
+    RuleBasedBreakIterator cached(commentedRules, cacheDir, parseError, status);
+    TEST_ASSERT_SUCCESS(status);
+    TEST_ASSERT(cached.getRules() == compiled.getRules());
+    uint32_t compiledLength, cachedLength;
+    const uint8_t *compiledBinary = compiled.getBinaryRules(compiledLength);
+    const uint8_t *cachedBinary = cached.getBinaryRules(cachedLength);
+    TEST_ASSERT(compiledLength == cachedLength &&
+                uprv_memcmp(compiledBinary, cachedBinary, compiledLength) == 0);
+    LocalPointer<RuleBasedBreakIterator> clone((RuleBasedBreakIterator *)cached.clone());
+    compiled.setText(text);
+    clone->setText(text);
+    for (int32_t b = compiled.first(), c = clone->first(); b != BreakIterator::DONE;
+            b = compiled.next(), c = clone->next()) {
+        if (b != c) {
+            errln("%s:%d cached rules: expected boundary %d, got %d", __FILE__, __LINE__, b, c);
+            break;
+        }
+    }
+
+    // Change the rule status value in the cache file. The iterator built from the
+    // cache must report the changed value, which shows that it was not recompiled.
+    uint32_t fileWords[2048];  // uint32_t for the alignment of the RBBI data
+    char *buffer = (char *)fileWords;
+    int32_t fileLength = 0;
+    f = fopen(fileName, "rb");
+    if (f != NULL) {
+        fileLength = (int32_t)fread(buffer, 1, sizeof(fileWords), f);
+        fclose(f);
+    }
+    int32_t dataOffset = 0;
+    while (dataOffset + (int32_t)sizeof(RBBIDataHeader) <= fileLength &&
+            ((RBBIDataHeader *)(buffer + dataOffset))->fMagic != 0xb1a0) {
+        dataOffset += 16;   // The payload follows a 16-aligned header.
+    }
+    UBool isPatched = FALSE;
+    if (dataOffset + (int32_t)sizeof(RBBIDataHeader) <= fileLength) {
+        const RBBIDataHeader *header = (const RBBIDataHeader *)(buffer + dataOffset);
+        int32_t *statusTable = (int32_t *)(buffer + dataOffset + header->fStatusTable);
+        for (uint32_t i = 0; i < header->fStatusTableLen / 4; ++i) {
+            if (statusTable[i] == 100) {
+                statusTable[i] = 200;
+                isPatched = TRUE;
+            }
+        }
+    }
+    if (!isPatched) {
+        errln("%s:%d unable to find the rule status in cache file %s", __FILE__, __LINE__, fileName);
+    } else {
+        f = fopen(fileName, "wb");
+        if (f != NULL) {
+            fwrite(buffer, 1, fileLength, f);
+            fclose(f);
+        }
+        RuleBasedBreakIterator patched(rules, cacheDir, parseError, status);
+        TEST_ASSERT_SUCCESS(status);
+        patched.setText(text);
+        TEST_ASSERT(patched.following(0) == 3);
+        TEST_ASSERT(patched.getRuleStatus() == 200);
+        compiled.following(0);
+        TEST_ASSERT(compiled.getRuleStatus() == 100);
+    }
+
+    // A damaged cache file is ignored and replaced.
+    f = fopen(fileName, "wb");
+    if (f != NULL) {
+        fputs("not a break iterator", f);
+        fclose(f);
+    }
+    RuleBasedBreakIterator rebuilt(rules, cacheDir, parseError, status);
+    TEST_ASSERT_SUCCESS(status);
+    cachedBinary = rebuilt.getBinaryRules(cachedLength);
+    TEST_ASSERT(compiledLength == cachedLength &&
+                uprv_memcmp(compiledBinary, cachedBinary, compiledLength) == 0);
+    RuleBasedBreakIterator reloaded(rules, cacheDir, parseError, status);
+    TEST_ASSERT_SUCCESS(status);
+    TEST_ASSERT(reloaded.getRules() == compiled.getRules());
+
+    // An unusable cache directory does not cause an error.
+    RuleBasedBreakIterator uncached(rules, "no" U_FILE_SEP_STRING "such" U_FILE_SEP_STRING "dir",
+                                    parseError, status);
+    TEST_ASSERT_SUCCESS(status);
+    TEST_ASSERT(uncached.getRules() == compiled.getRules());
+
+    // Syntax errors are reported as with the uncached constructor.
+    RuleBasedBreakIterator bad(UnicodeString("!!forward;[a-z;"), cacheDir, parseError, status);
+    TEST_ASSERT(U_FAILURE(status));
+    remove(fileName);
+}
+#endif
+
+
+//
+//  TestCustomDictionary   Dictionary-based breaking with a dictionary file added at runtime.
+//
+
+// Writes a .dict file with a UCharsTrie of the words, in the format of the gendict tool.
+static void writeDictionaryFile(const char *path, const UnicodeString words[], int32_t count,
+                                UErrorCode &status) {
+    UCharsTrieBuilder builder(status);
+    for (int32_t i = 0; i < count; ++i) {
+        builder.add(words[i], 0, status);
+    }
+    UnicodeString trie;
+    builder.buildUnicodeString(USTRINGTRIE_BUILD_SMALL, trie, status);
+    if (U_FAILURE(status)) {
+        return;
+    }
+    // DataHeader: headerSize, magic, UDataInfo; padded to 32 bytes.
+    char header[32] = { 0 };
+    header[0] = 32;     // headerSize in platform endianness
+    header[1] = 0;
+    if (U_IS_BIG_ENDIAN) {
+        header[0] = 0;
+        header[1] = 32;
+    }
+    header[2] = (char)0xda;
+    header[3] = 0x27;
+    UDataInfo info = {
+        sizeof(UDataInfo), 0, U_IS_BIG_ENDIAN, U_CHARSET_FAMILY, U_SIZEOF_UCHAR, 0,
+        { 0x44, 0x69, 0x63, 0x74 },     // "Dict"
+        { 1, 0, 0, 0 },
+        { 0, 0, 0, 0 }
+    };
+    uprv_memcpy(header + 4, &info, sizeof(UDataInfo));
+    int32_t trieOffset = 8 * 4;
+    int32_t totalSize = trieOffset + trie.length() * U_SIZEOF_UCHAR;
+    int32_t indexes[8] = {
+        trieOffset, totalSize, totalSize, totalSize,
+        1,  // DictionaryData::TRIE_TYPE_UCHARS
+        0, 0, 0
+    };
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        status = U_FILE_ACCESS_ERROR;
+        return;
+    }
+    fwrite(header, 1, sizeof(header), f);
+    fwrite(indexes, 4, 8, f);
+    fwrite(trie.getBuffer(), U_SIZEOF_UCHAR, trie.length(), f);
+    fclose(f);
+}
+
+// Returns the boundaries as a string like "0,3,7,".
+static UnicodeString getBoundaries(BreakIterator &bi, const UnicodeString &text) {
+    UnicodeString result;
+    bi.setText(text);
+    for (int32_t b = bi.first(); b != BreakIterator::DONE; b = bi.next()) {
+        char buffer[16];
+        sprintf(buffer, "%d,", (int)b);
+        result.append(UnicodeString(buffer, -1, US_INV));
+    }
+    return result;
+}
+
+void RBBITest::TestCustomDictionary() {
+    // "Hello" (a dictionary word) followed by a made-up word, twice.
+    UnicodeString madeUp = CharsToUnicodeString("\\u0E1F\\u0E2B\\u0E01\\u0E14\\u0E1F\\u0E2B");
+    UnicodeString hello = CharsToUnicodeString("\\u0E2A\\u0E27\\u0E31\\u0E2A\\u0E14\\u0E35");
+    UnicodeString text = hello + madeUp + hello + madeUp;
+    const char *dictPath = "." U_FILE_SEP_STRING "rbbitst_custom.dict";
+    const char *badPath = "." U_FILE_SEP_STRING "rbbitst_bad.dict";
+
+    UErrorCode status = U_ZERO_ERROR;
+    writeDictionaryFile(dictPath, &madeUp, 1, status);
+    LocalPointer<RuleBasedBreakIterator> bi(
+        (RuleBasedBreakIterator *)BreakIterator::createWordInstance(Locale("th"), status));
+    if (U_FAILURE(status)) {
+        dataerrln("%s:%d status = %s", __FILE__, __LINE__, u_errorName(status));
+        remove(dictPath);
+        return;
+    }
+    LocalPointer<RuleBasedBreakIterator> plain((RuleBasedBreakIterator *)bi->clone());
+    UnicodeString before = getBoundaries(*bi, text);
+    logln(UnicodeString("boundaries without the custom dictionary: ") + before);
+
+    bi->addDictionary(USCRIPT_THAI, dictPath, status);
+    TEST_ASSERT_SUCCESS(status);
+    UnicodeString expected = "0,6,12,18,24,";
+    UnicodeString after = getBoundaries(*bi, text);
+    if (after != expected) {
+        errln(UnicodeString("custom dictionary: expected boundaries ") + expected + ", got " + after);
+    }
+    if (before == expected) {
+        errln("%s:%d the made-up word is already handled without the custom dictionary; "
+              "change the test word", __FILE__, __LINE__);
+    }
+
+    // Clones share the dictionary; other break iterators are not affected.
+    LocalPointer<BreakIterator> clone(bi->clone());
+    TEST_ASSERT(getBoundaries(*clone, text) == expected);
+    TEST_ASSERT(getBoundaries(*plain, text) == before);
+    RuleBasedBreakIterator assigned(*plain);
+    assigned = *bi;
+    TEST_ASSERT(getBoundaries(assigned, text) == expected);
+    bi.adoptInstead(NULL);
+    TEST_ASSERT(getBoundaries(*clone, text) == expected);
+
+    // Errors.
+    status = U_ZERO_ERROR;
+    plain->addDictionary(USCRIPT_THAI, "." U_FILE_SEP_STRING "no_such_file.dict", status);
+    TEST_ASSERT(status == U_FILE_ACCESS_ERROR);
+    FILE *f = fopen(badPath, "wb");
+    if (f != NULL) {
+        fputs("This is not a dictionary file, though it is long enough for one.", f);
+        fclose(f);
+    }
+    status = U_ZERO_ERROR;
+    plain->addDictionary(USCRIPT_THAI, badPath, status);
+    TEST_ASSERT(status == U_INVALID_FORMAT_ERROR);
+    status = U_ZERO_ERROR;
+    plain->addDictionary(USCRIPT_LATIN, dictPath, status);
+    TEST_ASSERT(status == U_UNSUPPORTED_ERROR);
+    TEST_ASSERT(getBoundaries(*plain, text) == before);
+
+    clone.adoptInstead(NULL);
+    remove(dictPath);
+    remove(badPath);
+}
+
+
 //
 //  TestDebug    -  A place-holder test for debugging purposes.
 //                  For putting in fragments of other tests that can be invoked
@@ -76,12 +76,22 @@ public:
     void TestBug9983();
     void TestBug7547();
     void TestBug12797();
+    void TestLineBreakPartitioner();
+    void TestCachedRules();
+    void TestCustomDictionary();
 
     void TestDebug();
     void TestProperties();
 
 /***********************/
 private:
+    /**
+     * Compare the boundaries from a LineBreakPartitioner with those from
+     * a plain forward iteration over the text.
+     **/
+    void checkPartitionedBreaks(BreakIterator &bi, const UnicodeString &text,
+                                int32_t minLength, int32_t numThreads);
+
     /**
      * internal methods to prepare test data
      **/
@@ -31,6 +31,8 @@
 
 #include "unicode/localpointer.h"
 #include "unicode/regex.h"
+#include "unicode/regexset.h"
+#include "unicode/regexstream.h"
 #include "unicode/uchar.h"
 #include "unicode/ucnv.h"
 #include "unicode/uniset.h"
@@ -162,6 +164,30 @@ void RegexTest::runIndexedTest( int32_t index, UBool exec, const char* &name, ch
         case 28: name = "NamedCaptureLimits";
             if (exec) NamedCaptureLimits();
             break;
+        case 29: name = "TestDFAFind";
+            if (exec) TestDFAFind();
+            break;
+        case 30: name = "TestFindStartScans";
+            if (exec) TestFindStartScans();
+            break;
+        case 31: name = "TestRegexSet";
+            if (exec) TestRegexSet();
+            break;
+        case 32: name = "TestUTF8Input";
+            if (exec) TestUTF8Input();
+            break;
+        case 33: name = "TestMatcherReuse";
+            if (exec) TestMatcherReuse();
+            break;
+        case 34: name = "TestCachedPattern";
+            if (exec) TestCachedPattern();
+            break;
+        case 35: name = "TestStreamFind";
+            if (exec) TestStreamFind();
+            break;
+        case 36: name = "TestOptimizedPatterns";
+            if (exec) TestOptimizedPatterns();
+            break;
         default: name = "";
             break; //needed to end loop
     }
@@ -5834,4 +5860,789 @@ void RegexTest::TestBug11480() {
 }
 
 
+//
+//  TestFindStartScans   find() skips ahead to possible match starts, for patterns
+//                       that begin with a set, a char or a literal string.
+//                       Each case is checked with UTF-16 and with UTF-8 input,
+//                       and with a time limit, which bypasses the DFA.
+//
+void RegexTest::TestFindStartScans() {
+    static const struct {
+        const char *pattern;
+        const char *text;       // Unescaped.
+        int32_t     starts[4];  // UTF-16 indexes, ending with -1.
+    } cases[] = {
+        // START_SET: adjacent possible starts, and starts after a non-ASCII char.
+        { "[ab]c",      "\\u00e9aacbbc\\u00e9bc",   { 2, 5, 8, -1 } },
+        // START_STRING: the second unit of the string is also checked.
+        { "abc",        "xaababcab",                { 4, -1 } },
+        { "abc",        "xabcaxababc\\u00e9",         { 1, 8, -1 } },
+        { "abc",        "abab\\u00e9a",               { -1 } },
+        // START_STRING with a back reference before the string.
+        { "()\\1ab",    "xaaab",                    { 3, -1 } },
+    };
+    for (int32_t i = 0; i < UPRV_LENGTHOF(cases); ++i) {
+        UErrorCode status = U_ZERO_ERROR;
+        UnicodeString text = UnicodeString(cases[i].text, -1, US_INV).unescape();
+        char utf8[100];
+        int32_t utf8Length;
+        u_strToUTF8(utf8, UPRV_LENGTHOF(utf8), &utf8Length, text.getBuffer(), text.length(), &status);
+        for (int32_t variant = 0; variant < 4; ++variant) {
+            RegexMatcher matcher(UnicodeString(cases[i].pattern, -1, US_INV), 0, status);
+            REGEX_CHECK_STATUS;
+            if (variant & 1) {
+                matcher.setTimeLimit(1000, status);
+            }
+            UText ut = UTEXT_INITIALIZER;
+            UBool isUTF8 = (variant & 2) != 0;
+            if (isUTF8) {
+                utext_openUTF8(&ut, utf8, utf8Length, &status);
+                matcher.reset(&ut);
+            } else {
+                matcher.reset(text);
+            }
+            REGEX_CHECK_STATUS;
+            int32_t n = 0;
+            while (matcher.find(status)) {
+                int32_t expected = cases[i].starts[n];
+                if (expected >= 0 && isUTF8) {
+                    // Convert the UTF-16 index to a UTF-8 index.
+                    int32_t length8;
+                    UErrorCode lengthStatus = U_ZERO_ERROR;
+                    u_strToUTF8(NULL, 0, &length8, text.getBuffer(), expected, &lengthStatus);
+                    expected = length8;
+                }
+                if (matcher.start(status) != expected) {
+                    errln("%s:%d case %d variant %d: find() #%d at %d, expected %d",
+                          __FILE__, __LINE__, (int)i, (int)variant, (int)n,
+                          (int)matcher.start(status), (int)expected);
+                    break;
+                }
+                ++n;
+            }
+            REGEX_CHECK_STATUS;
+            if (cases[i].starts[n] >= 0) {
+                errln("%s:%d case %d variant %d: only %d matches", __FILE__, __LINE__,
+                      (int)i, (int)variant, (int)n);
+            }
+            if (!matcher.hitEnd()) {
+                errln("%s:%d case %d variant %d: hitEnd() = FALSE", __FILE__, __LINE__,
+                      (int)i, (int)variant);
+            }
+            utext_close(&ut);
+        }
+    }
+}
+
+
+//
+//  TestDFAFind   Patterns that backtrack exponentially when there is no match.
+//                find() and matches() check them with a DFA first, so that they
+//                finish quickly, without a time limit.
+//
+void RegexTest::TestDFAFind() {
+    UErrorCode status = U_ZERO_ERROR;
+    UnicodeString noMatch;
+    for (int32_t i = 0; i < 50; i++) {
+        noMatch.append((UChar)0x61);    // 'a'
+    }
+    UnicodeString match(noMatch);
+    noMatch.append((UChar)0x63);        // 'c'
+    match.append((UChar)0x62);          // 'b'
+
+    RegexMatcher matcher(UnicodeString("(a+)+b"), 0, status);
+    REGEX_CHECK_STATUS;
+    matcher.reset(noMatch);
+    REGEX_ASSERT(matcher.find(status) == FALSE);
+    REGEX_ASSERT(matcher.hitEnd() == TRUE);
+    REGEX_ASSERT(matcher.matches(status) == FALSE);
+    REGEX_CHECK_STATUS;
+
+    matcher.reset(match);
+    REGEX_ASSERT(matcher.find(status));
+    REGEX_ASSERT(matcher.start(status) == 0);
+    REGEX_ASSERT(matcher.end(status) == 51);
+    REGEX_ASSERT(matcher.start(1, status) == 0);
+    REGEX_ASSERT(matcher.end(1, status) == 50);
+    REGEX_ASSERT(matcher.find(status) == FALSE);
+    REGEX_ASSERT(matcher.matches(status));
+    REGEX_CHECK_STATUS;
+
+    // The same, with UTF-8 input that is not all in one UText chunk.
+    RegexMatcher matcher2(UnicodeString("(x+x+)+y"), 0, status);
+    REGEX_CHECK_STATUS;
+    noMatch.findAndReplace(UnicodeString("a"), UnicodeString("x"));
+    noMatch.insert(0, UnicodeString("z\u00e9z", -1, US_INV).unescape());
+    char utf8[100];
+    int32_t utf8Length;
+    u_strToUTF8(utf8, UPRV_LENGTHOF(utf8), &utf8Length, noMatch.getBuffer(), noMatch.length(), &status);
+    UText ut = UTEXT_INITIALIZER;
+    utext_openUTF8(&ut, utf8, utf8Length, &status);
+    REGEX_CHECK_STATUS;
+    matcher2.reset(&ut);
+    REGEX_ASSERT(matcher2.find(status) == FALSE);
+    REGEX_ASSERT(matcher2.matches(4, status) == FALSE);
+    REGEX_CHECK_STATUS;
+    utext_close(&ut);
+
+    // Patterns with back references are left to the backtracking engine.
+    RegexMatcher matcher3(UnicodeString("(a+)\\1b"), 0, status);
+    REGEX_CHECK_STATUS;
+    matcher3.reset(UnicodeString("xaaaabz"));
+    REGEX_ASSERT(matcher3.find(status));
+    REGEX_ASSERT(matcher3.start(status) == 1);
+    REGEX_ASSERT(matcher3.end(status) == 6);
+    REGEX_CHECK_STATUS;
+
+    // The match must start at the first \s, even though the DFA state after it
+    //   is the same as for a match that starts one character later.
+    RegexMatcher matcher4(UnicodeString("\\s*\\h"), 0, status);
+    REGEX_CHECK_STATUS;
+    matcher4.reset(UnicodeString("x\\r\\r ", -1, US_INV).unescape());
+    REGEX_ASSERT(matcher4.find(status));
+    REGEX_ASSERT(matcher4.start(status) == 1);
+    REGEX_ASSERT(matcher4.end(status) == 4);
+    REGEX_CHECK_STATUS;
+
+    // Matching input for a pattern that backtracks exponentially.  The DFA finds the
+    //   match, and the capture group, without the backtracking engine.
+    RegexMatcher matcher5(UnicodeString("(a+)+b|a*c"), 0, status);
+    REGEX_CHECK_STATUS;
+    UnicodeString matchC(match);
+    matchC.setCharAt(50, (UChar)0x63);  // 'c'
+    matcher5.reset(matchC);
+    REGEX_ASSERT(matcher5.find(status));
+    REGEX_ASSERT(matcher5.start(status) == 0);
+    REGEX_ASSERT(matcher5.end(status) == 51);
+    REGEX_ASSERT(matcher5.start(1, status) == -1);
+    REGEX_ASSERT(matcher5.matches(status));
+    REGEX_ASSERT(matcher5.end(status) == 51);
+    REGEX_ASSERT(matcher5.start(1, status) == -1);
+    matcher5.reset(match);
+    REGEX_ASSERT(matcher5.matches(status));
+    REGEX_ASSERT(matcher5.start(1, status) == 0);
+    REGEX_ASSERT(matcher5.end(1, status) == 50);
+    REGEX_CHECK_STATUS;
+
+    // The leftmost match starts at the end of a long run of characters that might
+    //   have started a match.  The DFA finds its start without trying each of them.
+    RegexMatcher matcher6(UnicodeString("x.*y|z"), 0, status);
+    REGEX_CHECK_STATUS;
+    UnicodeString xs;
+    for (int32_t i = 0; i < 20000; i++) {
+        xs.append((UChar)0x78);         // 'x'
+    }
+    xs.append((UChar)0x7a);             // 'z'
+    matcher6.reset(xs);
+    REGEX_ASSERT(matcher6.find(status));
+    REGEX_ASSERT(matcher6.start(status) == 20000);
+    REGEX_ASSERT(matcher6.end(status) == 20001);
+    REGEX_ASSERT(matcher6.hitEnd() == TRUE);
+    REGEX_ASSERT(matcher6.find(status) == FALSE);
+    REGEX_CHECK_STATUS;
+
+    // The DFA results must be those of the backtracking engine, which is used instead
+    //   when there is a time limit:  the matches, capture groups, hitEnd() and requireEnd().
+    static const char *const parityCases[][2] = {
+        { "ab+c", "xabd ab abbc abb" },
+        { "(ab|a)(bc|c)?", "abc abcd a" },
+        { "(?:b|(?:|a))+", "ba bba" },
+        { "(.?)+", "ab c" },
+        { "(a|ab)(c|bcd)(d*)", "abcd" },
+        { "[a-c]*?c|\\d+", "aabc 123a" },
+        { "(?i)(x\\u00e9)+|y", "X\\u00c9x\\u00e9 Y" },
+        { "\\s*\\h", "x\\r\\r " },
+    };
+    for (int32_t i = 0; i < UPRV_LENGTHOF(parityCases); i++) {
+        UnicodeString pattern = UnicodeString(parityCases[i][0], -1, US_INV).unescape();
+        UnicodeString text = UnicodeString(parityCases[i][1], -1, US_INV).unescape();
+        RegexMatcher dfaMatcher(pattern, 0, status);
+        RegexMatcher btMatcher(pattern, 0, status);
+        btMatcher.setTimeLimit(1000000, status);
+        REGEX_CHECK_STATUS;
+        dfaMatcher.reset(text);
+        btMatcher.reset(text);
+        for (int32_t step = 0; step < 10; step++) {
+            UBool found;
+            if (step < 9) {
+                found = dfaMatcher.find(status);
+                REGEX_ASSERT(found == btMatcher.find(status));
+            } else {
+                found = dfaMatcher.matches(status);
+                REGEX_ASSERT(found == btMatcher.matches(status));
+            }
+            REGEX_ASSERT(dfaMatcher.hitEnd() == btMatcher.hitEnd());
+            REGEX_ASSERT(dfaMatcher.requireEnd() == btMatcher.requireEnd());
+            for (int32_t group = 0; found && group <= dfaMatcher.groupCount(); group++) {
+                if (dfaMatcher.start(group, status) != btMatcher.start(group, status) ||
+                        dfaMatcher.end(group, status) != btMatcher.end(group, status)) {
+                    errln("%s:%d pattern %s step %d group %d: DFA [%d, %d), backtracking [%d, %d)",
+                          __FILE__, __LINE__, parityCases[i][0], (int)step, (int)group,
+                          (int)dfaMatcher.start(group, status), (int)dfaMatcher.end(group, status),
+                          (int)btMatcher.start(group, status), (int)btMatcher.end(group, status));
+                }
+            }
+            REGEX_CHECK_STATUS;
+            if (!found && step < 9) {
+                step = 8;
+            }
+        }
+    }
+}
+
+
+//---------------------------------------------------------------------------
+//
+//  TestRegexSet   RegexSet::find() reports the same first matches as
+//                 RegexMatcher::find() for each of its patterns.
+//
+//---------------------------------------------------------------------------
+void RegexTest::TestRegexSet() {
+    static const struct {
+        const char *pattern;
+        uint32_t    flags;
+    } patterns[] = {
+        { "colou?r",            0 },                        // Required literal "colo".
+        { "\\bflavou?r\\b",     UREGEX_CASE_INSENSITIVE },  // No literal.
+        { "q+uick",             0 },                        // "uick", after a loop.
+        { "a(?:b|c)d",          0 },                        // The alternation splits the literal.
+        { "x{0,3}yz",           0 },                        // "yz", after an optional part.
+        { "(?!foo)ba[rz]",      0 },                        // Look-ahead, no literal.
+        { "colou?r",            UREGEX_CASE_INSENSITIVE },  // The same pattern, no literal.
+        { "colo",               UREGEX_LITERAL },           // The same literal as pattern 0.
+        { "\\U0001F600+!",      0 },                        // Supplementary code point.
+        { "o[^r]*r",            0 },
+    };
+    static const char *texts[] = {
+        "",
+        "The colour of the flavor.",
+        "COLOR quick abd xxyz bar",
+        "colo uick acd yz foo baz",
+        "\\U0001F600\\U0001F600! colr x",
+        "uuick qqquick abcd xxxxyz",
+    };
+
+    UErrorCode status = U_ZERO_ERROR;
+    RegexSet set(status);
+    REGEX_CHECK_STATUS;
+    UVector matchers(status);
+    matchers.setDeleter(uprv_deleteUObject);
+    int32_t i;
+    for (i = 0; i < UPRV_LENGTHOF(patterns); i++) {
+        UnicodeString pattern = UnicodeString(patterns[i].pattern, -1, US_INV);
+        REGEX_ASSERT(set.add(pattern, patterns[i].flags, status) == i);
+        matchers.addElement(new RegexMatcher(pattern, patterns[i].flags, status), status);
+        REGEX_CHECK_STATUS;
+    }
+    REGEX_ASSERT(set.size() == UPRV_LENGTHOF(patterns));
+    REGEX_ASSERT(set.getPattern(3) != NULL &&
+                 set.getPattern(3)->pattern() == UNICODE_STRING_SIMPLE("a(?:b|c)d"));
+    REGEX_ASSERT(set.getPattern(UPRV_LENGTHOF(patterns)) == NULL);
+
+    for (int32_t t = 0; t < UPRV_LENGTHOF(texts); t++) {
+        UnicodeString text = UnicodeString(texts[t], -1, US_INV).unescape();
+        UBool found = set.find(text, status);
+        REGEX_CHECK_STATUS;
+        int32_t matchIndex = 0;
+        for (i = 0; i < UPRV_LENGTHOF(patterns); i++) {
+            RegexMatcher *matcher = (RegexMatcher *)matchers.elementAt(i);
+            matcher->reset(text);
+            if (!matcher->find()) {
+                continue;
+            }
+            if (matchIndex >= set.getMatchCount() || set.getMatch(matchIndex) != i) {
+                errln("%s:%d text %d: pattern %d matches, but RegexSet does not report it",
+                      __FILE__, __LINE__, t, i);
+                continue;
+            }
+            if (set.start(matchIndex, status) != matcher->start(status) ||
+                    set.end(matchIndex, status) != matcher->end(status)) {
+                errln("%s:%d text %d pattern %d: RegexSet match [%d, %d), RegexMatcher [%d, %d)",
+                      __FILE__, __LINE__, t, i, set.start(matchIndex, status), set.end(matchIndex, status),
+                      matcher->start(status), matcher->end(status));
+            }
+            matchIndex++;
+        }
+        REGEX_CHECK_STATUS;
+        REGEX_ASSERT(matchIndex == set.getMatchCount());
+        REGEX_ASSERT(found == (matchIndex > 0));
+    }
+
+    // Adding a pattern after a find() is taken into account by the next one.
+    UnicodeString text("a literal");
+    REGEX_ASSERT(!set.find(text, status));
+    REGEX_ASSERT(set.add(UNICODE_STRING_SIMPLE("lit[e]ral"), 0, status) == UPRV_LENGTHOF(patterns));
+    REGEX_ASSERT(set.find(text, status));
+    REGEX_ASSERT(set.getMatchCount() == 1 && set.getMatch(0) == UPRV_LENGTHOF(patterns));
+    REGEX_ASSERT(set.start(0, status) == 2 && set.end(0, status) == 9);
+    REGEX_CHECK_STATUS;
+
+    // Errors.
+    REGEX_ASSERT(set.getMatch(1) == -1);
+    set.start(1, status);
+    REGEX_ASSERT(status == U_INDEX_OUTOFBOUNDS_ERROR);
+    status = U_ZERO_ERROR;
+    UParseError pe;
+    REGEX_ASSERT(set.add(UNICODE_STRING_SIMPLE("a(b"), 0, pe, status) == -1);
+    REGEX_ASSERT(status == U_REGEX_MISMATCHED_PAREN);
+    REGEX_ASSERT(set.size() == UPRV_LENGTHOF(patterns) + 1);
+}
+
+
+//
+//  TestUTF8Input   UTF-8 input is matched directly in its bytes.  The matches must be
+//                  the same as those in the same text in UTF-16, with UTF-8 indexes.
+//
+void RegexTest::TestUTF8Input() {
+    static const struct {
+        const char *pattern;
+        uint32_t    flags;
+        const char *text;       // Unescaped.
+    } cases[] = {
+        { "\\u00e9t\\u00e9",        0,                      "\\u00c9t\\u00e9 \\u00e9t\\u00e9 \\u00e9t\\u00e9s" },
+        { "\\u00e9t\\u00e9",        UREGEX_CASE_INSENSITIVE, "\\u00c9T\\u00c9 \\u00e9t\\u00e9 ETE" },
+        { "[\\u00e0-\\u00ff]+",     0,                      "a\\u00e0\\u00e1b\\u00ff\\u0100\\u00fe" },
+        { "[\\u4e00-\\u9fff]+",     0,                      "abc\\u4e2d\\u6587 \\ud83d\\ude00\\u5b57" },
+        { "\\ud83d\\ude00.",        0,                      "x\\ud83d\\ude00\\ud83d\\ude01y\\ud83d\\ude00z" },
+        { "\\b\\w+\\b",             0,                      "\\u00fcber caf\\u00e9 na\\u0308ive \\u0436\\u0443\\u043a" },
+        { "(\\w+) \\1",             0,                      "\\u00e9t\\u00e9 \\u00e9t\\u00e9 caf\\u00e9 cafe" },
+        { "(\\w+) \\1",             UREGEX_CASE_INSENSITIVE, "\\u00c9T\\u00c9 \\u00e9t\\u00e9 stra\\u00dfe STRASSE" },
+        { "(?<=\\u00e9)\\w",        0,                      "\\u00e9a b\\u00e9c \\u4e2d\\u00e9\\u00e9" },
+        { "(?<!\\u4e2d)x",          0,                      "\\u4e2dx ax \\u6587x" },
+        { "^\\w+$",                 UREGEX_MULTILINE,       "\\u00e9\\u2028ab\\u0085c\\r\\nd\\u2029\\u00e8" },
+        { "\\w+$",                  0,                      "ab\\u00e9\\u2028" },
+        { "\\w+$",                  0,                      "ab\\u00e9\\r\\n" },
+        { ".*\\u00e9",              0,                      "a\\u00e9b\\u00e9\\u2028c\\u00e9" },
+        { "[^x]*y",                 0,                      "\\u00e9\\u4e2dy\\ud83d\\ude00xy" },
+        { "\\X",                    0,                      "e\\u0301\\u00e9\\r\\n\\ud83d\\ude00" },
+        { "\\R",                    0,                      "a\\r\\nb\\u2028c\\u0085" },
+        { "(a|\\u00e9)+?\\u00e8",   0,                      "a\\u00e9a\\u00e8 \\u00e9\\u00e8" },
+        { "\\u00e9{2,3}",           0,                      "\\u00e9\\u00e9\\u00e9\\u00e9\\u00e9" },
+    };
+    for (int32_t i = 0; i < UPRV_LENGTHOF(cases); ++i) {
+        UErrorCode status = U_ZERO_ERROR;
+        UnicodeString pattern = UnicodeString(cases[i].pattern, -1, US_INV).unescape();
+        UnicodeString text = UnicodeString(cases[i].text, -1, US_INV).unescape();
+        char utf8[200];
+        int32_t utf8Length;
+        u_strToUTF8(utf8, UPRV_LENGTHOF(utf8), &utf8Length, text.getBuffer(), text.length(), &status);
+        RegexMatcher m16(pattern, cases[i].flags, status);
+        RegexMatcher m8(pattern, cases[i].flags, status);
+        REGEX_CHECK_STATUS;
+        UText ut = UTEXT_INITIALIZER;
+        utext_openUTF8(&ut, utf8, utf8Length, &status);
+        m16.reset(text);
+        m8.reset(&ut);
+        REGEX_CHECK_STATUS;
+
+        // Each UTF-16 index, converted to UTF-8.
+        int32_t index8[100];
+        for (int32_t j = 0; j <= text.length(); ++j) {
+            UErrorCode lengthStatus = U_ZERO_ERROR;
+            u_strToUTF8(NULL, 0, &index8[j], text.getBuffer(), j, &lengthStatus);
+        }
+
+        for (int32_t n = 0;; ++n) {
+            UBool found16 = m16.find(status);
+            UBool found8 = m8.find(status);
+            REGEX_CHECK_STATUS;
+            if (found16 != found8) {
+                errln("%s:%d case %d: find() #%d is %d in UTF-16, %d in UTF-8",
+                      __FILE__, __LINE__, (int)i, (int)n, found16, found8);
+                break;
+            }
+            if (!found16) {
+                break;
+            }
+            for (int32_t group = 0; group <= m16.groupCount(); ++group) {
+                int32_t start16 = m16.start(group, status);
+                int32_t end16 = m16.end(group, status);
+                int32_t start8 = m8.start(group, status);
+                int32_t end8 = m8.end(group, status);
+                REGEX_CHECK_STATUS;
+                if ((start16 < 0 ? -1 : index8[start16]) != start8 ||
+                        (end16 < 0 ? -1 : index8[end16]) != end8) {
+                    errln("%s:%d case %d: find() #%d group %d is [%d, %d[ in UTF-8, expected [%d, %d[",
+                          __FILE__, __LINE__, (int)i, (int)n, (int)group, (int)start8, (int)end8,
+                          (int)(start16 < 0 ? -1 : index8[start16]), (int)(end16 < 0 ? -1 : index8[end16]));
+                }
+            }
+        }
+        if (m16.hitEnd() != m8.hitEnd()) {
+            errln("%s:%d case %d: hitEnd() differs", __FILE__, __LINE__, (int)i);
+        }
+
+        REGEX_ASSERT(m16.lookingAt(status) == m8.lookingAt(status));
+        REGEX_ASSERT(m16.matches(status) == m8.matches(status));
+        REGEX_CHECK_STATUS;
+        utext_close(&ut);
+    }
+
+    // Ill-formed UTF-8 is read as U+FFFD, one for each maximal subpart of a sequence.
+    {
+        UErrorCode status = U_ZERO_ERROR;
+        static const char ill[] = "a\xc3(\xe4\xb8x\xf0\x9f\x98";
+        UText ut = UTEXT_INITIALIZER;
+        utext_openUTF8(&ut, ill, -1, &status);
+        RegexMatcher m(UNICODE_STRING_SIMPLE("a.\\(\\ufffdx\\ufffd$"), 0, status);
+        m.reset(&ut);
+        REGEX_ASSERT(m.matches(status));
+        RegexMatcher m2(UNICODE_STRING_SIMPLE("\\ufffd"), 0, status);
+        m2.reset(&ut);
+        int32_t starts[] = { 1, 3, 6 };
+        for (int32_t n = 0; n < UPRV_LENGTHOF(starts); ++n) {
+            REGEX_ASSERT(m2.find(status));
+            REGEX_ASSERT(m2.start(status) == starts[n]);
+        }
+        REGEX_ASSERT(!m2.find(status));
+        REGEX_CHECK_STATUS;
+        utext_close(&ut);
+    }
+}
+
+
+//
+//  TestMatcherReuse   A new matcher reuses the backtrack stack and the DFA of a deleted
+//                     matcher of the same pattern.  It must behave as a fresh matcher.
+//
+void RegexTest::TestMatcherReuse() {
+    UErrorCode status = U_ZERO_ERROR;
+    UParseError pe;
+
+    // The stack limit is that of the new matcher, not of the matcher that grew the stack.
+    {
+        LocalPointer<RegexPattern> pattern(RegexPattern::compile(UNICODE_STRING_SIMPLE("(A)+A$"), 0, pe, status));
+        REGEX_CHECK_STATUS;
+        UnicodeString testString(100000, 0x41, 100000);
+        RegexMatcher *matcher = pattern->matcher(testString, status);
+        matcher->setStackLimit(0, status);
+        REGEX_ASSERT(matcher->lookingAt(status));
+        REGEX_CHECK_STATUS;
+        delete matcher;
+
+        matcher = pattern->matcher(testString, status);
+        REGEX_CHECK_STATUS;
+        REGEX_ASSERT(matcher->getStackLimit() == 8000000);
+        matcher->setStackLimit(10000, status);
+        REGEX_ASSERT(matcher->lookingAt(status) == FALSE);
+        REGEX_ASSERT(status == U_REGEX_STACK_OVERFLOW);
+        status = U_ZERO_ERROR;
+        delete matcher;
+    }
+
+    // Matchers that take turns with live and deleted matchers find the same matches.
+    {
+        static const char *const patterns[] = { "(a|b)*c", "ERROR\\s+(\\d+)", "(\\w+) \\1" };
+        UnicodeString text = UNICODE_STRING_SIMPLE("abbc ERROR 42 ac foo foo bc ERROR  7 bar bar");
+        for (int32_t i = 0; i < UPRV_LENGTHOF(patterns); ++i) {
+            LocalPointer<RegexPattern> pattern(
+                RegexPattern::compile(UnicodeString(patterns[i], -1, US_INV), 0, pe, status));
+            REGEX_CHECK_STATUS;
+            LocalPointer<RegexMatcher> reference(pattern->matcher(text, status));
+            REGEX_CHECK_STATUS;
+            for (int32_t round = 0; round < 3; ++round) {
+                LocalPointer<RegexMatcher> m1(pattern->matcher(text, status));
+                LocalPointer<RegexMatcher> m2(pattern->matcher(text, status));
+                REGEX_CHECK_STATUS;
+                reference->reset();
+                while (reference->find(status)) {
+                    REGEX_ASSERT(m1->find(status) && m2->find(status));
+                    REGEX_ASSERT(m1->start(status) == reference->start(status));
+                    REGEX_ASSERT(m2->end(1, status) == reference->end(1, status));
+                    REGEX_ASSERT(m1->group(1, status) == reference->group(1, status));
+                }
+                REGEX_ASSERT(!m1->find(status) && !m2->find(status));
+                REGEX_CHECK_STATUS;
+            }
+        }
+    }
+}
+
+
+//---------------------------------------------------------------------------
+//
+//  TestCachedPattern   Patterns compiled with UREGEX_CACHE_PATTERN are independent
+//                      copies of the cached pattern, with the same behavior.
+//
+//---------------------------------------------------------------------------
+void RegexTest::TestCachedPattern() {
+    UErrorCode status = U_ZERO_ERROR;
+    UParseError pe;
+    UnicodeString patString = UNICODE_STRING_SIMPLE("(\\w+)@(\\w+)");
+    UnicodeString text = UNICODE_STRING_SIMPLE("mail bob@example or ALICE@host");
+
+    LocalPointer<RegexPattern> plain(RegexPattern::compile(patString, UREGEX_CASE_INSENSITIVE, pe, status));
+    LocalPointer<RegexPattern> cached1(
+        RegexPattern::compile(patString, UREGEX_CACHE_PATTERN | UREGEX_CASE_INSENSITIVE, pe, status));
+    REGEX_CHECK_STATUS;
+    REGEX_ASSERT(cached1->flags() == UREGEX_CASE_INSENSITIVE);
+    REGEX_ASSERT(*cached1 == *plain);
+
+    UText patText = UTEXT_INITIALIZER;
+    utext_openConstUnicodeString(&patText, &patString, &status);
+    LocalPointer<RegexPattern> cached2(
+        RegexPattern::compile(&patText, UREGEX_CACHE_PATTERN | UREGEX_CASE_INSENSITIVE, pe, status));
+    utext_close(&patText);
+    REGEX_CHECK_STATUS;
+    REGEX_ASSERT(cached2->pattern() == patString);
+
+    // The copies outlive each other, and their matchers find the same matches.
+    cached1.adoptInstead(NULL);
+    LocalPointer<RegexMatcher> m1(cached2->matcher(text, status));
+    LocalPointer<RegexMatcher> m2(plain->matcher(text, status));
+    REGEX_CHECK_STATUS;
+    while (m2->find(status)) {
+        REGEX_ASSERT(m1->find(status));
+        REGEX_ASSERT(m1->start(1, status) == m2->start(1, status));
+        REGEX_ASSERT(m1->group(2, status) == m2->group(2, status));
+    }
+    REGEX_ASSERT(!m1->find(status));
+    REGEX_CHECK_STATUS;
+
+    // Syntax errors are reported as without the cache.
+    LocalPointer<RegexPattern> bad(
+        RegexPattern::compile(UNICODE_STRING_SIMPLE("abc(de"), UREGEX_CACHE_PATTERN, pe, status));
+    REGEX_ASSERT(bad.isNull());
+    REGEX_ASSERT(status == U_REGEX_MISMATCHED_PAREN);
+    REGEX_ASSERT(pe.line == 1 && pe.offset == 6);
+    status = U_ZERO_ERROR;
+
+    // Unknown flags are still rejected.
+    bad.adoptInstead(RegexPattern::compile(patString, UREGEX_CACHE_PATTERN | 0x10000, pe, status));
+    REGEX_ASSERT(status == U_REGEX_INVALID_FLAG);
+}
+
+
+//---------------------------------------------------------------------------
+//
+//  TestStreamFind   RegexStreamMatcher finds the same matches in text that is
+//                   appended in pieces as RegexMatcher finds in the whole text.
+//
+//---------------------------------------------------------------------------
+void RegexTest::TestStreamFind() {
+    UErrorCode status = U_ZERO_ERROR;
+    UParseError pe;
+
+    static const char *const patterns[] = {
+        "ERROR\\s+(\\d+)", "\\bfoo\\b", "(a|b)*c", "x*", "^abc", "(?m)^b\\w*$",
+        "(?<=ab)cd", "colou?r", "\\w+$", "ab|abcd"
+    };
+    UnicodeString text = UNICODE_STRING_SIMPLE(
+        "abc ERROR 42 foofoo foo ERROR  7\\nb1 bwx\\nabcd colour color aaac bbc xx").unescape();
+    for (int32_t i = 0; i < UPRV_LENGTHOF(patterns); ++i) {
+        LocalPointer<RegexPattern> pattern(
+            RegexPattern::compile(UnicodeString(patterns[i], -1, US_INV), 0, pe, status));
+        REGEX_CHECK_STATUS;
+        UnicodeString expected;
+        LocalPointer<RegexMatcher> matcher(pattern->matcher(text, status));
+        while (matcher->find(status)) {
+            expected.append((UChar)matcher->start(status)).append((UChar)matcher->end(status));
+        }
+        for (int32_t pieceLength = 1; pieceLength <= 7; pieceLength += 3) {
+            RegexStreamMatcher stream(*pattern, status);
+            UnicodeString actual;
+            for (int32_t start = 0; start < text.length(); start += pieceLength) {
+                stream.append(UnicodeString(text, start, pieceLength), status);
+                while (stream.find(status)) {
+                    actual.append((UChar)stream.start(status)).append((UChar)stream.end(status));
+                }
+            }
+            stream.finish(status);
+            while (stream.find(status)) {
+                actual.append((UChar)stream.start(status)).append((UChar)stream.end(status));
+            }
+            REGEX_CHECK_STATUS;
+            if (actual != expected) {
+                errln("%s:%d pattern %s, pieces of %d: different matches", __FILE__, __LINE__,
+                      patterns[i], pieceLength);
+            }
+        }
+    }
+
+    // A match is returned once more text cannot change it, with indexes in the stream.
+    LocalPointer<RegexPattern> pattern(RegexPattern::compile(UNICODE_STRING_SIMPLE("id=(\\d+)"), 0, pe, status));
+    RegexStreamMatcher stream(*pattern, status);
+    REGEX_CHECK_STATUS;
+    REGEX_ASSERT(stream.groupCount() == 1);
+    stream.append(UNICODE_STRING_SIMPLE("xxxx id=12"), status);
+    REGEX_ASSERT(!stream.find(status));
+    REGEX_ASSERT(stream.start(status) == -1 && status == U_REGEX_INVALID_STATE);
+    status = U_ZERO_ERROR;
+    REGEX_ASSERT(stream.getPendingStart() == 5);
+    stream.append(UNICODE_STRING_SIMPLE("34;"), status);
+    REGEX_ASSERT(stream.find(status));
+    REGEX_ASSERT(stream.start(status) == 5 && stream.end(status) == 12);
+    REGEX_ASSERT(stream.start(1, status) == 8 && stream.group(1, status) == UNICODE_STRING_SIMPLE("1234"));
+    REGEX_CHECK_STATUS;
+    stream.group(2, status);
+    REGEX_ASSERT(status == U_INDEX_OUTOFBOUNDS_ERROR);
+    status = U_ZERO_ERROR;
+    REGEX_ASSERT(!stream.find(status));
+
+    // Text that cannot be part of a match is not kept.
+    UnicodeString filler(1000, 0x2d, 1000);
+    for (int32_t i = 0; i < 100; ++i) {
+        stream.append(filler, status);
+        REGEX_ASSERT(!stream.find(status));
+    }
+    REGEX_ASSERT(stream.getPendingStart() == 100013);
+    stream.append(UNICODE_STRING_SIMPLE("id=5"), status);
+    stream.finish(status);
+    REGEX_ASSERT(stream.find(status));
+    REGEX_ASSERT(stream.start(status) == 100013 && stream.end(status) == 100017);
+    REGEX_ASSERT(!stream.find(status));
+    stream.append(filler, status);
+    REGEX_ASSERT(status == U_REGEX_INVALID_STATE);
+    status = U_ZERO_ERROR;
+
+    // A match attempt that grows longer than the pending length limit is given up.
+    stream.reset();
+    stream.setMaxPendingLength(0, status);
+    REGEX_ASSERT(status == U_ILLEGAL_ARGUMENT_ERROR);
+    status = U_ZERO_ERROR;
+    stream.setMaxPendingLength(100, status);
+    REGEX_ASSERT(stream.getMaxPendingLength() == 100);
+    stream.append(UNICODE_STRING_SIMPLE("id="), status);
+    stream.append(UnicodeString(1000, 0x31, 1000), status);
+    REGEX_ASSERT(!stream.find(status));
+    REGEX_ASSERT(stream.getPendingStart() == 1003);
+    stream.finish(status);
+    REGEX_ASSERT(!stream.find(status));
+    REGEX_CHECK_STATUS;
+}
+
+
+
+//---------------------------------------------------------------------------
+//
+//  TestOptimizedPatterns   Patterns that compile to optimized loops, and inputs
+//                          that do not contain a pattern's required literal,
+//                          match as the same patterns do without the optimizations.
+//                          The reference patterns use {1,} and {0,}, which compile
+//                          to counted loops, and a match callback, which turns off
+//                          the DFA and the required literal check.
+//
+//---------------------------------------------------------------------------
+U_CDECL_BEGIN
+static UBool U_CALLCONV
+optimizedPatternsCallback(const void * /*context*/, int32_t /*steps*/) {
+    return TRUE;
+}
+U_CDECL_END
+
+void RegexTest::TestOptimizedPatterns() {
+    static const char *const patterns[][2] = {
+        // Set loops for \d, \w and \s, and loops that need not give back input.
+        { "\\d+",               "\\d{1,}" },
+        { "\\d+\\s+\\w*",       "\\d{1,}\\s{1,}\\w{0,}" },
+        { "(\\w+)=(\\S+);",     "(\\w{1,})=(\\S{1,});" },
+        { "[a-z]*ing\\b",       "[a-z]{0,}ing\\b" },
+        { "\\D+(\\d)",          "\\D{1,}(\\d)" },
+        { "[a-c]+b",            "[a-c]{1,}b" },
+        { "x\\W*y",             "x\\W{0,}y" },
+        { ".*timeout",          ".{0,}timeout" },
+        { "(?s).*z",            "(?s).{0,}z" },
+        { "[^=]+=",             "[^=]{1,}=" },
+        { "\\w+$",              "\\w{1,}$" },
+        // Alternations of literals.
+        { "(?:GET|PUT|POST) (\\S+)", "(?:GET|PUT|POST) (\\S{1,})" },
+        { "ab|a|b\\d*",         "ab|a|b\\d{0,}" },
+        { "\\b(?:cat|dog|cow)s?\\b", "\\b(?:cat|dog|cow)s{0,1}\\b" },
+    };
+    static const char *const texts[] = {
+        "", "42", "abc 123  xyz 7", "key=value; a=b;c=;", "singing ring ing",
+        "abcab bca x..y x y", "wait timeout\\ntimeout", "GET /a PUT  POST /b",
+        "ab a b12 ba", "cats dog cowss", "zz\\u00e9=\\u00e8=", "x\\u3000y 12\\u0663",
+    };
+    for (int32_t i = 0; i < UPRV_LENGTHOF(patterns); ++i) {
+        UErrorCode status = U_ZERO_ERROR;
+        RegexMatcher m16(UnicodeString(patterns[i][0], -1, US_INV), 0, status);
+        RegexMatcher m8(UnicodeString(patterns[i][0], -1, US_INV), 0, status);
+        RegexMatcher ref(UnicodeString(patterns[i][1], -1, US_INV), 0, status);
+        ref.setMatchCallback(optimizedPatternsCallback, NULL, status);
+        REGEX_CHECK_STATUS;
+        for (int32_t j = 0; j < UPRV_LENGTHOF(texts); ++j) {
+            UnicodeString text = UnicodeString(texts[j], -1, US_INV).unescape();
+            char utf8[100];
+            int32_t utf8Length;
+            u_strToUTF8(utf8, UPRV_LENGTHOF(utf8), &utf8Length, text.getBuffer(), text.length(), &status);
+            UText ut = UTEXT_INITIALIZER;
+            utext_openUTF8(&ut, utf8, utf8Length, &status);
+            m16.reset(text);
+            m8.reset(&ut);
+            ref.reset(text);
+            UBool isASCII = utf8Length == text.length();
+            for (;;) {
+                UBool found = ref.find(status);
+                if (m16.find(status) != found || m16.hitEnd() != ref.hitEnd() ||
+                        (found && (m16.start(status) != ref.start(status) ||
+                                   m16.end(status) != ref.end(status) ||
+                                   m16.start(ref.groupCount(), status) != ref.start(ref.groupCount(), status)))) {
+                    errln("%s:%d pattern %s, text %s: find() differs from %s", __FILE__, __LINE__,
+                          patterns[i][0], texts[j], patterns[i][1]);
+                    break;
+                }
+                // The UTF-8 matcher finds the same matches, at different indexes for non-ASCII text.
+                if (m8.find(status) != found || m8.hitEnd() != ref.hitEnd() ||
+                        (found && isASCII && m8.end(status) != ref.end(status))) {
+                    errln("%s:%d pattern %s, UTF-8 text %s: find() differs from %s", __FILE__, __LINE__,
+                          patterns[i][0], texts[j], patterns[i][1]);
+                    break;
+                }
+                if (!found) {
+                    break;
+                }
+            }
+            REGEX_ASSERT(m16.matches(status) == ref.matches(status));
+            REGEX_ASSERT(m16.hitEnd() == ref.hitEnd());
+            REGEX_ASSERT(m16.lookingAt(status) == ref.lookingAt(status));
+            REGEX_ASSERT(m16.hitEnd() == ref.hitEnd());
+            REGEX_ASSERT(!m16.lookingAt(status) || m16.end(status) == ref.end(status));
+            REGEX_CHECK_STATUS;
+            utext_close(&ut);
+        }
+    }
+
+    // find() fails right away when the input does not contain a required literal,
+    //   but not for text that contains it, or before the part that does not.
+    UErrorCode status = U_ZERO_ERROR;
+    RegexMatcher matcher(UNICODE_STRING_SIMPLE("\\w+@\\w+\\.org"), 0, status);
+    REGEX_CHECK_STATUS;
+    UnicodeString text = UNICODE_STRING_SIMPLE("mail bob@example.com and ann@example.net");
+    matcher.reset(text);
+    REGEX_ASSERT(!matcher.find(status));
+    REGEX_ASSERT(matcher.hitEnd());
+    text = UNICODE_STRING_SIMPLE("mail bob@example.org and ann@example.org");
+    matcher.reset(text);
+    REGEX_ASSERT(matcher.find(status) && matcher.start(status) == 5);
+    REGEX_ASSERT(matcher.find(status) && matcher.start(status) == 25);
+    REGEX_ASSERT(!matcher.find(status));
+    matcher.region(0, 20, status);
+    REGEX_ASSERT(matcher.find(status) && matcher.end(status) == 20);
+    matcher.region(21, text.length(), status);
+    REGEX_ASSERT(matcher.find(status) && matcher.start(status) == 25);
+    matcher.region(0, 19, status);
+    REGEX_ASSERT(!matcher.find(status));
+    REGEX_ASSERT(matcher.hitEnd());
+
+    // A new text of the same length, with the literal elsewhere.
+    UnicodeString text2 = UNICODE_STRING_SIMPLE("mail bob@example.com and ann@example.org");
+    matcher.reset(text);
+    REGEX_ASSERT(matcher.find(status) && matcher.start(status) == 5);
+    matcher.reset(text2);
+    REGEX_ASSERT(matcher.find(status) && matcher.start(status) == 25);
+    REGEX_CHECK_STATUS;
+
+    // The same for UTF-8 input.
+    const char *utf8 = "\xc3\xa9t\xc3\xa9 bob@example.org ann@example.com";
+    UText ut = UTEXT_INITIALIZER;
+    utext_openUTF8(&ut, utf8, -1, &status);
+    matcher.reset(&ut);
+    REGEX_ASSERT(matcher.find(status) && matcher.start(status) == 6 && matcher.end(status) == 21);
+    REGEX_ASSERT(!matcher.find(status));
+    REGEX_ASSERT(matcher.hitEnd());
+    REGEX_CHECK_STATUS;
+    utext_close(&ut);
+}
+
 #endif  /* !UCONFIG_NO_REGULAR_EXPRESSIONS  */
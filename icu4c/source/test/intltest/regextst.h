@@ -56,6 +56,14 @@ public:
     virtual void TestBug11049();
     virtual void TestBug11371();
     virtual void TestBug11480();
+    virtual void TestDFAFind();
+    virtual void TestFindStartScans();
+    virtual void TestRegexSet();
+    virtual void TestUTF8Input();
+    virtual void TestMatcherReuse();
+    virtual void TestCachedPattern();
+    virtual void TestStreamFind();
+    virtual void TestOptimizedPatterns();
     
     // The following functions are internal to the regexp tests.
     virtual void assertUText(const char *expected, UText *actual, const char *file, int line);
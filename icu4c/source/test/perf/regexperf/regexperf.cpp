@@ -0,0 +1,458 @@
+/*
+**************************************************************************
+*    Copyright (C) 2016 and later: Unicode, Inc. and others.
+*    License & terms of use: http://www.unicode.org/copyright.html#License
+**************************************************************************
+**************************************************************************
+*   Copyright (C) 2016, International Business Machines
+*   Corporation and others.  All Rights Reserved.
+**************************************************************************
+*   file name:  regexperf.cpp
+*   encoding:   US-ASCII
+*   tab size:   8 (not used)
+*   indentation:4
+*
+*   Performance test for RegexMatcher::find() over a large input text,
+*   with the input in a UnicodeString (UTF-16) and in a UTF-8 UText.
+*   The Groups variants also fetch the offsets of all capture groups of each match.
+*   MatcherPerLine creates a new matcher for each line of the text, as a server
+*   would for each request.
+*   The Corpus tests ignore --pattern and use a fixed set of patterns of the kinds
+*   found in real applications, to catch regressions in the pattern compiler's
+*   optimizations: CorpusCompile compiles all of them, and the CorpusFind tests
+*   find all of the matches of each of them in the text.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unicode/uperf.h"
+#include "unicode/regex.h"
+#include "unicode/unistr.h"
+#include "unicode/ustring.h"
+#include "unicode/utext.h"
+#include "uoptions.h"
+#include "cmemory.h" // for UPRV_LENGTHOF
+
+#if !UCONFIG_NO_REGULAR_EXPRESSIONS
+
+// Command-line options specific to regexperf.
+// Options do not have abbreviations: Force readable command lines.
+// (Using U+0001 for abbreviation characters.)
+enum {
+    REGEX_PATTERN,
+    REGEX_REPEAT,
+    REGEXPERF_OPTIONS_COUNT
+};
+
+static UOption options[REGEXPERF_OPTIONS_COUNT]={
+    UOPTION_DEF("pattern", '\x01', UOPT_REQUIRES_ARG),
+    UOPTION_DEF("repeat",  '\x01', UOPT_REQUIRES_ARG)
+};
+
+static const char *const regexperf_usage =
+    "\t--pattern   Regular expression, in the ICU regex syntax.\n"
+    "\t            Default: ERROR\\s+(\\d+)\n"
+    "\t            Other interesting start types: E\\w+ (char), [A-Z]\\w+ (set)\n"
+    "\t--repeat    Number of copies of the input file text to search.\n"
+    "\t            Default: 1\n";
+
+// Patterns for the Corpus tests, in the ICU regex syntax.
+static const char *const corpusPatterns[] = {
+    "\\d{1,3}\\.\\d{1,3}\\.\\d{1,3}\\.\\d{1,3}",  // IPv4 address
+    "[\\w.+-]+@[\\w-]+\\.[\\w.-]+",               // e-mail address
+    "https?://[^\\s/]+(/\\S*)?",                  // URL
+    "\\d{4}-\\d{2}-\\d{2}",                       // ISO date
+    "\\d+:\\d+:\\d+",                             // time of day
+    "\\b(?:ERROR|WARN|FATAL)\\b",                 // log level keywords
+    "(?:GET|POST|PUT|DELETE|HEAD) (\\S+)",        // HTTP request line
+    "(\\w+)=(\\S+)",                              // key=value
+    "^\\s*(\\w+)\\s*:",                           // field name at a line start
+    "\"[^\"]*\"",                                 // quoted string
+    "0x[0-9A-Fa-f]+",                             // hexadecimal number
+    "[A-Z][a-z]+\\s+[A-Z][a-z]+",                 // two capitalized words
+    "[a-z]+ing\\b",                               // words ending in "ing"
+    ".*timeout",                                  // line with a keyword
+    "(\\w+)\\s+\\1",                              // repeated word
+};
+
+// Test object with setup data.
+class RegexPerformanceTest : public UPerfTest {
+public:
+    RegexPerformanceTest(int32_t argc, const char *argv[], UErrorCode &status)
+            : UPerfTest(argc, argv, options, UPRV_LENGTHOF(options), regexperf_usage, status),
+              pattern(NULL), utf8(NULL), utf8Length(0), matchCount(0), lineMatchCount(0),
+              corpusMatchCount(0) {
+        for (int32_t i = 0; i < UPRV_LENGTHOF(corpus); ++i) {
+            corpus[i] = NULL;
+        }
+        if (U_FAILURE(status)) {
+            return;
+        }
+        // No unescape(): the regex syntax itself handles \uhhhh and other escapes.
+        UnicodeString patternString(options[REGEX_PATTERN].value, -1, US_INV);
+        UParseError pe;
+        pattern = RegexPattern::compile(patternString, 0, pe, status);
+        if (U_FAILURE(status)) {
+            fprintf(stderr, "error: unable to compile the pattern - %s\n", u_errorName(status));
+            return;
+        }
+
+        int32_t inputLength;
+        const UChar *input = UPerfTest::getBuffer(inputLength, status);
+        if (U_FAILURE(status) || inputLength <= 0) {
+            return;
+        }
+        int32_t repeat = atoi(options[REGEX_REPEAT].value);
+        for (int32_t i = 0; i < repeat || i == 0; ++i) {
+            text.append(input, inputLength);
+        }
+
+        // Preflight the UTF-8 length and allocate utf8.
+        u_strToUTF8(NULL, 0, &utf8Length, text.getBuffer(), text.length(), &status);
+        if (status == U_BUFFER_OVERFLOW_ERROR) {
+            utf8 = (char *)malloc(utf8Length);
+            if (utf8 != NULL) {
+                status = U_ZERO_ERROR;
+                u_strToUTF8(utf8, utf8Length, NULL, text.getBuffer(), text.length(), &status);
+            } else {
+                status = U_MEMORY_ALLOCATION_ERROR;
+            }
+        }
+
+        LocalPointer<RegexMatcher> matcher(pattern->matcher(text, status));
+        while (U_SUCCESS(status) && matcher->find(status)) {
+            ++matchCount;
+        }
+        // Matches within lines, for MatcherPerLine.
+        int32_t lineStart = 0;
+        while (U_SUCCESS(status) && lineStart < text.length()) {
+            int32_t lineLimit = text.indexOf((UChar)0x0a, lineStart);
+            lineLimit = lineLimit < 0 ? text.length() : lineLimit + 1;
+            matcher->region(lineStart, lineLimit, status);
+            while (U_SUCCESS(status) && matcher->find(status)) {
+                ++lineMatchCount;
+            }
+            lineStart = lineLimit;
+        }
+        if (verbose) {
+            printf("len16:%ld  len8:%ld  matches:%ld  line matches:%ld\n",
+                   (long)text.length(), (long)utf8Length, (long)matchCount, (long)lineMatchCount);
+        }
+
+        // The Corpus patterns, and the number of matches of all of them.
+        for (int32_t i = 0; i < UPRV_LENGTHOF(corpusPatterns) && U_SUCCESS(status); ++i) {
+            corpus[i] = RegexPattern::compile(
+                UnicodeString(corpusPatterns[i], -1, US_INV), UREGEX_MULTILINE, pe, status);
+            if (U_FAILURE(status)) {
+                fprintf(stderr, "error: unable to compile the corpus pattern %s - %s\n",
+                        corpusPatterns[i], u_errorName(status));
+                break;
+            }
+            int32_t count = 0;
+            matcher.adoptInstead(corpus[i]->matcher(text, status));
+            while (U_SUCCESS(status) && matcher->find(status)) {
+                ++count;
+            }
+            if (verbose) {
+                printf("corpus pattern %s  matches:%ld\n", corpusPatterns[i], (long)count);
+            }
+            corpusMatchCount += count;
+        }
+    }
+
+    virtual ~RegexPerformanceTest() {
+        delete pattern;
+        for (int32_t i = 0; i < UPRV_LENGTHOF(corpus); ++i) {
+            delete corpus[i];
+        }
+        free(utf8);
+    }
+
+    virtual UPerfFunction* runIndexedTest(int32_t index, UBool exec, const char* &name, char* par = NULL);
+
+    RegexPattern *pattern;
+    UnicodeString text;
+    char *utf8;
+    int32_t utf8Length;
+    int32_t matchCount;
+    int32_t lineMatchCount;
+    RegexPattern *corpus[UPRV_LENGTHOF(corpusPatterns)];
+    int32_t corpusMatchCount;
+};
+
+// Performance test function object.
+class Command : public UPerfFunction {
+protected:
+    Command(const RegexPerformanceTest &testcase) : testcase(testcase) {}
+
+public:
+    virtual ~Command() {}
+
+    virtual long getOperationsPerIteration() {
+        // Number of UTF-16 code units searched.
+        return testcase.text.length();
+    }
+
+    virtual long getEventsPerIteration() {
+        return testcase.matchCount;
+    }
+
+    void checkCount(const char *name, int32_t count) {
+        if (count != testcase.matchCount) {
+            fprintf(stderr, "error: %s() count=%ld != %ld=RegexPerformanceTest.matchCount\n",
+                    name, (long)count, (long)testcase.matchCount);
+        }
+    }
+
+    const RegexPerformanceTest &testcase;
+};
+
+// Fetch the start and end offsets of all groups of the current match.
+static void getGroupOffsets(RegexMatcher &matcher, UErrorCode &status) {
+    for (int32_t group = 0; group <= matcher.groupCount(); ++group) {
+        matcher.start64(group, status);
+        matcher.end64(group, status);
+    }
+}
+
+class FindUTF16 : public Command {
+protected:
+    FindUTF16(const RegexPerformanceTest &testcase, UBool groups, UErrorCode &status)
+            : Command(testcase), matcher(testcase.pattern->matcher(status)), groups(groups) {}
+public:
+    static UPerfFunction* get(const RegexPerformanceTest &testcase, UBool groups) {
+        UErrorCode status = U_ZERO_ERROR;
+        FindUTF16 *command = new FindUTF16(testcase, groups, status);
+        if (U_FAILURE(status)) {
+            delete command;
+            return NULL;
+        }
+        return command;
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        matcher->reset(testcase.text);
+        int32_t count = 0;
+        while (matcher->find(*pErrorCode)) {
+            ++count;
+            if (groups) {
+                getGroupOffsets(*matcher, *pErrorCode);
+            }
+        }
+        checkCount("FindUTF16", count);
+    }
+private:
+    LocalPointer<RegexMatcher> matcher;
+    UBool groups;
+};
+
+class FindUTF8 : public Command {
+protected:
+    FindUTF8(const RegexPerformanceTest &testcase, UBool groups, UErrorCode &status)
+            : Command(testcase), matcher(testcase.pattern->matcher(status)), groups(groups) {}
+public:
+    static UPerfFunction* get(const RegexPerformanceTest &testcase, UBool groups) {
+        UErrorCode status = U_ZERO_ERROR;
+        FindUTF8 *command = new FindUTF8(testcase, groups, status);
+        if (U_FAILURE(status)) {
+            delete command;
+            return NULL;
+        }
+        return command;
+    }
+    virtual long getOperationsPerIteration() {
+        // Number of UTF-8 bytes searched.
+        return testcase.utf8Length;
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        UText utf8Text = UTEXT_INITIALIZER;
+        utext_openUTF8(&utf8Text, testcase.utf8, testcase.utf8Length, pErrorCode);
+        matcher->reset(&utf8Text);
+        int32_t count = 0;
+        while (matcher->find(*pErrorCode)) {
+            ++count;
+            if (groups) {
+                getGroupOffsets(*matcher, *pErrorCode);
+            }
+        }
+        utext_close(&utf8Text);
+        checkCount("FindUTF8", count);
+    }
+private:
+    LocalPointer<RegexMatcher> matcher;
+    UBool groups;
+};
+
+class MatcherPerLine : public Command {
+protected:
+    MatcherPerLine(const RegexPerformanceTest &testcase) : Command(testcase) {}
+public:
+    static UPerfFunction* get(const RegexPerformanceTest &testcase) {
+        return new MatcherPerLine(testcase);
+    }
+    virtual long getEventsPerIteration() {
+        return testcase.lineMatchCount;
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        const UChar *s = testcase.text.getBuffer();
+        int32_t length = testcase.text.length();
+        int32_t count = 0;
+        int32_t lineStart = 0;
+        while (lineStart < length && U_SUCCESS(*pErrorCode)) {
+            int32_t lineLimit = lineStart;
+            while (lineLimit < length && s[lineLimit++] != 0x0a) {}
+            UText line = UTEXT_INITIALIZER;
+            utext_openUChars(&line, s + lineStart, lineLimit - lineStart, pErrorCode);
+            RegexMatcher *matcher = testcase.pattern->matcher(*pErrorCode);
+            if (matcher != NULL) {
+                matcher->reset(&line);
+                while (matcher->find(*pErrorCode)) {
+                    ++count;
+                }
+                delete matcher;
+            }
+            utext_close(&line);
+            lineStart = lineLimit;
+        }
+        if (count != testcase.lineMatchCount) {
+            fprintf(stderr, "error: MatcherPerLine() count=%ld != %ld=RegexPerformanceTest.lineMatchCount\n",
+                    (long)count, (long)testcase.lineMatchCount);
+        }
+    }
+};
+
+class CorpusCompile : public Command {
+protected:
+    CorpusCompile(const RegexPerformanceTest &testcase) : Command(testcase) {
+        for (int32_t i = 0; i < UPRV_LENGTHOF(corpusPatterns); ++i) {
+            patterns[i] = UnicodeString(corpusPatterns[i], -1, US_INV);
+        }
+    }
+public:
+    static UPerfFunction* get(const RegexPerformanceTest &testcase) {
+        return new CorpusCompile(testcase);
+    }
+    virtual long getOperationsPerIteration() {
+        // Number of patterns compiled.
+        return UPRV_LENGTHOF(corpusPatterns);
+    }
+    virtual long getEventsPerIteration() {
+        return -1;
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        UParseError pe;
+        for (int32_t i = 0; i < UPRV_LENGTHOF(patterns) && U_SUCCESS(*pErrorCode); ++i) {
+            delete RegexPattern::compile(patterns[i], UREGEX_MULTILINE, pe, *pErrorCode);
+        }
+    }
+private:
+    UnicodeString patterns[UPRV_LENGTHOF(corpusPatterns)];
+};
+
+class CorpusFind : public Command {
+protected:
+    CorpusFind(const RegexPerformanceTest &testcase, UBool utf8, UErrorCode &status)
+            : Command(testcase), utf8(utf8) {
+        for (int32_t i = 0; i < UPRV_LENGTHOF(matchers); ++i) {
+            matchers[i] = U_SUCCESS(status) ? testcase.corpus[i]->matcher(status) : NULL;
+        }
+    }
+public:
+    static UPerfFunction* get(const RegexPerformanceTest &testcase, UBool utf8) {
+        UErrorCode status = U_ZERO_ERROR;
+        CorpusFind *command = new CorpusFind(testcase, utf8, status);
+        if (U_FAILURE(status)) {
+            delete command;
+            return NULL;
+        }
+        return command;
+    }
+    virtual ~CorpusFind() {
+        for (int32_t i = 0; i < UPRV_LENGTHOF(matchers); ++i) {
+            delete matchers[i];
+        }
+    }
+    virtual long getOperationsPerIteration() {
+        // Number of code units searched, once per pattern.
+        return (long)(utf8 ? testcase.utf8Length : testcase.text.length()) *
+               UPRV_LENGTHOF(corpusPatterns);
+    }
+    virtual long getEventsPerIteration() {
+        return testcase.corpusMatchCount;
+    }
+    virtual void call(UErrorCode* pErrorCode) {
+        UText utf8Text = UTEXT_INITIALIZER;
+        if (utf8) {
+            utext_openUTF8(&utf8Text, testcase.utf8, testcase.utf8Length, pErrorCode);
+        }
+        int32_t count = 0;
+        for (int32_t i = 0; i < UPRV_LENGTHOF(matchers); ++i) {
+            RegexMatcher *matcher = matchers[i];
+            if (utf8) {
+                matcher->reset(&utf8Text);
+            } else {
+                matcher->reset(testcase.text);
+            }
+            while (matcher->find(*pErrorCode)) {
+                ++count;
+            }
+        }
+        utext_close(&utf8Text);
+        if (count != testcase.corpusMatchCount) {
+            fprintf(stderr, "error: CorpusFind() count=%ld != %ld=RegexPerformanceTest.corpusMatchCount\n",
+                    (long)count, (long)testcase.corpusMatchCount);
+        }
+    }
+private:
+    RegexMatcher *matchers[UPRV_LENGTHOF(corpusPatterns)];
+    UBool utf8;
+};
+
+UPerfFunction* RegexPerformanceTest::runIndexedTest(int32_t index, UBool exec, const char* &name, char* /*par*/) {
+    switch (index) {
+        case 0: name = "FindUTF16";         if (exec) return FindUTF16::get(*this, FALSE); break;
+        case 1: name = "FindUTF8";          if (exec) return FindUTF8::get(*this, FALSE); break;
+        case 2: name = "FindGroupsUTF16";   if (exec) return FindUTF16::get(*this, TRUE); break;
+        case 3: name = "FindGroupsUTF8";    if (exec) return FindUTF8::get(*this, TRUE); break;
+        case 4: name = "MatcherPerLine";    if (exec) return MatcherPerLine::get(*this); break;
+        case 5: name = "CorpusCompile";     if (exec) return CorpusCompile::get(*this); break;
+        case 6: name = "CorpusFindUTF16";   if (exec) return CorpusFind::get(*this, FALSE); break;
+        case 7: name = "CorpusFindUTF8";    if (exec) return CorpusFind::get(*this, TRUE); break;
+        default: name = ""; break;
+    }
+    return NULL;
+}
+
+int main(int argc, const char *argv[])
+{
+    // Default values for command-line options.
+    options[REGEX_PATTERN].value = "ERROR\\s+(\\d+)";
+    options[REGEX_REPEAT].value = "1";
+
+    UErrorCode status = U_ZERO_ERROR;
+    RegexPerformanceTest test(argc, argv, status);
+
+    if (U_FAILURE(status)){
+        printf("The error is %s\n", u_errorName(status));
+        test.usage();
+        return status;
+    }
+
+    if (test.run() == FALSE){
+        fprintf(stderr, "FAILED: Tests could not be run, please check the "
+                        "arguments.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+#else
+
+int main(int /*argc*/, const char * /*argv*/[])
+{
+    fprintf(stderr, "regexperf: regular expressions are not available (UCONFIG_NO_REGULAR_EXPRESSIONS)\n");
+    return 1;
+}
+
+#endif